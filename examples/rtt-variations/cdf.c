@@ -112,22 +112,18 @@ double interpolate(double x, double x1, double y1, double x2, double y2)
         return y1 + (x - x1) * (y2 - y1) / (x2 - x1);
 }
 
-/* generate a random floating point number from min to max */
-double rand_range(double min, double max)
-{
-    return min + rand() * (max - min) / RAND_MAX;
-}
-
-/* generate a random value based on CDF distribution */
-double gen_random_cdf(struct cdf_table *table)
+/* generate a random value based on CDF distribution, uniform is in [0, 1) */
+double gen_random_cdf(struct cdf_table *table, double uniform)
 {
     int i = 0;
-    double x = rand_range(table->min_cdf, table->max_cdf);
-    /* printf("%f %f %f\n", x, table->min_cdf, table->max_cdf); */
+    double x;
 
     if (!table)
         return 0;
 
+    x = table->min_cdf + uniform * (table->max_cdf - table->min_cdf);
+    /* printf("%f %f %f\n", x, table->min_cdf, table->max_cdf); */
+
     for (i = 0; i < table->num_entry; i++)
     {
         if (x <= table->entries[i].cdf)
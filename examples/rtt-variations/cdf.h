@@ -37,7 +37,8 @@ void print_cdf(struct cdf_table *table);
 /* get average value of CDF distribution */
 double avg_cdf(struct cdf_table *table);
 
-/* Generate a random value based on CDF distribution */
-double gen_random_cdf(struct cdf_table *table);
+/* Generate a random value based on CDF distribution from a uniform
+ * value in [0, 1), e.g. drawn from a UniformRandomVariable */
+double gen_random_cdf(struct cdf_table *table, double uniform);
 
 #endif
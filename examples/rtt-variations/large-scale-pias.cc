@@ -37,21 +37,21 @@ enum AQM {
 };
 
 // Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
-double poission_gen_interval(double avg_rate)
+double poission_gen_interval(Ptr<UniformRandomVariable> uniform, double avg_rate)
 {
   if (avg_rate > 0)
-    return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
+    return -logf(1.0 - uniform->GetValue ()) / avg_rate;
   else
     return 0;
 }
 
 template<typename T>
-T rand_range (T min, T max)
+T rand_range (Ptr<UniformRandomVariable> uniform, T min, T max)
 {
-  return min + ((double)max - min) * rand () / RAND_MAX;
+  return min + ((double)max - min) * uniform->GetValue ();
 }
 
-void install_applications (int fromLeafId, NodeContainer servers, double requestRate, struct cdf_table *cdfTable,
+void install_applications (int fromLeafId, NodeContainer servers, double requestRate, struct cdf_table *cdfTable, Ptr<UniformRandomVariable> uniform,
                            long &flowCount, long &totalFlowSize, int SERVER_COUNT, int LEAF_COUNT, double START_TIME, double END_TIME, double FLOW_LAUNCH_END_TIME)
 {
   NS_LOG_INFO ("Install applications:");
@@ -59,7 +59,7 @@ void install_applications (int fromLeafId, NodeContainer servers, double request
     {
       int fromServerIndex = fromLeafId * SERVER_COUNT + i;
 
-      double startTime = START_TIME + poission_gen_interval (requestRate);
+      double startTime = START_TIME + poission_gen_interval (uniform, requestRate);
       while (startTime < FLOW_LAUNCH_END_TIME)
         {
           flowCount ++;
@@ -68,7 +68,7 @@ void install_applications (int fromLeafId, NodeContainer servers, double request
           int destServerIndex = fromServerIndex;
           while (destServerIndex >= fromLeafId * SERVER_COUNT && destServerIndex < fromLeafId * SERVER_COUNT + SERVER_COUNT)
             {
-              destServerIndex = rand_range (0, SERVER_COUNT * LEAF_COUNT);
+              destServerIndex = rand_range (uniform, 0, SERVER_COUNT * LEAF_COUNT);
             }
 
           Ptr<Node> destServer = servers.Get (destServerIndex);
@@ -77,8 +77,8 @@ void install_applications (int fromLeafId, NodeContainer servers, double request
           Ipv4Address destAddress = destInterface.GetLocal ();
 
           BulkSendPiasHelper source ("ns3::TcpSocketFactory", InetSocketAddress (destAddress, port));
-          uint32_t flowSize = gen_random_cdf (cdfTable);
-          uint32_t deplayClass = rand() % 5;
+          uint32_t flowSize = gen_random_cdf (cdfTable, uniform->GetValue ());
+          uint32_t deplayClass = uniform->GetInteger (0, 4);
 
           totalFlowSize += flowSize;
 
@@ -99,7 +99,7 @@ void install_applications (int fromLeafId, NodeContainer servers, double request
           sinkApp.Start (Seconds (START_TIME));
           sinkApp.Stop (Seconds (END_TIME));
 
-          startTime += poission_gen_interval (requestRate);
+          startTime += poission_gen_interval (uniform, requestRate);
         }
     }
 }
@@ -141,8 +141,11 @@ int main (int argc, char *argv[])
   uint32_t ECNSharpTarget = 10;
   uint32_t ECNSharpMarkingThreshold = 80;
 
+  bool enableFlowMonitor = true;
+
   CommandLine cmd;
   cmd.AddValue ("ID", "Running ID", id);
+  cmd.AddValue ("flowMonitor", "Whether to dump the flow monitor XML, the FCTs are always collected", enableFlowMonitor);
   cmd.AddValue ("StartTime", "Start time of the simulation", START_TIME);
   cmd.AddValue ("EndTime", "End time of the simulation", END_TIME);
   cmd.AddValue ("FlowLaunchEndTime", "End time of the flow launch period", FLOW_LAUNCH_END_TIME);
@@ -404,14 +407,8 @@ int main (int argc, char *argv[])
   NS_LOG_INFO ("Average request rate: " << requestRate << " per second");
 
   NS_LOG_INFO ("Initialize random seed: " << randomSeed);
-  if (randomSeed == 0)
-    {
-      srand ((unsigned)time (NULL));
-    }
-  else
-    {
-      srand (randomSeed);
-    }
+  RngSeedManager::SetSeed (randomSeed == 0 ? (unsigned)time (NULL) : randomSeed);
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
 
   NS_LOG_INFO ("Create applications");
 
@@ -420,32 +417,43 @@ int main (int argc, char *argv[])
 
   for (int fromLeafId = 0; fromLeafId < LEAF_COUNT; fromLeafId ++)
     {
-      install_applications(fromLeafId, servers, requestRate, cdfTable, flowCount, totalFlowSize, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
+      install_applications(fromLeafId, servers, requestRate, cdfTable, uniform, flowCount, totalFlowSize, SERVER_COUNT, LEAF_COUNT, START_TIME, END_TIME, FLOW_LAUNCH_END_TIME);
     }
 
   NS_LOG_INFO ("Total flow: " << flowCount);
 
   NS_LOG_INFO ("Actual average flow size: " << static_cast<double> (totalFlowSize) / flowCount);
 
-  NS_LOG_INFO ("Enabling flow monitor");
-
-  Ptr<FlowMonitor> flowMonitor;
-  FlowMonitorHelper flowHelper;
-  flowMonitor = flowHelper.InstallAll();
-
-
-  flowMonitor->CheckForLostPackets ();
+  NS_LOG_INFO ("Enabling FCT collector");
 
-  std::stringstream flowMonitorFilename;
+  std::stringstream resultPrefix;
+  resultPrefix << "Large_Scale_PIAS_" <<id << "_" << LEAF_COUNT << "X" << SPINE_COUNT << "_" << aqmStr << "_"  << transportProt << "_" << load;
 
-  flowMonitorFilename << "Large_Scale_PIAS_" <<id << "_" << LEAF_COUNT << "X" << SPINE_COUNT << "_" << aqmStr << "_"  << transportProt << "_" << load << ".xml";
+  Ptr<FctCollector> fctCollector = CreateObject<FctCollector> ();
+  fctCollector->InstallAll ();
 
+  Ptr<FlowMonitor> flowMonitor;
+  FlowMonitorHelper flowHelper;
+  if (enableFlowMonitor)
+    {
+      NS_LOG_INFO ("Enabling flow monitor");
+      flowMonitor = flowHelper.InstallAll();
+      flowMonitor->CheckForLostPackets ();
+    }
 
   NS_LOG_INFO ("Start simulation");
   Simulator::Stop (Seconds (END_TIME));
   Simulator::Run ();
 
-  flowMonitor->SerializeToXmlFile(flowMonitorFilename.str (), true, true);
+  if (enableFlowMonitor)
+    {
+      flowMonitor->SerializeToXmlFile(resultPrefix.str () + ".xml", true, true);
+    }
+
+  NS_LOG_INFO ("Completed flows: " << fctCollector->GetNCompleted ()
+               << ", unfinished: " << fctCollector->GetNInProgress ());
+  fctCollector->WriteRecords (resultPrefix.str () + "_fct.csv");
+  fctCollector->WriteSummary (resultPrefix.str () + "_fct_summary.csv");
 
   Simulator::Destroy ();
   free_cdf (cdfTable);
@@ -5,7 +5,10 @@
 #include "ns3/flow-monitor-module.h"
 #include "ns3/point-to-point-module.h"
 #include "ns3/traffic-control-module.h"
+#include "ns3/tlb-module.h"
+#include "ns3/datacenter-topology-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
 
 #include "ns3/ptr.h"
 #include "ns3/address.h"
@@ -54,6 +57,7 @@ enum AQM {
 
 // badly written global variables
 std::string result_dir = "tmp_index";
+Ptr<PacketTraceWriter> packetTrace;
 double app_seconds_start0 = 0.1;
 
 void ParseAppBw (std::string input, std::vector<std::string>* values) {
@@ -110,9 +114,7 @@ static void RxWithAddressesPacketSink (Ptr<const Packet> p, const Address &) {
   MySourceIDTag tag;
   if (p->FindFirstMatchingByteTag(tag)) {}
 
-  std::ofstream throput_ofs2 (result_dir + "/received_ms.dat", std::ios::out | std::ios::app);
-  throput_ofs2 << "[" << Simulator::Now ().GetMilliSeconds() << "] SourceIDTag: " << tag.Get() << ", size: " << p->GetSize()
-              << std::endl;
+  packetTrace->Write (PacketTraceRecord::RECEIVED, tag.Get (), p->GetSize ());
 }
 
 // // create an example to check where the packet drops
@@ -158,16 +160,15 @@ int main (int argc, char *argv[]) {
   std::string runModeStr = "Conga";
   uint32_t letFlowFlowletTimeout = 500;
   uint32_t congaFlowletTimeout = 500;
+  uint32_t tlbDecisionLogSize = 0; // TLB decisions kept, 0 to disable the log
+  uint32_t simulatorThreads = 0; // 0 for the sequential simulator
+  double flowBenderT = 0.05;
+  uint32_t flowBenderN = 1;
 
   // Other parameters
   uint64_t SPINE_LEAF_CAPACITY = spineLeafCapacity * LINK_CAPACITY_BASE;
   uint64_t LEAF_SERVER_CAPACITY = leafServerCapacity * LINK_CAPACITY_BASE;
   Time LINK_LATENCY = MicroSeconds (linkLatency);
-  /* Selective Acknowledgment: Enabling SACK allows the receiving party to explicitly 
-  notify the sender about which data packets have been successfully received, thereby 
-  enhancing the recovery efficiency in the case of lost packets. */ 
-  bool sack = true; 
-  std::string recovery = "ns3::TcpClassicRecovery";
 
   CommandLine cmd;
   cmd.AddValue ("StartTime", "Start time of the simulation", START_TIME);
@@ -194,9 +195,19 @@ int main (int argc, char *argv[]) {
   cmd.AddValue ("runMode", "Running mode of this simulation: Conga, Conga-flow, Presto, Weighted-Presto, DRB, FlowBender, ECMP, Clove, DRILL, LetFlow", runModeStr);
   cmd.AddValue ("letFlowFlowletTimeout", "Flowlet timeout in LetFlow", letFlowFlowletTimeout);
   cmd.AddValue ("congaFlowletTimeout", "Flowlet timeout in Conga", congaFlowletTimeout);
+  cmd.AddValue ("flowBenderT", "The T in FlowBender", flowBenderT);
+  cmd.AddValue ("flowBenderN", "The N in FlowBender", flowBenderN);
+  cmd.AddValue ("tlbDecisionLogSize", "Number of TLB path decisions kept in tlb-decisions.bin, 0 to disable", tlbDecisionLogSize);
+  cmd.AddValue ("simulatorThreads", "Threads running the nodes with the multithreaded simulator, 0 for the sequential one", simulatorThreads);
 
   cmd.Parse (argc, argv);
 
+  if (simulatorThreads > 0) {
+    Ptr<MultithreadedSimulatorImpl> simulator = CreateObject<MultithreadedSimulatorImpl> ();
+    simulator->SetAttribute ("ThreadCount", UintegerValue (simulatorThreads));
+    Simulator::SetImplementation (simulator);
+  }
+
   AQM aqm;
   if (aqmStr.compare ("TCN") == 0) {
     aqm = TCN;
@@ -227,6 +238,7 @@ int main (int argc, char *argv[]) {
       std::cout << "ERR: " << rm_dir_cmd2 << " failed, proceed anyway." << std::endl;
     }
   }
+  packetTrace = Create<PacketTraceWriter> (result_dir + "/packets.bin");
 
   if (transportProt.compare ("DcTcp") == 0) {
     NS_LOG_INFO ("Enabling DcTcp");
@@ -265,8 +277,6 @@ int main (int argc, char *argv[]) {
   Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 30)); // RcvBufSize: TcpSocket maximum receive buffer size (bytes)
   Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 30)); // SndBufSize: TcpSocket maximum transmit buffer size (bytes)
   Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (app_packet_size));
-  Config::SetDefault ("ns3::TcpSocketBase::Sack", BooleanValue (sack));
-  Config::SetDefault ("ns3::TcpL4Protocol::RecoveryType", TypeIdValue (TypeId::LookupByName (recovery)));
 
   RunMode runMode;
   if (runModeStr.compare ("TLB") == 0) {
@@ -327,311 +337,80 @@ int main (int argc, char *argv[]) {
     return 0;
   }
 
-  // create the nodes
-  NodeContainer spines;
-  spines.Create (SPINE_COUNT);
-  NodeContainer leaves;
-  leaves.Create (LEAF_COUNT);
-  NodeContainer servers;
-  servers.Create (SERVER_COUNT * LEAF_COUNT);
-
-  NS_LOG_INFO ("Install Internet stacks");
-  InternetStackHelper internet;
-  Ipv4StaticRoutingHelper staticRoutingHelper;
-  Ipv4CongaRoutingHelper congaRoutingHelper;
-  Ipv4GlobalRoutingHelper globalRoutingHelper;
-  Ipv4ListRoutingHelper listRoutingHelper;
-  Ipv4XPathRoutingHelper xpathRoutingHelper;
-  Ipv4DrbRoutingHelper drbRoutingHelper;
-  Ipv4DrillRoutingHelper drillRoutingHelper;
-  Ipv4LetFlowRoutingHelper letFlowRoutingHelper;
-
-  if (runMode == TLB) {
-    internet.SetTLB (true);
-    internet.Install (servers);
-
-    internet.SetTLB (false);
-    listRoutingHelper.Add (xpathRoutingHelper, 1);
-    listRoutingHelper.Add (globalRoutingHelper, 0);
-    internet.SetRoutingHelper (listRoutingHelper);
-    Config::SetDefault ("ns3::Ipv4GlobalRouting::PerflowEcmpRouting", BooleanValue(true));
-    internet.Install (spines);
-    internet.Install (leaves);
-  } 
-  else if (runMode == CONGA || runMode == CONGA_FLOW || runMode == CONGA_ECMP) {
-    internet.SetRoutingHelper (staticRoutingHelper);
-    internet.Install (servers);
-
-    internet.SetRoutingHelper (congaRoutingHelper);
-    internet.Install (spines);
-    internet.Install (leaves);
-  } 
-  else if (runMode == PRESTO || runMode == WEIGHTED_PRESTO || runMode == DRB) {
-    if (runMode == DRB) {
-        Config::SetDefault ("ns3::Ipv4DrbRouting::Mode", UintegerValue (0)); // Per dest
-    } 
-    else {
-        Config::SetDefault ("ns3::Ipv4DrbRouting::Mode", UintegerValue (1)); // Per flow
-    }
-    listRoutingHelper.Add (drbRoutingHelper, 1);
-    listRoutingHelper.Add (globalRoutingHelper, 0);
-    internet.SetRoutingHelper (listRoutingHelper);
-    internet.Install (servers);
-
-    listRoutingHelper.Clear ();
-    listRoutingHelper.Add (xpathRoutingHelper, 1);
-    listRoutingHelper.Add (globalRoutingHelper, 0);
-    internet.SetRoutingHelper (listRoutingHelper);
-    internet.Install (spines);
-    internet.Install (leaves);
-  } 
-  else if (runMode == FlowBender || runMode == ECMP) {
-    if (runMode == FlowBender) {
-      NS_LOG_INFO ("Enabling Flow Bender");
-      if (transportProt.compare ("Tcp") == 0) {
-          NS_LOG_ERROR ("FlowBender has to be working with DCTCP");
-          return 0;
-      }
-      Config::SetDefault ("ns3::TcpSocketBase::FlowBender", BooleanValue (true));
-      Config::SetDefault ("ns3::TcpFlowBender::T", DoubleValue (flowBenderT));
-      Config::SetDefault ("ns3::TcpFlowBender::N", UintegerValue (flowBenderN));
+  NS_LOG_INFO ("Initialize random seed: " << randomSeed);
+  RngSeedManager::SetSeed (randomSeed == 0 ? (unsigned)time (NULL) : randomSeed);
+
+  NS_LOG_INFO ("Build the leaf-spine topology");
+  DatacenterTopologyHelper topology;
+  topology.SetLeafSpine (SPINE_COUNT, LEAF_COUNT, SERVER_COUNT, LINK_COUNT);
+  topology.SetServerLinkAttributes (DataRate (LEAF_SERVER_CAPACITY), LINK_LATENCY);
+  topology.SetFabricLinkAttributes (DataRate (SPINE_LEAF_CAPACITY), LINK_LATENCY);
+  topology.SetDeviceQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (10));
+  topology.SetServerQueueDisc ("ns3::DelayQueueDisc");
+  if (aqm == TCN) {
+    topology.SetSwitchQueueDisc ("ns3::TCNQueueDisc");
+  }
+  else {
+    topology.SetSwitchQueueDisc ("ns3::ECNSharpQueueDisc");
+  }
+  if (runMode == FlowBender) {
+    NS_LOG_INFO ("Enabling Flow Bender");
+    if (transportProt.compare ("Tcp") == 0) {
+      NS_LOG_ERROR ("FlowBender has to be working with DCTCP");
+      return 0;
     }
-    internet.SetRoutingHelper (globalRoutingHelper);
-    Config::SetDefault ("ns3::Ipv4GlobalRouting::PerflowEcmpRouting", BooleanValue(true));
-    internet.Install (servers);
-    internet.Install (spines);
-    internet.Install (leaves);
-  }
-  else if (runMode == Clove) {
-    internet.SetClove (true);
-    internet.Install (servers);
-
-    internet.SetClove (false);
-    listRoutingHelper.Add (xpathRoutingHelper, 1);
-    listRoutingHelper.Add (globalRoutingHelper, 0);
-    internet.SetRoutingHelper (listRoutingHelper);
-    Config::SetDefault ("ns3::Ipv4GlobalRouting::PerflowEcmpRouting", BooleanValue(true));
-    internet.Install (spines);
-    internet.Install (leaves);
-  }
-  else if (runMode == DRILL) {
-    internet.SetRoutingHelper (staticRoutingHelper);
-    internet.Install (servers);
-
-    internet.SetRoutingHelper (drillRoutingHelper);
-    internet.Install (spines);
-    internet.Install (leaves);
+    Config::SetDefault ("ns3::TcpFlowBender::T", DoubleValue (flowBenderT));
+    Config::SetDefault ("ns3::TcpFlowBender::N", UintegerValue (flowBenderN));
+  }
+  topology.SetLoadBalancer (runModeStr);
+  if (runMode == CONGA) {
+    topology.SetFlowletTimeout (MicroSeconds (congaFlowletTimeout));
   }
   else if (runMode == LetFlow) {
-    internet.SetRoutingHelper (staticRoutingHelper);
-    internet.Install (servers);
-
-    internet.SetRoutingHelper (letFlowRoutingHelper);
-    internet.Install (spines);
-    internet.Install (leaves);
+    topology.SetFlowletTimeout (MicroSeconds (letFlowFlowletTimeout));
+  }
+  topology.Install ();
+  topology.AssignStreams (0);
+
+  if (simulatorThreads > 1) {
+    // Place the nodes on the threads by their expected traffic
+    PointToPointPartitionHelper partition;
+    partition.Partition (NodeContainer::GetGlobal (), simulatorThreads);
+    partition.Report (std::cout);
   }
 
-  NS_LOG_INFO ("Install channels and assign addresses");
-  PointToPointHelper p2p;
-  Ipv4AddressHelper ipv4;
-
-  NS_LOG_INFO ("Configuring servers");
-  // Config parameters
-  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (LEAF_SERVER_CAPACITY)));
-  p2p.SetChannelAttribute ("Delay", TimeValue(LINK_LATENCY));
-  p2p.SetQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (10));
-  ipv4.SetBase ("10.1.0.0", "255.255.255.0");
-  
-  // Set container
-  std::vector<Ipv4Address> leafNetworks (LEAF_COUNT);
+  NodeContainer servers = topology.GetServers ();
   std::vector<Ipv4Address> serverAddresses (SERVER_COUNT * LEAF_COUNT);
-  std::map<std::pair<int, int>, uint32_t> leafToSpinePath;
-  std::map<std::pair<int, int>, uint32_t> spineToLeafPath;
-  std::vector<Ptr<Ipv4TLBProbing>> probings (SERVER_COUNT * LEAF_COUNT);
-
-  for (int i = 0; i < LEAF_COUNT; i++) {
-    Ipv4Address network = ipv4.NewNetwork ();
-    leafNetworks[i] = network;
-
-    for (int j = 0; j < SERVER_COUNT; j++) {
-      // assign addresses
-      int serverIndex = i * SERVER_COUNT + j;
-      NodeContainer nodeContainer = NodeContainer (servers.Get (serverIndex), leaves.Get (i));
-      NetDeviceContainer netDeviceContainer = p2p.Install (nodeContainer);
-      Ipv4InterfaceContainer ifc = ipv4.Assign (netDeviceContainer); 
-      serverAddresses [serverIndex] = ifc.GetAddress (0);
-
-      // about QueueDisc
-      // 1. set up the server queue disc
-      Ptr<DelayQueueDisc> delayQueueDisc = CreateObject<DelayQueueDisc> ();
-      Ptr<Ipv4SimplePacketFilter> filter = CreateObject<Ipv4SimplePacketFilter> ();
-      delayQueueDisc->AddPacketFilter (filter);
-      delayQueueDisc->AddDelayClass (0, MicroSeconds (1));
-      delayQueueDisc->AddDelayClass (1, MicroSeconds (20));
-      delayQueueDisc->AddDelayClass (2, MicroSeconds (50));
-      delayQueueDisc->AddDelayClass (3, MicroSeconds (80));
-      delayQueueDisc->AddDelayClass (4, MicroSeconds (160));
-      // 2. set up the leaf queue disc
-      ObjectFactory switchSideQueueFactory;
-      if (aqm == TCN) {
-        switchSideQueueFactory.SetTypeId ("ns3::TCNQueueDisc");
-      }
-      else {
-        switchSideQueueFactory.SetTypeId ("ns3::ECNSharpQueueDisc");
-      }
-      Ptr<QueueDisc> switchSideQueueDisc = switchSideQueueFactory.Create<QueueDisc> ();
-      // 3. install the server queue disc
-      Ptr<NetDevice> netDevice0 = netDeviceContainer.Get (0);
-      Ptr<TrafficControlLayer> tcl0 = netDevice0->GetNode ()->GetObject<TrafficControlLayer> ();
-      delayQueueDisc->SetNetDevice (netDevice0);
-      tcl0->SetRootQueueDiscOnDevice (netDevice0, delayQueueDisc);
-      // 4. install the leaf queue disc
-      Ptr<NetDevice> netDevice1 = netDeviceContainer.Get (1);
-      Ptr<TrafficControlLayer> tcl1 = netDevice1->GetNode ()->GetObject<TrafficControlLayer> ();
-      switchSideQueueDisc->SetNetDevice (netDevice1);
-      tcl1->SetRootQueueDiscOnDevice (netDevice1, switchSideQueueDisc);
-
-      // // configure the example to be the first server - leaf
-      // if (i == 0 && j == 0) {
-      //   exampleDQD = delayQueueDisc;
-      //   exampleQD = delayQueueDisc;
-      // }
-
-      NS_LOG_INFO ("Leaf - " << i << " is connected to Server - " << j << " with address " << ifc.GetAddress(1) 
-        << " <-> " << ifc.GetAddress (0) << " with port " << netDeviceContainer.Get (1)->GetIfIndex () << " <-> " 
-        << netDeviceContainer.Get (0)->GetIfIndex ());
-    
-      // routing
-      if (runMode == TLB) {
-        for (int k = 0; k < SERVER_COUNT * LEAF_COUNT; k++) {
-          Ptr<Ipv4TLB> tlb = servers.Get (k)->GetObject<Ipv4TLB> ();
-          tlb->AddAddressWithTor (ifc.GetAddress (0), i);
-        }
-      }
-      else if (runMode == CONGA || runMode == CONGA_FLOW || runMode == CONGA_ECMP) {
-        // All servers just forward ALL PACKETS to leaf switch
-		    staticRoutingHelper.GetStaticRouting (servers.Get (serverIndex)->GetObject<Ipv4> ()) ->
-			    AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), netDeviceContainer.Get (0)->GetIfIndex ());
-		    // Conga leaf switches forward the packet to the correct servers
-        congaRoutingHelper.GetCongaRouting (leaves.Get (i)->GetObject<Ipv4> ()) ->
-			    AddRoute (interfaceContainer.GetAddress (0), Ipv4Mask("255.255.255.255"), netDeviceContainer.Get (1)->GetIfIndex ());
-        for (int k = 0; k < LEAF_COUNT; k++) {
-          congaRoutingHelper.GetCongaRouting (leaves.Get (k)->GetObject<Ipv4> ()) ->
-			      AddAddressToLeafIdMap (interfaceContainer.GetAddress (0), i);
-	      }
-      }
-      else if (runMode == Clove) {
-        for (int k = 0; k < SERVER_COUNT * LEAF_COUNT; k++) {
-          Ptr<Ipv4Clove> clove = servers.Get (k)->GetObject<Ipv4Clove> ();
-          clove->AddAddressWithTor (interfaceContainer.GetAddress (0), i);
-        }
-      }
-      else if (runMode == DRILL) {
-        // All servers just forward the packet to leaf switch
-		    staticRoutingHelper.GetStaticRouting (servers.Get (serverIndex)->GetObject<Ipv4> ())->
-			    AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), netDeviceContainer.Get (0)->GetIfIndex ());
-        // DRILL leaf switches forward the packet to the correct servers
-        drillRoutingHelper.GetDrillRouting (leaves.Get (i)->GetObject<Ipv4> ())->
-			    AddRoute (interfaceContainer.GetAddress (0), Ipv4Mask("255.255.255.255"), netDeviceContainer.Get (1)->GetIfIndex ());
-      }
-      else if (runMode == LetFlow) {
-        // All servers just forward the packet to leaf switch
-		    staticRoutingHelper.GetStaticRouting (servers.Get (serverIndex)->GetObject<Ipv4> ())->
-			    AddNetworkRouteTo (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), netDeviceContainer.Get (0)->GetIfIndex ());
-        Ptr<Ipv4LetFlowRouting> letFlowLeaf = letFlowRoutingHelper.GetLetFlowRouting (leaves.Get (i)->GetObject<Ipv4> ());
-        // LetFlow leaf switches forward the packet to the correct servers
-        letFlowLeaf->AddRoute (interfaceContainer.GetAddress (0), Ipv4Mask("255.255.255.255"), netDeviceContainer.Get (1)->GetIfIndex ());
-        letFlowLeaf->SetFlowletTimeout (MicroSeconds (letFlowFlowletTimeout));
-      }
-    }
+  for (int k = 0; k < SERVER_COUNT * LEAF_COUNT; k++) {
+    serverAddresses[k] = topology.GetServerAddress (k);
+
+    // The server queue disc delays the packets according to their class
+    Ptr<DelayQueueDisc> delayQueueDisc = DynamicCast<DelayQueueDisc> (topology.GetServerQueueDisc (k));
+    Ptr<Ipv4SimplePacketFilter> filter = CreateObject<Ipv4SimplePacketFilter> ();
+    delayQueueDisc->AddPacketFilter (filter);
+    delayQueueDisc->AddDelayClass (0, MicroSeconds (1));
+    delayQueueDisc->AddDelayClass (1, MicroSeconds (20));
+    delayQueueDisc->AddDelayClass (2, MicroSeconds (50));
+    delayQueueDisc->AddDelayClass (3, MicroSeconds (80));
+    delayQueueDisc->AddDelayClass (4, MicroSeconds (160));
   }
 
-  NS_LOG_INFO ("Configuring switches");
-  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate (SPINE_LEAF_CAPACITY)));
-  std::set<std::pair<uint32_t, uint32_t> > asymLink; // set< (A, B) > Leaf A -> Spine B is asymmetric
-
-  for (int i = 0; i < LEAF_COUNT; i++) {
-    if (runMode == CONGA || runMode == CONGA_FLOW || runMode == CONGA_ECMP) {
-	    Ptr<Ipv4CongaRouting> congaLeaf = congaRoutingHelper.GetCongaRouting (leaves.Get (i)->GetObject<Ipv4> ());
-      congaLeaf->SetLeafId (i);
-	    congaLeaf->SetTDre (MicroSeconds (30));
-	    congaLeaf->SetAlpha (0.2);
-	    congaLeaf->SetLinkCapacity(DataRate(SPINE_LEAF_CAPACITY));
-	    if (runMode == CONGA) {
-	      congaLeaf->SetFlowletTimeout (MicroSeconds (congaFlowletTimeout));
-	    }
-	    if (runMode == CONGA_FLOW) {
-	      congaLeaf->SetFlowletTimeout (MilliSeconds (13));
-	    }
-	    if (runMode == CONGA_ECMP) {
-	      congaLeaf->EnableEcmpMode ();
-	    }
-    }
-    for (int j = 0; j < SPINE_COUNT; j++) {
-      for (int l = 0; l < LINK_COUNT; l++) {
-        // We do not consider asym senerio
-        // If considering asym, codes should be added here
-        // Asym means some link will have only 1/10 the capacity of others 
-        ipv4.NewNetwork ();
-
-        NodeContainer nodeContainer = NodeContainer (leaves.Get (i), spines.Get (j));
-        NetDeviceContainer netDeviceContainer = p2p.Install (nodeContainer);
-              
-        ObjectFactory switchSideQueueFactory;
-
-        if (aqm == TCN) {
-          switchSideQueueFactory.SetTypeId ("ns3::TCNQueueDisc");
-        }
-        else {
-          switchSideQueueFactory.SetTypeId ("ns3::ECNSharpQueueDisc");
-        }
-
-        // Leaf to Spine Queue
-        Ptr<QueueDisc> leafQueueDisc = switchSideQueueFactory.Create<QueueDisc> ();
-        Ptr<NetDevice> netDevice0 = netDeviceContainer.Get (0);
-        Ptr<TrafficControlLayer> tcl0 = netDevice0->GetNode ()->GetObject<TrafficControlLayer> ();
-        leafQueueDisc->SetNetDevice (netDevice0);
-        tcl0->SetRootQueueDiscOnDevice (netDevice0, leafQueueDisc);
-
-        // Spine to Leaf Queue
-        Ptr<QueueDisc> spineQueueDisc = switchSideQueueFactory.Create<QueueDisc> ();
-        Ptr<NetDevice> netDevice1 = netDeviceContainer.Get (1);
-        Ptr<TrafficControlLayer> tcl1 = netDevice1->GetNode ()->GetObject<TrafficControlLayer> ();
-        spineQueueDisc->SetNetDevice (netDevice1);
-        tcl1->SetRootQueueDiscOnDevice (netDevice1, spineQueueDisc);
-
-        Ipv4InterfaceContainer ipv4InterfaceContainer = ipv4.Assign (netDeviceContainer);
-              
-        NS_LOG_INFO ("Leaf - " << i << " is connected to Spine - " << j << " with address "
-                      << ipv4InterfaceContainer.GetAddress(0) << " <-> " << ipv4InterfaceContainer.GetAddress (1)
-                      << " with port " << netDeviceContainer.Get (0)->GetIfIndex () << " <-> " << netDeviceContainer.Get (1)->GetIfIndex ()
-                      << " with data rate " << spineLeafCapacity);
-      }
+  Ptr<TLBDecisionLog> tlbDecisionLog;
+  if (runMode == TLB && tlbDecisionLogSize > 0) {
+    tlbDecisionLog = Create<TLBDecisionLog> (tlbDecisionLogSize);
+    for (uint32_t k = 0; k < servers.GetN (); k++) {
+      servers.Get (k)->GetObject<Ipv4TLB> ()->SetDecisionLog (tlbDecisionLog);
     }
   }
 
-  NS_LOG_INFO ("Populate global routing tables");
-  Ipv4GlobalRoutingHelper::PopulateRoutingTables ();
-
   double oversubRatio = static_cast<double>(SERVER_COUNT * LEAF_SERVER_CAPACITY) / (SPINE_LEAF_CAPACITY * SPINE_COUNT * LINK_COUNT);
   NS_LOG_INFO ("Over-subscription ratio: " << oversubRatio);
 
-  NS_LOG_INFO ("Initialize random seed: " << randomSeed);
-  if (randomSeed == 0)
-    {
-      srand ((unsigned)time (NULL));
-    }
-  else
-    {
-      srand (randomSeed);
-    }
-
   NS_LOG_INFO("================== Generate application ==================");
 
   Ptr<MySource>* sources;
   sources = new Ptr<MySource>[LEAF_COUNT * SERVER_COUNT / 2];
 
-  uint32_t app_packet_size = 1440; // in bytes
   std::vector<std::string> app_bw0{};
   std::string app_bw0_str = "10Mbps";
   ParseAppBw(app_bw0_str, &app_bw0);
@@ -657,7 +436,7 @@ int main (int argc, char *argv[]) {
     Address sinkAddress (InetSocketAddress (serverAddresses [i + LEAF_COUNT * SERVER_COUNT / 2], sinkPort));
     Ptr<Socket> ns3TcpSocket = Socket::CreateSocket (servers.Get (i), TcpSocketFactory::GetTypeId ());
     Ptr<MySource> app = CreateObject<MySource> ();
-    app->Setup (ns3TcpSocket, sinkAddress, app_packet_size, &app_bw0, i, false, result_dir, &app_seconds_change0); // i provides the source id for the packets
+    app->Setup (ns3TcpSocket, sinkAddress, app_packet_size, &app_bw0, i, false, packetTrace, &app_seconds_change0); // i provides the source id for the packets
     app->SetStartTime (Seconds (START_TIME));                             
     servers.Get (i)->AddApplication (app);
     app->SetStopTime (Seconds (END_TIME));
@@ -685,4 +464,13 @@ int main (int argc, char *argv[]) {
 
   Simulator::Destroy ();
   NS_LOG_INFO ("Stop simulation");
+
+  if (tlbDecisionLog != 0) {
+    tlbDecisionLog->Write (result_dir + "/tlb-decisions.bin");
+  }
+
+  // Text layout of the per packet traces for the analysis scripts
+  packetTrace->Close ();
+  PacketTraceReader::ConvertToText (result_dir + "/packets.bin",
+                                    result_dir + "/sent_ms.dat", result_dir + "/received_ms.dat");
 }
@@ -25,9 +25,9 @@ enum AQM {
 
 // Port from Traffic Generator // Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
 double
-poission_gen_interval(double avg_rate) {
+poission_gen_interval(Ptr<UniformRandomVariable> uniform, double avg_rate) {
     if (avg_rate > 0)
-        return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
+        return -logf(1.0 - uniform->GetValue ()) / avg_rate;
     else
         return 0;
 }
@@ -42,9 +42,9 @@ void CheckThroughput (Ptr<PacketSink> sink, uint32_t senderID) {
 }
 
 template<typename T> T
-rand_range (T min, T max)
+rand_range (Ptr<UniformRandomVariable> uniform, T min, T max)
 {
-    return min + ((double)max - min) * rand () / RAND_MAX;
+    return min + ((double)max - min) * uniform->GetValue ();
 }
 
 std::string
@@ -247,14 +247,8 @@ int main (int argc, char *argv[])
 
 
     NS_LOG_INFO ("Initialize random seed: " << randomSeed);
-    if (randomSeed == 0)
-    {
-        srand ((unsigned)time (NULL));
-    }
-    else
-    {
-        srand (randomSeed);
-    }
+    RngSeedManager::SetSeed (randomSeed == 0 ? (unsigned)time (NULL) : randomSeed);
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
 
     uint16_t basePort = 8080;
 
@@ -281,8 +275,8 @@ int main (int argc, char *argv[])
     NS_LOG_INFO ("Install 100 short TCP flows");
     for (uint32_t i = 0; i < 100; ++i)
     {
-        double startTime = rand_range (0.0, 0.4);
-        uint32_t tos = rand_range (0, 3);
+        double startTime = rand_range (uniform, 0.0, 0.4);
+        uint32_t tos = rand_range (uniform, 0, 3);
         BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (switchToRecvIpv4Container.GetAddress (1), basePort));
         source.SetAttribute ("MaxBytes", UintegerValue (28000)); // 14kb
         source.SetAttribute ("SendSize", UintegerValue (1400));
@@ -9,6 +9,7 @@
 #include "ns3/data-rate.h"
 #include "ns3/traced-callback.h"
 #include "ns3/seq-ts-size-header.h"
+#include "ns3/packet-trace-writer.h"
 
 // added on 07.27
 #include <fstream>
@@ -32,7 +33,7 @@ public:
   virtual ~MySource();
 
   // Default OnOffApp creates socket until app start time, can't access and configure the tracing externally
-  void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, std::vector<std::string>* dataRate, uint32_t appid, bool poisson, std::string result_dir, std::vector<double>* change_time);
+  void Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, std::vector<std::string>* dataRate, uint32_t appid, bool poisson, Ptr<PacketTraceWriter> packetTrace, std::vector<double>* change_time);
 
   uint32_t GetPacketsSent();
 
@@ -53,7 +54,7 @@ private:
   Ptr<ExponentialRandomVariable>  m_var;
 
   // added on 07.27
-  std::string                     m_result_dir;
+  Ptr<PacketTraceWriter>          m_packetTrace;
   void StopSendNew (void);
 
   // added on 08.07 for data rate change
@@ -72,10 +73,11 @@ MySource::MySource ():
 MySource::~MySource()
 {
   m_socket = 0;
+  m_packetTrace = 0;
 }
 
 void
-MySource::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, std::vector<std::string>* dataRate, uint32_t appid, bool /*unusedParam1*/, std::string result_dir, std::vector<double>* change_time)
+MySource::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, std::vector<std::string>* dataRate, uint32_t appid, bool /*unusedParam1*/, Ptr<PacketTraceWriter> packetTrace, std::vector<double>* change_time)
 {
   m_socket = socket;
   m_peer = address;
@@ -86,7 +88,7 @@ MySource::Setup (Ptr<Socket> socket, Address address, uint32_t packetSize, std::
   // No need for poisson as the demand is infinite anyway and the packet gap pattern is determined by the underlying transport
 
   // added on 07.27
-  m_result_dir = result_dir;
+  m_packetTrace = packetTrace;
 
   // added on 08.07 for data rate change
   m_dataRate = dataRate;
@@ -160,9 +162,7 @@ MySource::SendPacket (void)
   m_socket->Send (packet);
 
   // added on 07.27
-  std::ofstream throput_ofs2 (m_result_dir + "/sent_ms.dat", std::ios::out | std::ios::app);
-  throput_ofs2 << "[" << Simulator::Now ().GetMilliSeconds() << "] SourceIDTag: " << tag.Get() << ", size: " << packet->GetSize()              
-              << std::endl;
+  m_packetTrace->Write (PacketTraceRecord::SENT, tag.Get (), packet->GetSize ());
 
   // Infinite demand
   // if (++m_packetsSent < m_nPackets)
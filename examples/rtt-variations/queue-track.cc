@@ -33,17 +33,17 @@ enum AQM {
 
 // Port from Traffic Generator // Acknowledged to https://github.com/HKUST-SING/TrafficGenerator/blob/master/src/common/common.c
 double
-poission_gen_interval(double avg_rate) {
+poission_gen_interval(Ptr<UniformRandomVariable> uniform, double avg_rate) {
     if (avg_rate > 0)
-        return -logf(1.0 - (double)rand() / RAND_MAX) / avg_rate;
+        return -logf(1.0 - uniform->GetValue ()) / avg_rate;
     else
         return 0;
 }
 
 template<typename T> T
-rand_range (T min, T max)
+rand_range (Ptr<UniformRandomVariable> uniform, T min, T max)
 {
-    return min + ((double)max - min) * rand () / RAND_MAX;
+    return min + ((double)max - min) * uniform->GetValue ();
 }
 
 std::string
@@ -285,14 +285,8 @@ int main (int argc, char *argv[])
     NS_LOG_INFO ("Average request rate: " << requestRate << " per second per sender");
 
     NS_LOG_INFO ("Initialize random seed: " << randomSeed);
-    if (randomSeed == 0)
-    {
-        srand ((unsigned)time (NULL));
-    }
-    else
-    {
-        srand (randomSeed);
-    }
+    RngSeedManager::SetSeed (randomSeed == 0 ? (unsigned)time (NULL) : randomSeed);
+    Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
 
     NS_LOG_INFO ("Install background application");
 
@@ -301,10 +295,10 @@ int main (int argc, char *argv[])
     for (uint32_t i = 0; i < numOfSenders; ++i)
     {
         uint32_t totalFlow = 0;
-        double startTime = 0.0 + poission_gen_interval (requestRate);
+        double startTime = 0.0 + poission_gen_interval (uniform, requestRate);
         while (startTime < endTime && totalFlow < (flowNum / numOfSenders))
         {
-            uint32_t flowSize = gen_random_cdf (cdfTable);
+            uint32_t flowSize = gen_random_cdf (cdfTable, uniform->GetValue ());
             BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (switchToRecvIpv4Container.GetAddress (1), basePort));
             source.SetAttribute ("MaxBytes", UintegerValue (flowSize));
             source.SetAttribute ("SendSize", UintegerValue (1400));
@@ -319,7 +313,7 @@ int main (int argc, char *argv[])
 
             ++totalFlow;
             ++basePort;
-            startTime += poission_gen_interval (requestRate);
+            startTime += poission_gen_interval (uniform, requestRate);
         }
     }
 
@@ -333,7 +327,7 @@ int main (int argc, char *argv[])
         while (startTime < endTime)
         {
             BulkSendHelper source ("ns3::TcpSocketFactory", InetSocketAddress (switchToRecvIpv4Container.GetAddress (1), basePort));
-            source.SetAttribute ("MaxBytes", UintegerValue (rand_range (FLOW_SIZE_MIN, FLOW_SIZE_MAX)));
+            source.SetAttribute ("MaxBytes", UintegerValue (rand_range (uniform, FLOW_SIZE_MIN, FLOW_SIZE_MAX)));
             source.SetAttribute ("SendSize", UintegerValue (1400));
             ApplicationContainer sourceApps = source.Install (senders.Get (i));
             sourceApps.Start (Seconds (startTime));
@@ -0,0 +1,258 @@
+"""Run a parameter sweep of large-scale / large-scale-pias on all local cores.
+
+Every combination of the parameter grid runs in its own result directory,
+so the runs do not share tmp_index or the flow monitor XML file.  A run
+that completed in a previous invocation is skipped, which makes it safe to
+restart an interrupted sweep.  The FCT / throughput summary of each run is
+parsed with fct_parser and merged into one table, with the peak RSS of the
+run to size --mem-per-job.
+
+Example:
+
+  python examples/rtt-variations/sweep.py --program large-scale-pias \\
+      --out sweep-pias --mem-per-job 2048 \\
+      -p AQM=TCN,ECNSharp -p load=0.3,0.5,0.7 -p randomSeed=1-10 \\
+      -p cdfFileName=examples/rtt-variations/DCTCP_CDF.txt
+"""
+from __future__ import division
+from __future__ import print_function
+import argparse
+import glob
+import itertools
+import json
+import os
+import re
+import subprocess
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import fct_parser
+
+SUMMARY_KEYS = ['avg_fct', 'avg_small_fct', 'avg_large_fct', 'small_flow_99', 'flow_99',
+                'total_tx', 'total_rx', 'flow_count', 'large_throughput', 'max_rss_mb']
+
+
+def parse_values(text):
+    """'a,b,c' -> [a, b, c]; an integer range 'lo-hi' is expanded."""
+    values = []
+    for item in text.split(','):
+        m = re.match(r'^(\d+)-(\d+)$', item)
+        if m:
+            values.extend(str(v) for v in range(int(m.group(1)), int(m.group(2)) + 1))
+        else:
+            values.append(item)
+    return values
+
+
+def absolute_if_file(value):
+    # Runs are launched from their own directory
+    if os.path.exists(value):
+        return os.path.abspath(value)
+    return value
+
+
+def build_grid(params):
+    keys = []
+    choices = []
+    for param in params:
+        key, _, text = param.partition('=')
+        if not text:
+            raise SystemExit('bad parameter %r, expected key=v1,v2,...' % param)
+        keys.append(key)
+        choices.append([absolute_if_file(v) for v in parse_values(text)])
+    return [list(zip(keys, combo)) for combo in itertools.product(*choices)]
+
+
+def run_name(run):
+    parts = []
+    for key, value in run:
+        if os.path.isabs(value):
+            value = os.path.basename(value)
+        parts.append('%s=%s' % (key, re.sub(r'[^A-Za-z0-9._-]', '_', value)))
+    return ','.join(parts) or 'default'
+
+
+def find_binary(build_dir, program):
+    pattern = os.path.join(build_dir, 'examples', 'rtt-variations', 'ns3-*-%s-*' % program)
+    binaries = [b for b in glob.glob(pattern) if os.access(b, os.X_OK) and not b.endswith('.o')]
+    if not binaries:
+        raise SystemExit('cannot find %s, build it first' % pattern)
+    return sorted(binaries)[0]
+
+
+def memory_mb():
+    # Memory left to the runs, MemTotal only for the kernels without
+    # MemAvailable (it comes first in /proc/meminfo)
+    fields = {}
+    try:
+        with open('/proc/meminfo') as f:
+            for line in f:
+                key, value = line.split(':', 1)
+                fields[key] = int(value.split()[0])
+    except (IOError, ValueError):
+        return None
+    available = fields.get('MemAvailable', fields.get('MemTotal'))
+    return available // 1024 if available is not None else None
+
+
+def wait_job(job):
+    """Exit code of a finished run, None while it runs.
+
+    Reaps the run with wait4 to get its own peak RSS, the RUSAGE_CHILDREN
+    maximum covering every run reaped so far."""
+    proc = job['proc']
+    pid, status, usage = os.wait4(proc.pid, os.WNOHANG)
+    if pid == 0:
+        return None
+    if os.WIFSIGNALED(status):
+        proc.returncode = -os.WTERMSIG(status)
+    else:
+        proc.returncode = os.WEXITSTATUS(status)
+    # ru_maxrss is in kB on Linux
+    job['max_rss_mb'] = usage.ru_maxrss // 1024
+    return proc.returncode
+
+
+def limit_memory(mem_mb):
+    def apply():
+        import resource
+        limit = mem_mb * 1024 * 1024
+        resource.setrlimit(resource.RLIMIT_AS, (limit, limit))
+    return apply
+
+
+def summarize(run_dir):
+    files = glob.glob(os.path.join(run_dir, '*.xml'))
+    if not files:
+        return None
+    # fct_parser reports every flow on stdout, keep it in the run directory
+    saved = sys.stdout
+    try:
+        with open(os.path.join(run_dir, 'fct_parser.log'), 'w') as log:
+            sys.stdout = log
+            return fct_parser.parse(files[0])
+    except Exception as e:
+        print('cannot parse %s: %s' % (files[0], e), file=saved)
+        return None
+    finally:
+        sys.stdout = saved
+
+
+def finish(job, code):
+    run, run_dir = job['run'], job['dir']
+    job['log'].close()
+    if code != 0:
+        print('FAILED (%d) %s, see %s' % (code, run_dir, os.path.join(run_dir, 'run.log')))
+        return
+    summary = summarize(run_dir)
+    if summary is None:
+        # Not marked done, the next invocation runs it again
+        print('FAILED (no summary) %s, see %s' % (run_dir, os.path.join(run_dir, 'run.log')))
+        return
+    summary['max_rss_mb'] = job['max_rss_mb']
+    with open(os.path.join(run_dir, 'summary.json'), 'w') as f:
+        json.dump({'params': run, 'summary': summary}, f)
+    print('done %s (%.0fs, %d MB)' % (run_dir, time.time() - job['start'], job['max_rss_mb']))
+
+
+def is_done(run_dir):
+    # Summaries of failed parses written by older versions do not count
+    try:
+        with open(os.path.join(run_dir, 'summary.json')) as f:
+            return json.load(f)['summary'] is not None
+    except (IOError, ValueError, KeyError):
+        return False
+
+
+def merge(out, runs):
+    rows = []
+    for run in runs:
+        path = os.path.join(out, run_name(run), 'summary.json')
+        if os.path.exists(path):
+            with open(path) as f:
+                rows.append(json.load(f))
+    keys = []
+    for row in rows:
+        for key, _ in row['params']:
+            if key not in keys:
+                keys.append(key)
+    table = os.path.join(out, 'summary.tsv')
+    with open(table, 'w') as f:
+        f.write('\t'.join(keys + SUMMARY_KEYS) + '\n')
+        for row in rows:
+            params = dict(row['params'])
+            summary = row['summary'] or {}
+            values = [params.get(k, '') for k in keys] + [summary.get(k, '') for k in SUMMARY_KEYS]
+            f.write('\t'.join(str(v) for v in values) + '\n')
+    print('%d / %d runs merged into %s' % (len(rows), len(runs), table))
+
+
+def main(argv):
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('--program', default='large-scale', help='large-scale or large-scale-pias')
+    parser.add_argument('--build-dir', default='build', help='waf output directory')
+    parser.add_argument('--binary', help='program to run, found in --build-dir by default')
+    parser.add_argument('--out', default='sweep', help='root of the per run result directories')
+    parser.add_argument('-p', '--param', action='append', default=[],
+                        help='key=v1,v2,... passed as --key=v, integer ranges lo-hi are expanded')
+    parser.add_argument('-j', '--jobs', type=int, default=0, help='parallel runs, all cores by default')
+    parser.add_argument('--mem-per-job', type=int, default=0,
+                        help='address space limit of a run in MB, also caps the parallel runs')
+    parser.add_argument('--merge-only', action='store_true', help='only merge the existing summaries')
+    args = parser.parse_args(argv[1:])
+
+    runs = build_grid(args.param)
+    out = os.path.abspath(args.out)
+    if args.merge_only:
+        merge(out, runs)
+        return 0
+
+    binary = os.path.abspath(args.binary or find_binary(args.build_dir, args.program))
+    env = dict(os.environ)
+    lib_dir = os.path.abspath(args.build_dir)
+    env['LD_LIBRARY_PATH'] = lib_dir + os.pathsep + env.get('LD_LIBRARY_PATH', '')
+
+    jobs = args.jobs
+    if not jobs:
+        import multiprocessing
+        jobs = multiprocessing.cpu_count()
+    if args.mem_per_job:
+        available = memory_mb()
+        if available:
+            jobs = max(1, min(jobs, available // args.mem_per_job))
+
+    todo = []
+    for run in runs:
+        run_dir = os.path.join(out, run_name(run))
+        if is_done(run_dir):
+            continue
+        todo.append((run, run_dir))
+    print('%d runs, %d already done, %d parallel' % (len(runs), len(runs) - len(todo), jobs))
+
+    running = []
+    while todo or running:
+        while todo and len(running) < jobs:
+            run, run_dir = todo.pop(0)
+            if not os.path.isdir(run_dir):
+                os.makedirs(run_dir)
+            log = open(os.path.join(run_dir, 'run.log'), 'w')
+            cmd = [binary] + ['--%s=%s' % (k, v) for k, v in run]
+            log.write(' '.join(cmd) + '\n')
+            log.flush()
+            proc = subprocess.Popen(cmd, cwd=run_dir, env=env, stdout=log, stderr=subprocess.STDOUT,
+                                    preexec_fn=limit_memory(args.mem_per_job) if args.mem_per_job else None)
+            running.append({'proc': proc, 'run': run, 'dir': run_dir, 'log': log, 'start': time.time()})
+        time.sleep(0.5)
+        for job in running[:]:
+            code = wait_job(job)
+            if code is not None:
+                running.remove(job)
+                finish(job, code)
+
+    merge(out, runs)
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv))
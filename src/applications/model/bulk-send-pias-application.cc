@@ -68,6 +68,9 @@ BulkSendPiasApplication::GetTypeId (void)
     .AddTraceSource ("Tx", "A new packet is created and is sent",
                      MakeTraceSourceAccessor (&BulkSendPiasApplication::m_txTrace),
                      "ns3::Packet::TracedCallback")
+    .AddTraceSource ("FlowStart", "The connection of the flow is requested",
+                     MakeTraceSourceAccessor (&BulkSendPiasApplication::m_flowStartTrace),
+                     "ns3::BulkSendPiasApplication::FlowStartTracedCallback")
   ;
   return tid;
 }
@@ -145,6 +148,11 @@ void BulkSendPiasApplication::StartApplication (void) // Called at time specifie
 
       m_socket->Connect (m_peer);
       m_socket->ShutdownRecv ();
+
+      // The local address is only complete once the route to the peer is known
+      Address local;
+      m_socket->GetSockName (local);
+      m_flowStartTrace (local, m_maxBytes);
       m_socket->SetConnectCallback (
         MakeCallback (&BulkSendPiasApplication::ConnectionSucceeded, this),
         MakeCallback (&BulkSendPiasApplication::ConnectionFailed, this));
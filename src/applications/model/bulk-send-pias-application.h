@@ -46,6 +46,14 @@ public:
    */
   Ptr<Socket> GetSocket (void) const;
 
+  /**
+   * TracedCallback signature for the start of a flow.
+   *
+   * \param [in] local the local address of the connection
+   * \param [in] maxBytes the bytes the flow will send, 0 if unbounded
+   */
+  typedef void (* FlowStartTracedCallback) (const Address &local, uint32_t maxBytes);
+
 protected:
   virtual void DoDispose (void);
 private:
@@ -81,6 +89,9 @@ private:
   /// Traced Callback: sent packets
   TracedCallback<Ptr<const Packet> > m_txTrace;
 
+  /// Traced Callback: connection requested, local address and flow size
+  TracedCallback<const Address &, uint32_t> m_flowStartTrace;
+
 private:
   /**
    * \brief Connection Succeeded (called by Socket through a callback)
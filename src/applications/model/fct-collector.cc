@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "fct-collector.h"
+
+#include "ns3/log.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+#include "ns3/simulator.h"
+#include "ns3/inet-socket-address.h"
+
+#include <algorithm>
+#include <fstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FctCollector");
+
+NS_OBJECT_ENSURE_REGISTERED (FctCollector);
+
+TypeId
+FctCollector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::FctCollector")
+    .SetParent<Object> ()
+    .SetGroupName ("Applications")
+    .AddConstructor<FctCollector> ()
+    .AddAttribute ("KeepRecords",
+                   "Keep a record of every completed flow",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&FctCollector::m_keepRecords),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+FctCollector::FctCollector ()
+  : m_keepRecords (true)
+{
+  NS_LOG_FUNCTION (this);
+  // Same small (< 100KB) and large (> 10MB) flows as fct_parser.py
+  std::vector<uint32_t> bounds;
+  bounds.push_back (100000);
+  bounds.push_back (10000001);
+  SetSizeBuckets (bounds);
+}
+
+FctCollector::~FctCollector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+FctCollector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_inProgress.clear ();
+  Object::DoDispose ();
+}
+
+void
+FctCollector::InstallAll (void)
+{
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::BulkSendPiasApplication/FlowStart",
+                                 MakeCallback (&FctCollector::FlowStarted, this));
+  Config::ConnectWithoutContext ("/NodeList/*/ApplicationList/*/$ns3::PacketSink/PeerClose",
+                                 MakeCallback (&FctCollector::FlowCompleted, this));
+}
+
+bool
+FctCollector::GetKey (const Address &address, uint64_t &key)
+{
+  if (!InetSocketAddress::IsMatchingType (address))
+    {
+      return false;
+    }
+  InetSocketAddress inet = InetSocketAddress::ConvertFrom (address);
+  key = (static_cast<uint64_t> (inet.GetIpv4 ().Get ()) << 16) | inet.GetPort ();
+  return true;
+}
+
+void
+FctCollector::FlowStarted (const Address &source, uint32_t size)
+{
+  NS_LOG_FUNCTION (this << source << size);
+  uint64_t key;
+  if (!GetKey (source, key))
+    {
+      NS_LOG_WARN ("Only IPv4 flows are collected");
+      return;
+    }
+  FlowInProgress &flow = m_inProgress[key];
+  flow.start = Simulator::Now ();
+  flow.size = size;
+}
+
+void
+FctCollector::FlowCompleted (const Address &source)
+{
+  NS_LOG_FUNCTION (this << source);
+  uint64_t key;
+  if (!GetKey (source, key))
+    {
+      return;
+    }
+  std::map<uint64_t, FlowInProgress>::iterator itr = m_inProgress.find (key);
+  if (itr == m_inProgress.end ())
+    {
+      NS_LOG_LOGIC ("Completed flow " << source << " was not started");
+      return;
+    }
+
+  Time fct = Simulator::Now () - itr->second.start;
+  uint32_t size = itr->second.size;
+  m_histograms[GetBucket (size)].Add (fct.GetNanoSeconds ());
+  m_all.Add (fct.GetNanoSeconds ());
+  if (m_keepRecords)
+    {
+      FlowRecord record;
+      record.startNs = itr->second.start.GetNanoSeconds ();
+      record.fctNs = fct.GetNanoSeconds ();
+      record.size = size;
+      m_records.push_back (record);
+    }
+  m_inProgress.erase (itr);
+}
+
+void
+FctCollector::SetSizeBuckets (const std::vector<uint32_t> &bounds)
+{
+  for (uint32_t i = 1; i < bounds.size (); ++i)
+    {
+      NS_ASSERT_MSG (bounds[i - 1] < bounds[i], "Bucket bounds must be increasing");
+    }
+  m_bounds = bounds;
+  m_histograms.assign (bounds.size () + 1, HdrHistogram ());
+}
+
+uint32_t
+FctCollector::GetNBuckets (void) const
+{
+  return m_histograms.size ();
+}
+
+uint32_t
+FctCollector::GetBucket (uint32_t size) const
+{
+  return std::upper_bound (m_bounds.begin (), m_bounds.end (), size) - m_bounds.begin ();
+}
+
+const HdrHistogram &
+FctCollector::GetHistogram (uint32_t bucket) const
+{
+  return m_histograms[bucket];
+}
+
+const HdrHistogram &
+FctCollector::GetAllFlowsHistogram (void) const
+{
+  return m_all;
+}
+
+uint64_t
+FctCollector::GetNCompleted (void) const
+{
+  return m_all.GetCount ();
+}
+
+uint32_t
+FctCollector::GetNInProgress (void) const
+{
+  return m_inProgress.size ();
+}
+
+const std::vector<FctCollector::FlowRecord> &
+FctCollector::GetRecords (void) const
+{
+  return m_records;
+}
+
+bool
+FctCollector::WriteRecords (const std::string &filename) const
+{
+  std::ofstream os (filename.c_str ());
+  if (!os.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open " << filename);
+      return false;
+    }
+  os << "start_ns,fct_ns,size\n";
+  for (std::vector<FlowRecord>::const_iterator itr = m_records.begin (); itr != m_records.end (); ++itr)
+    {
+      os << itr->startNs << "," << itr->fctNs << "," << itr->size << "\n";
+    }
+  return true;
+}
+
+bool
+FctCollector::WriteSummary (const std::string &filename) const
+{
+  std::ofstream os (filename.c_str ());
+  if (!os.is_open ())
+    {
+      NS_LOG_ERROR ("Cannot open " << filename);
+      return false;
+    }
+  PrintSummary (os);
+  return true;
+}
+
+void
+FctCollector::PrintSummary (std::ostream &os) const
+{
+  os << "min_size,max_size,flows,mean_fct_ns,p50_fct_ns,p99_fct_ns,p999_fct_ns\n";
+  for (uint32_t bucket = 0; bucket <= m_histograms.size (); ++bucket)
+    {
+      // The last line covers all the flows
+      const HdrHistogram &histogram = bucket < m_histograms.size () ? m_histograms[bucket] : m_all;
+      bool all = bucket == m_histograms.size ();
+      uint32_t minSize = (all || bucket == 0) ? 0 : m_bounds[bucket - 1];
+      os << minSize << ",";
+      if (all || bucket == m_bounds.size ())
+        {
+          os << "inf";
+        }
+      else
+        {
+          os << m_bounds[bucket];
+        }
+      os << "," << histogram.GetCount ()
+         << "," << static_cast<uint64_t> (histogram.GetMean ())
+         << "," << histogram.GetPercentile (50)
+         << "," << histogram.GetPercentile (99)
+         << "," << histogram.GetPercentile (99.9) << "\n";
+    }
+}
+
+} // namespace ns3
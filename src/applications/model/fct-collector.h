@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FCT_COLLECTOR_H
+#define FCT_COLLECTOR_H
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/address.h"
+#include "ns3/hdr-histogram.h"
+
+#include <stdint.h>
+#include <map>
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup applications
+ *
+ * \brief Flow completion times, collected as the flows complete
+ *
+ * A flow starts when its sender requests the connection and completes when
+ * the receiver gets the in sequence FIN, i.e. all of its data. Flows are
+ * matched by the address and port of the sender. Only the flows in
+ * progress are kept, plus one compact record per completed flow if
+ * KeepRecords is set; nothing is kept per packet.
+ *
+ * The completion times go into one HdrHistogram per flow size bucket, so
+ * the percentiles are available without sorting the flows.
+ *
+ * InstallAll hooks the FlowStart trace of every BulkSendPiasApplication and
+ * the PeerClose trace of every PacketSink; other applications can report
+ * their flows through FlowStarted and FlowCompleted.
+ */
+class FctCollector : public Object
+{
+public:
+  static TypeId GetTypeId (void);
+
+  FctCollector ();
+  virtual ~FctCollector ();
+
+  /**
+   * \brief One completed flow
+   */
+  struct FlowRecord
+  {
+    int64_t startNs;
+    int64_t fctNs;
+    uint32_t size;
+  };
+
+  /**
+   * \brief Connect to the applications installed so far
+   */
+  void InstallAll (void);
+
+  void FlowStarted (const Address &source, uint32_t size);
+  void FlowCompleted (const Address &source);
+
+  /**
+   * \brief Set the flow size buckets
+   * \param bounds increasing upper bounds (excluded) of the buckets, a last
+   * bucket gets the larger flows
+   */
+  void SetSizeBuckets (const std::vector<uint32_t> &bounds);
+
+  uint32_t GetNBuckets (void) const;
+  uint32_t GetBucket (uint32_t size) const;
+  const HdrHistogram &GetHistogram (uint32_t bucket) const;
+  const HdrHistogram &GetAllFlowsHistogram (void) const;
+
+  uint64_t GetNCompleted (void) const;
+  uint32_t GetNInProgress (void) const;
+  const std::vector<FlowRecord> &GetRecords (void) const;
+
+  /**
+   * \brief Write one line per completed flow: start_ns,fct_ns,size
+   */
+  bool WriteRecords (const std::string &filename) const;
+
+  /**
+   * \brief Write the FCT percentiles of every size bucket as CSV
+   */
+  bool WriteSummary (const std::string &filename) const;
+  void PrintSummary (std::ostream &os) const;
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  struct FlowInProgress
+  {
+    Time start;
+    uint32_t size;
+  };
+
+  static bool GetKey (const Address &address, uint64_t &key);
+
+  bool m_keepRecords;
+
+  std::map<uint64_t, FlowInProgress> m_inProgress;
+  std::vector<uint32_t> m_bounds;
+  std::vector<HdrHistogram> m_histograms;
+  HdrHistogram m_all;
+  std::vector<FlowRecord> m_records;
+};
+
+} // namespace ns3
+
+#endif /* FCT_COLLECTOR_H */
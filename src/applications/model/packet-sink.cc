@@ -59,6 +59,10 @@ PacketSink::GetTypeId (void)
                      "A packet has been received",
                      MakeTraceSourceAccessor (&PacketSink::m_rxTrace),
                      "ns3::Packet::AddressTracedCallback")
+    .AddTraceSource ("PeerClose",
+                     "A connection has received all the data of its peer",
+                     MakeTraceSourceAccessor (&PacketSink::m_peerCloseTrace),
+                     "ns3::PacketSink::PeerCloseTracedCallback")
   ;
   return tid;
 }
@@ -194,6 +198,11 @@ void PacketSink::HandleRead (Ptr<Socket> socket)
 void PacketSink::HandlePeerClose (Ptr<Socket> socket)
 {
   NS_LOG_FUNCTION (this << socket);
+  Address from;
+  if (socket->GetPeerName (from) == 0)
+    {
+      m_peerCloseTrace (from);
+    }
 }
  
 void PacketSink::HandlePeerError (Ptr<Socket> socket)
@@ -206,6 +215,9 @@ void PacketSink::HandleAccept (Ptr<Socket> s, const Address& from)
 {
   NS_LOG_FUNCTION (this << s << from);
   s->SetRecvCallback (MakeCallback (&PacketSink::HandleRead, this));
+  s->SetCloseCallbacks (
+    MakeCallback (&PacketSink::HandlePeerClose, this),
+    MakeCallback (&PacketSink::HandlePeerError, this));
   m_socketList.push_back (s);
 }
 
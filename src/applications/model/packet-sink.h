@@ -91,6 +91,13 @@ public:
    * \return list of pointers to accepted sockets
    */
   std::list<Ptr<Socket> > GetAcceptedSockets (void) const;
+
+  /**
+   * TracedCallback signature for the close of a connection by its peer.
+   *
+   * \param [in] from the address of the peer
+   */
+  typedef void (* PeerCloseTracedCallback) (const Address &from);
  
 protected:
   virtual void DoDispose (void);
@@ -133,6 +140,9 @@ private:
   /// Traced Callback: received packets, source address.
   TracedCallback<Ptr<const Packet>, const Address &> m_rxTrace;
 
+  /// Traced Callback: in sequence FIN of a connection, peer address.
+  TracedCallback<const Address &> m_peerCloseTrace;
+
 };
 
 } // namespace ns3
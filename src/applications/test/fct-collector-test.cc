@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ns3/uinteger.h"
+#include "ns3/data-rate.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/bulk-send-pias-helper.h"
+#include "ns3/packet-sink-helper.h"
+#include "ns3/fct-collector.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+
+using namespace ns3;
+
+/**
+ * Test that FctCollector, hooked on the FlowStart and PeerClose traces of
+ * the applications, gets the completion time of every flow in its records
+ * and in the summary CSV
+ */
+class FctCollectorTestCase : public TestCase
+{
+public:
+  FctCollectorTestCase ();
+  virtual ~FctCollectorTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void FlowStart (const Address &local, uint32_t size);
+  void PeerClose (const Address &from);
+
+  std::map<Address, Time> m_start;  //!< start of the flows, by sender address
+  std::map<Address, Time> m_close;  //!< completion of the flows, by sender address
+};
+
+FctCollectorTestCase::FctCollectorTestCase ()
+  : TestCase ("Test the flow completion times collected from the application traces")
+{
+}
+
+FctCollectorTestCase::~FctCollectorTestCase ()
+{
+}
+
+void
+FctCollectorTestCase::FlowStart (const Address &local, uint32_t size)
+{
+  m_start[local] = Simulator::Now ();
+}
+
+void
+FctCollectorTestCase::PeerClose (const Address &from)
+{
+  m_close[from] = Simulator::Now ();
+}
+
+void
+FctCollectorTestCase::DoRun (void)
+{
+  NodeContainer n;
+  n.Create (2);
+
+  InternetStackHelper internet;
+  internet.Install (n);
+
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Mbps")));
+  devHelper.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (50)));
+  NetDeviceContainer d = devHelper.Install (n);
+
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer i = ipv4.Assign (d);
+
+  uint16_t port = 4000;
+  PacketSinkHelper sinkHelper ("ns3::TcpSocketFactory", InetSocketAddress (Ipv4Address::GetAny (), port));
+  ApplicationContainer sinks = sinkHelper.Install (n.Get (1));
+  sinks.Start (Seconds (0.0));
+
+  // A small flow and a flow in the second size bucket, overlapping
+  uint32_t sizes[2] = { 50000, 200000 };
+  ApplicationContainer sources;
+  for (uint32_t f = 0; f < 2; f++)
+    {
+      BulkSendPiasHelper source ("ns3::TcpSocketFactory", InetSocketAddress (i.GetAddress (1), port));
+      source.SetAttribute ("MaxBytes", UintegerValue (sizes[f]));
+      ApplicationContainer app = source.Install (n.Get (0));
+      app.Start (Seconds (1.0 + 0.001 * f));
+      sources.Add (app);
+    }
+
+  Ptr<FctCollector> collector = CreateObject<FctCollector> ();
+  collector->InstallAll ();
+  for (uint32_t f = 0; f < sources.GetN (); f++)
+    {
+      sources.Get (f)->TraceConnectWithoutContext ("FlowStart", MakeCallback (&FctCollectorTestCase::FlowStart, this));
+    }
+  sinks.Get (0)->TraceConnectWithoutContext ("PeerClose", MakeCallback (&FctCollectorTestCase::PeerClose, this));
+
+  Simulator::Stop (Seconds (10.0));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_start.size (), 2, "Flows not started");
+  NS_TEST_ASSERT_MSG_EQ (m_close.size (), 2, "Flows not completed");
+  NS_TEST_EXPECT_MSG_EQ (collector->GetNCompleted (), 2, "Completed flows not collected");
+  NS_TEST_EXPECT_MSG_EQ (collector->GetNInProgress (), 0, "Completed flows still in progress");
+
+  // The FCT of each flow, from its own traces, by size; the small flow
+  // starts first
+  Time firstStart = std::min (m_start.begin ()->second, m_start.rbegin ()->second);
+  std::map<uint32_t, int64_t> fcts;
+  for (std::map<Address, Time>::const_iterator itr = m_start.begin (); itr != m_start.end (); ++itr)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_close.count (itr->first), 1, "Flow completed with another address");
+      uint32_t size = sizes[itr->second == firstStart ? 0 : 1];
+      fcts[size] = (m_close[itr->first] - itr->second).GetNanoSeconds ();
+      NS_TEST_EXPECT_MSG_GT (fcts[size], 0, "Flow completed before its start");
+    }
+
+  const std::vector<FctCollector::FlowRecord> &records = collector->GetRecords ();
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 2, "Completed flows not recorded");
+  for (uint32_t r = 0; r < records.size (); r++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (fcts.count (records[r].size), 1, "Wrong size of flow " << r);
+      NS_TEST_EXPECT_MSG_EQ (records[r].fctNs, fcts[records[r].size], "Wrong FCT of the flow of " << records[r].size << " bytes");
+    }
+  NS_TEST_EXPECT_MSG_EQ (collector->GetHistogram (0).GetCount (), 1, "Small flow not in the first bucket");
+  NS_TEST_EXPECT_MSG_EQ (collector->GetHistogram (1).GetCount (), 1, "Large flow not in the second bucket");
+  NS_TEST_EXPECT_MSG_EQ (collector->GetHistogram (2).GetCount (), 0, "Flow in the last bucket");
+
+  // One line per bucket, then one for all the flows, the percentiles being
+  // within the precision of the histograms
+  std::string filename = CreateTempDirFilename ("fct-summary.csv");
+  NS_TEST_ASSERT_MSG_EQ (collector->WriteSummary (filename), true, "Cannot write the summary");
+  std::ifstream is (filename.c_str ());
+  std::string line;
+  std::getline (is, line);
+  NS_TEST_EXPECT_MSG_EQ (line, "min_size,max_size,flows,mean_fct_ns,p50_fct_ns,p99_fct_ns,p999_fct_ns", "Wrong header");
+  std::string bounds[4] = { "0,100000", "100000,10000001", "10000001,inf", "0,inf" };
+  uint64_t counts[4] = { 1, 1, 0, 2 };
+  for (uint32_t b = 0; b < 4; b++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (bool (std::getline (is, line)), true, "Missing line " << b << " of the summary");
+      std::istringstream fields (line);
+      std::string minSize, maxSize;
+      uint64_t count, mean, p50, p99, p999;
+      char comma;
+      std::getline (fields, minSize, ',');
+      std::getline (fields, maxSize, ',');
+      fields >> count >> comma >> mean >> comma >> p50 >> comma >> p99 >> comma >> p999;
+      NS_TEST_EXPECT_MSG_EQ (minSize + "," + maxSize, bounds[b], "Wrong bounds on line " << b);
+      NS_TEST_EXPECT_MSG_EQ (count, counts[b], "Wrong count on line " << b);
+      if (b < 2)
+        {
+          double fct = fcts[sizes[b]];
+          NS_TEST_EXPECT_MSG_EQ_TOL (double (mean), fct, fct / 128, "Wrong mean FCT on line " << b);
+          NS_TEST_EXPECT_MSG_EQ_TOL (double (p99), fct, fct / 128, "Wrong p99 FCT on line " << b);
+        }
+      else if (b == 3)
+        {
+          double fct = std::max (fcts[sizes[0]], fcts[sizes[1]]);
+          NS_TEST_EXPECT_MSG_EQ_TOL (double (p999), fct, fct / 128, "Wrong p99.9 FCT of all the flows");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (bool (std::getline (is, line)), false, "Extra lines in the summary");
+
+  collector->Dispose ();
+  Simulator::Destroy ();
+}
+
+class FctCollectorTestSuite : public TestSuite
+{
+public:
+  FctCollectorTestSuite ();
+};
+
+FctCollectorTestSuite::FctCollectorTestSuite ()
+  : TestSuite ("fct-collector", UNIT)
+{
+  AddTestCase (new FctCollectorTestCase, TestCase::QUICK);
+}
+
+static FctCollectorTestSuite fctCollectorTestSuite;
@@ -19,15 +19,19 @@ Ipv4Clove::Ipv4Clove () :
     m_disToUncongestedPath (false)
 {
     NS_LOG_FUNCTION (this);
+    m_flowletTable.SetTimeout (m_flowletTimeout);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4Clove::Ipv4Clove (const Ipv4Clove &other) :
     m_flowletTimeout (other.m_flowletTimeout),
     m_runMode (other.m_runMode),
+    m_flowletTable (other.m_flowletTable),
     m_halfRTT (other.m_halfRTT),
     m_disToUncongestedPath (other.m_disToUncongestedPath)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 TypeId
@@ -39,8 +43,14 @@ Ipv4Clove::GetTypeId (void)
         .AddConstructor<Ipv4Clove> ()
         .AddAttribute ("FlowletTimeout", "FlowletTimeout",
                        TimeValue (MicroSeconds (40)),
-                       MakeTimeAccessor (&Ipv4Clove::m_flowletTimeout),
+                       MakeTimeAccessor (&Ipv4Clove::SetFlowletTimeout,
+                                         &Ipv4Clove::GetFlowletTimeout),
                        MakeTimeChecker ())
+        .AddAttribute ("FlowletTableSize", "The number of entries of the flowlet table",
+                       UintegerValue (4096),
+                       MakeUintegerAccessor (&Ipv4Clove::SetFlowletTableSize,
+                                             &Ipv4Clove::GetFlowletTableSize),
+                       MakeUintegerChecker<uint32_t> (FlowletTable::WAYS))
         .AddAttribute ("RunMode", "RunMode",
                        UintegerValue (0),
                        MakeUintegerAccessor (&Ipv4Clove::m_runMode),
@@ -64,6 +74,12 @@ Ipv4Clove::AddAddressWithTor (Ipv4Address address, uint32_t torId)
     m_ipTorMap[address] = torId;
 }
 
+void
+Ipv4Clove::SetTorDirectory (Ptr<const TorDirectory> directory)
+{
+    m_torDirectory = directory;
+}
+
 void
 Ipv4Clove::AddAvailPath (uint32_t destTor, uint32_t path)
 {
@@ -96,26 +112,52 @@ Ipv4Clove::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
     }
 
-    struct CloveFlowlet flowlet;
-    std::map<uint32_t, CloveFlowlet>::iterator flowletItr = m_flowletMap.find (flowId);
-    if (flowletItr != m_flowletMap.end ())
+    Time now = Simulator::Now ();
+    FlowletEntry *flowlet = m_flowletTable.Lookup (flowId);
+    if (flowlet == 0)
     {
-        flowlet = flowletItr->second;
+        flowlet = m_flowletTable.Insert (flowId, now);
+        flowlet->port = Ipv4Clove::CalPath (destTor);
     }
-    else
+    else if (now - flowlet->activeTime >= m_flowletTimeout)
     {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
+        flowlet->port = Ipv4Clove::CalPath (destTor);
     }
 
-    if (Simulator::Now () - flowlet.lastSeen >= m_flowletTimeout)
-    {
-        flowlet.path = Ipv4Clove::CalPath (destTor);
-    }
+    flowlet->activeTime = now;
+
+    return flowlet->port;
+}
+
+void
+Ipv4Clove::SetFlowletTimeout (Time timeout)
+{
+    m_flowletTimeout = timeout;
+    m_flowletTable.SetTimeout (timeout);
+}
+
+Time
+Ipv4Clove::GetFlowletTimeout (void) const
+{
+    return m_flowletTimeout;
+}
 
-    flowlet.lastSeen = Simulator::Now ();
-    m_flowletMap[flowId] = flowlet;
+void
+Ipv4Clove::SetFlowletTableSize (uint32_t nEntries)
+{
+    m_flowletTable.SetSize (nEntries);
+}
 
-    return flowlet.path;
+uint32_t
+Ipv4Clove::GetFlowletTableSize (void) const
+{
+    return m_flowletTable.GetSize ();
+}
+
+const FlowletTable &
+Ipv4Clove::GetFlowletTable (void) const
+{
+    return m_flowletTable;
 }
 
 
@@ -124,12 +166,20 @@ Ipv4Clove::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
 {
     std::map<Ipv4Address, uint32_t>::iterator torItr = m_ipTorMap.find (daddr);
 
-    if (torItr == m_ipTorMap.end ())
+    if (torItr != m_ipTorMap.end ())
     {
-        return false;
+        destTorId = torItr->second;
+        return true;
     }
-    destTorId = torItr->second;
-    return true;
+    return m_torDirectory != 0 && m_torDirectory->FindTor (daddr, destTorId);
+}
+
+int64_t
+Ipv4Clove::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
 }
 
 uint32_t
@@ -143,11 +193,11 @@ Ipv4Clove::CalPath (uint32_t destTor)
     std::vector<uint32_t> paths = itr->second;
     if (m_runMode == CLOVE_RUNMODE_EDGE_FLOWLET)
     {
-        return paths[rand() % paths.size ()];
+        return paths[m_rand->GetInteger (0, paths.size () - 1)];
     }
     else if (m_runMode == CLOVE_RUNMODE_ECN)
     {
-        double r = ((double) rand () / RAND_MAX);
+        double r = m_rand->GetValue ();
         std::vector<uint32_t>::iterator itr = paths.begin ();
         double weightSum = 0.0;
         for ( ; itr != paths.end (); ++itr)
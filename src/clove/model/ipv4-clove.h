@@ -5,6 +5,9 @@
 #include "ns3/object.h"
 #include "ns3/nstime.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/tor-directory.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
 #include <map>
@@ -16,11 +19,6 @@
 
 namespace ns3 {
 
-struct CloveFlowlet {
-    Time lastSeen;
-    uint32_t path;
-};
-
 class Ipv4Clove : public Object {
 
 public:
@@ -30,6 +28,8 @@ public:
     static TypeId GetTypeId (void);
 
     void AddAddressWithTor (Ipv4Address address, uint32_t torId);
+    // Looked up for the addresses not added one by one
+    void SetTorDirectory (Ptr<const TorDirectory> directory);
     void AddAvailPath (uint32_t destTor, uint32_t path);
 
     uint32_t GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr);
@@ -38,6 +38,16 @@ public:
 
     bool FindTorId (Ipv4Address daddr, uint32_t &torId);
 
+    void SetFlowletTimeout (Time timeout);
+    Time GetFlowletTimeout (void) const;
+
+    void SetFlowletTableSize (uint32_t nEntries);
+    uint32_t GetFlowletTableSize (void) const;
+    const FlowletTable & GetFlowletTable (void) const;
+
+    // Use a fixed stream for the paths of new flowlets, returns 1
+    int64_t AssignStreams (int64_t stream);
+
 private:
     uint32_t CalPath (uint32_t destTor);
 
@@ -45,14 +55,17 @@ private:
     uint32_t m_runMode;
 
     std::map<uint32_t, std::vector<uint32_t> > m_availablePath;
+    Ptr<const TorDirectory> m_torDirectory;
     std::map<Ipv4Address, uint32_t> m_ipTorMap;
-    std::map<uint32_t, CloveFlowlet> m_flowletMap;
+    FlowletTable m_flowletTable;
 
     // Clove ECN
     Time m_halfRTT;
     bool m_disToUncongestedPath;
     std::map<std::pair<uint32_t, uint32_t>, double> m_pathWeight;
     std::map<std::pair<uint32_t, uint32_t>, Time> m_pathECNSeen;
+
+    Ptr<UniformRandomVariable> m_rand;
 };
 
 }
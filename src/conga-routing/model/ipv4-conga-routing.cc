@@ -8,9 +8,11 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
 #include "ipv4-conga-tag.h"
 
 #include <algorithm>
+#include <sstream>
 
 #define LOOPBACK_PORT 0
 
@@ -20,6 +22,83 @@ NS_LOG_COMPONENT_DEFINE("Ipv4CongaRouting");
 
 NS_OBJECT_ENSURE_REGISTERED (Ipv4CongaRouting);
 
+// The table printers walk the whole tables, skip them unless they print
+#ifdef NS3_LOG_ENABLE
+#define CONGA_PRINT_TABLE(print)                \
+  do                                            \
+    {                                           \
+      if (g_log.IsEnabled (LOG_LOGIC))          \
+        {                                       \
+          print;                                \
+        }                                       \
+    }                                           \
+  while (false)
+#else
+#define CONGA_PRINT_TABLE(print)
+#endif
+
+// Lowest set bit of a 64 bits word, by the de Bruijn sequence 0x03f79d71b4ca8b09
+static const uint32_t g_lowestBitIndex[64] = {
+  0, 1, 56, 2, 57, 49, 28, 3, 61, 58, 42, 50, 38, 29, 17, 4,
+  62, 47, 59, 36, 45, 43, 51, 22, 53, 39, 33, 30, 24, 18, 12, 5,
+  63, 55, 48, 27, 60, 41, 37, 16, 46, 35, 44, 21, 52, 32, 23, 11,
+  54, 26, 40, 15, 34, 20, 31, 10, 25, 14, 19, 9, 13, 8, 7, 6
+};
+
+static inline void
+SetBit (std::vector<uint64_t> &bits, uint32_t index)
+{
+  bits[index / 64] |= static_cast<uint64_t> (1) << (index % 64);
+}
+
+static inline void
+ClearBit (std::vector<uint64_t> &bits, uint32_t index)
+{
+  bits[index / 64] &= ~(static_cast<uint64_t> (1) << (index % 64));
+}
+
+// The first set bit at or after start, wrapping around the end
+static bool
+FindNextBit (const std::vector<uint64_t> &bits, uint32_t start, uint32_t &index)
+{
+  uint32_t nWords = bits.size ();
+  if (nWords == 0)
+  {
+    return false;
+  }
+  uint32_t word = start / 64;
+  uint64_t mask = ~static_cast<uint64_t> (0) << (start % 64);
+  if (word >= nWords)
+  {
+    word = 0;
+    mask = ~static_cast<uint64_t> (0);
+  }
+  // The first word is visited again at the end for its bits before start
+  for (uint32_t i = 0; i <= nWords; ++i)
+  {
+    uint64_t w = bits[word] & mask;
+    if (w != 0)
+    {
+      uint64_t lowest = w & (~w + 1);
+      index = word * 64 + g_lowestBitIndex[(lowest * 0x03f79d71b4ca8b09ULL) >> 58];
+      return true;
+    }
+    mask = ~static_cast<uint64_t> (0);
+    word = (word + 1) % nWords;
+  }
+  return false;
+}
+
+CongaMetric::CongaMetric ()
+  : ce (0)
+{
+}
+
+CongaLeafState::CongaLeafState ()
+  : cursor (0)
+{
+}
+
 Ipv4CongaRouting::Ipv4CongaRouting ():
     // Parameters
     m_isLeaf (false),
@@ -32,12 +111,14 @@ Ipv4CongaRouting::Ipv4CongaRouting ():
     m_flowletTimeout (MicroSeconds(50)), // The default value of flowlet timeout is small for experimental purpose
     m_ecmpMode (false),
     // Variables
-    m_feedbackIndex (0),
-    m_dreEvent (),
-    m_agingEvent (),
-    m_ipv4 (0)
+    m_ipv4 (0),
+    m_nPorts (0)
 {
   NS_LOG_FUNCTION (this);
+  m_flowletTable.SetTimeout (m_flowletTimeout);
+  m_dre.SetPeriod (m_tdre);
+  m_dre.SetAlpha (m_alpha);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4CongaRouting::~Ipv4CongaRouting ()
@@ -51,7 +132,13 @@ Ipv4CongaRouting::GetTypeId (void)
   static TypeId tid = TypeId("ns3::Ipv4CongaRouting")
       .SetParent<Object>()
       .SetGroupName ("Internet")
-      .AddConstructor<Ipv4CongaRouting> ();
+      .AddConstructor<Ipv4CongaRouting> ()
+      .AddAttribute ("FlowletTableSize", "The number of entries of the flowlet table",
+                     UintegerValue (4096),
+                     MakeUintegerAccessor (&Ipv4CongaRouting::SetFlowletTableSize,
+                                           &Ipv4CongaRouting::GetFlowletTableSize),
+                     MakeUintegerChecker<uint32_t> (FlowletTable::WAYS))
+  ;
 
   return tid;
 }
@@ -67,18 +154,39 @@ void
 Ipv4CongaRouting::SetFlowletTimeout (Time timeout)
 {
   m_flowletTimeout = timeout;
+  m_flowletTable.SetTimeout (timeout);
+}
+
+void
+Ipv4CongaRouting::SetFlowletTableSize (uint32_t nEntries)
+{
+  m_flowletTable.SetSize (nEntries);
+}
+
+uint32_t
+Ipv4CongaRouting::GetFlowletTableSize (void) const
+{
+  return m_flowletTable.GetSize ();
+}
+
+const FlowletTable &
+Ipv4CongaRouting::GetFlowletTable (void) const
+{
+  return m_flowletTable;
 }
 
 void
 Ipv4CongaRouting::SetAlpha (double alpha)
 {
   m_alpha = alpha;
+  m_dre.SetAlpha (alpha);
 }
 
 void
 Ipv4CongaRouting::SetTDre (Time time)
 {
   m_tdre = time;
+  m_dre.SetPeriod (time);
 }
 
 void
@@ -90,7 +198,11 @@ Ipv4CongaRouting::SetLinkCapacity (DataRate dataRate)
 void
 Ipv4CongaRouting::SetLinkCapacity (uint32_t interface, DataRate dataRate)
 {
-  m_Cs[interface] = dataRate;
+  if (interface >= m_Cs.size ())
+  {
+    m_Cs.resize (interface + 1, 0);
+  }
+  m_Cs[interface] = dataRate.GetBitRate ();
 }
 
 void
@@ -105,70 +217,128 @@ Ipv4CongaRouting::AddAddressToLeafIdMap (Ipv4Address addr, uint32_t leafId)
   m_ipLeafIdMap[addr] = leafId;
 }
 
+void
+Ipv4CongaRouting::SetTorDirectory (Ptr<const TorDirectory> directory)
+{
+  m_torDirectory = directory;
+}
+
+bool
+Ipv4CongaRouting::FindLeafId (Ipv4Address addr, uint32_t &leafId) const
+{
+  std::map<Ipv4Address, uint32_t>::const_iterator itr = m_ipLeafIdMap.find (addr);
+  if (itr != m_ipLeafIdMap.end ())
+    {
+      leafId = itr->second;
+      return true;
+    }
+  return m_torDirectory != 0 && m_torDirectory->FindTor (addr, leafId);
+}
+
 void
 Ipv4CongaRouting::EnableEcmpMode ()
 {
   m_ecmpMode = true;
 }
 
+int64_t
+Ipv4CongaRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 void
 Ipv4CongaRouting::InitCongestion (uint32_t leafId, uint32_t port, uint32_t congestion)
 {
-  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
-      m_congaToLeafTable.find(leafId);
-  if (itr != m_congaToLeafTable.end ())
+  CongaLeafState &state = Ipv4CongaRouting::GetLeafState (leafId);
+  Ipv4CongaRouting::ReserveToLeaf (state, port);
+  state.toLeaf[port].ce = congestion;
+  state.toLeaf[port].updateTime = Simulator::Now ();
+}
+
+void
+Ipv4CongaRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
+{
+  NS_LOG_LOGIC (this << " Add Conga routing entry: " << network << "/" << networkMask << " would go through port: " << port);
+  m_routeLookup.Insert (network, networkMask, port);
+  m_nPorts = std::max (m_nPorts, port + 1);
+}
+
+CongaLeafState &
+Ipv4CongaRouting::GetLeafState (uint32_t leafId)
+{
+  if (leafId >= m_leafTable.size ())
   {
-    (itr->second)[port] = std::make_pair(Simulator::Now (), congestion);
+    m_leafTable.resize (leafId + 1);
   }
-  else
+  return m_leafTable[leafId];
+}
+
+void
+Ipv4CongaRouting::ReserveToLeaf (CongaLeafState &state, uint32_t port)
+{
+  if (port >= state.toLeaf.size ())
   {
-    std::map<uint32_t, std::pair<Time, uint32_t> > newMap;
-    newMap[port] = std::make_pair(Simulator::Now (), congestion);
-    m_congaToLeafTable[leafId] = newMap;
+    state.toLeaf.resize (std::max (m_nPorts, port + 1));
   }
 }
 
 void
-Ipv4CongaRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
+Ipv4CongaRouting::ReserveFromLeaf (CongaLeafState &state, uint32_t port)
 {
-  NS_LOG_LOGIC (this << " Add Conga routing entry: " << network << "/" << networkMask << " would go through port: " << port);
-  CongaRouteEntry congaRouteEntry;
-  congaRouteEntry.network = network;
-  congaRouteEntry.networkMask = networkMask;
-  congaRouteEntry.port = port;
-  m_routeEntryList.push_back (congaRouteEntry);
+  if (port >= state.fromLeaf.size ())
+  {
+    uint32_t nPorts = std::max (m_nPorts, port + 1);
+    state.fromLeaf.resize (nPorts);
+    state.valid.resize ((nPorts + 63) / 64, 0);
+    state.changed.resize ((nPorts + 63) / 64, 0);
+  }
 }
 
-std::vector<CongaRouteEntry>
-Ipv4CongaRouting::LookupCongaRouteEntries (Ipv4Address dest)
+bool
+Ipv4CongaRouting::SelectFeedback (CongaLeafState &state, Time now, uint32_t &port, uint32_t &ce)
 {
-  std::vector<CongaRouteEntry> congaRouteEntries;
-  std::vector<CongaRouteEntry>::iterator itr = m_routeEntryList.begin ();
-  for ( ; itr != m_routeEntryList.end (); ++itr)
+  uint32_t index;
+  bool found = false;
+  while (!found && FindNextBit (state.changed, state.cursor, index))
+  {
+    ClearBit (state.changed, index);
+    if (now - state.fromLeaf[index].updateTime > m_agingTime)
+    {
+      ClearBit (state.valid, index);
+    }
+    else
+    {
+      found = true;
+    }
+  }
+  while (!found && FindNextBit (state.valid, state.cursor, index))
   {
-    if((*itr).networkMask.IsMatch(dest, (*itr).network))
+    if (now - state.fromLeaf[index].updateTime > m_agingTime)
+    {
+      ClearBit (state.valid, index);
+    }
+    else
     {
-      congaRouteEntries.push_back (*itr);
+      found = true;
     }
   }
-  return congaRouteEntries;
+  if (!found)
+  {
+    return false;
+  }
+  state.cursor = index + 1;
+  port = index;
+  ce = state.fromLeaf[index].ce;
+  return true;
 }
 
-Ptr<Ipv4Route>
-Ipv4CongaRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
-{
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress(nextIf,0).GetLocal();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (port));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
-  route->SetDestination (destAddress);
-  return route;
+Ipv4LpmSpan<uint32_t>
+Ipv4CongaRouting::LookupCongaRouteEntries (Ipv4Address dest)
+{
+  return m_routeLookup.Lookup (dest);
 }
 
 Ptr<Ipv4Route>
@@ -221,7 +391,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   }
   flowId = flowIdTag.GetFlowId ();
 
-  std::vector<CongaRouteEntry> routeEntries = Ipv4CongaRouting::LookupCongaRouteEntries (destAddress);
+  Ipv4LpmSpan<uint32_t> routeEntries = Ipv4CongaRouting::LookupCongaRouteEntries (destAddress);
 
   if (routeEntries.empty ())
   {
@@ -233,23 +403,11 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   // Dev use
   if (m_ecmpMode)
   {
-    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
-    Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
-    ucb (route, packet, header);
-  }
-
-  // Turn on DRE event scheduler if it is not running
-  if (!m_dreEvent.IsRunning ())
-  {
-    NS_LOG_LOGIC (this << " Conga routing restarts dre event scheduling");
-    m_dreEvent = Simulator::Schedule(m_tdre, &Ipv4CongaRouting::DreEvent, this);
-  }
-
-  // Turn on aging event scheduler if it is not running
-  if (!m_agingEvent.IsRunning ())
-  {
-    NS_LOG_LOGIC (this << "Conga routing restarts aging event scheduling");
-    m_agingEvent = Simulator::Schedule(m_agingTime / 4, &Ipv4CongaRouting::AgingEvent, this);
+    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()];
+    if (!m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb))
+    {
+      return false;
+    }
   }
 
   // First, check if this switch if leaf switch
@@ -270,66 +428,36 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // Build an empty Conga header (as the packet tag)
       // Determine the port and fill the header fields
 
-      Ipv4CongaRouting::PrintDreTable ();
-      Ipv4CongaRouting::PrintCongaToLeafTable ();
-      Ipv4CongaRouting::PrintFlowletTable ();
+      CONGA_PRINT_TABLE (Ipv4CongaRouting::PrintDreTable ());
+      CONGA_PRINT_TABLE (Ipv4CongaRouting::PrintCongaToLeafTable ());
+      CONGA_PRINT_TABLE (Ipv4CongaRouting::PrintFlowletTable ());
 
       // Determine the dest switch leaf id
-      std::map<Ipv4Address, uint32_t>::iterator itr = m_ipLeafIdMap.find(destAddress);
-      if (itr == m_ipLeafIdMap.end ())
+      uint32_t destLeafId;
+      if (!Ipv4CongaRouting::FindLeafId (destAddress, destLeafId))
       {
         NS_LOG_ERROR (this << " Conga routing cannot find leaf switch id");
         ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
         return false;
       }
-      uint32_t destLeafId = itr->second;
 
-      // Check piggyback information
-      std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator fbItr =
-          m_congaFromLeafTable.find (destLeafId);
+      CongaLeafState &leafState = Ipv4CongaRouting::GetLeafState (destLeafId);
 
+      // Piggyback according to round robin and favoring those that has been changed
       uint32_t fbLbTag = LOOPBACK_PORT;
       uint32_t fbMetric = 0;
-
-      // Piggyback according to round robin and favoring those that has been changed
-      if (fbItr != m_congaFromLeafTable.end ())
-      {
-        std::map<uint32_t, FeedbackInfo>::iterator innerFbItr = (fbItr->second).begin ();
-        std::advance (innerFbItr, m_feedbackIndex++ % (fbItr->second).size ()); // round robin
-
-        if ((innerFbItr->second).change == false)  // prefer the changed ones
-        {
-          for (unsigned loopIndex = 0; loopIndex < (fbItr->second).size (); loopIndex ++) // prevent infinite looping
-          {
-            if (++innerFbItr == (fbItr->second).end ()) {
-              innerFbItr = (fbItr->second).begin (); // start from the beginning
-            }
-            if ((innerFbItr->second).change == true)
-            {
-              break;
-            }
-          }
-        }
-
-        fbLbTag = innerFbItr->first;
-        fbMetric = (innerFbItr->second).ce;
-        (innerFbItr->second).change = false;
-      }
+      Ipv4CongaRouting::SelectFeedback (leafState, now, fbLbTag, fbMetric);
 
       // Port determination logic:
       // Firstly, check the flowlet table to see whether there is existing flowlet
       // If not hit, determine the port based on the congestion degree of the link
 
       // Flowlet table look up
-      struct Flowlet *flowlet = NULL;
-
       // If the flowlet table entry is valid, return the port
-      std::map<uint32_t, struct Flowlet *>::iterator flowletItr = m_flowletTable.find (flowId);
-      if (flowletItr != m_flowletTable.end ())
+      FlowletEntry *flowlet = m_flowletTable.Lookup (flowId);
+      if (flowlet != NULL)
       {
-        flowlet = flowletItr->second;
-        if (flowlet != NULL && // Impossible in normal cases
-            now - flowlet->activeTime <= m_flowletTimeout)
+        if (now - flowlet->activeTime <= m_flowletTimeout)
         {
           // Do not forget to update the flowlet active time
           flowlet->activeTime = now;
@@ -349,47 +477,42 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
           // Update local dre
           Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
 
-          Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
-          ucb (route, packet, header);
-
           NS_LOG_LOGIC (this << " Sending Conga on leaf switch (flowlet hit): " << m_leafId << " - LbTag: " << selectedPort << ", CE: " << 0 << ", FbLbTag: " << fbLbTag << ", FbMetric: " << fbMetric);
 
-          return true;
+          return m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb);
         }
       }
 
       NS_LOG_LOGIC (this << " Flowlet expires, calculate the new port");
       // Not hit. Determine the port
 
-      // 1. Select port congestion information based on dest leaf switch id
-      std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator
-          congaToLeafItr = m_congaToLeafTable.find (destLeafId);
+      // 1. Port congestion information of the dest leaf switch is in leafState
 
       // 2. Prepare the candidate port
       // For a new flowlet, we pick the uplink port that minimizes the maximum of the local metric (from the local DREs)
       // and the remote metric (from the Congestion-To-Leaf Table).
       uint32_t minPortCongestion = (std::numeric_limits<uint32_t>::max)();
 
-      std::vector<uint32_t> portCandidates;
-      std::vector<CongaRouteEntry>::iterator routeEntryItr = routeEntries.begin ();
+      std::vector<uint32_t> &portCandidates = m_portCandidates;
+      portCandidates.clear ();
+      Ipv4LpmSpan<uint32_t>::const_iterator routeEntryItr = routeEntries.begin ();
 
       for ( ; routeEntryItr != routeEntries.end (); ++routeEntryItr)
       {
-        uint32_t port = (*routeEntryItr).port;
+        uint32_t port = *routeEntryItr;
         uint32_t localCongestion = 0;
         uint32_t remoteCongestion = 0;
 
-        std::map<uint32_t, uint32_t>::iterator localCongestionItr = m_XMap.find (port);
-        if (localCongestionItr != m_XMap.end ())
+        if (port < m_XMap.size ())
         {
-          localCongestion = Ipv4CongaRouting::QuantizingX (port, localCongestionItr->second);
+          localCongestion = Ipv4CongaRouting::QuantizingX (port, m_dre.Get (m_XMap[port], now));
         }
 
-        std::map<uint32_t, std::pair<Time, uint32_t> >::iterator remoteCongestionItr =
-            (congaToLeafItr->second).find (port);
-        if (remoteCongestionItr != (congaToLeafItr->second).end ())
+        // Metrics not refreshed within the aging time are considered as 0
+        if (port < leafState.toLeaf.size ()
+            && now - leafState.toLeaf[port].updateTime <= m_agingTime)
         {
-          remoteCongestion = (remoteCongestionItr->second).second;
+          remoteCongestion = leafState.toLeaf[port].ce;
         }
 
         uint32_t congestionDegree = std::max (localCongestion, remoteCongestion);
@@ -401,7 +524,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
           portCandidates.clear();
           portCandidates.push_back(port);
         }
-        if (congestionDegree == minPortCongestion)
+        else if (congestionDegree == minPortCongestion)
         {
           // Equally good port
           portCandidates.push_back(port);
@@ -420,19 +543,13 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       else
       {
         // If there are no cached ports, we randomly choose a good port
-        selectedPort = portCandidates[rand() % portCandidates.size ()];
+        selectedPort = portCandidates[m_rand->GetInteger (0, portCandidates.size () - 1)];
         if (flowlet == NULL)
         {
-          struct Flowlet *newFlowlet = new Flowlet;
-          newFlowlet->port = selectedPort;
-          newFlowlet->activeTime = now;
-          m_flowletTable[flowId] = newFlowlet;
-        }
-        else
-        {
-          flowlet->port = selectedPort;
-          flowlet->activeTime = now;
+          flowlet = m_flowletTable.Insert (flowId, now);
         }
+        flowlet->port = selectedPort;
+        flowlet->activeTime = now;
       }
 
       // 4. Construct Conga Header for the packet
@@ -447,12 +564,9 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // Update local dre
       Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
 
-      Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
-      ucb (route, packet, header);
-
       NS_LOG_LOGIC (this << " Sending Conga on leaf switch: " << m_leafId << " - LbTag: " << selectedPort << ", CE: " << 0 << ", FbLbTag: " << fbLbTag << ", FbMetric: " << fbMetric);
 
-      return true;
+      return m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb);
     }
     else
     {
@@ -464,64 +578,31 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       // Forwarding the packet to destination
 
       // Determine the source switch leaf id
-      std::map<Ipv4Address, uint32_t>::iterator itr = m_ipLeafIdMap.find(header.GetSource ());
-      if (itr == m_ipLeafIdMap.end ())
+      uint32_t sourceLeafId;
+      if (!Ipv4CongaRouting::FindLeafId (header.GetSource (), sourceLeafId))
       {
         NS_LOG_ERROR (this << " Conga routing cannot find leaf switch id");
         ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
         return false;
       }
-      uint32_t sourceLeafId = itr->second;
 
-      // 1. Update the CongaFromLeafTable
-      std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator fromLeafItr = m_congaFromLeafTable.find (sourceLeafId);
+      CongaLeafState &leafState = Ipv4CongaRouting::GetLeafState (sourceLeafId);
 
-      if (fromLeafItr == m_congaFromLeafTable.end ())
-      {
-        std::map<uint32_t, FeedbackInfo> newMap;
-        FeedbackInfo feedbackInfo;
-        feedbackInfo.ce = ipv4CongaTag.GetCe ();
-        feedbackInfo.change = true;
-        feedbackInfo.updateTime = Simulator::Now ();
-        newMap[ipv4CongaTag.GetLbTag ()] = feedbackInfo;
-        m_congaFromLeafTable[sourceLeafId] = newMap;
-      }
-      else
-      {
-        std::map<uint32_t, FeedbackInfo>::iterator innerItr = (fromLeafItr->second).find (ipv4CongaTag.GetLbTag ());
-        if (innerItr == (fromLeafItr->second).end ())
-        {
-          FeedbackInfo feedbackInfo;
-          feedbackInfo.ce = ipv4CongaTag.GetCe ();
-          feedbackInfo.change = true;
-          feedbackInfo.updateTime = Simulator::Now ();
-          (fromLeafItr->second)[ipv4CongaTag.GetLbTag ()] = feedbackInfo;
-        }
-        else
-        {
-          (innerItr->second).ce = ipv4CongaTag.GetCe ();
-          (innerItr->second).change = true;
-          (innerItr->second).updateTime = Simulator::Now ();
-        }
-      }
+      // 1. Update the CongaFromLeafTable
+      uint32_t lbTag = ipv4CongaTag.GetLbTag ();
+      Ipv4CongaRouting::ReserveFromLeaf (leafState, lbTag);
+      leafState.fromLeaf[lbTag].ce = ipv4CongaTag.GetCe ();
+      leafState.fromLeaf[lbTag].updateTime = now;
+      SetBit (leafState.valid, lbTag);
+      SetBit (leafState.changed, lbTag);
 
       // 2. Update the CongaToLeafTable
-      if (ipv4CongaTag.GetFbLbTag () != LOOPBACK_PORT)
+      uint32_t fbLbTag = ipv4CongaTag.GetFbLbTag ();
+      if (fbLbTag != LOOPBACK_PORT)
       {
-        std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator toLeafItr =
-            m_congaToLeafTable.find(sourceLeafId);
-        if (toLeafItr != m_congaToLeafTable.end ())
-        {
-          (toLeafItr->second)[ipv4CongaTag.GetFbLbTag ()] =
-              std::make_pair(Simulator::Now (), ipv4CongaTag.GetFbMetric ());
-        }
-        else
-        {
-          std::map<uint32_t, std::pair<Time, uint32_t> > newMap;
-          newMap[ipv4CongaTag.GetFbLbTag ()] =
-              std::make_pair(Simulator::Now (), ipv4CongaTag.GetFbMetric ());
-          m_congaToLeafTable[sourceLeafId] = newMap;
-        }
+        Ipv4CongaRouting::ReserveToLeaf (leafState, fbLbTag);
+        leafState.toLeaf[fbLbTag].ce = ipv4CongaTag.GetFbMetric ();
+        leafState.toLeaf[fbLbTag].updateTime = now;
       }
 
       // Not necessary
@@ -529,18 +610,15 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       packet->RemovePacketTag (ipv4CongaTag);
 
       // Pick port using standard ECMP
-      uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+      uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()];
 
       Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
 
-      Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
-      ucb (route, packet, header);
-
-      Ipv4CongaRouting::PrintDreTable ();
-      Ipv4CongaRouting::PrintCongaToLeafTable ();
-      Ipv4CongaRouting::PrintCongaFromLeafTable ();
+      CONGA_PRINT_TABLE (Ipv4CongaRouting::PrintDreTable ());
+      CONGA_PRINT_TABLE (Ipv4CongaRouting::PrintCongaToLeafTable ());
+      CONGA_PRINT_TABLE (Ipv4CongaRouting::PrintCongaFromLeafTable ());
 
-      return true;
+      return m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb);
     }
   }
   else
@@ -557,7 +635,7 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     }
 
     // Determine the port using standard ECMP
-    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()].port;
+    uint32_t selectedPort = routeEntries[flowId % routeEntries.size ()];
 
     // Update local dre
     uint32_t X = Ipv4CongaRouting::UpdateLocalDre (header, packet, selectedPort);
@@ -576,31 +654,32 @@ Ipv4CongaRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
       packet->ReplacePacketTag(ipv4CongaTag);
     }
 
-    Ptr<Ipv4Route> route = Ipv4CongaRouting::ConstructIpv4Route (selectedPort, destAddress);
-    ucb (route, packet, header);
-
-    return true;
+    return m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb);
   }
 }
 
 void
 Ipv4CongaRouting::NotifyInterfaceUp (uint32_t interface)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4CongaRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4CongaRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4CongaRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
@@ -609,6 +688,7 @@ Ipv4CongaRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_nextHopTable.SetIpv4 (ipv4);
 }
 
 void
@@ -620,127 +700,34 @@ Ipv4CongaRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4CongaRouting::DoDispose (void)
 {
-  std::map<uint32_t, Flowlet *>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end (); ++itr )
-  {
-    delete (itr->second);
-  }
-  m_dreEvent.Cancel ();
-  m_agingEvent.Cancel ();
+  m_flowletTable.Clear ();
   m_ipv4=0;
+  m_nextHopTable.Clear ();
+  m_routeLookup.Clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
 uint32_t
 Ipv4CongaRouting::UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t port)
 {
-  uint32_t X = 0;
-  std::map<uint32_t, uint32_t>::iterator XItr = m_XMap.find(port);
-  if (XItr != m_XMap.end ())
+  if (port >= m_XMap.size ())
   {
-    X = XItr->second;
+    m_XMap.resize (port + 1);
   }
-  uint32_t newX = X + packet->GetSize () + header.GetSerializedSize ();
+  uint32_t newX = m_dre.Add (m_XMap[port], Simulator::Now (), packet->GetSize () + header.GetSerializedSize ());
   NS_LOG_LOGIC (this << " Update local dre, new X: " << newX);
-  m_XMap[port] = newX;
   return newX;
 }
 
-void
-Ipv4CongaRouting::DreEvent ()
-{
-  bool moveToIdleStatus = true;
-
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
-  for ( ; itr != m_XMap.end (); ++itr )
-  {
-    uint32_t newX = itr->second * (1 - m_alpha);
-    itr->second = newX;
-    if (newX != 0)
-    {
-      moveToIdleStatus = false;
-    }
-  }
-
-  NS_LOG_LOGIC (this << " Dre event finished, the dre table is now: ");
-  Ipv4CongaRouting::PrintDreTable ();
-
-  if (!moveToIdleStatus)
-  {
-    m_dreEvent = Simulator::Schedule(m_tdre, &Ipv4CongaRouting::DreEvent, this);
-  }
-  else
-  {
-    NS_LOG_LOGIC (this << " Dre event goes into idle status");
-  }
-}
-
-void
-Ipv4CongaRouting::AgingEvent ()
-{
-    bool moveToIdleStatus = true;
-    std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > >::iterator itr =
-        m_congaToLeafTable.begin ();
-    for ( ; itr != m_congaToLeafTable.end (); ++itr)
-    {
-      std::map<uint32_t, std::pair<Time, uint32_t> >::iterator innerItr =
-        (itr->second).begin ();
-      for (; innerItr != (itr->second).end (); ++innerItr)
-      {
-        if (Simulator::Now () - (innerItr->second).first > m_agingTime)
-        {
-          (innerItr->second).second = 0;
-        }
-        else
-        {
-          moveToIdleStatus = false;
-        }
-      }
-    }
-    std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr2 =
-        m_congaFromLeafTable.begin ();
-    for ( ; itr2 != m_congaFromLeafTable.end (); ++itr2 )
-    {
-        std::map<uint32_t, FeedbackInfo>::iterator innerItr2 =
-          (itr2->second).begin ();
-        for ( ; innerItr2 != (itr2->second).end (); ++innerItr2)
-        {
-          if (Simulator::Now () - (innerItr2->second).updateTime > m_agingTime)
-          {
-            (itr2->second).erase (innerItr2);
-            if ((itr2->second).empty ())
-            {
-                m_congaFromLeafTable.erase (itr2);
-            }
-          }
-          else
-          {
-            moveToIdleStatus = false;
-          }
-        }
-    }
-
-
-    if (!moveToIdleStatus)
-    {
-      m_agingEvent = Simulator::Schedule(m_agingTime / 4, &Ipv4CongaRouting::AgingEvent, this);
-    }
-    else
-    {
-      NS_LOG_LOGIC (this << " Aging event goes into idle status");
-    }
-}
-
 uint32_t
 Ipv4CongaRouting::QuantizingX (uint32_t interface, uint32_t X)
 {
-  DataRate c = m_C;
-  std::map<uint32_t, DataRate>::iterator itr = m_Cs.find (interface);
-  if (itr != m_Cs.end ())
+  uint64_t bitRate = m_C.GetBitRate ();
+  if (interface < m_Cs.size () && m_Cs[interface] != 0)
   {
-    c = itr->second;
+    bitRate = m_Cs[interface];
   }
-  double ratio = static_cast<double> (X * 8) / (c.GetBitRate () * m_tdre.GetSeconds () / m_alpha);
+  double ratio = static_cast<double> (X * 8) / (bitRate * m_tdre.GetSeconds () / m_alpha);
   NS_LOG_LOGIC ("ratio: " << ratio);
   return static_cast<uint32_t>(ratio * std::pow(2, m_Q));
 }
@@ -748,89 +735,84 @@ Ipv4CongaRouting::QuantizingX (uint32_t interface, uint32_t X)
 void
 Ipv4CongaRouting::PrintCongaToLeafTable ()
 {
-/*
   std::ostringstream oss;
   oss << "===== CongaToLeafTable For Leaf: " << m_leafId <<"=====" << std::endl;
-  std::map<uint32_t, std::map<uint32_t, uint32_t> >::iterator itr = m_congaToLeafTable.begin ();
-  for ( ; itr != m_congaToLeafTable.end (); ++itr )
+  for (uint32_t leafId = 0; leafId < m_leafTable.size (); ++leafId)
   {
-    oss << "Leaf ID: " << itr->first << std::endl<<"\t";
-    std::map<uint32_t, uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    const std::vector<CongaMetric> &toLeaf = m_leafTable[leafId].toLeaf;
+    oss << "Leaf ID: " << leafId << std::endl<<"\t";
+    for (uint32_t port = 0; port < toLeaf.size (); ++port)
     {
+      if (toLeaf[port].updateTime.IsZero () && toLeaf[port].ce == 0)
+      {
+        continue;
+      }
       oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second)
+          << port << ", ce: "  << toLeaf[port].ce
+          << ", time: " << toLeaf[port].updateTime
           << " } ";
     }
     oss << std::endl;
   }
   oss << "============================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 void
 Ipv4CongaRouting::PrintCongaFromLeafTable ()
 {
-/*
   std::ostringstream oss;
   oss << "===== CongaFromLeafTable For Leaf: " << m_leafId << "=====" <<std::endl;
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> >::iterator itr = m_congaFromLeafTable.begin ();
-  for ( ; itr != m_congaFromLeafTable.end (); ++itr )
+  for (uint32_t leafId = 0; leafId < m_leafTable.size (); ++leafId)
   {
-    oss << "Leaf ID: " << itr->first << std::endl << "\t";
-    std::map<uint32_t, FeedbackInfo>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr)
+    const CongaLeafState &state = m_leafTable[leafId];
+    oss << "Leaf ID: " << leafId << std::endl << "\t";
+    for (uint32_t port = 0; port < state.fromLeaf.size (); ++port)
     {
+      uint64_t bit = static_cast<uint64_t> (1) << (port % 64);
+      if ((state.valid[port / 64] & bit) == 0)
+      {
+        continue;
+      }
       oss << "{ port: "
-          << innerItr->first << ", ce: "  << (innerItr->second).ce
-          << ", change: " << (innerItr->second).change
+          << port << ", ce: "  << state.fromLeaf[port].ce
+          << ", change: " << ((state.changed[port / 64] & bit) != 0)
           << " } ";
     }
     oss << std::endl;
   }
   oss << "==============================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 void
 Ipv4CongaRouting::PrintFlowletTable ()
 {
-/*
   std::ostringstream oss;
   oss << "===== Flowlet For Leaf: " << m_leafId << "=====" << std::endl;
-  std::map<uint32_t, Flowlet*>::iterator itr = m_flowletTable.begin ();
-  for ( ; itr != m_flowletTable.end(); ++itr )
-  {
-    oss << "flowId: " << itr->first << std::endl << "\t"
-        << "port: " << (itr->second)->port << "\t"
-        << "activeTime" << (itr->second)->activeTime << std::endl;
-  }
+  oss << "entries: " << m_flowletTable.GetSize () << "\t"
+      << "collisions: " << m_flowletTable.GetNCollisions () << "\t"
+      << "evictions: " << m_flowletTable.GetNEvictions () << std::endl;
   oss << "===================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 void
 Ipv4CongaRouting::PrintDreTable ()
 {
-/*
   std::ostringstream oss;
   std::string switchType = m_isLeaf == true ? "leaf switch" : "spine switch";
   oss << "==== Local Dre for " << switchType << " ====" <<std::endl;
-  std::map<uint32_t, uint32_t>::iterator itr = m_XMap.begin ();
-  for ( ; itr != m_XMap.end (); ++itr)
+  for (uint32_t port = 0; port < m_XMap.size (); ++port)
   {
-    oss << "port: " << itr->first <<
-      ", X: " << itr->second <<
-      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (itr->second) <<std::endl;
+    uint32_t X = m_dre.Get (m_XMap[port], Simulator::Now ());
+    oss << "port: " << port <<
+      ", X: " << X <<
+      ", Quantized X: " << Ipv4CongaRouting::QuantizingX (port, X) <<std::endl;
   }
   oss << "=================================";
   NS_LOG_LOGIC (oss.str ());
-*/
 }
 
 
 }
-
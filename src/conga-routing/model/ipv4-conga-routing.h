@@ -4,38 +4,61 @@
 
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/ipv4-next-hop-table.h"
+#include "ns3/ipv4-lpm-trie.h"
+#include "ns3/flowlet-table.h"
+#include "ns3/lazy-dre.h"
+#include "ns3/tor-directory.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 
 #include <map>
 #include <vector>
 
+class Ipv4CongaFeedbackTestCase;
+
 namespace ns3 {
 
-struct Flowlet {
-  uint32_t port;
-  Time activeTime;
-};
+// A congestion metric and when it was learnt
+struct CongaMetric {
+  CongaMetric ();
 
-struct FeedbackInfo {
   uint32_t ce;
-  bool change;
   Time updateTime;
 };
 
-struct CongaRouteEntry {
-  Ipv4Address network;
-  Ipv4Mask networkMask;
-  uint32_t port;
+// The CONGA state of a leaf about one remote leaf, indexed by uplink port.
+// The vectors are sized once for the ports known when the remote leaf is
+// first seen and only grow for a port beyond them.
+struct CongaLeafState {
+  CongaLeafState ();
+
+  // Congestion-To-Leaf: the metric of our uplinks, fed back by the remote leaf
+  std::vector<CongaMetric> toLeaf;
+
+  // Congestion-From-Leaf: the metric of the uplinks of the remote leaf, to feed back
+  std::vector<CongaMetric> fromLeaf;
+
+  // Bitmaps over fromLeaf of the entries held and of those changed since
+  // they were last fed back
+  std::vector<uint64_t> valid;
+  std::vector<uint64_t> changed;
+
+  // Round robin position of the next feedback
+  uint32_t cursor;
 };
 
 class Ipv4CongaRouting : public Ipv4RoutingProtocol
 {
 public:
+  // Allow test cases to access private members
+  friend class ::Ipv4CongaFeedbackTestCase;
+
   Ipv4CongaRouting ();
   ~Ipv4CongaRouting ();
 
@@ -55,14 +78,24 @@ public:
 
   void SetFlowletTimeout (Time timeout);
 
+  void SetFlowletTableSize (uint32_t nEntries);
+  uint32_t GetFlowletTableSize (void) const;
+  const FlowletTable & GetFlowletTable (void) const;
+
   void AddAddressToLeafIdMap (Ipv4Address addr, uint32_t leafId);
 
+  // Looked up for the addresses not added to the leaf id map
+  void SetTorDirectory (Ptr<const TorDirectory> directory);
+
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
 
   void InitCongestion (uint32_t destLeafId, uint32_t port, uint32_t congestion);
 
   void EnableEcmpMode ();
 
+  // Use a fixed stream for the choice among equally good ports, returns 1
+  int64_t AssignStreams (int64_t stream);
+
   /* Inherit From Ipv4RoutingProtocol */
   virtual Ptr<Ipv4Route> RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr);
   virtual bool RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr<const NetDevice> idev,
@@ -93,7 +126,8 @@ private:
 
   DataRate m_C;
 
-  std::map<uint32_t, DataRate> m_Cs;
+  // Bit rate of every port, 0 for m_C
+  std::vector<uint64_t> m_Cs;
 
   // Quantizing bits
   uint32_t m_Q;
@@ -107,55 +141,64 @@ private:
   bool m_ecmpMode;
 
   // ------ Variables ------
-  // Used to maintain the round robin
-  unsigned long m_feedbackIndex;
-
-  // Dre Event ID
-  EventId m_dreEvent;
-
-  // Metric aging event
-  EventId m_agingEvent;
-
   // Ipv4 associated with this router
   Ptr<Ipv4> m_ipv4;
 
-  // Route table
-  std::vector<CongaRouteEntry> m_routeEntryList;
+  // Shared next hop route of each output port
+  Ipv4NextHopTable m_nextHopTable;
+
+  // Route table, longest prefix -> equal-cost output ports
+  Ipv4LpmTrie<uint32_t> m_routeLookup;
 
   // Ip and leaf switch map,
   // used to determine the which leaf switch the packet would go through
+  Ptr<const TorDirectory> m_torDirectory;
   std::map<Ipv4Address, uint32_t> m_ipLeafIdMap;
 
-  // Congestion To Leaf Table
-  std::map<uint32_t, std::map<uint32_t, std::pair<Time, uint32_t> > > m_congaToLeafTable;
+  // Congestion To Leaf and From Leaf Tables, indexed by leaf id
+  std::vector<CongaLeafState> m_leafTable;
 
-  // Congestion From Leaf Table
-  std::map<uint32_t, std::map<uint32_t, FeedbackInfo> > m_congaFromLeafTable;
+  // One more than the highest uplink port, the initial size of the leaf states
+  uint32_t m_nPorts;
 
   // Flowlet Table
-  std::map<uint32_t, Flowlet *> m_flowletTable;
+  FlowletTable m_flowletTable;
+
+  // Scratch buffer of the equally good ports of a new flowlet
+  std::vector<uint32_t> m_portCandidates;
+
+  // Breaks the ties between the candidate ports of new flowlets
+  Ptr<UniformRandomVariable> m_rand;
 
   // Parameters
-  // DRE
-  std::map<uint32_t, uint32_t> m_XMap;
+  // DRE, decayed on access
+  LazyDre m_dre;
+  std::vector<DreRegister> m_XMap;
 
   // ------ Functions ------
   // DRE algorithm
   uint32_t UpdateLocalDre (const Ipv4Header &header, Ptr<Packet> packet, uint32_t path);
 
-  void DreEvent();
+  // The state about a remote leaf, with room for the port
+  CongaLeafState & GetLeafState (uint32_t leafId);
+  void ReserveToLeaf (CongaLeafState &state, uint32_t port);
+  void ReserveFromLeaf (CongaLeafState &state, uint32_t port);
 
-  void AgingEvent ();
+  // Pick the feedback to piggyback to a remote leaf, the changed entries
+  // first, in round robin. The entries older than the aging time are dropped.
+  bool SelectFeedback (CongaLeafState &state, Time now, uint32_t &port, uint32_t &ce);
 
   // Quantizing X to metrics degree
   // X is bytes here and we quantizing it to 0 - 2^Q
   uint32_t QuantizingX (uint32_t interface, uint32_t X);
 
-  std::vector<CongaRouteEntry> LookupCongaRouteEntries (Ipv4Address dest);
+  Ipv4LpmSpan<uint32_t> LookupCongaRouteEntries (Ipv4Address dest);
+
+  // The leaf switch of the address, from the directory or the leaf id map
+  bool FindLeafId (Ipv4Address addr, uint32_t &leafId) const;
 
-  Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
 
-  // Debug use
+  // Debug use, only called when the LOG_LOGIC level is enabled
   void PrintCongaToLeafTable ();
   void PrintCongaFromLeafTable ();
   void PrintFlowletTable ();
@@ -1,8 +1,11 @@
 #include "ipv4-conga-tag.h"
+#include "ns3/packet-tag-slots.h"
 
 namespace ns3
 {
 
+NS_PACKET_TAG_SLOT (Ipv4CongaTag);
+
 Ipv4CongaTag::Ipv4CongaTag () {}
 
 TypeId
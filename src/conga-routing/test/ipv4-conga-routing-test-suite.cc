@@ -2,6 +2,8 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-conga-routing.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/nstime.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +48,115 @@ Ipv4CongaRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Test the choice of the metric fed back to a remote leaf: the changed
+// entries go before the unchanged ones, both in round robin, and the
+// entries older than the aging time are dropped
+class Ipv4CongaFeedbackTestCase : public TestCase
+{
+public:
+  Ipv4CongaFeedbackTestCase ();
+  virtual ~Ipv4CongaFeedbackTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  // Record the metric of a port of the remote leaf, as RouteInput does
+  void Learn (CongaLeafState &state, uint32_t port, uint32_t ce, Time now);
+  // The port selected for the feedback, or -1 if none
+  int32_t Select (CongaLeafState &state, Time now, uint32_t &ce);
+
+  Ptr<Ipv4CongaRouting> m_routing;
+};
+
+Ipv4CongaFeedbackTestCase::Ipv4CongaFeedbackTestCase ()
+  : TestCase ("CongaRouting feedback selection")
+{
+}
+
+Ipv4CongaFeedbackTestCase::~Ipv4CongaFeedbackTestCase ()
+{
+}
+
+void
+Ipv4CongaFeedbackTestCase::Learn (CongaLeafState &state, uint32_t port, uint32_t ce, Time now)
+{
+  m_routing->ReserveFromLeaf (state, port);
+  state.fromLeaf[port].ce = ce;
+  state.fromLeaf[port].updateTime = now;
+  state.valid[port / 64] |= static_cast<uint64_t> (1) << (port % 64);
+  state.changed[port / 64] |= static_cast<uint64_t> (1) << (port % 64);
+}
+
+int32_t
+Ipv4CongaFeedbackTestCase::Select (CongaLeafState &state, Time now, uint32_t &ce)
+{
+  uint32_t port;
+  if (!m_routing->SelectFeedback (state, now, port, ce))
+    {
+      return -1;
+    }
+  return port;
+}
+
+void
+Ipv4CongaFeedbackTestCase::DoRun (void)
+{
+  m_routing = CreateObject<Ipv4CongaRouting> ();
+  // Uplink ports 1 to 4, the leaf states are sized for 5 ports
+  for (uint32_t port = 1; port <= 4; ++port)
+    {
+      m_routing->AddRoute (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), port);
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_routing->m_nPorts, 5, "Wrong number of ports");
+
+  uint32_t ce;
+  Time t0 = Seconds (1);
+
+  // Changed entries before unchanged ones, with round robin wraparound
+  CongaLeafState &state = m_routing->GetLeafState (1);
+  Learn (state, 1, 1, t0);
+  Learn (state, 2, 2, t0);
+  Learn (state, 3, 3, t0);
+  NS_TEST_EXPECT_MSG_EQ (state.fromLeaf.size (), 5, "Leaf state not sized for the known ports");
+  for (uint32_t port = 1; port <= 3; ++port)
+    {
+      NS_TEST_EXPECT_MSG_EQ (Select (state, t0, ce), (int32_t) port, "Changed entries not in round robin");
+      NS_TEST_EXPECT_MSG_EQ (ce, port, "Wrong metric fed back");
+    }
+  Learn (state, 2, 7, t0);
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t0, ce), 2, "Unchanged entry fed back before a changed one");
+  NS_TEST_EXPECT_MSG_EQ (ce, 7, "Stale metric fed back");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t0, ce), 3, "Unchanged entries not in round robin");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t0, ce), 1, "No wraparound of the round robin");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t0, ce), 2, "No round robin after the wraparound");
+
+  // Aging: ports 1 and 3 learnt at t0, port 2 relearnt later
+  Time t1 = t0 + MilliSeconds (8);
+  Learn (state, 2, 4, t1);
+  Time t2 = t0 + MilliSeconds (15);
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t2, ce), 2, "Aged entries fed back");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t2, ce), 2, "Aged entries fed back");
+  NS_TEST_EXPECT_MSG_EQ (state.valid[0], static_cast<uint64_t> (1) << 2, "Aged entries not dropped");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t2 + MilliSeconds (10), ce), -1, "Feedback without any fresh entry");
+  NS_TEST_EXPECT_MSG_EQ (state.valid[0], 0, "Aged entry not dropped");
+
+  // A port beyond the ports known when the leaf state was created, in
+  // another word of the bitmaps
+  Time t3 = t0 + Seconds (1);
+  Learn (state, 70, 5, t3);
+  NS_TEST_EXPECT_MSG_EQ (state.fromLeaf.size (), 71, "Leaf state not grown for a new port");
+  NS_TEST_EXPECT_MSG_EQ (state.valid.size (), 2, "Bitmaps not grown for a new port");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t3, ce), 70, "New port not fed back");
+  NS_TEST_EXPECT_MSG_EQ (ce, 5, "Wrong metric of the new port");
+  Learn (state, 1, 6, t3);
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t3, ce), 1, "No wraparound from the last word");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t3, ce), 70, "Entry of the new port lost");
+  NS_TEST_EXPECT_MSG_EQ (Select (state, t3, ce), 1, "No wraparound from the last word");
+
+  m_routing->Dispose ();
+  m_routing = 0;
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +172,7 @@ CongaRoutingTestSuite::CongaRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new Ipv4CongaRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new Ipv4CongaFeedbackTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -8,6 +8,7 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 #include <vector>
 #include <map>
 
@@ -50,6 +51,9 @@ public:
 
     void ReceivePacket (Ptr<Socket> socket);
 
+    // Use a fixed stream for the noise of the probe interval, returns 1
+    int64_t AssignStreams (int64_t stream);
+
     typedef void (*ProbingCallback)
         (uint32_t pathId, Ptr<Packet> packet, Ipv4Header header, Time rtt, bool isCE);
 
@@ -76,6 +80,8 @@ private:
 
     Time m_probeTimeout;
 
+    Ptr<UniformRandomVariable> m_rand;
+
     // Trace source
     TracedCallback <uint32_t, Ptr<Packet>, Ipv4Header ,Time, bool> m_probingCallback;
 
@@ -20,6 +20,7 @@
 
 #include "event-impl.h"
 #include "log.h"
+#include <new>
 
 /**
  * \file
@@ -31,6 +32,90 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("EventImpl");
 
+namespace {
+
+/** Granularity of the event size classes. */
+const std::size_t EVENT_SIZE_STEP = 16;
+/** Number of event size classes, larger events go to malloc. */
+const uint32_t EVENT_SIZE_CLASSES = 8;
+/** Most events kept per size class and thread. */
+const uint32_t EVENT_FREE_LIST_MAX = 4096;
+
+/** A free event, linked to the next one of its size class. */
+struct FreeEvent
+{
+  FreeEvent *next; //!< next free event
+};
+
+/** Free events of the calling thread, per size class. */
+__thread FreeEvent *g_freeEvents[EVENT_SIZE_CLASSES];
+/** Number of free events of the calling thread, per size class. */
+__thread uint32_t g_nFreeEvents[EVENT_SIZE_CLASSES];
+/** Whether the static destructors of the main thread have run. */
+__thread bool g_freeEventsDestroyed = false;
+
+/** Release the free lists of the main thread at exit. */
+struct FreeEventsDestructor
+{
+  ~FreeEventsDestructor ()
+  {
+    EventImpl::ReleaseThreadFreeLists ();
+    g_freeEventsDestroyed = true;
+  }
+} g_freeEventsDestructor; //!< releases the main thread free lists
+
+} // unnamed namespace
+
+void *
+EventImpl::operator new (std::size_t size)
+{
+  uint32_t sizeClass = (size - 1) / EVENT_SIZE_STEP;
+  if (sizeClass >= EVENT_SIZE_CLASSES)
+    {
+      return ::operator new (size);
+    }
+  FreeEvent *event = g_freeEvents[sizeClass];
+  if (event == 0)
+    {
+      return ::operator new ((sizeClass + 1) * EVENT_SIZE_STEP);
+    }
+  g_freeEvents[sizeClass] = event->next;
+  g_nFreeEvents[sizeClass]--;
+  return event;
+}
+
+void
+EventImpl::operator delete (void *p, std::size_t size)
+{
+  uint32_t sizeClass = (size - 1) / EVENT_SIZE_STEP;
+  if (sizeClass >= EVENT_SIZE_CLASSES
+      || g_nFreeEvents[sizeClass] >= EVENT_FREE_LIST_MAX
+      || g_freeEventsDestroyed)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeEvent *event = static_cast<FreeEvent *> (p);
+  event->next = g_freeEvents[sizeClass];
+  g_freeEvents[sizeClass] = event;
+  g_nFreeEvents[sizeClass]++;
+}
+
+void
+EventImpl::ReleaseThreadFreeLists (void)
+{
+  for (uint32_t i = 0; i < EVENT_SIZE_CLASSES; i++)
+    {
+      while (g_freeEvents[i] != 0)
+        {
+          FreeEvent *event = g_freeEvents[i];
+          g_freeEvents[i] = event->next;
+          ::operator delete (event);
+        }
+      g_nFreeEvents[i] = 0;
+    }
+}
+
 EventImpl::~EventImpl ()
 {
   NS_LOG_FUNCTION (this);
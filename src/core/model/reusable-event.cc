@@ -0,0 +1,80 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "reusable-event.h"
+#include "simulator.h"
+#include "assert.h"
+#include "log.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::ReusableEvent implementation.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ReusableEvent");
+
+ReusableEvent::Impl::Impl (const Callback<void> &callback)
+  : m_callback (callback),
+    m_notifying (false)
+{
+}
+
+bool
+ReusableEvent::Impl::IsNotifying (void) const
+{
+  return m_notifying;
+}
+
+void
+ReusableEvent::Impl::Notify (void)
+{
+  m_notifying = true;
+  m_callback ();
+  m_notifying = false;
+}
+
+ReusableEvent::ReusableEvent ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ReusableEvent::~ReusableEvent ()
+{
+  NS_LOG_FUNCTION (this);
+  Cancel ();
+}
+
+void
+ReusableEvent::Schedule (const Time &delay)
+{
+  NS_LOG_FUNCTION (this << delay);
+  NS_ASSERT_MSG (!m_callback.IsNull (), "No function set");
+  NS_ASSERT_MSG (!IsRunning (), "The event is already scheduled");
+  m_event = EventId ();
+  // The event list holds the event until it has run, and a cancelled one
+  // until its time is reached. The event is reused when only this timer
+  // holds it, besides the simulator running it.
+  if (m_impl == 0 || m_impl->IsCancelled ()
+      || m_impl->GetReferenceCount () > (m_impl->IsNotifying () ? 2u : 1u))
+    {
+      m_impl = Create<Impl> (m_callback);
+    }
+  m_event = Simulator::Schedule (delay, m_impl);
+}
+
+void
+ReusableEvent::Cancel (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_event.Cancel ();
+}
+
+bool
+ReusableEvent::IsRunning (void) const
+{
+  return m_event.IsRunning ();
+}
+
+} // namespace ns3
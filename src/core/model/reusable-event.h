@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef REUSABLE_EVENT_H
+#define REUSABLE_EVENT_H
+
+#include "callback.h"
+#include "event-id.h"
+#include "event-impl.h"
+#include "nstime.h"
+#include "ptr.h"
+
+/**
+ * \file
+ * \ingroup events
+ * ns3::ReusableEvent declaration.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup events
+ * \brief A timer which schedules the same event object each time
+ *
+ * A model which re-arms a timer every few microseconds, such as a periodic
+ * probe or a timer moved on every packet, allocates an event and releases
+ * it at each Simulator::Schedule. ReusableEvent instead keeps one event
+ * and schedules it again once it has run, or from its own function. A new
+ * event is only created when the last one was cancelled.
+ *
+ * The event is cancelled when the ReusableEvent is destroyed.
+ */
+class ReusableEvent
+{
+public:
+  ReusableEvent ();
+  ~ReusableEvent ();
+
+  /**
+   * \param [in] memPtr the member function pointer
+   * \param [in] objPtr the pointer to object
+   *
+   * Set the function called when the event expires.
+   */
+  template <typename MEM_PTR, typename OBJ_PTR>
+  void SetFunction (MEM_PTR memPtr, OBJ_PTR objPtr);
+
+  /**
+   * \brief Schedule the event, which must not be running
+   *
+   * \param [in] delay the delay before the event expires
+   */
+  void Schedule (const Time &delay);
+  /**
+   * \brief Cancel the event if it is running
+   */
+  void Cancel (void);
+  /**
+   * \returns true if the event is scheduled and not cancelled
+   */
+  bool IsRunning (void) const;
+
+private:
+  /**
+   * \brief The event which calls the function
+   */
+  class Impl : public EventImpl
+  {
+  public:
+    /**
+     * \param [in] callback the function to call
+     */
+    Impl (const Callback<void> &callback);
+    /**
+     * \returns true while the function runs
+     */
+    bool IsNotifying (void) const;
+  private:
+    virtual void Notify (void);
+
+    Callback<void> m_callback; //!< the function to call
+    bool m_notifying;          //!< whether the function runs
+  };
+
+  /** Not copyable, the event refers to one timer. */
+  ReusableEvent (const ReusableEvent &);
+  /** Not copyable, the event refers to one timer. */
+  ReusableEvent & operator = (const ReusableEvent &);
+
+  Callback<void> m_callback;  //!< the function to call
+  Ptr<Impl> m_impl;           //!< the event scheduled last
+  EventId m_event;            //!< the id of the event scheduled last
+};
+
+} // namespace ns3
+
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3 {
+
+template <typename MEM_PTR, typename OBJ_PTR>
+void
+ReusableEvent::SetFunction (MEM_PTR memPtr, OBJ_PTR objPtr)
+{
+  m_callback = MakeCallback (memPtr, objPtr);
+  m_impl = 0;
+}
+
+} // namespace ns3
+
+#endif /* REUSABLE_EVENT_H */
@@ -0,0 +1,293 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "timing-wheel-scheduler.h"
+#include "event-impl.h"
+#include "uinteger.h"
+#include "assert.h"
+#include "fatal-error.h"
+#include "log.h"
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Implementation of ns3::TimingWheelScheduler class.
+ */
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TimingWheelScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED (TimingWheelScheduler);
+
+namespace {
+
+/** Order the events so that the next one is on top of the heaps. */
+struct Later
+{
+  bool operator () (const Scheduler::Event &a, const Scheduler::Event &b) const
+  {
+    return a.key > b.key;
+  }
+};
+
+} // unnamed namespace
+
+TypeId
+TimingWheelScheduler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TimingWheelScheduler")
+    .SetParent<Scheduler> ()
+    .SetGroupName ("Core")
+    .AddConstructor<TimingWheelScheduler> ()
+    .AddAttribute ("BucketWidth",
+                   "The time span of a bucket, rounded up to a power of two "
+                   "of the time resolution.",
+                   TimeValue (MicroSeconds (1)),
+                   MakeTimeAccessor (&TimingWheelScheduler::m_width),
+                   MakeTimeChecker (Time (0)))
+    .AddAttribute ("BucketCount",
+                   "The number of buckets of the wheel, rounded up to a "
+                   "power of two. Later events wait in a heap.",
+                   UintegerValue (4096),
+                   MakeUintegerAccessor (&TimingWheelScheduler::m_nBuckets),
+                   MakeUintegerChecker<uint32_t> (1, 1 << 24))
+  ;
+  return tid;
+}
+
+TimingWheelScheduler::TimingWheelScheduler ()
+  : m_nBuckets (0),
+    m_shift (0),
+    m_cursor (0),
+    m_inWheel (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+TimingWheelScheduler::~TimingWheelScheduler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TimingWheelScheduler::NotifyConstructionCompleted (void)
+{
+  NS_LOG_FUNCTION (this);
+  int64_t steps = m_width.GetTimeStep ();
+  m_shift = 0;
+  while (m_shift < 62 && (int64_t (1) << m_shift) < steps)
+    {
+      m_shift++;
+    }
+  // whole words of the bitmap
+  uint32_t nBuckets = 64;
+  while (nBuckets < m_nBuckets)
+    {
+      nBuckets <<= 1;
+    }
+  m_nBuckets = nBuckets;
+  m_wheel.resize (m_nBuckets);
+  m_nonEmpty.resize (m_nBuckets / 64, 0);
+  NS_LOG_LOGIC ("buckets=" << m_nBuckets << ", width=" << (int64_t (1) << m_shift));
+  Scheduler::NotifyConstructionCompleted ();
+}
+
+uint64_t
+TimingWheelScheduler::BucketOf (uint64_t ts) const
+{
+  return ts >> m_shift;
+}
+
+void
+TimingWheelScheduler::InsertCurrent (const Scheduler::Event &ev)
+{
+  m_current.push_back (ev);
+  std::push_heap (m_current.begin (), m_current.end (), Later ());
+}
+
+void
+TimingWheelScheduler::InsertWheel (uint64_t bucket, const Scheduler::Event &ev)
+{
+  uint32_t slot = bucket & (m_nBuckets - 1);
+  m_wheel[slot].push_back (ev);
+  m_nonEmpty[slot >> 6] |= uint64_t (1) << (slot & 63);
+  m_inWheel++;
+}
+
+void
+TimingWheelScheduler::Insert (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t bucket = BucketOf (ev.key.m_ts);
+  if (m_current.empty () && m_inWheel == 0 && m_overflow.empty ())
+    {
+      m_cursor = bucket;
+    }
+  if (bucket <= m_cursor)
+    {
+      InsertCurrent (ev);
+    }
+  else if (bucket - m_cursor < m_nBuckets)
+    {
+      InsertWheel (bucket, ev);
+    }
+  else
+    {
+      m_overflow.push_back (ev);
+      std::push_heap (m_overflow.begin (), m_overflow.end (), Later ());
+    }
+}
+
+bool
+TimingWheelScheduler::IsEmpty (void) const
+{
+  return m_current.empty ();
+}
+
+Scheduler::Event
+TimingWheelScheduler::PeekNext (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_current.empty ());
+  return m_current.front ();
+}
+
+Scheduler::Event
+TimingWheelScheduler::RemoveNext (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (!m_current.empty ());
+  Scheduler::Event ev = m_current.front ();
+  std::pop_heap (m_current.begin (), m_current.end (), Later ());
+  m_current.pop_back ();
+  if (m_current.empty ())
+    {
+      Advance ();
+    }
+  NS_LOG_DEBUG ("remove " << ev.key.m_ts << " " << ev.key.m_uid);
+  return ev;
+}
+
+void
+TimingWheelScheduler::Remove (const Scheduler::Event &ev)
+{
+  NS_LOG_FUNCTION (this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+  uint64_t bucket = BucketOf (ev.key.m_ts);
+  if (bucket <= m_cursor)
+    {
+      for (Bucket::iterator i = m_current.begin (); i != m_current.end (); ++i)
+        {
+          if (i->key.m_uid == ev.key.m_uid)
+            {
+              NS_ASSERT (ev.impl == i->impl);
+              *i = m_current.back ();
+              m_current.pop_back ();
+              if (m_current.empty ())
+                {
+                  Advance ();
+                }
+              else
+                {
+                  std::make_heap (m_current.begin (), m_current.end (), Later ());
+                }
+              return;
+            }
+        }
+    }
+  else if (bucket - m_cursor < m_nBuckets)
+    {
+      uint32_t slot = bucket & (m_nBuckets - 1);
+      Bucket &b = m_wheel[slot];
+      for (Bucket::iterator i = b.begin (); i != b.end (); ++i)
+        {
+          if (i->key.m_uid == ev.key.m_uid)
+            {
+              NS_ASSERT (ev.impl == i->impl);
+              *i = b.back ();
+              b.pop_back ();
+              if (b.empty ())
+                {
+                  m_nonEmpty[slot >> 6] &= ~(uint64_t (1) << (slot & 63));
+                }
+              m_inWheel--;
+              return;
+            }
+        }
+    }
+  else
+    {
+      for (Bucket::iterator i = m_overflow.begin (); i != m_overflow.end (); ++i)
+        {
+          if (i->key.m_uid == ev.key.m_uid)
+            {
+              NS_ASSERT (ev.impl == i->impl);
+              *i = m_overflow.back ();
+              m_overflow.pop_back ();
+              std::make_heap (m_overflow.begin (), m_overflow.end (), Later ());
+              return;
+            }
+        }
+    }
+  NS_ASSERT (false);
+}
+
+uint64_t
+TimingWheelScheduler::NextBucket (void) const
+{
+  uint32_t start = (m_cursor + 1) & (m_nBuckets - 1);
+  uint32_t nWords = m_nonEmpty.size ();
+  uint32_t word = start >> 6;
+  uint64_t bits = m_nonEmpty[word] & (~uint64_t (0) << (start & 63));
+  // one more word than the bitmap holds, for the buckets before start in
+  // the first word
+  for (uint32_t n = 0; n <= nWords; n++)
+    {
+      if (bits != 0)
+        {
+          uint32_t slot = (word << 6) + __builtin_ctzll (bits);
+          return m_cursor + 1 + ((slot - start) & (m_nBuckets - 1));
+        }
+      word = (word + 1) % nWords;
+      bits = m_nonEmpty[word];
+    }
+  NS_FATAL_ERROR ("No event in the wheel");
+  return 0;
+}
+
+void
+TimingWheelScheduler::Advance (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_current.empty ());
+  if (m_inWheel > 0)
+    {
+      m_cursor = NextBucket ();
+    }
+  else if (!m_overflow.empty ())
+    {
+      m_cursor = BucketOf (m_overflow.front ().key.m_ts);
+    }
+  else
+    {
+      return;
+    }
+  // the events of the heap which now fall in the wheel; they are all later
+  // than the events already in the wheel.
+  while (!m_overflow.empty ()
+         && BucketOf (m_overflow.front ().key.m_ts) - m_cursor < m_nBuckets)
+    {
+      Scheduler::Event ev = m_overflow.front ();
+      std::pop_heap (m_overflow.begin (), m_overflow.end (), Later ());
+      m_overflow.pop_back ();
+      InsertWheel (BucketOf (ev.key.m_ts), ev);
+    }
+  // swap, so that both keep their storage
+  uint32_t slot = m_cursor & (m_nBuckets - 1);
+  m_current.swap (m_wheel[slot]);
+  m_nonEmpty[slot >> 6] &= ~(uint64_t (1) << (slot & 63));
+  m_inWheel -= m_current.size ();
+  std::make_heap (m_current.begin (), m_current.end (), Later ());
+  NS_ASSERT (!m_current.empty ());
+}
+
+} // namespace ns3
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef TIMING_WHEEL_SCHEDULER_H
+#define TIMING_WHEEL_SCHEDULER_H
+
+#include "scheduler.h"
+#include "nstime.h"
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * Declaration of ns3::TimingWheelScheduler class.
+ */
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief a timing wheel event scheduler with an overflow heap
+ *
+ * The events of the next BucketCount buckets of BucketWidth each are kept
+ * unsorted in the bucket of their time, and the later ones in a binary
+ * heap. Only the bucket of the current time is ordered, as a heap too, when
+ * the scheduler reaches it; the next non empty bucket is found with a
+ * bitmap, and the events of the overflow heap move into the wheel as it
+ * turns. Inserting and removing the next event are thus O(1) amortized as
+ * long as the events are spread over the buckets and most of them are
+ * scheduled within the span of the wheel, which the defaults (4096 buckets
+ * of 1 us) size for packet level simulations of fast networks:
+ * transmissions, propagation delays, queue and transport timers. Events
+ * crowding a few buckets cost O(log n), as with the HeapScheduler.
+ *
+ * The buckets are vectors that keep their storage from one turn to the
+ * next, so the steady state inserts and removes allocate nothing.
+ * Removing an event which is not the next one searches its bucket, or the
+ * heap.
+ */
+class TimingWheelScheduler : public Scheduler
+{
+public:
+  /**
+   *  Register this type.
+   *  \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+
+  /** Constructor. */
+  TimingWheelScheduler ();
+  /** Destructor. */
+  virtual ~TimingWheelScheduler ();
+
+  // Inherited
+  virtual void Insert (const Scheduler::Event &ev);
+  virtual bool IsEmpty (void) const;
+  virtual Scheduler::Event PeekNext (void) const;
+  virtual Scheduler::Event RemoveNext (void);
+  virtual void Remove (const Scheduler::Event &ev);
+
+private:
+  /** Bucket of events. */
+  typedef std::vector<Scheduler::Event> Bucket;
+
+  virtual void NotifyConstructionCompleted (void);
+
+  /**
+   * \param [in] ts The event timestamp.
+   * \returns The absolute number of the bucket holding \p ts.
+   */
+  uint64_t BucketOf (uint64_t ts) const;
+  /**
+   * Insert an event in the current bucket.
+   * \param [in] ev The event to insert.
+   */
+  void InsertCurrent (const Scheduler::Event &ev);
+  /**
+   * Insert an event in a later bucket of the wheel.
+   * \param [in] bucket The absolute number of the bucket.
+   * \param [in] ev The event to insert.
+   */
+  void InsertWheel (uint64_t bucket, const Scheduler::Event &ev);
+  /** \returns The absolute number of the next non empty bucket of the wheel. */
+  uint64_t NextBucket (void) const;
+  /** Turn the wheel to the next non empty bucket, and make it the current one. */
+  void Advance (void);
+
+  /** Width of the buckets. */
+  Time m_width;
+  /** Number of buckets, rounded up to a power of two. */
+  uint32_t m_nBuckets;
+  /** Log2 of the bucket width in time steps. */
+  uint32_t m_shift;
+  /** The buckets of the wheel. */
+  std::vector<Bucket> m_wheel;
+  /** One bit per bucket of the wheel, set when it holds events. */
+  std::vector<uint64_t> m_nonEmpty;
+  /** The current bucket, a heap of the next events. */
+  Bucket m_current;
+  /** Absolute number of the current bucket. */
+  uint64_t m_cursor;
+  /** Number of events in the buckets of the wheel. */
+  uint32_t m_inWheel;
+  /** Heap of the events beyond the wheel. */
+  std::vector<Scheduler::Event> m_overflow;
+};
+
+} // namespace ns3
+
+#endif /* TIMING_WHEEL_SCHEDULER_H */
@@ -0,0 +1,73 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/reusable-event.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+class ReusableEventTestCase : public TestCase
+{
+public:
+  ReusableEventTestCase ();
+  virtual void DoRun (void);
+  void Expire (void);
+  void Reschedule (Time delay);
+  ReusableEvent m_event;
+  std::vector<Time> m_expired;
+};
+
+ReusableEventTestCase::ReusableEventTestCase ()
+  : TestCase ("Check that a reusable event can be rescheduled and cancelled")
+{
+}
+
+void
+ReusableEventTestCase::Expire (void)
+{
+  m_expired.push_back (Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ (m_event.IsRunning (), false, "The event is running while it expires");
+  if (m_expired.size () < 3)
+    {
+      m_event.Schedule (MicroSeconds (10));
+    }
+}
+
+void
+ReusableEventTestCase::Reschedule (Time delay)
+{
+  m_event.Cancel ();
+  m_event.Schedule (delay);
+}
+
+void
+ReusableEventTestCase::DoRun (void)
+{
+  m_event.SetFunction (&ReusableEventTestCase::Expire, this);
+  m_event.Schedule (MicroSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (m_event.IsRunning (), true, "The event is not running once scheduled");
+  // the event reschedules itself at 20 and 30 us, then is scheduled again
+  // at 100 us and moved from 150 to 120 us: the cancelled one must not run
+  Simulator::Schedule (MicroSeconds (100), &ReusableEventTestCase::Reschedule, this, MicroSeconds (50));
+  Simulator::Schedule (MicroSeconds (110), &ReusableEventTestCase::Reschedule, this, MicroSeconds (10));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (m_expired.size (), 4u, "The event did not expire the expected number of times");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[0], MicroSeconds (10), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[1], MicroSeconds (20), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[2], MicroSeconds (30), "Wrong expiration time");
+  NS_TEST_EXPECT_MSG_EQ (m_expired[3], MicroSeconds (120), "Wrong expiration time");
+}
+
+
+static class ReusableEventTestSuite : public TestSuite
+{
+public:
+  ReusableEventTestSuite ()
+    : TestSuite ("reusable-event", UNIT)
+  {
+    AddTestCase (new ReusableEventTestCase (), TestCase::QUICK);
+  }
+} g_reusableEventTestSuite;
@@ -35,6 +35,7 @@ Ipv4DrbRouting::Ipv4DrbRouting () :
     m_mode (PER_FLOW)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrbRouting::~Ipv4DrbRouting ()
@@ -116,6 +117,14 @@ Ipv4DrbRouting::AddWeightedPath (Ipv4Address destAddr, uint32_t weight, uint32_t
 /* Inherit From Ipv4RoutingProtocol */
 /* NOTE In DRB, the RouteOutput will not actually route the packets out but assign the path ID on it */
 /* DRB relies the list routing & static routing to do the real routing */
+int64_t
+Ipv4DrbRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
 Ptr<Ipv4Route>
 Ipv4DrbRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDevice> oif, Socket::SocketErrno &sockerr)
 {
@@ -161,12 +170,16 @@ Ipv4DrbRouting::RouteOutput (Ptr<Packet> p, const Ipv4Header &header, Ptr<NetDev
   }
   /* Breathe a fresh air to celebrate the end of ugly code */
 
-  uint32_t index = rand () % paths.size ();
+  uint32_t index;
   std::map<uint32_t, uint32_t>::iterator itr = m_indexMap.find (flowIndentify);
   if (itr != m_indexMap.end ())
   {
     index = itr->second;
   }
+  else
+  {
+    index = m_rand->GetInteger (0, paths.size () - 1);
+  }
 
   uint32_t path = paths[index];
   m_indexMap[flowIndentify] = (index + 1) % paths.size ();
@@ -38,6 +38,7 @@ Ipv4DrillRouting::Ipv4DrillRouting ()
     : m_d (2)
 {
   NS_LOG_FUNCTION (this);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4DrillRouting::~Ipv4DrillRouting ()
@@ -49,26 +50,21 @@ void
 Ipv4DrillRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
 {
   NS_LOG_LOGIC (this << " Add Drill routing entry: " << network << "/" << networkMask << " would go through port: " << port);
-  DrillRouteEntry drillRouteEntry;
-  drillRouteEntry.network = network;
-  drillRouteEntry.networkMask = networkMask;
-  drillRouteEntry.port = port;
-  m_routeEntryList.push_back (drillRouteEntry);
+  m_routeLookup.Insert (network, networkMask, port);
 }
 
-std::vector<DrillRouteEntry>
+int64_t
+Ipv4DrillRouting::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
+}
+
+Ipv4LpmSpan<uint32_t>
 Ipv4DrillRouting::LookupDrillRouteEntries (Ipv4Address dest)
 {
-  std::vector<DrillRouteEntry> drillRouteEntries;
-  std::vector<DrillRouteEntry>::iterator itr = m_routeEntryList.begin ();
-  for ( ; itr != m_routeEntryList.end (); ++itr)
-  {
-    if((*itr).networkMask.IsMatch(dest, (*itr).network))
-    {
-      drillRouteEntries.push_back (*itr);
-    }
-  }
-  return drillRouteEntries;
+  return m_routeLookup.Lookup (dest);
 }
 
 uint32_t
@@ -110,23 +106,6 @@ Ipv4DrillRouting::CalculateQueueLength (uint32_t interface)
   return totalLength;
 }
 
-Ptr<Ipv4Route>
-Ipv4DrillRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
-{
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress(nextIf,0).GetLocal();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (port));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
-  route->SetDestination (destAddress);
-  return route;
-}
-
 
 /* Inherit From Ipv4RoutingProtocol */
 Ptr<Ipv4Route>
@@ -164,9 +143,9 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     return false;
   }
 
-  std::vector<DrillRouteEntry> allPorts = Ipv4DrillRouting::LookupDrillRouteEntries (destAddress);
+  Ipv4LpmSpan<uint32_t> routeEntries = Ipv4DrillRouting::LookupDrillRouteEntries (destAddress);
 
-  if (allPorts.empty ())
+  if (routeEntries.empty ())
   {
     NS_LOG_ERROR (this << " Drill routing cannot find routing entry");
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
@@ -176,8 +155,6 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   uint32_t leastLoadInterface = 0;
   uint32_t leastLoad = std::numeric_limits<uint32_t>::max ();
 
-  std::random_shuffle (allPorts.begin (), allPorts.end ());
-
   std::map<Ipv4Address, uint32_t>::iterator itr = m_previousBestQueueMap.find (destAddress);
 
   if (itr != m_previousBestQueueMap.end ())
@@ -186,15 +163,35 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
     leastLoad = CalculateQueueLength (itr->second);
   }
 
-  uint32_t sampleNum = m_d < allPorts.size () ? m_d : allPorts.size ();
+  // Sample d distinct ports with Floyd's algorithm, in O(d^2) instead of
+  // shuffling all the ports
+  uint32_t nPorts = routeEntries.size ();
+  uint32_t sampleNum = m_d < nPorts ? m_d : nPorts;
+  m_sampledIndexes.clear ();
+  for (uint32_t j = nPorts - sampleNum; j < nPorts; j++)
+  {
+    uint32_t index = m_rand->GetInteger (0, j);
+    if (std::find (m_sampledIndexes.begin (), m_sampledIndexes.end (), index) != m_sampledIndexes.end ())
+    {
+      index = j;
+    }
+    m_sampledIndexes.push_back (index);
+  }
+
+  // Floyd's set is uniform but not its order, which would decide the ties
+  for (uint32_t j = sampleNum; j > 1; j--)
+  {
+    std::swap (m_sampledIndexes[j - 1], m_sampledIndexes[m_rand->GetInteger (0, j - 1)]);
+  }
 
-  for (uint32_t samplePort = 0; samplePort < sampleNum; samplePort ++)
+  for (uint32_t j = 0; j < sampleNum; j++)
   {
-    uint32_t sampleLoad = Ipv4DrillRouting::CalculateQueueLength (allPorts[samplePort].port);
+    uint32_t samplePort = routeEntries[m_sampledIndexes[j]];
+    uint32_t sampleLoad = Ipv4DrillRouting::CalculateQueueLength (samplePort);
     if (sampleLoad < leastLoad)
     {
       leastLoad = sampleLoad;
-      leastLoadInterface = allPorts[samplePort].port;
+      leastLoadInterface = samplePort;
     }
   }
 
@@ -202,30 +199,31 @@ Ipv4DrillRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
 
   m_previousBestQueueMap[destAddress] = leastLoadInterface;
 
-  Ptr<Ipv4Route> route = Ipv4DrillRouting::ConstructIpv4Route (leastLoadInterface, destAddress);
-  ucb (route, packet, header);
-
-  return true;
+  return m_nextHopTable.Forward (leastLoadInterface, packet, header, ucb, ecb);
 }
 
 void
 Ipv4DrillRouting::NotifyInterfaceUp (uint32_t interface)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4DrillRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4DrillRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4DrillRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
@@ -234,6 +232,7 @@ Ipv4DrillRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_nextHopTable.SetIpv4 (ipv4);
 }
 
 void
@@ -244,6 +243,8 @@ Ipv4DrillRouting::PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const
 void
 Ipv4DrillRouting::DoDispose (void)
 {
+  m_nextHopTable.Clear ();
+  m_routeLookup.Clear ();
 }
 }
 
@@ -4,23 +4,19 @@
 
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/ipv4-next-hop-table.h"
+#include "ns3/ipv4-lpm-trie.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-address.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
 #include <map>
 
 namespace ns3 {
 
-struct DrillRouteEntry {
-  Ipv4Address network;
-  Ipv4Mask networkMask;
-  uint32_t port;
-};
-
-
 class Ipv4DrillRouting : public Ipv4RoutingProtocol {
 
 public:
@@ -30,10 +26,19 @@ public:
   static TypeId GetTypeId (void);
 
   void AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port);
-  std::vector<DrillRouteEntry> LookupDrillRouteEntries (Ipv4Address dest);
+  Ipv4LpmSpan<uint32_t> LookupDrillRouteEntries (Ipv4Address dest);
 
   uint32_t CalculateQueueLength (uint32_t interface);
-  Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
 
 
   /* Inherit From Ipv4RoutingProtocol */
@@ -55,7 +60,17 @@ private:
   std::map<Ipv4Address, uint32_t> m_previousBestQueueMap;
 
   Ptr<Ipv4> m_ipv4;
-  std::vector<DrillRouteEntry> m_routeEntryList;
+
+  // Shared next hop route of each output port
+  Ipv4NextHopTable m_nextHopTable;
+
+  // Route table, longest prefix -> equal-cost output ports
+  Ipv4LpmTrie<uint32_t> m_routeLookup;
+
+  // Scratch buffer of the indexes of the sampled ports
+  std::vector<uint32_t> m_sampledIndexes;
+
+  Ptr<UniformRandomVariable> m_rand;
 };
 
 }
@@ -19,17 +19,29 @@
 //
 
 #include "flow-classifier.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
 
 namespace ns3 {
 
 FlowClassifier::FlowClassifier ()
   :
-    m_lastNewFlowId (0)
+    m_lastNewFlowId (0),
+    m_mutex (0)
 {
+#ifdef HAVE_PTHREAD_H
+  m_mutex = new SystemMutex ();
+#endif
 }
 
 FlowClassifier::~FlowClassifier ()
 {
+#ifdef HAVE_PTHREAD_H
+  delete m_mutex;
+#endif
 }
 
 FlowId
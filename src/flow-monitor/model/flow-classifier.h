@@ -26,6 +26,8 @@
 
 namespace ns3 {
 
+class SystemMutex;
+
 /**
  * \ingroup flow-monitor
  * \brief Abstract identifier of a packet flow
@@ -76,6 +78,10 @@ protected:
   /// \returns a new FlowId
   FlowId GetNewFlowId ();
 
+  /// Serializes the classifications of the probes, which may run on
+  /// several simulation threads. Null without threading support.
+  SystemMutex *m_mutex;
+
 };
 
 
@@ -22,6 +22,12 @@
 #include "ns3/simulator.h"
 #include "ns3/log.h"
 #include "ns3/double.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
+
 #include <fstream>
 #include <sstream>
 
@@ -83,9 +89,20 @@ FlowMonitor::GetInstanceTypeId (void) const
 }
 
 FlowMonitor::FlowMonitor ()
-  : m_enabled (false)
+  : m_enabled (false),
+    m_mutex (0)
 {
   // m_histogramBinWidth=DEFAULT_BIN_WIDTH;
+#ifdef HAVE_PTHREAD_H
+  m_mutex = new SystemMutex ();
+#endif
+}
+
+FlowMonitor::~FlowMonitor ()
+{
+#ifdef HAVE_PTHREAD_H
+  delete m_mutex;
+#endif
 }
 
 void
@@ -142,6 +159,9 @@ FlowMonitor::ReportFirstTx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t pack
     {
       return;
     }
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (*m_mutex);
+#endif
   Time now = Simulator::Now ();
   TrackedPacket &tracked = m_trackedPackets[std::make_pair (flowId, packetId)];
   tracked.firstSeenTime = now;
@@ -172,6 +192,9 @@ FlowMonitor::ReportForwarding (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t p
     {
       return;
     }
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (*m_mutex);
+#endif
   std::pair<FlowId, FlowPacketId> key (flowId, packetId);
   TrackedPacketMap::iterator tracked = m_trackedPackets.find (key);
   if (tracked == m_trackedPackets.end ())
@@ -202,6 +225,9 @@ FlowMonitor::ReportLastRx (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packe
     {
       return;
     }
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (*m_mutex);
+#endif
   TrackedPacketMap::iterator tracked = m_trackedPackets.find (std::make_pair (flowId, packetId));
   if (tracked == m_trackedPackets.end ())
     {
@@ -266,6 +292,9 @@ FlowMonitor::ReportDrop (Ptr<FlowProbe> probe, uint32_t flowId, uint32_t packetI
     {
       return;
     }
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (*m_mutex);
+#endif
 
   probe->AddPacketDropStats (flowId, packetSize, reasonCode);
 
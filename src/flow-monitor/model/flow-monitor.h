@@ -34,6 +34,8 @@
 
 namespace ns3 {
 
+class SystemMutex;
+
 /**
  * \defgroup flow-monitor Flow Monitor
  * \brief  Collect and store performance data from a simulation
@@ -149,6 +151,7 @@ public:
   static TypeId GetTypeId ();
   TypeId GetInstanceTypeId () const;
   FlowMonitor ();
+  virtual ~FlowMonitor ();
 
   /// Add a FlowClassifier to be used by the flow monitor.
   /// \param classifier the FlowClassifier
@@ -297,6 +300,10 @@ private:
   double m_flowInterruptionsBinWidth; //!< Flow interruptions bin width (for histograms)
   Time m_flowInterruptionsMinTime; //!< Flow interruptions minimum time
 
+  /// Serializes the reports of the probes, which may run on several
+  /// simulation threads. Null without threading support.
+  SystemMutex *m_mutex;
+
   /// Get the stats for a given flow
   /// \param flowId the Flow identification
   /// \returns the stats of the flow
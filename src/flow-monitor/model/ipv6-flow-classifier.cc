@@ -24,6 +24,11 @@
 #include "ipv6-flow-classifier.h"
 #include "ns3/udp-header.h"
 #include "ns3/tcp-header.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
 
 namespace ns3 {
 
@@ -147,6 +152,9 @@ Ipv6FlowClassifier::Classify (const Ipv6Header &ipHeader, Ptr<const Packet> ipPa
   tuple.sourcePort = srcPort;
   tuple.destinationPort = dstPort;
 
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (*m_mutex);
+#endif
   // try to insert the tuple, but check if it already exists
   std::pair<std::map<FiveTuple, FlowId>::iterator, bool> insert
     = m_flowMap.insert (std::pair<FiveTuple, FlowId> (tuple, 0));
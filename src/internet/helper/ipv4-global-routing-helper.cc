@@ -64,6 +64,12 @@ Ipv4GlobalRoutingHelper::PopulateRoutingTables (void)
   GlobalRouteManager::InitializeRoutes ();
 }
 void 
+Ipv4GlobalRoutingHelper::PopulateRoutingTables (uint32_t nThreads)
+{
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes (nThreads);
+}
+void 
 Ipv4GlobalRoutingHelper::RecomputeRoutingTables (void)
 {
   GlobalRouteManager::DeleteGlobalRoutes ();
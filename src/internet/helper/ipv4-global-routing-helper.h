@@ -69,6 +69,16 @@ public:
    *
    */
   static void PopulateRoutingTables (void);
+  /**
+   * \brief Same as PopulateRoutingTables (), with the SPF computations of
+   * the routers spread over several threads.
+   *
+   * The routes are the same as with a single thread.  Use this for large
+   * topologies, the computation is one SPF per router.
+   *
+   * \param nThreads the number of threads
+   */
+  static void PopulateRoutingTables (uint32_t nThreads);
   /**
    * \brief Remove all routes that were previously installed in a prior call
    * to either PopulateRoutingTables() or RecomputeRoutingTables(), and 
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "clove-path-selector.h"
+#include "ipv4-xpath-tag.h"
+#include "ns3/ipv4-clove.h"
+#include "ns3/tcp-clove-tag.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("ClovePathSelector");
+
+NS_OBJECT_ENSURE_REGISTERED (ClovePathSelector);
+
+TypeId
+ClovePathSelector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::ClovePathSelector")
+    .SetParent<HostPathSelector> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<ClovePathSelector> ()
+  ;
+  return tid;
+}
+
+ClovePathSelector::ClovePathSelector ()
+  : HostPathSelector (),
+    m_piggyback (false),
+    m_path (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ClovePathSelector::ClovePathSelector (const ClovePathSelector &other)
+  : HostPathSelector (other),
+    m_piggyback (false),
+    m_path (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+ClovePathSelector::~ClovePathSelector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+ClovePathSelector::DoDispose (void)
+{
+  m_clove = 0;
+  HostPathSelector::DoDispose ();
+}
+
+Ptr<HostPathSelector>
+ClovePathSelector::Fork (void)
+{
+  return CopyObject<ClovePathSelector> (this);
+}
+
+void
+ClovePathSelector::Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender)
+{
+  HostPathSelector::Setup (node, flowId, saddr, daddr, isSender);
+  m_clove = node->GetObject<Ipv4Clove> ();
+  NS_ASSERT_MSG (m_clove != 0, "Clove is enabled on a node without Ipv4Clove");
+}
+
+void
+ClovePathSelector::SendOnPath (Ptr<Packet> p)
+{
+  uint32_t path = m_clove->GetPath (m_flowId, m_saddr, m_daddr);
+  NS_LOG_LOGIC (this << " path " << path);
+
+  Ipv4XPathTag ipv4XPathTag;
+  ipv4XPathTag.SetPathId (path);
+  p->AddPacketTag (ipv4XPathTag);
+
+  TcpCloveTag tcpCloveTag;
+  tcpCloveTag.SetPath (path);
+  p->AddPacketTag (tcpCloveTag);
+}
+
+uint32_t
+ClovePathSelector::SendData (Ptr<Packet> p, bool isRetransmission)
+{
+  if (m_isSender)
+    {
+      SendOnPath (p);
+    }
+  // Clove does not pause the connection
+  return 0;
+}
+
+uint32_t
+ClovePathSelector::SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission)
+{
+  if (m_isSender)
+    {
+      SendOnPath (p);
+    }
+  if (m_piggyback)
+    {
+      TcpCloveTag tcpCloveTag;
+      tcpCloveTag.SetPath (m_path);
+      p->AddPacketTag (tcpCloveTag);
+    }
+  return 0;
+}
+
+void
+ClovePathSelector::ReceivedData (Ptr<Packet> p)
+{
+  if (m_isSender)
+    {
+      return;
+    }
+  TcpCloveTag tcpCloveTag;
+  if (p->RemovePacketTag (tcpCloveTag))
+    {
+      m_piggyback = true;
+      m_path = tcpCloveTag.GetPath ();
+    }
+}
+
+void
+ClovePathSelector::ReceivedAck (Ptr<Packet> p, uint32_t bytesAcked, bool withECE)
+{
+  if (!m_isSender)
+    {
+      return;
+    }
+  TcpCloveTag tcpCloveTag;
+  if (p->RemovePacketTag (tcpCloveTag))
+    {
+      m_clove->FlowRecv (tcpCloveTag.GetPath (), m_daddr, withECE);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef CLOVE_PATH_SELECTOR_H
+#define CLOVE_PATH_SELECTOR_H
+
+#include "host-path-selector.h"
+
+namespace ns3 {
+
+class Ipv4Clove;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The Clove scheme on a TCP connection, driving the Ipv4Clove of
+ * the node
+ *
+ * The sender asks Ipv4Clove for the path of every segment and carries it
+ * in a TcpCloveTag. The receiver echoes the path of the last data segment
+ * on its ACKs, and the sender reports it to Ipv4Clove with the ECN echo of
+ * the ACK.
+ */
+class ClovePathSelector : public HostPathSelector
+{
+public:
+  static TypeId GetTypeId (void);
+
+  ClovePathSelector ();
+  ClovePathSelector (const ClovePathSelector &other);
+  virtual ~ClovePathSelector ();
+
+  virtual Ptr<HostPathSelector> Fork (void);
+  virtual void Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender);
+
+  virtual uint32_t SendData (Ptr<Packet> p, bool isRetransmission);
+  virtual uint32_t SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission);
+  virtual void ReceivedData (Ptr<Packet> p);
+  virtual void ReceivedAck (Ptr<Packet> p, uint32_t bytesAcked, bool withECE);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Tag a segment of the sender with a path chosen by Ipv4Clove
+   */
+  void SendOnPath (Ptr<Packet> p);
+
+  Ptr<Ipv4Clove> m_clove;     //!< the Clove of the node
+
+  // Receiver
+  bool m_piggyback;           //!< whether a Clove tag was received
+  uint32_t m_path;            //!< path of the last data segment
+};
+
+} // namespace ns3
+
+#endif /* CLOVE_PATH_SELECTOR_H */
@@ -38,6 +38,7 @@ const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
 class Ipv4GlobalRouting;
+class Node;
 
 /**
  * @brief Vertex used in shortest path first (SPF) computations. See \RFC{2328},
@@ -672,6 +673,13 @@ public:
    */
   uint32_t GetNumExtLSAs () const;
 
+/**
+ * @brief Make a deep copy of the database, so that SPF computations can
+ * run on several copies at the same time.
+ *
+ * @returns the copy, owned by the caller
+ */
+  GlobalRouteManagerLSDB* Copy () const;
 
 private:
   typedef std::map<Ipv4Address, GlobalRoutingLSA*> LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -733,6 +741,19 @@ public:
  */
   virtual void InitializeRoutes ();
 
+/**
+ * @brief Compute routes using Dijkstra SPF computations running on several
+ * threads and populate per-node forwarding tables
+ *
+ * Every thread works on its own copy of the LSDB and computes the routes of
+ * a share of the roots; the routes are the same as those of
+ * InitializeRoutes ().  Without threading support, or with a single thread,
+ * this is InitializeRoutes ().
+ *
+ * @param nThreads the number of threads
+ */
+  virtual void InitializeRoutes (uint32_t nThreads);
+
 /**
  * @brief Debugging routine; allow client code to supply a pre-built LSDB
  */
@@ -764,8 +785,36 @@ private:
  */
   GlobalRouteManagerImpl& operator= (GlobalRouteManagerImpl& srmi);
 
+  /**
+   * @brief The node at the root of an SPF computation, looked up before the
+   * computation so that the computation does not walk the node list.
+   */
+  struct SPFRoot
+  {
+    Ipv4Address routerId; //!< the router ID of the root
+    uint32_t nodeId; //!< the node of the root
+    Ipv4GlobalRouting* routing; //!< the routing table to fill, 0 if no node has this router ID
+    std::vector<std::pair<Ipv4Address, int32_t> > addresses; //!< local addresses and their interface
+  };
+
   SPFVertex* m_spfroot; //!< the root node
   GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+  const SPFRoot* m_root; //!< the node at the root of the current SPF computation
+  std::vector<const SPFRoot*> m_workerRoots; //!< the roots computed by this worker thread
+
+  /**
+   * \brief Look up the node of a router and its interfaces
+   *
+   * \param node the node, the node list is searched for the router ID if 0
+   * \param routerId the router ID
+   * \param root the root to fill
+   */
+  static void LoadRoot (Ptr<Node> node, Ipv4Address routerId, SPFRoot &root);
+
+  /**
+   * \brief Compute the routes of the roots assigned to this worker
+   */
+  void RunWorker (void);
 
   /**
    * \brief Test if a node is a stub, from an OSPF sense.
@@ -787,6 +836,13 @@ private:
    */
   void SPFCalculate (Ipv4Address root);
 
+  /**
+   * \brief Calculate the SPF tree of a root and add its routes
+   *
+   * \param root the root, looked up beforehand
+   */
+  void SPFCalculate (const SPFRoot &root);
+
   /**
    * \brief Process Stub nodes
    *
@@ -58,6 +58,14 @@ GlobalRouteManager::InitializeRoutes (void)
   InitializeRoutes ();
 }
 
+void
+GlobalRouteManager::InitializeRoutes (uint32_t nThreads)
+{
+  NS_LOG_FUNCTION (nThreads);
+  SimulationSingleton<GlobalRouteManagerImpl>::Get ()->
+  InitializeRoutes (nThreads);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId (void)
 {
@@ -62,6 +62,14 @@ public:
  */
   static void InitializeRoutes ();
 
+/**
+ * @brief Compute routes using Dijkstra SPF computations spread over several
+ * threads and populate per-node forwarding tables
+ *
+ * @param nThreads the number of threads
+ */
+  static void InitializeRoutes (uint32_t nThreads);
+
 private:
 /**
  * @brief Global Route Manager copy construction is disallowed.  There's no 
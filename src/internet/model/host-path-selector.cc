@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "host-path-selector.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("HostPathSelector");
+
+NS_OBJECT_ENSURE_REGISTERED (HostPathSelector);
+
+TypeId
+HostPathSelector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::HostPathSelector")
+    .SetParent<Object> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+HostPathSelector::HostPathSelector ()
+  : Object (),
+    m_flowId (0),
+    m_isSender (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HostPathSelector::HostPathSelector (const HostPathSelector &other)
+  : Object (other),
+    m_flowId (0),
+    m_isSender (false)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+HostPathSelector::~HostPathSelector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+HostPathSelector::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_node = 0;
+  Object::DoDispose ();
+}
+
+void
+HostPathSelector::Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender)
+{
+  NS_LOG_FUNCTION (this << node << flowId << saddr << daddr << isSender);
+  m_node = node;
+  m_flowId = flowId;
+  m_saddr = saddr;
+  m_daddr = daddr;
+  m_isSender = isSender;
+}
+
+uint32_t
+HostPathSelector::GetFlowId (void) const
+{
+  return m_flowId;
+}
+
+uint32_t
+HostPathSelector::SendData (Ptr<Packet> p, bool isRetransmission)
+{
+  return 0;
+}
+
+uint32_t
+HostPathSelector::SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission)
+{
+  return 0;
+}
+
+void
+HostPathSelector::ReceivedData (Ptr<Packet> p)
+{
+}
+
+void
+HostPathSelector::ReceivedAck (Ptr<Packet> p, uint32_t bytesAcked, bool withECE)
+{
+}
+
+void
+HostPathSelector::PktsAcked (SequenceNumber32 highTxMark, SequenceNumber32 ackNumber,
+                             uint32_t bytesAcked, bool withECE)
+{
+}
+
+void
+HostPathSelector::Timeout (void)
+{
+}
+
+Time
+HostPathSelector::GetPauseTime (void)
+{
+  return Time (0);
+}
+
+} // namespace ns3
@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef HOST_PATH_SELECTOR_H
+#define HOST_PATH_SELECTOR_H
+
+#include "ns3/object.h"
+#include "ns3/ptr.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/sequence-number.h"
+
+namespace ns3 {
+
+class Node;
+class Packet;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The host side of a load balancing scheme, plugged into a TCP
+ * connection
+ *
+ * The edge-based schemes (TLB, Clove, FlowBender) choose the path of the
+ * segments at the sender and learn about the paths from the ACKs. A
+ * HostPathSelector holds the state of one connection: the socket forks
+ * its selector and binds it with Setup once the IPv4 endpoint of the
+ * connection is known, before the SYN of the end opening the connection
+ * and before the SYN-ACK of the end accepting it. The flow id, the
+ * addresses and the load balancer of the node are resolved once there,
+ * not for every segment.
+ *
+ * The socket calls the hooks below on the send, receive and timeout
+ * paths. The default hooks do nothing, so a scheme only overrides what
+ * it uses.
+ *
+ * \see TcpSocketBase::SetPathSelector
+ */
+class HostPathSelector : public Object
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return the object TypeId
+   */
+  static TypeId GetTypeId (void);
+
+  HostPathSelector ();
+  HostPathSelector (const HostPathSelector &other);
+  virtual ~HostPathSelector ();
+
+  /**
+   * \brief Copy the configuration of the selector for a new connection,
+   * without its per-connection state
+   */
+  virtual Ptr<HostPathSelector> Fork (void) = 0;
+
+  /**
+   * \brief Bind the selector to its connection
+   * \param node the node of the socket
+   * \param flowId the hash of the 5-tuple of the connection
+   * \param saddr the local address
+   * \param daddr the peer address
+   * \param isSender true on the end opening the connection
+   */
+  virtual void Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender);
+
+  /**
+   * \returns the flow id put in the FlowIdTag of the segments, hashed by
+   * the ECMP switches
+   */
+  virtual uint32_t GetFlowId (void) const;
+
+  /**
+   * \brief Choose the path of a data segment and tag the segment
+   * \param p the segment, without its TCP header
+   * \param isRetransmission whether the data were sent before
+   * \returns the path for the pause support, 0 not to pause on a path change
+   */
+  virtual uint32_t SendData (Ptr<Packet> p, bool isRetransmission);
+
+  /**
+   * \brief Choose the path of a segment without data and tag the segment
+   * \param p the segment, without its TCP header
+   * \param flags the TCP flags of the segment
+   * \param isRetransmission whether this is a SYN sent again
+   * \returns the path for the pause support, 0 not to pause on a path change
+   */
+  virtual uint32_t SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission);
+
+  /**
+   * \brief Read the tags of a data segment received
+   */
+  virtual void ReceivedData (Ptr<Packet> p);
+
+  /**
+   * \brief Read the tags of an ACK received
+   * \param p the ACK, without its TCP header
+   * \param bytesAcked the bytes newly acknowledged
+   * \param withECE whether the ACK echoes a congestion mark
+   */
+  virtual void ReceivedAck (Ptr<Packet> p, uint32_t bytesAcked, bool withECE);
+
+  /**
+   * \brief Account the segments acknowledged, next to the PktsAcked of the
+   * congestion control
+   */
+  virtual void PktsAcked (SequenceNumber32 highTxMark, SequenceNumber32 ackNumber,
+                          uint32_t bytesAcked, bool withECE);
+
+  /**
+   * \brief The retransmission timer of the connection expired
+   */
+  virtual void Timeout (void);
+
+  /**
+   * \returns how long the socket holds its segments after a path change,
+   * when its Pause attribute is set
+   */
+  virtual Time GetPauseTime (void);
+
+protected:
+  virtual void DoDispose (void);
+
+  Ptr<Node> m_node;           //!< node of the socket
+  uint32_t m_flowId;          //!< hash of the 5-tuple
+  Ipv4Address m_saddr;        //!< local address
+  Ipv4Address m_daddr;        //!< peer address
+  bool m_isSender;            //!< whether this end opened the connection
+};
+
+} // namespace ns3
+
+#endif /* HOST_PATH_SELECTOR_H */
@@ -1,8 +1,11 @@
 #include "ipv4-ecn-tag.h"
+#include "ns3/packet-tag-slots.h"
 
 namespace ns3
 {
 
+NS_PACKET_TAG_SLOT (Ipv4EcnTag);
+
 Ipv4EcnTag::Ipv4EcnTag () {}
 
 void
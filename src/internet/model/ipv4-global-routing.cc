@@ -31,7 +31,8 @@
 #include "ipv4-global-routing.h"
 #include "global-route-manager.h"
 #include "ns3/flow-id-tag.h"
-#include "ns3/hash.h"
+#include "ns3/enum.h"
+#include "ns3/uinteger.h"
 
 namespace ns3 {
 
@@ -55,6 +56,19 @@ Ipv4GlobalRouting::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&Ipv4GlobalRouting::m_perFlowEcmpRouting),
                    MakeBooleanChecker ())
+    .AddAttribute ("PerflowEcmpHashKernel",
+                   "Hash kernel used to map a flow id onto one of the ECMP routes",
+                   EnumValue (FlowHasher::CRC32C),
+                   MakeEnumAccessor (&Ipv4GlobalRouting::SetPerflowEcmpHashKernel,
+                                     &Ipv4GlobalRouting::GetPerflowEcmpHashKernel),
+                   MakeEnumChecker (FlowHasher::CRC32C, "Crc32c",
+                                    FlowHasher::MURMUR3, "Murmur3",
+                                    FlowHasher::TOEPLITZ, "Toeplitz"))
+    .AddAttribute ("PerflowEcmpHashSeed",
+                   "Router specific seed of the per-flow ECMP hash, the TTL being mixed in at every hop",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&Ipv4GlobalRouting::m_perFlowEcmpSeed),
+                   MakeUintegerChecker<uint32_t> ())
     .AddAttribute ("RespondToInterfaceEvents",
                    "Set to true if you want to dynamically recompute the global routes upon Interface notification events (up/down, or add/remove address)",
                    BooleanValue (false),
@@ -67,7 +81,9 @@ Ipv4GlobalRouting::GetTypeId (void)
 Ipv4GlobalRouting::Ipv4GlobalRouting ()
   : m_randomEcmpRouting (false),
     m_perFlowEcmpRouting (false),
-    m_respondToInterfaceEvents (false)
+    m_perFlowEcmpSeed (0),
+    m_respondToInterfaceEvents (false),
+    m_lookupTablesDirty (false)
 {
   NS_LOG_FUNCTION (this);
 
@@ -79,6 +95,18 @@ Ipv4GlobalRouting::~Ipv4GlobalRouting ()
   NS_LOG_FUNCTION (this);
 }
 
+void
+Ipv4GlobalRouting::SetPerflowEcmpHashKernel (FlowHasher::HashKernel kernel)
+{
+  m_flowHasher.SetKernel (kernel);
+}
+
+FlowHasher::HashKernel
+Ipv4GlobalRouting::GetPerflowEcmpHashKernel (void) const
+{
+  return m_flowHasher.GetKernel ();
+}
+
 void
 Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
                                    Ipv4Address nextHop,
@@ -88,6 +116,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, nextHop, interface);
   m_hostRoutes.push_back (route);
+  m_lookupTablesDirty = true;
 }
 
 void
@@ -98,6 +127,7 @@ Ipv4GlobalRouting::AddHostRouteTo (Ipv4Address dest,
   Ipv4RoutingTableEntry *route = new Ipv4RoutingTableEntry ();
   *route = Ipv4RoutingTableEntry::CreateHostRouteTo (dest, interface);
   m_hostRoutes.push_back (route);
+  m_lookupTablesDirty = true;
 }
 
 void
@@ -113,6 +143,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_lookupTablesDirty = true;
 }
 
 void
@@ -126,6 +157,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo (Ipv4Address network,
                                                         networkMask,
                                                         interface);
   m_networkRoutes.push_back (route);
+  m_lookupTablesDirty = true;
 }
 
 void
@@ -141,6 +173,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo (Ipv4Address network,
                                                         nextHop,
                                                         interface);
   m_ASexternalRoutes.push_back (route);
+  m_lookupTablesDirty = true;
 }
 
 
@@ -150,79 +183,45 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
   NS_LOG_FUNCTION (this << dest << oif);
   NS_LOG_LOGIC ("Looking for route for destination " << dest);
   Ptr<Ipv4Route> rtentry = 0;
-  // store all available routes that bring packets to their destination
-  typedef std::vector<Ipv4RoutingTableEntry*> RouteVec_t;
-  RouteVec_t allRoutes;
 
-  NS_LOG_LOGIC ("Number of m_hostRoutes = " << m_hostRoutes.size ());
-  for (HostRoutesCI i = m_hostRoutes.begin ();
-       i != m_hostRoutes.end ();
-       i++)
+  if (m_lookupTablesDirty)
     {
-      NS_ASSERT ((*i)->IsHost ());
-      if ((*i)->GetDest ().IsEqual (dest))
-        {
-          if (oif != 0)
-            {
-              if (oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
-                {
-                  NS_LOG_LOGIC ("Not on requested interface, skipping");
-                  continue;
-                }
-            }
-          allRoutes.push_back (*i);
-          NS_LOG_LOGIC (allRoutes.size () << "Found global host route" << *i);
-        }
+      BuildLookupTables ();
     }
-  if (allRoutes.size () == 0) // if no host route is found
+
+  // Network routes are only considered if no host route is found, and
+  // external routes if no host/network route is found. The network and
+  // external tables return the routes of the longest matching prefix, in
+  // the order of the route lists; with a requested output device, the
+  // longest prefix among the routes on this device
+  RouteSpan allRoutes = m_hostLookup.Lookup (dest);
+  uint32_t nRoutes = CountRoutesOnDevice (allRoutes, oif);
+  NS_LOG_LOGIC ("Found " << nRoutes << " global host routes");
+  if (nRoutes == 0)
     {
-      NS_LOG_LOGIC ("Number of m_networkRoutes" << m_networkRoutes.size ());
-      for (NetworkRoutesI j = m_networkRoutes.begin ();
-           j != m_networkRoutes.end ();
-           j++)
+      allRoutes = m_networkLookup.Lookup (dest);
+      nRoutes = CountRoutesOnDevice (allRoutes, oif);
+      if (nRoutes == 0 && oif != 0)
         {
-          Ipv4Mask mask = (*j)->GetDestNetworkMask ();
-          Ipv4Address entry = (*j)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
-            {
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*j)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*j);
-              NS_LOG_LOGIC (allRoutes.size () << "Found global network route" << *j);
-            }
+          allRoutes = LookupOnDevice (m_networkRoutes, dest, oif);
+          nRoutes = allRoutes.size ();
         }
+      NS_LOG_LOGIC ("Found " << nRoutes << " global network routes");
     }
-  if (allRoutes.size () == 0)  // consider external if no host/network found
+  if (nRoutes == 0)
     {
-      for (ASExternalRoutesI k = m_ASexternalRoutes.begin ();
-           k != m_ASexternalRoutes.end ();
-           k++)
+      allRoutes = m_externalLookup.Lookup (dest);
+      nRoutes = CountRoutesOnDevice (allRoutes, oif);
+      if (nRoutes == 0 && oif != 0)
         {
-          Ipv4Mask mask = (*k)->GetDestNetworkMask ();
-          Ipv4Address entry = (*k)->GetDestNetwork ();
-          if (mask.IsMatch (dest, entry))
-            {
-              NS_LOG_LOGIC ("Found external route" << *k);
-              if (oif != 0)
-                {
-                  if (oif != m_ipv4->GetNetDevice ((*k)->GetInterface ()))
-                    {
-                      NS_LOG_LOGIC ("Not on requested interface, skipping");
-                      continue;
-                    }
-                }
-              allRoutes.push_back (*k);
-              break;
-            }
+          allRoutes = LookupOnDevice (m_ASexternalRoutes, dest, oif);
+          nRoutes = allRoutes.size ();
         }
+      // Only the first external route is used
+      nRoutes = nRoutes > 0 ? 1 : 0;
+      NS_LOG_LOGIC ("Found " << nRoutes << " external routes");
     }
-  if (allRoutes.size () > 0 ) // if route(s) is found
+  if (nRoutes > 0) // if route(s) is found
     {
       // pick up one of the routes uniformly at random if random
       // ECMP routing is enabled, or always select the first route
@@ -230,22 +229,21 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
       uint32_t selectIndex;
       if (m_randomEcmpRouting)
         {
-          selectIndex = m_rand->GetInteger (0, allRoutes.size ()-1);
+          selectIndex = m_rand->GetInteger (0, nRoutes - 1);
         }
       else if (m_perFlowEcmpRouting && flowId != 0) // If the flow id is 0, it may be the socket setup endpoint request, we simply return the first
         {                                           // available route to indicate the address is not local
-          std::stringstream hash_string;
-          hash_string << flowId;
-          hash_string << header.GetTtl ();
-          uint32_t hashPerturbe = Hash32 (hash_string.str ()); // Hash Perturbe
-          selectIndex = hashPerturbe % allRoutes.size();
+          // The TTL is mixed in nonlinearly so that the successive hops pick
+          // their routes independently, the kernels being linear in the seed
+          uint32_t hashPerturbe = m_flowHasher.GetHopHash (flowId, m_perFlowEcmpSeed, header.GetTtl ()); // Hash Perturbe
+          selectIndex = hashPerturbe % nRoutes;
           NS_LOG_LOGIC ("Per flow ECMP is enabled, select index: " << selectIndex << " for flow: " << flowId);
         }
       else
         {
           selectIndex = 0;
         }
-      Ipv4RoutingTableEntry* route = allRoutes.at (selectIndex);
+      Ipv4RoutingTableEntry* route = GetRouteOnDevice (allRoutes, oif, selectIndex);
       // create a Ipv4Route object from the selected routing table entry
       rtentry = Create<Ipv4Route> ();
       rtentry->SetDestination (route->GetDest ());
@@ -262,6 +260,99 @@ Ipv4GlobalRouting::LookupGlobal (Ipv4Address dest, Ptr<Packet> packet, const Ipv
     }
 }
 
+void
+Ipv4GlobalRouting::BuildLookupTables (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_hostLookup.Clear ();
+  m_networkLookup.Clear ();
+  m_externalLookup.Clear ();
+  for (HostRoutesCI i = m_hostRoutes.begin (); i != m_hostRoutes.end (); i++)
+    {
+      NS_ASSERT ((*i)->IsHost ());
+      m_hostLookup.Insert ((*i)->GetDest (), Ipv4Mask::GetOnes (), *i);
+    }
+  for (NetworkRoutesCI i = m_networkRoutes.begin (); i != m_networkRoutes.end (); i++)
+    {
+      m_networkLookup.Insert ((*i)->GetDestNetwork (), (*i)->GetDestNetworkMask (), *i);
+    }
+  for (ASExternalRoutesCI i = m_ASexternalRoutes.begin (); i != m_ASexternalRoutes.end (); i++)
+    {
+      m_externalLookup.Insert ((*i)->GetDestNetwork (), (*i)->GetDestNetworkMask (), *i);
+    }
+  m_lookupTablesDirty = false;
+}
+
+Ipv4GlobalRouting::RouteSpan
+Ipv4GlobalRouting::LookupOnDevice (const NetworkRoutes &routes, Ipv4Address dest, Ptr<NetDevice> oif)
+{
+  NS_LOG_FUNCTION (this << dest << oif);
+  // Only used when a socket bound to a device sends to a prefix reached
+  // through another device, so a scan of the route list is enough
+  m_routesOnDevice.clear ();
+  uint16_t longest = 0;
+  for (NetworkRoutesCI i = routes.begin (); i != routes.end (); i++)
+    {
+      Ipv4Mask mask = (*i)->GetDestNetworkMask ();
+      if (!mask.IsMatch (dest, (*i)->GetDestNetwork ())
+          || oif != m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+        {
+          continue;
+        }
+      uint16_t len = mask.GetPrefixLength ();
+      if (len > longest || m_routesOnDevice.empty ())
+        {
+          m_routesOnDevice.clear ();
+          longest = len;
+        }
+      if (len == longest)
+        {
+          m_routesOnDevice.push_back (*i);
+        }
+    }
+  return m_routesOnDevice.empty () ? RouteSpan () : RouteSpan (&m_routesOnDevice[0], m_routesOnDevice.size ());
+}
+
+uint32_t
+Ipv4GlobalRouting::CountRoutesOnDevice (const RouteSpan &routes, Ptr<NetDevice> oif) const
+{
+  if (oif == 0)
+    {
+      return routes.size ();
+    }
+  uint32_t n = 0;
+  for (RouteSpan::const_iterator i = routes.begin (); i != routes.end (); ++i)
+    {
+      if (oif == m_ipv4->GetNetDevice ((*i)->GetInterface ()))
+        {
+          n++;
+        }
+      else
+        {
+          NS_LOG_LOGIC ("Not on requested interface, skipping");
+        }
+    }
+  return n;
+}
+
+Ipv4RoutingTableEntry *
+Ipv4GlobalRouting::GetRouteOnDevice (const RouteSpan &routes, Ptr<NetDevice> oif, uint32_t index) const
+{
+  if (oif == 0)
+    {
+      return routes[index];
+    }
+  for (RouteSpan::const_iterator i = routes.begin (); i != routes.end (); ++i)
+    {
+      if (oif == m_ipv4->GetNetDevice ((*i)->GetInterface ()) && index-- == 0)
+        {
+          return *i;
+        }
+    }
+  NS_ASSERT (false);
+  return 0;
+}
+
 uint32_t
 Ipv4GlobalRouting::GetNRoutes (void) const
 {
@@ -326,6 +417,7 @@ void
 Ipv4GlobalRouting::RemoveRoute (uint32_t index)
 {
   NS_LOG_FUNCTION (this << index);
+  m_lookupTablesDirty = true;
   if (index < m_hostRoutes.size ())
     {
       uint32_t tmp = 0;
@@ -409,6 +501,10 @@ Ipv4GlobalRouting::DoDispose (void)
     {
       delete (*l);
     }
+  m_hostLookup.Clear ();
+  m_networkLookup.Clear ();
+  m_externalLookup.Clear ();
+  m_lookupTablesDirty = false;
 
   Ipv4RoutingProtocol::DoDispose ();
 }
@@ -28,6 +28,8 @@
 #include "ns3/ipv4.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/flow-hasher.h"
+#include "ns3/ipv4-lpm-trie.h"
 
 namespace ns3 {
 
@@ -226,6 +228,13 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Select the hash kernel used by per flow ECMP
+   * \param kernel the hash kernel
+   */
+  void SetPerflowEcmpHashKernel (FlowHasher::HashKernel kernel);
+  FlowHasher::HashKernel GetPerflowEcmpHashKernel (void) const;
+
 protected:
   void DoDispose (void);
 
@@ -235,6 +244,11 @@ private:
 
   bool m_perFlowEcmpRouting;
 
+  /// Hasher used to pick the ECMP route from the flow id in per flow ECMP mode
+  FlowHasher m_flowHasher;
+  /// Router specific seed of the per-flow ECMP hash, the TTL being mixed in at every hop
+  uint32_t m_perFlowEcmpSeed;
+
   /// Set to true if this interface should respond to interface events by globallly recomputing routes
   bool m_respondToInterfaceEvents;
   /// A uniform random number generator for randomly routing packets among ECMP
@@ -267,6 +281,47 @@ private:
   NetworkRoutes m_networkRoutes;       //!< Routes to networks
   ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+  /// Longest prefix match view on the route lists, with the equal-cost routes of each prefix
+  typedef Ipv4LpmTrie<Ipv4RoutingTableEntry *> RouteLookup;
+  /// Equal-cost routes of one prefix, as returned by RouteLookup
+  typedef Ipv4LpmSpan<Ipv4RoutingTableEntry *> RouteSpan;
+
+  /**
+   * \brief Rebuild the lookup tables from the route lists
+   */
+  void BuildLookupTables (void);
+
+  /**
+   * \brief Find the routes to the longest prefix matching a destination
+   * among the routes going out through a device
+   * \param routes the network or external routes
+   * \param dest the destination address
+   * \param oif the requested output device
+   * \returns the routes, valid until the next call
+   */
+  RouteSpan LookupOnDevice (const NetworkRoutes &routes, Ipv4Address dest, Ptr<NetDevice> oif);
+
+  /**
+   * \param routes the candidate routes
+   * \param oif the requested output device, or 0 for any
+   * \returns the number of candidate routes going out through oif
+   */
+  uint32_t CountRoutesOnDevice (const RouteSpan &routes, Ptr<NetDevice> oif) const;
+
+  /**
+   * \param routes the candidate routes
+   * \param oif the requested output device, or 0 for any
+   * \param index index among the candidate routes going out through oif
+   * \returns the selected route
+   */
+  Ipv4RoutingTableEntry *GetRouteOnDevice (const RouteSpan &routes, Ptr<NetDevice> oif, uint32_t index) const;
+
+  RouteLookup m_hostLookup;            //!< Host routes
+  RouteLookup m_networkLookup;         //!< Network routes
+  RouteLookup m_externalLookup;        //!< External routes
+  bool m_lookupTablesDirty;            //!< Whether the route lists changed since the last build
+  std::vector<Ipv4RoutingTableEntry *> m_routesOnDevice; //!< Routes returned by LookupOnDevice
+
   Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
@@ -0,0 +1,260 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_LPM_TRIE_H
+#define IPV4_LPM_TRIE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/assert.h"
+
+#include <stdint.h>
+#include <vector>
+#include <map>
+#include <utility>
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Read-only view on the equal-cost next hops of one prefix
+ *
+ * The view points into the storage of the Ipv4LpmTrie that returned it and
+ * stays valid until the trie is modified.
+ */
+template <typename T>
+class Ipv4LpmSpan
+{
+public:
+  typedef const T * const_iterator;
+
+  Ipv4LpmSpan ()
+    : m_begin (0),
+      m_size (0)
+  {
+  }
+
+  Ipv4LpmSpan (const T *begin, uint32_t size)
+    : m_begin (begin),
+      m_size (size)
+  {
+  }
+
+  const_iterator begin (void) const
+  {
+    return m_begin;
+  }
+
+  const_iterator end (void) const
+  {
+    return m_begin + m_size;
+  }
+
+  uint32_t size (void) const
+  {
+    return m_size;
+  }
+
+  bool empty (void) const
+  {
+    return m_size == 0;
+  }
+
+  const T & operator[] (uint32_t index) const
+  {
+    NS_ASSERT (index < m_size);
+    return m_begin[index];
+  }
+
+private:
+  const T *m_begin;
+  uint32_t m_size;
+};
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Longest prefix match table with equal-cost next hop groups
+ *
+ * Every prefix owns a group of values (e.g. the equal-cost routes or output
+ * ports towards it) stored contiguously, so that a lookup returns the whole
+ * group as an Ipv4LpmSpan without allocating. A lookup returns the group of
+ * the longest prefix matching the destination only: a more specific prefix
+ * hides the shorter ones covering it, as in a router. Ipv4GlobalRouting,
+ * CONGA, DRILL and LetFlow all resolve their routes this way.
+ *
+ * The lookup structure is an uncompressed multibit trie with a fixed stride
+ * of 8 bits (at most 4 memory accesses per lookup) built by controlled
+ * prefix expansion: a prefix of length L is expanded into the
+ * 2^(8 - L % 8) slots of the node at depth (L - 1) / 8 it covers, longer
+ * prefixes overwriting shorter ones. Each slot stores the child node index
+ * and the group of the longest prefix covering it within its node, the
+ * lookup keeps the last group seen on its way down.
+ *
+ * A node has 256 slots of 8 bytes, 2 KB. Besides the root, a prefix of
+ * length L needs a node for each of its (L - 1) / 8 leading bytes not
+ * shared with another prefix, so a table costs at most 2 KB * (1 + 3 *
+ * prefixes) and much less when the prefixes share their leading bytes, as
+ * the /24 and /32 routes of a data center do. DIR-24-8 would take 32 MB per
+ * table, too much for every switch of a simulated fabric, and a compressed
+ * trie such as Poptrie only pays off with far more prefixes than these
+ * tables hold.
+ *
+ * Insertions only touch the staging table; the trie is rebuilt in
+ * O(prefixes) on the first lookup after a modification, which suits
+ * routing tables that are populated once and then read for every packet.
+ */
+template <typename T>
+class Ipv4LpmTrie
+{
+public:
+  Ipv4LpmTrie ()
+    : m_dirty (false)
+  {
+  }
+
+  /**
+   * \brief Add a value to the equal-cost group of a prefix
+   * \param network the network address
+   * \param mask the network mask, it must be contiguous
+   * \param value the value appended to the group of this prefix
+   */
+  void Insert (Ipv4Address network, Ipv4Mask mask, const T &value)
+  {
+    uint16_t len = mask.GetPrefixLength ();
+    uint32_t addr = network.Get () & mask.Get ();
+    m_prefixes[std::make_pair (len, addr)].push_back (value);
+    m_dirty = true;
+  }
+
+  /**
+   * \brief Remove every prefix
+   */
+  void Clear (void)
+  {
+    m_prefixes.clear ();
+    m_nodes.clear ();
+    m_groups.clear ();
+    m_values.clear ();
+    m_dirty = false;
+  }
+
+  /**
+   * \returns the number of distinct prefixes
+   */
+  uint32_t GetNPrefixes (void) const
+  {
+    return m_prefixes.size ();
+  }
+
+  /**
+   * \brief Find the equal-cost group of the longest prefix matching dest
+   * \param dest the destination address
+   * \returns the group, empty if no prefix matches
+   */
+  Ipv4LpmSpan<T> Lookup (Ipv4Address dest)
+  {
+    if (m_dirty)
+      {
+        Build ();
+      }
+    if (m_nodes.empty ())
+      {
+        return Ipv4LpmSpan<T> ();
+      }
+    uint32_t addr = dest.Get ();
+    uint32_t node = 0;
+    uint32_t group = NONE;
+    for (uint32_t depth = 0; depth < 4; ++depth)
+      {
+        const Slot &slot = m_nodes[node * STRIDE_SLOTS + ((addr >> (24 - 8 * depth)) & 0xff)];
+        if (slot.group != NONE)
+          {
+            group = slot.group;
+          }
+        if (slot.child == NONE)
+          {
+            break;
+          }
+        node = slot.child;
+      }
+    if (group == NONE)
+      {
+        return Ipv4LpmSpan<T> ();
+      }
+    const std::pair<uint32_t, uint32_t> &range = m_groups[group];
+    return Ipv4LpmSpan<T> (&m_values[range.first], range.second);
+  }
+
+private:
+  static const uint32_t NONE = 0xffffffff;
+  static const uint32_t STRIDE_SLOTS = 256;
+
+  struct Slot
+  {
+    uint32_t child;   //!< index of the child node, NONE if leaf
+    uint32_t group;   //!< group of the longest prefix covering this slot in this node
+  };
+
+  uint32_t NewNode (void)
+  {
+    Slot empty;
+    empty.child = NONE;
+    empty.group = NONE;
+    m_nodes.resize (m_nodes.size () + STRIDE_SLOTS, empty);
+    return m_nodes.size () / STRIDE_SLOTS - 1;
+  }
+
+  void Build (void)
+  {
+    m_nodes.clear ();
+    m_groups.clear ();
+    m_values.clear ();
+    NewNode ();
+
+    // The staging map is ordered by prefix length first, so shorter
+    // prefixes are expanded before the longer ones overwriting them
+    typename Prefixes::const_iterator itr = m_prefixes.begin ();
+    for ( ; itr != m_prefixes.end (); ++itr)
+      {
+        uint16_t len = itr->first.first;
+        uint32_t addr = itr->first.second;
+
+        uint32_t group = m_groups.size ();
+        m_groups.push_back (std::make_pair ((uint32_t) m_values.size (), (uint32_t) itr->second.size ()));
+        m_values.insert (m_values.end (), itr->second.begin (), itr->second.end ());
+
+        uint32_t depth = len == 0 ? 0 : (len - 1) / 8;
+        uint32_t node = 0;
+        for (uint32_t d = 0; d < depth; ++d)
+          {
+            uint32_t index = node * STRIDE_SLOTS + ((addr >> (24 - 8 * d)) & 0xff);
+            if (m_nodes[index].child == NONE)
+              {
+                uint32_t child = NewNode ();
+                m_nodes[index].child = child;
+              }
+            node = m_nodes[index].child;
+          }
+
+        uint32_t bits = len - depth * 8;
+        uint32_t first = bits == 0 ? 0 : ((addr >> (24 - 8 * depth)) & 0xff) & (0xff << (8 - bits));
+        uint32_t count = 1 << (8 - bits);
+        for (uint32_t i = first; i < first + count; ++i)
+          {
+            m_nodes[node * STRIDE_SLOTS + i].group = group;
+          }
+      }
+    m_dirty = false;
+  }
+
+  typedef std::map<std::pair<uint16_t, uint32_t>, std::vector<T> > Prefixes;
+
+  Prefixes m_prefixes;                                  //!< staging table, (length, network) -> group
+  std::vector<Slot> m_nodes;                            //!< trie nodes, STRIDE_SLOTS slots each
+  std::vector<std::pair<uint32_t, uint32_t> > m_groups; //!< (offset, size) of each group in m_values
+  std::vector<T> m_values;                              //!< values of all groups, contiguous per group
+  bool m_dirty;
+};
+
+} // namespace ns3
+
+#endif /* IPV4_LPM_TRIE_H */
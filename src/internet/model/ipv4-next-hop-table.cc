@@ -0,0 +1,109 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ipv4-next-hop-table.h"
+
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/channel.h"
+#include "ns3/node.h"
+#include "ns3/socket.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Ipv4NextHopTable");
+
+Ipv4NextHopTable::Ipv4NextHopTable ()
+  : m_ipv4 (0)
+{
+}
+
+void
+Ipv4NextHopTable::SetIpv4 (Ptr<Ipv4> ipv4)
+{
+  m_ipv4 = ipv4;
+  Clear ();
+}
+
+const Ptr<Ipv4Route> &
+Ipv4NextHopTable::Lookup (uint32_t port)
+{
+  if (port >= m_routes.size ())
+    {
+      m_routes.resize (port + 1);
+    }
+  Ptr<Ipv4Route> &route = m_routes[port];
+  if (route == 0)
+    {
+      route = Resolve (port);
+    }
+  return route;
+}
+
+bool
+Ipv4NextHopTable::Forward (uint32_t port, Ptr<const Packet> packet, const Ipv4Header &header,
+                           const Ipv4RoutingProtocol::UnicastForwardCallback &ucb,
+                           const Ipv4RoutingProtocol::ErrorCallback &ecb)
+{
+  const Ptr<Ipv4Route> &route = Lookup (port);
+  if (route == 0)
+    {
+      NS_LOG_ERROR ("No next hop behind port: " << port);
+      ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
+      return false;
+    }
+  ucb (route, packet, header);
+  return true;
+}
+
+void
+Ipv4NextHopTable::Invalidate (uint32_t port)
+{
+  if (port < m_routes.size ())
+    {
+      m_routes[port] = 0;
+    }
+}
+
+void
+Ipv4NextHopTable::Clear (void)
+{
+  m_routes.clear ();
+}
+
+Ptr<Ipv4Route>
+Ipv4NextHopTable::Resolve (uint32_t port) const
+{
+  NS_ASSERT (m_ipv4 != 0);
+  if (port >= m_ipv4->GetNInterfaces () || m_ipv4->GetNAddresses (port) == 0)
+    {
+      NS_LOG_ERROR ("Port " << port << " has no address, cannot build the next hop route");
+      return 0;
+    }
+
+  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
+  Ptr<Channel> channel = dev->GetChannel ();
+  if (channel == 0 || channel->GetNDevices () != 2)
+    {
+      NS_LOG_ERROR ("Port " << port << " is not a point-to-point port");
+      return 0;
+    }
+
+  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
+  Ptr<NetDevice> peerDev = channel->GetDevice (otherEnd);
+  Ptr<Ipv4> peerIpv4 = peerDev->GetNode ()->GetObject<Ipv4> ();
+  int32_t peerIf = peerIpv4 != 0 ? peerIpv4->GetInterfaceForDevice (peerDev) : -1;
+  if (peerIf < 0 || peerIpv4->GetNAddresses (peerIf) == 0)
+    {
+      // The peer is not configured yet, do not cache anything
+      NS_LOG_ERROR ("Peer of port " << port << " has no address yet");
+      return 0;
+    }
+
+  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
+  route->SetOutputDevice (dev);
+  route->SetGateway (peerIpv4->GetAddress (peerIf, 0).GetLocal ());
+  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
+  NS_LOG_LOGIC ("Next hop of port " << port << " is " << route->GetGateway ());
+  return route;
+}
+
+} // namespace ns3
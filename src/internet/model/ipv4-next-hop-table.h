@@ -0,0 +1,87 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef IPV4_NEXT_HOP_TABLE_H
+#define IPV4_NEXT_HOP_TABLE_H
+
+#include "ns3/ptr.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-protocol.h"
+
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ipv4Routing
+ *
+ * \brief Per router table of precomputed next hop routes, one per output port
+ *
+ * Switch routing protocols that forward on a port number (XPath, DRILL,
+ * LetFlow, CONGA) hand the same Ipv4Route to the forwarding callback for
+ * every packet leaving a given port. This table resolves the peer device
+ * behind each point-to-point port once, keeps the resulting Ipv4Route and
+ * hands out that shared instance afterwards, so the forwarding path does
+ * neither allocate nor look up the peer node.
+ *
+ * The routes carry the output device, the gateway (address of the peer
+ * interface) and the source address; the destination is left unset since
+ * the forwarding path takes it from the Ipv4 header. The routes must be
+ * treated as immutable by their users.
+ *
+ * Entries are resolved lazily on first use, since the peer end of a link
+ * may not be configured yet when the local interface comes up, and are
+ * invalidated whenever the owner is notified of an interface or address
+ * change.
+ */
+class Ipv4NextHopTable
+{
+public:
+  Ipv4NextHopTable ();
+
+  /**
+   * \brief Bind the table to the Ipv4 of the router, dropping all entries
+   * \param ipv4 the Ipv4 object of the router
+   */
+  void SetIpv4 (Ptr<Ipv4> ipv4);
+
+  /**
+   * \brief Get the shared route leaving through the given port
+   * \param port the output interface index
+   * \returns the route, or 0 if the port has no point-to-point peer
+   */
+  const Ptr<Ipv4Route> & Lookup (uint32_t port);
+
+  /**
+   * \brief Hand a packet to the forwarding callback with the route of a port
+   * \param port the output interface index
+   * \param packet the packet
+   * \param header the Ipv4 header of the packet
+   * \param ucb the forwarding callback
+   * \param ecb the error callback, called if the port has no next hop
+   * \returns whether the packet was forwarded
+   */
+  bool Forward (uint32_t port, Ptr<const Packet> packet, const Ipv4Header &header,
+                const Ipv4RoutingProtocol::UnicastForwardCallback &ucb,
+                const Ipv4RoutingProtocol::ErrorCallback &ecb);
+
+  /**
+   * \brief Drop the entry of one port, it is resolved again on next use
+   * \param port the interface index
+   */
+  void Invalidate (uint32_t port);
+
+  /**
+   * \brief Drop all entries
+   */
+  void Clear (void);
+
+private:
+  Ptr<Ipv4Route> Resolve (uint32_t port) const;
+
+  Ptr<Ipv4> m_ipv4;
+  std::vector<Ptr<Ipv4Route> > m_routes;
+};
+
+} // namespace ns3
+
+#endif /* IPV4_NEXT_HOP_TABLE_H */
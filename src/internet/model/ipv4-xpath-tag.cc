@@ -1,7 +1,10 @@
 #include "ipv4-xpath-tag.h"
+#include "ns3/packet-tag-slots.h"
 
 namespace ns3 {
 
+NS_PACKET_TAG_SLOT (Ipv4XPathTag);
+
 Ipv4XPathTag::Ipv4XPathTag () {}
 
 TypeId
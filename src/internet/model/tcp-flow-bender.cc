@@ -15,7 +15,7 @@ TypeId
 TcpFlowBender::GetTypeId (void)
 {
     static TypeId tid = TypeId ("ns3::TcpFlowBender")
-        .SetParent<Object> ()
+        .SetParent<HostPathSelector> ()
         .SetGroupName ("Internent")
         .AddConstructor<TcpFlowBender> ()
          .AddAttribute ("T", "The congestion degree within one RTT",
@@ -31,7 +31,7 @@ TcpFlowBender::GetTypeId (void)
 }
 
 TcpFlowBender::TcpFlowBender ()
-    :Object (),
+    :HostPathSelector (),
      m_totalBytes (0),
      m_markedBytes (0),
      m_numCongestionRtt (0),
@@ -44,7 +44,7 @@ TcpFlowBender::TcpFlowBender ()
 }
 
 TcpFlowBender::TcpFlowBender (const TcpFlowBender &other)
-     :Object (),
+     :HostPathSelector (other),
      m_totalBytes (0),
      m_markedBytes (0),
      m_numCongestionRtt (0),
@@ -65,6 +65,7 @@ void
 TcpFlowBender::DoDispose (void)
 {
     NS_LOG_FUNCTION (this);
+    HostPathSelector::DoDispose ();
 }
 
 void
@@ -92,8 +93,39 @@ TcpFlowBender::GetV ()
     return m_V;
 }
 
+Ptr<HostPathSelector>
+TcpFlowBender::Fork (void)
+{
+    return CopyObject<TcpFlowBender> (this);
+}
+
+uint32_t
+TcpFlowBender::GetFlowId (void) const
+{
+    return m_flowId + m_V;
+}
+
+uint32_t
+TcpFlowBender::SendData (Ptr<Packet> p, bool isRetransmission)
+{
+    return TcpFlowBender::GetV ();
+}
+
+uint32_t
+TcpFlowBender::SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission)
+{
+    return TcpFlowBender::GetV ();
+}
+
+void
+TcpFlowBender::PktsAcked (SequenceNumber32 highTxMark, SequenceNumber32 ackNumber,
+        uint32_t bytesAcked, bool withECE)
+{
+    TcpFlowBender::ReceivedPacket (highTxMark, ackNumber, bytesAcked, withECE);
+}
+
 Time
-TcpFlowBender::GetPauseTime ()
+TcpFlowBender::GetPauseTime (void)
 {
     return MicroSeconds (80);
 }
@@ -2,14 +2,18 @@
 #ifndef TCP_FLOW_BENDER
 #define TCP_FLOW_BENDER
 
-#include "ns3/object.h"
+#include "host-path-selector.h"
 #include "ns3/event-id.h"
 #include "ns3/nstime.h"
 #include "ns3/sequence-number.h"
 
 namespace ns3 {
 
-class TcpFlowBender : public Object
+/**
+ * \brief FlowBender: the sender moves the flow to another ECMP path by
+ * changing its flow id when too many of its bytes are marked in N RTTs
+ */
+class TcpFlowBender : public HostPathSelector
 {
 public:
     static TypeId GetTypeId (void);
@@ -24,7 +28,14 @@ public:
 
     uint32_t GetV ();
 
-    Time GetPauseTime ();
+    // HostPathSelector, the path is the V added to the flow id
+    virtual Ptr<HostPathSelector> Fork (void);
+    virtual uint32_t GetFlowId (void) const;
+    virtual uint32_t SendData (Ptr<Packet> p, bool isRetransmission);
+    virtual uint32_t SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission);
+    virtual void PktsAcked (SequenceNumber32 highTxMark, SequenceNumber32 ackNumber,
+                            uint32_t bytesAcked, bool withECE);
+    virtual Time GetPauseTime (void);
 
 private:
 
@@ -68,8 +68,7 @@ TcpOption::CreateOption (uint8_t kind)
     TypeId tid;
   };
 
-  static ObjectFactory objectFactory;
-  static kindToTid toTid[] =
+  static const kindToTid toTid[] =
   {
     { TcpOption::END,       TcpOptionEnd::GetTypeId () },
     { TcpOption::MSS,       TcpOptionMSS::GetTypeId () },
@@ -83,6 +82,8 @@ TcpOption::CreateOption (uint8_t kind)
     {
       if (toTid[i].kind == kind)
         {
+          // Not static: the options may be parsed by several threads
+          ObjectFactory objectFactory;
           objectFactory.SetTypeId (toTid[i].tid);
           return objectFactory.Create<TcpOption> ();
         }
@@ -7,6 +7,8 @@
 #include "ns3/tcp-socket-base.h"
 #include "ns3/flow-id-tag.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -14,6 +16,12 @@ NS_LOG_COMPONENT_DEFINE ("TcpResequenceBuffer");
 
 NS_OBJECT_ENSURE_REGISTERED (TcpResequenceBuffer);
 
+namespace {
+
+const uint32_t OUT_ORDER_INIT_SLOTS = 64;
+
+} // anonymous namespace
+
 TypeId
 TcpResequenceBuffer::GetTypeId (void)
 {
@@ -36,11 +44,6 @@ TcpResequenceBuffer::GetTypeId (void)
                    TimeValue (MicroSeconds (50)),
                    MakeTimeAccessor (&TcpResequenceBuffer::m_outOrderQueueTimerLimit),
                    MakeTimeChecker  ())
-    .AddAttribute ("PeriodicalCheckTime",
-                   "Periodical check time",
-                   TimeValue (MicroSeconds (10)),
-                   MakeTimeAccessor (&TcpResequenceBuffer::m_periodicalCheckTime),
-                   MakeTimeChecker  ())
     .AddTraceSource ("Buffer",
                      "When one packet is buffered",
                      MakeTraceSourceAccessor (&TcpResequenceBuffer::m_tcpRBBuffer),
@@ -59,18 +62,24 @@ TcpResequenceBuffer::TcpResequenceBuffer ():
     m_sizeLimit (64000),
     m_inOrderQueueTimerLimit (MicroSeconds (20)),
     m_outOrderQueueTimerLimit (MicroSeconds (50)),
-    m_periodicalCheckTime (MicroSeconds (10)),
     m_traceFlowId (0),
  	// Variables
     m_size (0),
     m_inOrderQueueTimer (Simulator::Now ()),
     m_outOrderQueueTimer (Simulator::Now ()),
-    m_checkEvent (),
+    m_timerDeadline (Simulator::Now ()),
     m_hasStopped (false),
     m_firstSeq (SequenceNumber32 (0)),
-    m_nextSeq (SequenceNumber32 (0))
+    m_nextSeq (SequenceNumber32 (0)),
+    m_outOrderMask (0),
+    m_outOrderSize (0),
+    m_outOrderDeleted (0),
+    m_outOrderOrigin (0),
+    m_slotBytes (1)
 {
   NS_LOG_FUNCTION (this);
+  ResizeOutOrder (OUT_ORDER_INIT_SLOTS);
+  m_timerEvent.SetFunction (&TcpResequenceBuffer::TimerExpired, this);
 }
 
 TcpResequenceBuffer::~TcpResequenceBuffer ()
@@ -82,12 +91,12 @@ void
 TcpResequenceBuffer::DoDispose (void)
 {
   NS_LOG_FUNCTION (this);
+  m_timerEvent.Cancel ();
   m_inOrderQueue.clear ();
-  while (!m_outOrderQueue.empty ())
-  {
-    m_outOrderQueue.pop ();
-  }
-  m_outOrderSeqSet.clear ();
+  m_outOrderWindow.clear ();
+  m_outOrderMask = 0;
+  m_outOrderSize = 0;
+  m_outOrderDeleted = 0;
 }
 
 void
@@ -102,11 +111,9 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
     return;
   }
 
-  // Turn on the periodical check and reset the timer
-  if (!m_checkEvent.IsRunning ())
+  // Reset the queue timers if the buffer was idle
+  if (!m_timerEvent.IsRunning ())
   {
-    NS_LOG_LOGIC ("Turn on periodical check");
-    m_checkEvent = Simulator::Schedule (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
     m_inOrderQueueTimer = Simulator::Now ();
     m_outOrderQueueTimer = Simulator::Now ();
   }
@@ -144,6 +151,13 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
 
   m_tcpRBBuffer (m_traceFlowId, Simulator::Now (), element.m_seq, TcpResequenceBuffer::CalculateNextSeq (element));
 
+  // The slot granularity of the out of order window follows the segment
+  // size, it can only change while the window is empty
+  if (element.m_dataSize > m_slotBytes && m_outOrderSize == 0)
+  {
+    m_slotBytes = element.m_dataSize;
+  }
+
   // If the seq < first seq, retransmission may occur
   if (element.m_seq < m_firstSeq)
   {
@@ -175,18 +189,16 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
   // If the seq == next seq
   else if (TcpResequenceBuffer::PutInTheInOrderQueue (element))
   {
-    // Try to fill the in order queue from the out order queue
-    while (!m_outOrderQueue.empty ())
+    // Try to fill the in order queue from the out order window
+    while (m_outOrderSize > 0)
     {
-      if (TcpResequenceBuffer::PutInTheInOrderQueue (m_outOrderQueue.top ()))
-      {
-        m_outOrderSeqSet.erase (m_outOrderQueue.top ().m_seq);
-        m_outOrderQueue.pop ();
-      }
-      else
+      int32_t slot = TcpResequenceBuffer::FindOutOrder (m_nextSeq);
+      if (slot < 0)
       {
         break;
       }
+      TcpResequenceBuffer::PutInTheInOrderQueue (m_outOrderWindow[slot].element);
+      TcpResequenceBuffer::RemoveOutOrder (slot);
       m_outOrderQueueTimer = Simulator::Now ();
     }
     // If the size exceeds the limit
@@ -200,12 +212,13 @@ TcpResequenceBuffer::BufferPacket (Ptr<Packet> packet,
   // If the seq > next seq
   else
   {
-    if (m_outOrderSeqSet.find (element.m_seq) == m_outOrderSeqSet.end())
+    if (TcpResequenceBuffer::FindOutOrder (element.m_seq) < 0)
     {
-      m_outOrderQueue.push (element);
-      m_outOrderSeqSet.insert (element.m_seq);
+      TcpResequenceBuffer::InsertOutOrder (element);
     }
   }
+
+  TcpResequenceBuffer::ArmTimer ();
 }
 
 
@@ -218,10 +231,10 @@ TcpResequenceBuffer::SetTcp (TcpSocketBase *tcp)
 void
 TcpResequenceBuffer::Stop (void)
 {
-  // After the hasStopped flag turned into true, it would never activate the
-  // periodical check event again to prepare for the destruction
+  // After the hasStopped flag turned into true, it would never arm the
+  // timer again to prepare for the destruction
   m_hasStopped = true;
-  m_checkEvent.Cancel ();
+  m_timerEvent.Cancel ();
   m_tcp = NULL;
 }
 
@@ -231,6 +244,10 @@ TcpResequenceBuffer::PutInTheInOrderQueue (const TcpResequenceBufferElement &ele
   if (m_nextSeq == SequenceNumber32 (0) // For the fist packet
         || m_nextSeq == element.m_seq)
   {
+    if (m_inOrderQueue.empty ())
+    {
+      TcpResequenceBuffer::CatchUpQueueTimer (m_inOrderQueueTimer, m_inOrderQueueTimerLimit);
+    }
     m_inOrderQueue.push_back (element);
     m_size += element.m_dataSize;
     m_nextSeq = TcpResequenceBuffer::CalculateNextSeq (element);
@@ -257,35 +274,194 @@ TcpResequenceBuffer::CalculateNextSeq (const TcpResequenceBufferElement &element
   return newSeq;
 }
 
+uint32_t
+TcpResequenceBuffer::GetHomeSlot (SequenceNumber32 seq) const
+{
+  return ((seq.GetValue () - m_outOrderOrigin) / m_slotBytes) & m_outOrderMask;
+}
+
+int32_t
+TcpResequenceBuffer::FindOutOrder (SequenceNumber32 seq) const
+{
+  if (m_outOrderSize == 0)
+  {
+    return -1;
+  }
+  uint32_t slot = GetHomeSlot (seq);
+  for (uint32_t probe = 0; probe <= m_outOrderMask; ++probe)
+  {
+    const OutOrderSlot &entry = m_outOrderWindow[slot];
+    if (entry.state == SLOT_EMPTY)
+    {
+      return -1;
+    }
+    if (entry.state == SLOT_USED && entry.element.m_seq == seq)
+    {
+      return slot;
+    }
+    slot = (slot + 1) & m_outOrderMask;
+  }
+  return -1;
+}
+
+void
+TcpResequenceBuffer::InsertOutOrder (const TcpResequenceBufferElement &element)
+{
+  if (m_outOrderSize == 0)
+  {
+    TcpResequenceBuffer::CatchUpQueueTimer (m_outOrderQueueTimer, m_outOrderQueueTimerLimit);
+  }
+  if (m_outOrderSize == 0 && m_outOrderDeleted == 0)
+  {
+    // Anchor the window on the next expected segment
+    m_outOrderOrigin = m_nextSeq.GetValue ();
+  }
+  else if ((m_outOrderSize + m_outOrderDeleted + 1) * 4 > (m_outOrderMask + 1) * 3)
+  {
+    // Keep the load factor under 3/4, purging the deleted slots
+    uint32_t nSlots = m_outOrderMask + 1;
+    TcpResequenceBuffer::ResizeOutOrder ((m_outOrderSize + 1) * 2 > nSlots ? nSlots * 2 : nSlots);
+  }
+
+  uint32_t slot = GetHomeSlot (element.m_seq);
+  while (m_outOrderWindow[slot].state == SLOT_USED)
+  {
+    slot = (slot + 1) & m_outOrderMask;
+  }
+  if (m_outOrderWindow[slot].state == SLOT_DELETED)
+  {
+    m_outOrderDeleted--;
+  }
+  m_outOrderWindow[slot].element = element;
+  m_outOrderWindow[slot].state = SLOT_USED;
+  m_outOrderSize++;
+}
+
 void
-TcpResequenceBuffer::PeriodicalCheck ()
+TcpResequenceBuffer::RemoveOutOrder (uint32_t slot)
+{
+  m_outOrderWindow[slot].element.m_packet = 0;
+  m_outOrderSize--;
+  if (m_outOrderSize == 0)
+  {
+    // Nothing left to probe through, start over from a clean window
+    TcpResequenceBuffer::ClearOutOrder ();
+    return;
+  }
+  m_outOrderWindow[slot].state = SLOT_DELETED;
+  m_outOrderDeleted++;
+}
+
+void
+TcpResequenceBuffer::ResizeOutOrder (uint32_t nSlots)
+{
+  NS_LOG_LOGIC ("Out order window resized to " << nSlots << " slots");
+  std::vector<OutOrderSlot> old;
+  old.swap (m_outOrderWindow);
+
+  OutOrderSlot empty;
+  empty.state = SLOT_EMPTY;
+  m_outOrderWindow.assign (nSlots, empty);
+  m_outOrderMask = nSlots - 1;
+  m_outOrderSize = 0;
+  m_outOrderDeleted = 0;
+
+  for (std::vector<OutOrderSlot>::const_iterator itr = old.begin (); itr != old.end (); ++itr)
+  {
+    if (itr->state == SLOT_USED)
+    {
+      uint32_t slot = GetHomeSlot (itr->element.m_seq);
+      while (m_outOrderWindow[slot].state == SLOT_USED)
+      {
+        slot = (slot + 1) & m_outOrderMask;
+      }
+      m_outOrderWindow[slot] = *itr;
+      m_outOrderSize++;
+    }
+  }
+}
+
+void
+TcpResequenceBuffer::ClearOutOrder (void)
+{
+  if (m_outOrderSize == 0 && m_outOrderDeleted == 0)
+  {
+    return;
+  }
+  for (std::vector<OutOrderSlot>::iterator itr = m_outOrderWindow.begin (); itr != m_outOrderWindow.end (); ++itr)
+  {
+    itr->state = SLOT_EMPTY;
+    itr->element.m_packet = 0;
+  }
+  m_outOrderSize = 0;
+  m_outOrderDeleted = 0;
+}
+
+void
+TcpResequenceBuffer::ArmTimer (void)
+{
+  if (m_hasStopped || (m_inOrderQueue.empty () && m_outOrderSize == 0))
+  {
+    NS_LOG_LOGIC ("Turn the timer into idle status");
+    m_timerEvent.Cancel ();
+    return;
+  }
+
+  // An empty queue has nothing to flush, its deadline does not count
+  Time deadline = Time::Max ();
+  if (!m_inOrderQueue.empty ())
+  {
+    deadline = m_inOrderQueueTimer + m_inOrderQueueTimerLimit;
+  }
+  if (m_outOrderSize > 0)
+  {
+    deadline = std::min (deadline, m_outOrderQueueTimer + m_outOrderQueueTimerLimit);
+  }
+
+  // A timer already armed for an earlier deadline re-arms itself when it
+  // fires, only move it when the deadline gets closer
+  if (m_timerEvent.IsRunning () && m_timerDeadline <= deadline)
+  {
+    return;
+  }
+  m_timerEvent.Cancel ();
+  m_timerDeadline = std::max (deadline, Simulator::Now ());
+  m_timerEvent.Schedule (m_timerDeadline - Simulator::Now ());
+}
+
+void
+TcpResequenceBuffer::CatchUpQueueTimer (Time &queueTimer, Time limit)
+{
+  int64_t elapsed = (Simulator::Now () - queueTimer).GetTimeStep ();
+  int64_t period = limit.GetTimeStep ();
+  if (period > 0 && elapsed >= period)
+  {
+    queueTimer += TimeStep (elapsed - elapsed % period);
+  }
+}
+
+void
+TcpResequenceBuffer::TimerExpired (void)
 {
   if (m_hasStopped)
   {
     return;
   }
 
-  if (Simulator::Now () - m_inOrderQueueTimer > m_inOrderQueueTimerLimit)
+  if (Simulator::Now () - m_inOrderQueueTimer >= m_inOrderQueueTimerLimit)
   {
     FlushInOrderQueue (IN_ORDER_TIMEOUT);
     m_firstSeq = m_nextSeq;
   }
 
-  if (Simulator::Now () - m_outOrderQueueTimer > m_outOrderQueueTimerLimit)
+  if (Simulator::Now () - m_outOrderQueueTimer >= m_outOrderQueueTimerLimit)
   {
     FlushInOrderQueue (OUT_ORDER_TIMEOUT);
     FlushOutOrderQueue (OUT_ORDER_TIMEOUT);
     m_firstSeq = m_nextSeq;
   }
 
-  if (!m_inOrderQueue.empty () || !m_outOrderQueue.empty ())
-  {
-    m_checkEvent = Simulator::Schedule (m_periodicalCheckTime, &TcpResequenceBuffer::PeriodicalCheck, this);
-  }
-  else
-  {
-	NS_LOG_LOGIC ("Turn the periodical check into idle status");
-  }
+  ArmTimer ();
 }
 
 void
@@ -297,7 +473,7 @@ TcpResequenceBuffer::FlushOneElement (const TcpResequenceBufferElement &element,
   }
   NS_LOG_INFO ("Flush packet: " << element.m_packet);
   m_tcpRBFlush (m_traceFlowId, Simulator::Now (), element.m_seq, m_inOrderQueue.size (),
-          m_outOrderQueue.size (), reason);
+          m_outOrderSize, reason);
   m_tcp->DoForwardUp (element.m_packet, element.m_fromAddress, element.m_toAddress);
 }
 
@@ -330,17 +506,30 @@ void
 TcpResequenceBuffer::FlushOutOrderQueue (TcpRBPopReason reason)
 {
   NS_LOG_FUNCTION (this);
-  // Flush the data
-  while (!m_outOrderQueue.empty ())
+  // Flush the data in sequence order
+  std::vector<std::pair<SequenceNumber32, uint32_t> > order;
+  order.reserve (m_outOrderSize);
+  for (uint32_t slot = 0; slot < m_outOrderWindow.size (); ++slot)
+  {
+    if (m_outOrderWindow[slot].state == SLOT_USED)
+    {
+      order.push_back (std::make_pair (m_outOrderWindow[slot].element.m_seq, slot));
+    }
+  }
+  std::sort (order.begin (), order.end ());
+
+  std::vector<std::pair<SequenceNumber32, uint32_t> >::const_iterator itr = order.begin ();
+  for ( ; itr != order.end (); ++itr)
   {
     if (m_hasStopped)
     {
       break;
     }
-    TcpResequenceBuffer::FlushOneElement (m_outOrderQueue.top (), reason);
-    m_outOrderQueue.pop ();
+    TcpResequenceBuffer::FlushOneElement (m_outOrderWindow[itr->second].element, reason);
+    TcpResequenceBuffer::RemoveOutOrder (itr->second);
   }
-  m_outOrderSeqSet.clear ();
+  // Drop what is left after a stop
+  TcpResequenceBuffer::ClearOutOrder ();
 
   // Reset the timer
   m_outOrderQueueTimer = Simulator::Now ();
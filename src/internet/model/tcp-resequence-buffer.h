@@ -5,13 +5,11 @@
 #include "ns3/packet.h"
 #include "ns3/sequence-number.h"
 #include "ns3/nstime.h"
-#include "ns3/event-id.h"
+#include "ns3/reusable-event.h"
 #include "ns3/callback.h"
 #include "ns3/traced-value.h"
 
 #include <vector>
-#include <queue>
-#include <set>
 
 namespace ns3
 {
@@ -25,6 +23,7 @@ enum TcpRBPopReason
 };
 
 class TcpSocketBase;
+class TcpResequenceBufferTimerTest;
 
 class TcpResequenceBufferElement
 {
@@ -43,17 +42,14 @@ public:
   Address m_fromAddress;
 
   Address m_toAddress;
-
-  friend inline bool operator > (const TcpResequenceBufferElement &l, const TcpResequenceBufferElement &r)
-  {
-    return l.m_seq > r.m_seq;
-  }
 };
 
 class TcpResequenceBuffer : public Object
 {
 
 public:
+  // Allow the test cases to check the timer
+  friend class TcpResequenceBufferTimerTest;
 
   static TypeId GetTypeId (void);
 
@@ -74,10 +70,38 @@ public:
 
 private:
 
+  // Slot of the out of order window
+  struct OutOrderSlot
+  {
+    TcpResequenceBufferElement element;
+    uint8_t state;
+  };
+
+  enum OutOrderSlotState
+  {
+    SLOT_EMPTY = 0,
+    SLOT_USED,
+    SLOT_DELETED
+  };
+
   bool PutInTheInOrderQueue (const TcpResequenceBufferElement &element);
   SequenceNumber32 CalculateNextSeq (const TcpResequenceBufferElement &element);
 
-  void PeriodicalCheck ();
+  // Out of order window, open addressed on the sequence number
+  uint32_t GetHomeSlot (SequenceNumber32 seq) const;
+  int32_t FindOutOrder (SequenceNumber32 seq) const;
+  void InsertOutOrder (const TcpResequenceBufferElement &element);
+  void RemoveOutOrder (uint32_t slot);
+  void ResizeOutOrder (uint32_t nSlots);
+  void ClearOutOrder (void);
+
+  // Arm the timer for the earliest deadline of the in order and out of
+  // order queues holding segments, cancel it if both are empty
+  void ArmTimer (void);
+  // Restart the timer of a queue getting its first segment as if the timer
+  // had flushed the empty queue at each of its deadlines
+  void CatchUpQueueTimer (Time &queueTimer, Time limit);
+  void TimerExpired (void);
 
   void FlushOneElement (const TcpResequenceBufferElement &element, TcpRBPopReason reason);
   void FlushInOrderQueue (TcpRBPopReason reason);
@@ -89,8 +113,6 @@ private:
   Time m_inOrderQueueTimerLimit;
   Time m_outOrderQueueTimerLimit;
 
-  Time m_periodicalCheckTime;
-
   uint32_t m_traceFlowId;
 
   // Variables
@@ -98,7 +120,8 @@ private:
   Time m_inOrderQueueTimer;
   Time m_outOrderQueueTimer;
 
-  EventId m_checkEvent;
+  ReusableEvent m_timerEvent;
+  Time m_timerDeadline;
   bool m_hasStopped;
 
   SequenceNumber32 m_firstSeq;
@@ -106,11 +129,15 @@ private:
 
   std::vector<TcpResequenceBufferElement> m_inOrderQueue;
 
-  std::priority_queue<TcpResequenceBufferElement,
-      std::vector<TcpResequenceBufferElement>,
-      std::greater<TcpResequenceBufferElement> > m_outOrderQueue;
-
-  std::set<SequenceNumber32> m_outOrderSeqSet;
+  // Circular window of out of order segments, the slot of a segment is its
+  // offset from m_outOrderOrigin in units of m_slotBytes, probing linearly
+  // on collision (e.g. segments shorter than m_slotBytes)
+  std::vector<OutOrderSlot> m_outOrderWindow;
+  uint32_t m_outOrderMask;
+  uint32_t m_outOrderSize;        // Used slots
+  uint32_t m_outOrderDeleted;     // Deleted slots, still probed through by lookups
+  uint32_t m_outOrderOrigin;
+  uint32_t m_slotBytes;
 
   TcpSocketBase *m_tcp;
 
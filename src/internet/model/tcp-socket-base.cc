@@ -52,11 +52,10 @@
 #include "rtt-estimator.h"
 #include "ipv4-ecn-tag.h"
 #include "ns3/flow-id-tag.h"
-#include "ns3/ipv4-xpath-tag.h"
-#include "ns3/tcp-tlb-tag.h"
-#include "ns3/ipv4-clove.h"
-#include "ns3/tcp-clove-tag.h"
-#include "ns3/hash.h"
+#include "tlb-path-selector.h"
+#include "clove-path-selector.h"
+#include "tcp-flow-bender.h"
+#include "ns3/enum.h"
 
 #include <math.h>
 #include <algorithm>
@@ -159,6 +158,13 @@ TcpSocketBase::GetTypeId (void)
                    BooleanValue (false),
                    MakeBooleanAccessor (&TcpSocketBase::m_CloveEnabled),
                    MakeBooleanChecker ())
+    .AddAttribute ("FlowHashKernel", "Hash kernel used to derive the flow id from the 5-tuple",
+                   EnumValue (FlowHasher::CRC32C),
+                   MakeEnumAccessor (&TcpSocketBase::SetFlowHashKernel,
+                                     &TcpSocketBase::GetFlowHashKernel),
+                   MakeEnumChecker (FlowHasher::CRC32C, "Crc32c",
+                                    FlowHasher::MURMUR3, "Murmur3",
+                                    FlowHasher::TOEPLITZ, "Toeplitz"))
     .AddAttribute ("Pause", "Whether TCP should pause in FlowBender & TLB",
                    BooleanValue (false),
                    MakeBooleanAccessor (&TcpSocketBase::m_isPauseEnabled),
@@ -352,15 +358,11 @@ TcpSocketBase::TcpSocketBase (void)
     m_ecn (true),
     m_resequenceBufferEnabled (false),
     m_flowBenderEnabled (false),
-    // TLB
     m_TLBEnabled (false),
-    m_TLBSendSide (false),
-    m_piggybackTLBInfo (false),
     m_TLBReverseAckEnabled (false),
-    // Clove
     m_CloveEnabled (false),
-    m_CloveSendSide (false),
-    m_piggybackCloveInfo (false),
+    m_flowId (0),
+    m_hasFlowId (false),
     // Pause
     m_isPauseEnabled (false),
     m_isPause (false),
@@ -387,9 +389,6 @@ TcpSocketBase::TcpSocketBase (void)
   m_resequenceBuffer->SetTcp (this);
 
 
-  // Flow Bender support
-  m_flowBender = CreateObject<TcpFlowBender> ();
-
   // Pause support
   m_pauseBuffer = CreateObject<TcpPauseBuffer> ();
 
@@ -458,15 +457,13 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
     m_ecn (sock.m_ecn),
     m_resequenceBufferEnabled (sock.m_resequenceBufferEnabled),
     m_flowBenderEnabled (sock.m_flowBenderEnabled),
-    // TLB
     m_TLBEnabled (sock.m_TLBEnabled),
-    m_TLBSendSide (false),
-    m_piggybackTLBInfo (false),
     m_TLBReverseAckEnabled (sock.m_TLBReverseAckEnabled),
-    // Clove
     m_CloveEnabled (sock.m_CloveEnabled),
-    m_CloveSendSide (false),
-    m_piggybackCloveInfo (false),
+    m_pathSelectorPrototype (sock.m_pathSelectorPrototype),
+    m_flowHasher (sock.m_flowHasher),
+    m_flowId (0),
+    m_hasFlowId (false),
     // Pause
     m_isPauseEnabled (sock.m_isPauseEnabled),
     m_isPause (false),
@@ -509,9 +506,6 @@ TcpSocketBase::TcpSocketBase (const TcpSocketBase& sock)
   m_resequenceBuffer->m_tcpRBBuffer = sock.m_resequenceBuffer->m_tcpRBBuffer;
   m_resequenceBuffer->SetTcp (this);
 
-  // Flow Bender support
-  m_flowBender = CreateObject<TcpFlowBender> ();
-
   // Pause support
   m_pauseBuffer = CreateObject<TcpPauseBuffer> ();
 
@@ -1145,14 +1139,10 @@ TcpSocketBase::DoConnect (void)
         sendflags |= (TcpHeader::ECE | TcpHeader::CWR);
         NS_LOG_LOGIC (this << " ECN capable connection, sending ECN setup SYN");
       }
-      if (m_TLBEnabled)
-      {
-          m_TLBSendSide = true;
-      }
-      if (m_CloveEnabled)
-      {
-          m_CloveSendSide = true;
-      }
+      if (m_endPoint != 0)
+        {
+          SetupPathSelector (true);
+        }
       SendEmptyPacket (sendflags);
 
       // XXX Resequence Buffer Support, disable resequence buffer on sender side
@@ -1470,8 +1460,8 @@ TcpSocketBase::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
           m_txTrace (p, h, this);
           if (m_endPoint)
           {
-            TcpSocketBase::AttachFlowId (p, m_endPoint->GetLocalAddress (),
-                    m_endPoint->GetPeerAddress (), tcpHeader.GetSourcePort (), tcpHeader.GetDestinationPort ());
+            p->AddPacketTag (FlowIdTag (CalFlowId (m_endPoint->GetLocalAddress (),
+                    m_endPoint->GetPeerAddress (), tcpHeader.GetSourcePort (), tcpHeader.GetDestinationPort ())));
           }
           m_tcp->SendPacket (p, h, toAddress, fromAddress, m_boundnetdevice);
         }
@@ -1637,33 +1627,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
     withECE = true;
   }
 
-  // XXX TLB Support
-  if (m_TLBEnabled && m_TLBSendSide)
+  // XXX Host load balancing, path feedback
+  if (m_pathSelector)
   {
-    TcpTLBTag tcpTLBTag;
-    bool found = packet->RemovePacketTag(tcpTLBTag);
-    if (found)
-    {
-        uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                m_endPoint->GetPeerAddress (), m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        m_pathAcked = tcpTLBTag.GetPath ();
-        // std::cout << this << " Path acked: " << m_pathAcked << std::endl;
-        ipv4TLB->FlowRecv (flowId, m_pathAcked, m_endPoint->GetPeerAddress (), bytesAcked, withECE, tcpTLBTag.GetTime ());
-    }
-  }
-
-  // XXX Clove Support
-  if (m_CloveEnabled && m_CloveSendSide)
-  {
-    TcpCloveTag tcpCloveTag;
-    bool found = packet->RemovePacketTag(tcpCloveTag);
-    if (found)
-    {
-        Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
-        m_pathAcked = tcpCloveTag.GetPath ();
-        ipv4Clove->FlowRecv (m_pathAcked, m_endPoint->GetPeerAddress (), withECE);
-    }
+    m_pathSelector->ReceivedAck (packet, bytesAcked, withECE);
   }
 
   if (ackNumber == m_txBuffer->HeadSequence ()
@@ -1728,10 +1695,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       // Artificially call PktsAcked. After all, one segment has been ACKed.
       m_congestionControl->PktsAcked (m_tcb, 1, m_lastRtt, withECE, m_highTxMark, ackNumber);
 
-      // XXX FlowBender
-      if (m_flowBenderEnabled)
+      // XXX Host load balancing
+      if (m_pathSelector)
       {
-        m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize, withECE);
+        m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize, withECE);
       }
 
     }
@@ -1769,10 +1736,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
       if (m_tcb->m_congState == TcpSocketState::CA_OPEN)
         {
             m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt, withECE, m_highTxMark, ackNumber);
-            // XXX FlowBender
-            if (m_flowBenderEnabled)
+            // XXX Host load balancing
+            if (m_pathSelector)
             {
-              m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
+              m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
             }
         }
       // XXX After the CWR has been acked, the CA_CWR exits
@@ -1788,10 +1755,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
           m_retransOut = 0;
 
           m_congestionControl->PktsAcked(m_tcb, segsAcked, m_lastRtt, withECE, m_highTxMark, ackNumber);
-          // XXX FlowBender
-          if (m_flowBenderEnabled)
+          // XXX Host load balancing
+          if (m_pathSelector)
           {
-              m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
+              m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
           }
 
         }
@@ -1801,10 +1768,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
           // packet algorithm from FACK to NewReno. We simply go back in Open.
           m_tcb->m_congState = TcpSocketState::CA_OPEN;
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt, withECE, m_highTxMark, ackNumber);
-          // XXX FlowBender
-          if (m_flowBenderEnabled)
+          // XXX Host load balancing
+          if (m_pathSelector)
           {
-              m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
+              m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
           }
 
           m_dupAckCount = 0;
@@ -1859,10 +1826,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
                * been processed when they come under the form of dupACKs
                */
               m_congestionControl->PktsAcked (m_tcb, 1, m_lastRtt, withECE, m_highTxMark, ackNumber);
-              // XXX FlowBender
-              if (m_flowBenderEnabled)
+              // XXX Host load balancing
+              if (m_pathSelector)
               {
-                  m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize, withECE);
+                  m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize, withECE);
               }
 
               NS_LOG_INFO ("Partial ACK for seq " << ackNumber <<
@@ -1884,10 +1851,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
                * except the (maybe) new ACKs which come from a new window
                */
               m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt, withECE, m_highTxMark, ackNumber);
-              // XXX FlowBender
-              if (m_flowBenderEnabled)
+              // XXX Host load balancing
+              if (m_pathSelector)
               {
-                m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
+                m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
               }
 
               newSegsAcked = (ackNumber - m_recover) / m_tcb->m_segmentSize;
@@ -1903,10 +1870,10 @@ TcpSocketBase::ReceivedAck (Ptr<Packet> packet, const TcpHeader& tcpHeader)
           // Go back in OPEN state
           m_isFirstPartialAck = true;
           m_congestionControl->PktsAcked (m_tcb, segsAcked, m_lastRtt, withECE, m_highTxMark, ackNumber);
-          // XXX FlowBender
-          if (m_flowBenderEnabled)
+          // XXX Host load balancing
+          if (m_pathSelector)
           {
-            m_flowBender->ReceivedPacket (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
+            m_pathSelector->PktsAcked (m_highTxMark, ackNumber, m_tcb->m_segmentSize * segsAcked, withECE);
           }
 
           m_dupAckCount = 0;
@@ -2524,117 +2491,22 @@ TcpSocketBase::SendEmptyPacket (uint8_t flags)
         }
     }
 
-  // XXX TLB Support
-  if (m_TLBEnabled)
-  {
-    if (m_TLBSendSide)
-    {
-      uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-      Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-      uint32_t path = ipv4TLB->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-      // std::cout << this << " Get Path From TLB: " << path << std::endl;
-
-      // XPath Support
-      Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
-      p->AddPacketTag (ipv4XPathTag);
-
-      // TLB Support
-      TcpTLBTag tcpTLBTag;
-      tcpTLBTag.SetPath (path);
-      tcpTLBTag.SetTime (Simulator::Now ());
-      p->AddPacketTag (tcpTLBTag);
-
-      bool synRetrans = hasSyn && (m_synCount != m_synRetries - 1);
-      ipv4TLB->FlowSend (flowId, m_endPoint->GetPeerAddress (), path, p->GetSize (), synRetrans);
-      if (synRetrans)
-      {
-          ipv4TLB->FlowTimeout (flowId, m_endPoint->GetPeerAddress (), path);
-      }
-
-      // Pause Support
-      if (m_isPauseEnabled && m_oldPath == 0)
-      {
-          m_oldPath = path;
-      }
-
-      if (m_isPauseEnabled
-            && !m_isPause
-            && m_oldPath != path)
-      {
-          std::cout << "Turning on pause" << std::endl;
-          m_isPause = true;
-          m_oldPath = path;
-          Time pauseTime = ipv4TLB->GetPauseTime (flowId);
-          Simulator::Schedule (pauseTime, &TcpSocketBase::RecoverFromPause, this);
-      }
-    }
-
-    if (m_piggybackTLBInfo)
-    {
-      TcpTLBTag tcpTLBTag;
-      tcpTLBTag.SetPath (m_TLBPath);
-      tcpTLBTag.SetTime (m_onewayRtt);
-      p->AddPacketTag (tcpTLBTag);
-    }
-
-    if (m_TLBReverseAckEnabled && (hasSyn || isAck) && !m_TLBSendSide)
-    {
-      uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                        m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-      Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-      uint32_t path = ipv4TLB->GetAckPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-
-      // XPath Support
-      Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
-      p->AddPacketTag (ipv4XPathTag);
-    }
-  }
-
-  // XXX Clove Support
-  if (m_CloveEnabled)
+  // XXX Host load balancing, path of the segment and feedback tags
+  if (m_pathSelector)
   {
-    if (m_CloveSendSide)
-    {
-      uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-      Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
-      uint32_t path = ipv4Clove->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-
-      // XPath Support
-      Ipv4XPathTag ipv4XPathTag;
-      ipv4XPathTag.SetPathId (path);
-      p->AddPacketTag (ipv4XPathTag);
-
-      // Clove Support
-      TcpCloveTag tcpCloveTag;
-      tcpCloveTag.SetPath (path);
-      p->AddPacketTag (tcpCloveTag);
-    }
-
-    if (m_piggybackCloveInfo)
-    {
-      TcpCloveTag tcpCloveTag;
-      tcpCloveTag.SetPath (m_ClovePath);
-      p->AddPacketTag (tcpCloveTag);
-    }
+    bool synRetrans = hasSyn && (m_synCount != m_synRetries - 1);
+    UpdatePause (m_pathSelector->SendEmpty (p, flags, synRetrans));
   }
 
   m_txTrace (p, header, this);
 
   if (m_endPoint != 0)
     {
-      TcpSocketBase::AttachFlowId (p, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
+      TcpSocketBase::AttachFlowId (p);
 
       if (m_isPause)
       {
-          std::cout << "Pause enabled, buffering packet..." <<std::endl;
+          NS_LOG_LOGIC (this << " pause enabled, buffering the packet");
           m_pauseBuffer->BufferItem (p, header);
       }
       else
@@ -2787,6 +2659,7 @@ TcpSocketBase::CompleteFork (Ptr<Packet> p, const TcpHeader& h,
                                     InetSocketAddress::ConvertFrom (fromAddress).GetIpv4 (),
                                     InetSocketAddress::ConvertFrom (fromAddress).GetPort ());
       m_endPoint6 = 0;
+      SetupPathSelector (false);
     }
   else if (Inet6SocketAddress::IsMatchingType (toAddress))
     {
@@ -2964,73 +2837,17 @@ TcpSocketBase::SendDataPacket (SequenceNumber32 seq, uint32_t maxSize, bool with
 
   if (m_endPoint)
     {
-      TcpSocketBase::AttachFlowId (p, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-      // XXX TLB Support
-      if (m_TLBEnabled && m_TLBSendSide)
-      {
-        uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        uint32_t path = ipv4TLB->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-        // std::cout << this << " Get Path From TLB: " << path << std::endl;
-
-        // XPath Support
-        Ipv4XPathTag ipv4XPathTag;
-        ipv4XPathTag.SetPathId (path);
-        p->AddPacketTag (ipv4XPathTag);
-
-        // TLB Support
-        TcpTLBTag tcpTLBTag;
-        tcpTLBTag.SetPath (path);
-        tcpTLBTag.SetTime (Simulator::Now ());
-        p->AddPacketTag (tcpTLBTag);
-        ipv4TLB->FlowSend (flowId, m_endPoint->GetPeerAddress (), path, p->GetSize (), isRetransmission);
-
-        // Pause Support
-        if (m_isPauseEnabled && m_oldPath == 0)
-        {
-            m_oldPath = path;
-        }
-        if (m_isPauseEnabled
-            && !m_isPause
-            && m_oldPath != path)
-        {
-            std::cout << "Turning on pause ..." << std::endl;
-            m_isPause = true;
-            m_oldPath = path;
-            Time pauseTime = ipv4TLB->GetPauseTime (flowId);
-            Simulator::Schedule (pauseTime, &TcpSocketBase::RecoverFromPause, this);
-        }
-      }
+      TcpSocketBase::AttachFlowId (p);
 
-      // XXX Clove Support
-      if (m_CloveEnabled)
+      // XXX Host load balancing, path of the segment
+      if (m_pathSelector)
       {
-        if (m_CloveSendSide)
-        {
-          uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                                 m_endPoint->GetPeerAddress (), header.GetSourcePort (), header.GetDestinationPort ());
-
-          Ptr<Ipv4Clove> ipv4Clove = m_node->GetObject<Ipv4Clove> ();
-          uint32_t path = ipv4Clove->GetPath (flowId, m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress ());
-
-          // XPath Support
-          Ipv4XPathTag ipv4XPathTag;
-          ipv4XPathTag.SetPathId (path);
-          p->AddPacketTag (ipv4XPathTag);
-
-          // Clove Support
-          TcpCloveTag tcpCloveTag;
-          tcpCloveTag.SetPath (path);
-          p->AddPacketTag (tcpCloveTag);
-        }
+        UpdatePause (m_pathSelector->SendData (p, isRetransmission));
       }
 
-
       if (m_isPause)
       {
-          std::cout << "Pause enabled, buffering packet ..." <<std::endl;
+          NS_LOG_LOGIC (this << " pause enabled, buffering the packet");
           m_pauseBuffer->BufferItem (p, header);
       }
       else
@@ -3275,30 +3092,10 @@ TcpSocketBase::ReceivedData (Ptr<Packet> p, const TcpHeader& tcpHeader)
     sendflags |= TcpHeader::ECE;
   }
 
-  // XXX TLB Support
-  if (m_TLBEnabled && !m_TLBSendSide)
+  // XXX Host load balancing, path of the data to echo
+  if (m_pathSelector)
   {
-    TcpTLBTag tcpTLBTag;
-    bool found = p->RemovePacketTag(tcpTLBTag);
-    if (found)
-    {
-      m_piggybackTLBInfo = true;
-      m_onewayRtt = Simulator::Now () - tcpTLBTag.GetTime ();
-      m_TLBPath = tcpTLBTag.GetPath ();
-    }
-  }
-
-  // XXX Clove Support
-  if (m_CloveEnabled && !m_CloveSendSide)
-  {
-    TcpCloveTag tcpCloveTag;
-    bool found = p->RemovePacketTag(tcpCloveTag);
-    if (found)
-    {
-      m_piggybackCloveInfo = true;
-      m_ClovePath = tcpCloveTag.GetPath ();
-    }
-
+    m_pathSelector->ReceivedData (p);
   }
 
   // Put into Rx buffer
@@ -3529,8 +3326,7 @@ TcpSocketBase::PersistTimeout ()
 
   if (m_endPoint != 0)
     {
-      TcpSocketBase::AttachFlowId (p, m_endPoint->GetLocalAddress (),
-                         m_endPoint->GetPeerAddress (), tcpHeader.GetSourcePort (), tcpHeader.GetDestinationPort ());
+      TcpSocketBase::AttachFlowId (p);
 
       m_tcp->SendPacket (p, tcpHeader, m_endPoint->GetLocalAddress (),
                          m_endPoint->GetPeerAddress (), m_boundnetdevice);
@@ -3594,13 +3390,10 @@ TcpSocketBase::Retransmit ()
 
   if (m_tcb->m_congState != TcpSocketState::CA_LOSS)
     {
-      // XXX TLB Support
-      if (m_TLBEnabled)
+      // XXX Host load balancing
+      if (m_pathSelector)
       {
-        uint32_t flowId = TcpSocketBase::CalFlowId (m_endPoint->GetLocalAddress (),
-                m_endPoint->GetPeerAddress (), m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
-        Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        ipv4TLB->FlowTimeout (flowId, m_endPoint->GetPeerAddress (), m_pathAcked);
+        m_pathSelector->Timeout ();
       }
       m_tcb->m_congState = TcpSocketState::CA_LOSS;
       m_tcb->m_ssThresh = m_congestionControl->GetSsThresh (m_tcb, BytesInFlight ());
@@ -4075,6 +3868,19 @@ TcpSocketBase::SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo)
   m_congestionControl = algo;
 }
 
+void
+TcpSocketBase::SetPathSelector (Ptr<HostPathSelector> selector)
+{
+  NS_LOG_FUNCTION (this << selector);
+  m_pathSelectorPrototype = selector;
+}
+
+Ptr<HostPathSelector>
+TcpSocketBase::GetPathSelector (void) const
+{
+  return m_pathSelector;
+}
+
 Ptr<TcpSocketBase>
 TcpSocketBase::Fork (void)
 {
@@ -4093,67 +3899,109 @@ TcpSocketBase::SafeSubtraction (uint32_t a, uint32_t b)
 }
 
 void
-TcpSocketBase::AttachFlowId (Ptr<Packet> packet,
-        const Ipv4Address &saddr, const Ipv4Address &daddr, uint16_t sport, uint16_t dport)
+TcpSocketBase::AttachFlowId (Ptr<Packet> packet)
 {
-  // const static uint8_t PROT_NUMBER = 6;
   // XXX Per flow ECMP support
-  // Calculate the flow id and store it in the packet flow id packet tag
+  // Store the flow id in the packet flow id packet tag
   // NOTE Here we do not use the byte tag since we want the flow id tag to be applied to each packet
   // after TCP fragmentation
+  uint32_t flowId;
+  if (m_pathSelector)
+    {
+      // FlowBender moves the flow by changing its flow id
+      flowId = m_pathSelector->GetFlowId ();
+    }
+  else if (m_hasFlowId)
+    {
+      flowId = m_flowId;
+    }
+  else
+    {
+      // A segment sent without a connection, e.g. a RST from a listening socket
+      flowId = CalFlowId (m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress (),
+                          m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
+    }
+  packet->AddPacketTag (FlowIdTag (flowId));
+}
 
-  // uint32_t flowId = 0;
-
-  // flowId ^= saddr.Get();
-  // flowId ^= daddr.Get();
-  // flowId ^= sport;
-  // flowId ^= (dport << 16);
-  // flowId += PROT_NUMBER;
-
-  uint32_t flowId = TcpSocketBase::CalFlowId (saddr, daddr, sport, dport);
-
-  // XXX Flow Bender support
-  if (m_flowBenderEnabled)
-  {
-    uint32_t path = m_flowBender->GetV ();
-    flowId += path;
+void
+TcpSocketBase::SetupPathSelector (bool isSender)
+{
+  NS_LOG_FUNCTION (this << isSender);
+  NS_ASSERT (m_endPoint != 0);
+  m_flowId = CalFlowId (m_endPoint->GetLocalAddress (), m_endPoint->GetPeerAddress (),
+                        m_endPoint->GetLocalPort (), m_endPoint->GetPeerPort ());
+  m_hasFlowId = true;
 
-    // Pause Support
-    if (m_isPauseEnabled && m_oldPath == 0)
+  if (m_pathSelectorPrototype)
     {
-        m_oldPath = path;
+      m_pathSelector = m_pathSelectorPrototype->Fork ();
     }
-    if (m_isPauseEnabled
-            && !m_isPause
-            && m_oldPath != 0
-            && m_oldPath != path)
+  else if (m_TLBEnabled)
     {
-        std::cout << "Turning on pause ..." << std::endl;
-        m_isPause = true;
-        m_oldPath = path;
-        Time pauseTime = m_flowBender->GetPauseTime ();
-        Simulator::Schedule (pauseTime, &TcpSocketBase::RecoverFromPause, this);
+      m_pathSelector = CreateObject<TLBPathSelector> ();
+      m_pathSelector->SetAttribute ("ReverseAck", BooleanValue (m_TLBReverseAckEnabled));
     }
-  }
+  else if (m_CloveEnabled)
+    {
+      m_pathSelector = CreateObject<ClovePathSelector> ();
+    }
+  else if (m_flowBenderEnabled)
+    {
+      m_pathSelector = CreateObject<TcpFlowBender> ();
+    }
+  else
+    {
+      m_pathSelector = 0;
+      return;
+    }
+  m_pathSelector->Setup (m_node, m_flowId, m_endPoint->GetLocalAddress (),
+                         m_endPoint->GetPeerAddress (), isSender);
+}
 
-  packet->AddPacketTag(FlowIdTag(flowId));
+void
+TcpSocketBase::UpdatePause (uint32_t path)
+{
+  if (!m_isPauseEnabled || path == 0)
+    {
+      return;
+    }
+  if (m_oldPath == 0)
+    {
+      m_oldPath = path;
+    }
+  if (!m_isPause && m_oldPath != path)
+    {
+      NS_LOG_LOGIC (this << " path changed to " << path << ", turning on pause");
+      m_isPause = true;
+      m_oldPath = path;
+      Simulator::Schedule (m_pathSelector->GetPauseTime (), &TcpSocketBase::RecoverFromPause, this);
+    }
 }
 
 uint32_t
 TcpSocketBase::CalFlowId (const Ipv4Address &saddr, const Ipv4Address &daddr,
           uint16_t sport, uint16_t dport)
 {
-  std::stringstream hash_string;
-  hash_string << daddr.Get ();
-  hash_string << dport;
+  return m_flowHasher.GetHash (saddr, daddr, sport, dport, TcpL4Protocol::PROT_NUMBER);
+}
 
-  return Hash32 (hash_string.str ());
+void
+TcpSocketBase::SetFlowHashKernel (FlowHasher::HashKernel kernel)
+{
+  m_flowHasher.SetKernel (kernel);
+}
+
+FlowHasher::HashKernel
+TcpSocketBase::GetFlowHashKernel (void) const
+{
+  return m_flowHasher.GetKernel ();
 }
 
 void
 TcpSocketBase::RecoverFromPause (void)
 {
-    std::cout << "Recovering from pause, flushing packets out..." <<std::endl;
+    NS_LOG_LOGIC (this << " recovering from pause, flushing the buffered packets");
     while (m_pauseBuffer->HasBufferedItem ())
     {
         struct TcpPauseItem item = m_pauseBuffer->GetBufferedItem ();
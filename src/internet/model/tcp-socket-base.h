@@ -39,9 +39,9 @@
 #include "rtt-estimator.h"
 #include "tcp-congestion-ops.h"
 #include "tcp-resequence-buffer.h"
-#include "tcp-flow-bender.h"
-#include "ns3/ipv4-tlb.h"
+#include "host-path-selector.h"
 #include "tcp-pause-buffer.h"
+#include "ns3/flow-hasher.h"
 
 namespace ns3 {
 
@@ -389,6 +389,22 @@ public:
    */
   void SetCongestionControlAlgorithm (Ptr<TcpCongestionOps> algo);
 
+  /**
+   * \brief Install a host load balancing scheme on this socket
+   *
+   * Every connection of the socket, and of the sockets it forks, works on
+   * its own Fork of the selector. When no selector is installed, the TLB,
+   * Clove and FlowBender attributes choose one, in that order.
+   *
+   * \param selector the selector to fork for every connection
+   */
+  void SetPathSelector (Ptr<HostPathSelector> selector);
+
+  /**
+   * \returns the selector of the current connection, 0 if none
+   */
+  Ptr<HostPathSelector> GetPathSelector (void) const;
+
   // Necessary implementations of null functions from ns3::Socket
   virtual enum SocketErrno GetErrno (void) const;    // returns m_errno
   virtual enum SocketType GetSocketType (void) const; // returns socket type
@@ -925,12 +941,38 @@ protected:
    */
   static uint32_t SafeSubtraction (uint32_t a, uint32_t b);
 
-  void AttachFlowId (Ptr<Packet> packet, const Ipv4Address &saddr, const Ipv4Address &daddr,
-          uint16_t sport, uint16_t dport);
+  /**
+   * \brief Tag a segment sent through the IPv4 endpoint with the flow id of
+   * the connection, for ECMP
+   */
+  void AttachFlowId (Ptr<Packet> packet);
+
+  /**
+   * \brief Hash the flow id of the connection and bind the path selector
+   * to it, once the IPv4 endpoint is set up
+   * \param isSender true on the end opening the connection
+   */
+  void SetupPathSelector (bool isSender);
+
+  /**
+   * \brief Pause the connection when the path selector moves it to another
+   * path, if the Pause attribute is set
+   * \param path the path of the segment being sent, 0 for none
+   */
+  void UpdatePause (uint32_t path);
 
+  /**
+   * \brief Calculate the flow id from the binary 5-tuple of the connection
+   *
+   * The tuple is hashed in place with the configured FlowHasher kernel, so no
+   * heap allocation takes place on the per-segment path.
+   */
   uint32_t CalFlowId (const Ipv4Address &saddr, const Ipv4Address &daddr,
           uint16_t sport, uint16_t dport);
 
+  void SetFlowHashKernel (FlowHasher::HashKernel kernel);
+  FlowHasher::HashKernel GetFlowHashKernel (void) const;
+
   void RecoverFromPause (void);
 
 protected:
@@ -1015,27 +1057,18 @@ protected:
   bool m_resequenceBufferEnabled;   //!< Whether resequence buffer is enabled
   Ptr<TcpResequenceBuffer>  m_resequenceBuffer;     //!< Resequence buffer
 
-  // Flow Bender
+  // Host load balancing
   bool m_flowBenderEnabled;         //!< Whether the flow bender is enabled
-  Ptr<TcpFlowBender>        m_flowBender;           //!< Flow Bender
-
-  // TLB Support
-  bool                      m_TLBEnabled;
-
-  bool                      m_TLBSendSide;
-  bool                      m_piggybackTLBInfo;
-  Time                      m_onewayRtt;
-  uint32_t                  m_TLBPath;
-
-  uint32_t                  m_pathAcked;
-
-  bool                      m_TLBReverseAckEnabled;
-
-  // Clove Support
-  bool                      m_CloveEnabled;
-  bool                      m_CloveSendSide;
-  bool                      m_piggybackCloveInfo;
-  uint32_t                  m_ClovePath;
+  bool m_TLBEnabled;                //!< Whether TLB is enabled
+  bool m_TLBReverseAckEnabled;      //!< Whether TLB also chooses the path of the ACKs
+  bool m_CloveEnabled;              //!< Whether Clove is enabled
+  Ptr<HostPathSelector>     m_pathSelectorPrototype; //!< Selector forked for every connection
+  Ptr<HostPathSelector>     m_pathSelector;          //!< Selector of the connection
+
+  // Flow id hashing
+  FlowHasher                m_flowHasher;
+  uint32_t                  m_flowId;         //!< Flow id of the connection
+  bool                      m_hasFlowId;      //!< Whether m_flowId is set
 
   // Pause Support
   bool                      m_isPauseEnabled;
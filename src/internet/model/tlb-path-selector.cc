@@ -0,0 +1,182 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "tlb-path-selector.h"
+#include "tcp-header.h"
+#include "ipv4-xpath-tag.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/tcp-tlb-tag.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+#include "ns3/boolean.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TLBPathSelector");
+
+NS_OBJECT_ENSURE_REGISTERED (TLBPathSelector);
+
+TypeId
+TLBPathSelector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::TLBPathSelector")
+    .SetParent<HostPathSelector> ()
+    .SetGroupName ("Internet")
+    .AddConstructor<TLBPathSelector> ()
+    .AddAttribute ("ReverseAck", "Whether the receiver asks TLB for the path of its ACKs",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&TLBPathSelector::m_reverseAck),
+                   MakeBooleanChecker ())
+  ;
+  return tid;
+}
+
+TLBPathSelector::TLBPathSelector ()
+  : HostPathSelector (),
+    m_reverseAck (false),
+    m_pathAcked (0),
+    m_piggyback (false),
+    m_path (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TLBPathSelector::TLBPathSelector (const TLBPathSelector &other)
+  : HostPathSelector (other),
+    m_reverseAck (other.m_reverseAck),
+    m_pathAcked (0),
+    m_piggyback (false),
+    m_path (0)
+{
+  NS_LOG_FUNCTION (this);
+}
+
+TLBPathSelector::~TLBPathSelector ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+TLBPathSelector::DoDispose (void)
+{
+  m_tlb = 0;
+  HostPathSelector::DoDispose ();
+}
+
+Ptr<HostPathSelector>
+TLBPathSelector::Fork (void)
+{
+  return CopyObject<TLBPathSelector> (this);
+}
+
+void
+TLBPathSelector::Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender)
+{
+  HostPathSelector::Setup (node, flowId, saddr, daddr, isSender);
+  m_tlb = node->GetObject<Ipv4TLB> ();
+  NS_ASSERT_MSG (m_tlb != 0, "TLB is enabled on a node without Ipv4TLB");
+}
+
+uint32_t
+TLBPathSelector::SendOnPath (Ptr<Packet> p, bool isRetransmission)
+{
+  uint32_t path = m_tlb->GetPath (m_flowId, m_saddr, m_daddr);
+  NS_LOG_LOGIC (this << " path " << path);
+
+  Ipv4XPathTag ipv4XPathTag;
+  ipv4XPathTag.SetPathId (path);
+  p->AddPacketTag (ipv4XPathTag);
+
+  TcpTLBTag tcpTLBTag;
+  tcpTLBTag.SetPath (path);
+  tcpTLBTag.SetTime (Simulator::Now ());
+  p->AddPacketTag (tcpTLBTag);
+
+  m_tlb->FlowSend (m_flowId, m_daddr, path, p->GetSize (), isRetransmission);
+  return path;
+}
+
+uint32_t
+TLBPathSelector::SendData (Ptr<Packet> p, bool isRetransmission)
+{
+  return m_isSender ? SendOnPath (p, isRetransmission) : 0;
+}
+
+uint32_t
+TLBPathSelector::SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission)
+{
+  uint32_t path = 0;
+  if (m_isSender)
+    {
+      path = SendOnPath (p, isRetransmission);
+      if (isRetransmission)
+        {
+          m_tlb->FlowTimeout (m_flowId, m_daddr, path);
+        }
+    }
+
+  if (m_piggyback)
+    {
+      TcpTLBTag tcpTLBTag;
+      tcpTLBTag.SetPath (m_path);
+      tcpTLBTag.SetTime (m_onewayRtt);
+      p->AddPacketTag (tcpTLBTag);
+    }
+
+  bool hasSyn = flags & TcpHeader::SYN;
+  bool isAck = (flags & ~(TcpHeader::ECE | TcpHeader::CWR)) == TcpHeader::ACK;
+  if (m_reverseAck && (hasSyn || isAck) && !m_isSender)
+    {
+      Ipv4XPathTag ipv4XPathTag;
+      ipv4XPathTag.SetPathId (m_tlb->GetAckPath (m_flowId, m_saddr, m_daddr));
+      p->AddPacketTag (ipv4XPathTag);
+    }
+  return path;
+}
+
+void
+TLBPathSelector::ReceivedData (Ptr<Packet> p)
+{
+  if (m_isSender)
+    {
+      return;
+    }
+  TcpTLBTag tcpTLBTag;
+  if (p->RemovePacketTag (tcpTLBTag))
+    {
+      m_piggyback = true;
+      m_onewayRtt = Simulator::Now () - tcpTLBTag.GetTime ();
+      m_path = tcpTLBTag.GetPath ();
+    }
+}
+
+void
+TLBPathSelector::ReceivedAck (Ptr<Packet> p, uint32_t bytesAcked, bool withECE)
+{
+  if (!m_isSender)
+    {
+      return;
+    }
+  TcpTLBTag tcpTLBTag;
+  if (p->RemovePacketTag (tcpTLBTag))
+    {
+      m_pathAcked = tcpTLBTag.GetPath ();
+      NS_LOG_LOGIC (this << " path acked " << m_pathAcked);
+      m_tlb->FlowRecv (m_flowId, m_pathAcked, m_daddr, bytesAcked, withECE, tcpTLBTag.GetTime ());
+    }
+}
+
+void
+TLBPathSelector::Timeout (void)
+{
+  m_tlb->FlowTimeout (m_flowId, m_daddr, m_pathAcked);
+}
+
+Time
+TLBPathSelector::GetPauseTime (void)
+{
+  return m_tlb->GetPauseTime (m_flowId);
+}
+
+} // namespace ns3
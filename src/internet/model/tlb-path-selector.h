@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_PATH_SELECTOR_H
+#define TLB_PATH_SELECTOR_H
+
+#include "host-path-selector.h"
+
+namespace ns3 {
+
+class Ipv4TLB;
+
+/**
+ * \ingroup tcp
+ *
+ * \brief The TLB scheme on a TCP connection, driving the Ipv4TLB of the node
+ *
+ * The sender asks Ipv4TLB for the path of every segment and stamps it with
+ * the send time in a TcpTLBTag. The receiver echoes the path and the one
+ * way delay of the last data segment on its ACKs, which the sender feeds
+ * back into Ipv4TLB.
+ */
+class TLBPathSelector : public HostPathSelector
+{
+public:
+  static TypeId GetTypeId (void);
+
+  TLBPathSelector ();
+  TLBPathSelector (const TLBPathSelector &other);
+  virtual ~TLBPathSelector ();
+
+  virtual Ptr<HostPathSelector> Fork (void);
+  virtual void Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender);
+
+  virtual uint32_t SendData (Ptr<Packet> p, bool isRetransmission);
+  virtual uint32_t SendEmpty (Ptr<Packet> p, uint8_t flags, bool isRetransmission);
+  virtual void ReceivedData (Ptr<Packet> p);
+  virtual void ReceivedAck (Ptr<Packet> p, uint32_t bytesAcked, bool withECE);
+  virtual void Timeout (void);
+  virtual Time GetPauseTime (void);
+
+protected:
+  virtual void DoDispose (void);
+
+private:
+  /**
+   * \brief Tag a segment of the sender with a path chosen by Ipv4TLB
+   * \returns the path
+   */
+  uint32_t SendOnPath (Ptr<Packet> p, bool isRetransmission);
+
+  bool m_reverseAck;          //!< whether the receiver also chooses the path of its ACKs
+  Ptr<Ipv4TLB> m_tlb;         //!< the TLB of the node
+
+  // Sender
+  uint32_t m_pathAcked;       //!< path of the last segment acknowledged
+
+  // Receiver
+  bool m_piggyback;           //!< whether a TLB tag was received
+  uint32_t m_path;            //!< path of the last data segment
+  Time m_onewayRtt;           //!< one way delay of the last data segment
+};
+
+} // namespace ns3
+
+#endif /* TLB_PATH_SELECTOR_H */
@@ -15,12 +15,19 @@
  */
 
 #include <vector>
+#include <set>
+#include <sstream>
 #include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node.h"
 #include "ns3/node-container.h"
@@ -420,6 +427,215 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun (void)
 }
 
 
+class Ipv4GlobalRoutingParallelTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingParallelTestCase ();
+  virtual ~Ipv4GlobalRoutingParallelTestCase ();
+
+private:
+  std::vector<std::string> GetRoutes (NodeContainer nodes);
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingParallelTestCase::Ipv4GlobalRoutingParallelTestCase ()
+  : TestCase ("Global routes computed on several threads")
+{
+}
+
+Ipv4GlobalRoutingParallelTestCase::~Ipv4GlobalRoutingParallelTestCase ()
+{
+}
+
+std::vector<std::string>
+Ipv4GlobalRoutingParallelTestCase::GetRoutes (NodeContainer nodes)
+{
+  std::vector<std::string> routes;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Ptr<Ipv4GlobalRouting> gr = nodes.Get (i)->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      std::ostringstream oss;
+      for (uint32_t j = 0; j < gr->GetNRoutes (); j++)
+        {
+          oss << *gr->GetRoute (j) << std::endl;
+        }
+      routes.push_back (oss.str ());
+    }
+  return routes;
+}
+
+// A 3x3 grid with its diagonals, so that most routes have several equal
+// cost next hops, and a stub node hanging off the corner.  The routes
+// computed on three threads must be those computed on a single one.
+void
+Ipv4GlobalRoutingParallelTestCase::DoRun (void)
+{
+  NodeContainer grid;
+  grid.Create (9);
+  NodeContainer stub;
+  stub.Create (1);
+  NodeContainer all (grid, stub);
+
+  InternetStackHelper internet;
+  internet.Install (all);
+
+  // Equal cost paths are only supported over point-to-point links
+  SimpleNetDeviceHelper devHelper;
+  devHelper.SetNetDevicePointToPointMode (true);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.0.0", "255.255.255.252");
+  for (uint32_t r = 0; r < 3; r++)
+    {
+      for (uint32_t c = 0; c < 3; c++)
+        {
+          uint32_t n = r * 3 + c;
+          if (c < 2)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (grid.Get (n), grid.Get (n + 1))));
+              ipv4.NewNetwork ();
+            }
+          if (r < 2)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (grid.Get (n), grid.Get (n + 3))));
+              ipv4.NewNetwork ();
+            }
+          if (r < 2 && c < 2)
+            {
+              ipv4.Assign (devHelper.Install (NodeContainer (grid.Get (n), grid.Get (n + 4))));
+              ipv4.NewNetwork ();
+            }
+        }
+    }
+  ipv4.Assign (devHelper.Install (NodeContainer (grid.Get (8), stub.Get (0))));
+
+  Ipv4GlobalRoutingHelper::PopulateRoutingTables (3);
+  std::vector<std::string> parallel = GetRoutes (all);
+
+  GlobalRouteManager::DeleteGlobalRoutes ();
+  GlobalRouteManager::BuildGlobalRoutingDatabase ();
+  GlobalRouteManager::InitializeRoutes ();
+  std::vector<std::string> sequential = GetRoutes (all);
+
+  for (uint32_t i = 0; i < all.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_NE (sequential[i], "", "No routes on node " << i);
+      NS_TEST_EXPECT_MSG_EQ (parallel[i], sequential[i], "Different routes on node " << i);
+    }
+
+  Simulator::Destroy ();
+}
+
+
+class Ipv4GlobalRoutingLookupTestCase : public TestCase
+{
+public:
+  Ipv4GlobalRoutingLookupTestCase ();
+  virtual ~Ipv4GlobalRoutingLookupTestCase ();
+
+private:
+  std::set<Ptr<NetDevice> > GetOutputDevices (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest,
+                                               Ptr<NetDevice> oif);
+  virtual void DoRun (void);
+};
+
+Ipv4GlobalRoutingLookupTestCase::Ipv4GlobalRoutingLookupTestCase ()
+  : TestCase ("Global routes matching a destination with prefixes of different lengths")
+{
+}
+
+Ipv4GlobalRoutingLookupTestCase::~Ipv4GlobalRoutingLookupTestCase ()
+{
+}
+
+// The output devices of the routes picked at random among the candidates
+std::set<Ptr<NetDevice> >
+Ipv4GlobalRoutingLookupTestCase::GetOutputDevices (Ptr<Ipv4GlobalRouting> routing, Ipv4Address dest,
+                                                   Ptr<NetDevice> oif)
+{
+  std::set<Ptr<NetDevice> > devices;
+  Ipv4Header header;
+  header.SetDestination (dest);
+  for (uint32_t i = 0; i < 100; i++)
+    {
+      Socket::SocketErrno sockerr;
+      Ptr<Ipv4Route> route = routing->RouteOutput (Create<Packet> (), header, oif, sockerr);
+      if (route)
+        {
+          devices.insert (route->GetOutputDevice ());
+        }
+    }
+  return devices;
+}
+
+// A node with three interfaces and routes to nested prefixes.  Only the
+// routes to the longest matching prefix are candidates, a requested output
+// device falls back to the less specific routes on this device, and the
+// same holds for the external routes.
+void
+Ipv4GlobalRoutingLookupTestCase::DoRun (void)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.Install (node);
+
+  SimpleNetDeviceHelper devHelper;
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("192.168.1.0", "255.255.255.0");
+  Ptr<NetDevice> dev[4];
+  for (uint32_t i = 1; i <= 3; i++)
+    {
+      NetDeviceContainer devices = devHelper.Install (node);
+      ipv4.Assign (devices);
+      ipv4.NewNetwork ();
+      dev[i] = devices.Get (0);
+    }
+
+  Ptr<Ipv4GlobalRouting> routing = CreateObject<Ipv4GlobalRouting> ();
+  routing->SetAttribute ("RandomEcmpRouting", BooleanValue (true));
+  routing->SetIpv4 (node->GetObject<Ipv4> ());
+  routing->AddNetworkRouteTo ("10.0.0.0", "255.0.0.0", "192.168.1.2", 1);
+  routing->AddNetworkRouteTo ("10.1.0.0", "255.255.0.0", "192.168.2.2", 2);
+  routing->AddASExternalRouteTo ("20.0.0.0", "255.0.0.0", "192.168.1.2", 1);
+  routing->AddASExternalRouteTo ("20.1.0.0", "255.255.0.0", "192.168.2.2", 2);
+
+  std::set<Ptr<NetDevice> > devices = GetOutputDevices (routing, "10.1.2.3", 0);
+  NS_TEST_EXPECT_MSG_EQ (devices.size (), 1, "The less specific network route is a candidate");
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[2]), 1, "The more specific network route is not used");
+
+  devices = GetOutputDevices (routing, "10.2.0.1", 0);
+  NS_TEST_EXPECT_MSG_EQ (devices.size (), 1, "A network route not matching is a candidate");
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[1]), 1, "The matching network route is not used");
+
+  devices = GetOutputDevices (routing, "10.1.2.3", dev[1]);
+  NS_TEST_EXPECT_MSG_EQ (devices.size (), 1, "A route not on the requested device is used");
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[1]), 1, "No fallback to the less specific route on the device");
+
+  devices = GetOutputDevices (routing, "10.1.2.3", dev[3]);
+  NS_TEST_EXPECT_MSG_EQ (devices.size (), 0, "A route found on a device without routes");
+
+  devices = GetOutputDevices (routing, "20.1.2.3", 0);
+  NS_TEST_EXPECT_MSG_EQ (devices.size (), 1, "Several external routes are used");
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[2]), 1, "The more specific external route is not used");
+
+  devices = GetOutputDevices (routing, "20.1.2.3", dev[1]);
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[1]), 1, "No fallback to the less specific external route on the device");
+
+  // A host route takes precedence over the network routes, unless it is
+  // not on the requested device
+  routing->AddHostRouteTo ("10.1.2.3", "192.168.3.2", 3);
+  devices = GetOutputDevices (routing, "10.1.2.3", 0);
+  NS_TEST_EXPECT_MSG_EQ (devices.size (), 1, "Network routes used despite a host route");
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[3]), 1, "The host route is not used");
+
+  devices = GetOutputDevices (routing, "10.1.2.3", dev[2]);
+  NS_TEST_EXPECT_MSG_EQ (devices.count (dev[2]), 1, "No fallback to the network routes on the device");
+
+  routing->Dispose ();
+  Simulator::Destroy ();
+}
+
+
+
 class Ipv4GlobalRoutingTestSuite : public TestSuite
 {
 public:
@@ -431,6 +647,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite ()
 {
   AddTestCase (new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
   AddTestCase (new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingParallelTestCase, TestCase::QUICK);
+  AddTestCase (new Ipv4GlobalRoutingLookupTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -0,0 +1,77 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/test.h"
+#include "ns3/ipv4-lpm-trie.h"
+
+using namespace ns3;
+
+/**
+ * Check that the trie returns the group of the longest matching prefix.
+ */
+class Ipv4LpmTrieTestCase : public TestCase
+{
+public:
+  Ipv4LpmTrieTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+Ipv4LpmTrieTestCase::Ipv4LpmTrieTestCase ()
+  : TestCase ("Longest prefix match returns the most specific equal-cost group")
+{
+}
+
+void
+Ipv4LpmTrieTestCase::DoRun (void)
+{
+  Ipv4LpmTrie<uint32_t> trie;
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.0.0.1")).empty (), true, "Empty trie matched");
+
+  trie.Insert (Ipv4Address ("0.0.0.0"), Ipv4Mask ("0.0.0.0"), 0);
+  trie.Insert (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+  trie.Insert (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 2);
+  trie.Insert (Ipv4Address ("10.1.0.0"), Ipv4Mask ("255.255.0.0"), 3);
+  trie.Insert (Ipv4Address ("10.1.2.0"), Ipv4Mask ("255.255.254.0"), 4);
+  trie.Insert (Ipv4Address ("10.1.2.3"), Ipv4Mask ("255.255.255.255"), 5);
+  NS_TEST_ASSERT_MSG_EQ (trie.GetNPrefixes (), 5, "Equal prefixes not merged");
+
+  Ipv4LpmSpan<uint32_t> span = trie.Lookup (Ipv4Address ("10.1.2.3"));
+  NS_TEST_ASSERT_MSG_EQ (span.size (), 1, "Host route not preferred");
+  NS_TEST_ASSERT_MSG_EQ (span[0], 5, "Host route not preferred");
+
+  span = trie.Lookup (Ipv4Address ("10.1.3.200"));
+  NS_TEST_ASSERT_MSG_EQ (span.size (), 1, "/23 not matched");
+  NS_TEST_ASSERT_MSG_EQ (span[0], 4, "/23 not matched");
+
+  span = trie.Lookup (Ipv4Address ("10.1.4.1"));
+  NS_TEST_ASSERT_MSG_EQ (span.size (), 2, "/16 group incomplete");
+  NS_TEST_ASSERT_MSG_EQ (span[0], 2, "/16 group order");
+  NS_TEST_ASSERT_MSG_EQ (span[1], 3, "/16 group order");
+
+  span = trie.Lookup (Ipv4Address ("10.200.0.1"));
+  NS_TEST_ASSERT_MSG_EQ (span[0], 1, "/8 not matched");
+
+  span = trie.Lookup (Ipv4Address ("192.168.0.1"));
+  NS_TEST_ASSERT_MSG_EQ (span[0], 0, "Default route not matched");
+
+  // Insertion after a lookup rebuilds the trie
+  trie.Insert (Ipv4Address ("192.168.0.0"), Ipv4Mask ("255.255.255.0"), 6);
+  span = trie.Lookup (Ipv4Address ("192.168.0.1"));
+  NS_TEST_ASSERT_MSG_EQ (span[0], 6, "Trie not rebuilt after insertion");
+
+  trie.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (trie.Lookup (Ipv4Address ("10.1.2.3")).empty (), true, "Cleared trie matched");
+}
+
+class Ipv4LpmTrieTestSuite : public TestSuite
+{
+public:
+  Ipv4LpmTrieTestSuite ();
+};
+
+Ipv4LpmTrieTestSuite::Ipv4LpmTrieTestSuite ()
+  : TestSuite ("ipv4-lpm-trie", UNIT)
+{
+  AddTestCase (new Ipv4LpmTrieTestCase, TestCase::QUICK);
+}
+
+static Ipv4LpmTrieTestSuite g_ipv4LpmTrieTestSuite;
@@ -0,0 +1,141 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/ipv4-next-hop-table.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/node-container.h"
+#include "ns3/packet.h"
+#include "ns3/socket.h"
+
+using namespace ns3;
+
+/**
+ * Check that the table resolves the route of a point-to-point port to the
+ * peer interface, shares it between lookups, and misses on the ports
+ * without a configured peer. Forward hands the packet to the forwarding
+ * callback on a hit and to the error callback on a miss.
+ */
+class Ipv4NextHopTableTestCase : public TestCase
+{
+public:
+  Ipv4NextHopTableTestCase ();
+private:
+  virtual void DoRun (void);
+  /// Record a forwarded packet
+  void Forwarded (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header);
+  /// Record a dropped packet
+  void Dropped (Ptr<const Packet> packet, const Ipv4Header &header, Socket::SocketErrno error);
+
+  Ptr<Ipv4Route> m_forwarded; //!< route of the last forwarded packet
+  uint32_t m_nDropped;        //!< packets dropped without route
+};
+
+Ipv4NextHopTableTestCase::Ipv4NextHopTableTestCase ()
+  : TestCase ("Next hop routes resolved per port and shared"),
+    m_nDropped (0)
+{
+}
+
+void
+Ipv4NextHopTableTestCase::Forwarded (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  m_forwarded = route;
+}
+
+void
+Ipv4NextHopTableTestCase::Dropped (Ptr<const Packet> packet, const Ipv4Header &header, Socket::SocketErrno error)
+{
+  NS_TEST_EXPECT_MSG_EQ (error, Socket::ERROR_NOROUTETOHOST, "Wrong drop reason");
+  m_nDropped++;
+}
+
+void
+Ipv4NextHopTableTestCase::DoRun (void)
+{
+  // Interface 1 of the router is a link to the peer, interface 2 a link to
+  // a node without address yet, interface 3 a shared channel
+  NodeContainer nodes;
+  nodes.Create (5);
+  InternetStackHelper internet;
+  internet.Install (nodes);
+  SimpleNetDeviceHelper devices;
+  NetDeviceContainer link = devices.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  NetDeviceContainer pending = devices.Install (NodeContainer (nodes.Get (0), nodes.Get (2)));
+  NetDeviceContainer shared = devices.Install (NodeContainer (nodes.Get (0), nodes.Get (3), nodes.Get (4)));
+
+  Ipv4AddressHelper addresses;
+  addresses.SetBase ("10.1.1.0", "255.255.255.0");
+  addresses.Assign (link);
+  addresses.SetBase ("10.1.2.0", "255.255.255.0");
+  addresses.Assign (NetDeviceContainer (pending.Get (0)));
+  addresses.SetBase ("10.1.3.0", "255.255.255.0");
+  addresses.Assign (shared);
+
+  Ptr<Ipv4> ipv4 = nodes.Get (0)->GetObject<Ipv4> ();
+  Ipv4NextHopTable table;
+  table.SetIpv4 (ipv4);
+
+  // Hit: the route of the port goes to the peer interface
+  Ptr<Ipv4Route> route = table.Lookup (1);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "No route through the point-to-point port");
+  NS_TEST_EXPECT_MSG_EQ (route->GetOutputDevice (), link.Get (0), "Wrong output device");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), Ipv4Address ("10.1.1.2"), "Gateway is not the peer interface");
+  NS_TEST_EXPECT_MSG_EQ (route->GetSource (), Ipv4Address ("10.1.1.1"), "Source is not the port address");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (1), route, "Route of the port not shared");
+
+  // Miss: loopback, no interface, shared channel, peer without address
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (0), 0, "Route through the loopback");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (10), 0, "Route through a missing interface");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (3), 0, "Route through a shared channel");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (2), 0, "Route to a peer without address");
+
+  // A miss is not cached, the port resolves once the peer is configured
+  addresses.SetBase ("10.1.2.0", "255.255.255.0", "0.0.0.2");
+  addresses.Assign (NetDeviceContainer (pending.Get (1)));
+  route = table.Lookup (2);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "Miss cached");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), Ipv4Address ("10.1.2.2"), "Gateway is not the peer interface");
+
+  // A hit is cached until the port is invalidated
+  Ptr<Ipv4> peer = nodes.Get (1)->GetObject<Ipv4> ();
+  int32_t peerIf = peer->GetInterfaceForDevice (link.Get (1));
+  peer->RemoveAddress (peerIf, 0);
+  peer->AddAddress (peerIf, Ipv4InterfaceAddress (Ipv4Address ("10.1.1.3"), Ipv4Mask ("255.255.255.0")));
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (1)->GetGateway (), Ipv4Address ("10.1.1.2"), "Hit not cached");
+  table.Invalidate (1);
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (1)->GetGateway (), Ipv4Address ("10.1.1.3"), "Port not resolved again");
+  NS_TEST_EXPECT_MSG_EQ (table.Lookup (2), route, "Other port invalidated");
+
+  // Forward uses the route of the port, or drops the packet
+  Ipv4RoutingProtocol::UnicastForwardCallback ucb = MakeCallback (&Ipv4NextHopTableTestCase::Forwarded, this);
+  Ipv4RoutingProtocol::ErrorCallback ecb = MakeCallback (&Ipv4NextHopTableTestCase::Dropped, this);
+  Ptr<Packet> packet = Create<Packet> (100);
+  Ipv4Header header;
+  NS_TEST_EXPECT_MSG_EQ (table.Forward (2, packet, header, ucb, ecb), true, "Packet not forwarded");
+  NS_TEST_EXPECT_MSG_EQ (m_forwarded, route, "Packet forwarded on another route");
+  NS_TEST_EXPECT_MSG_EQ (table.Forward (3, packet, header, ucb, ecb), false, "Packet forwarded without route");
+  NS_TEST_EXPECT_MSG_EQ (m_nDropped, 1, "Packet without route not dropped");
+
+  table.Clear ();
+  NS_TEST_EXPECT_MSG_NE (table.Lookup (2), route, "Table not cleared");
+
+  Simulator::Destroy ();
+  Ipv4AddressGenerator::Reset ();
+}
+
+class Ipv4NextHopTableTestSuite : public TestSuite
+{
+public:
+  Ipv4NextHopTableTestSuite ();
+};
+
+Ipv4NextHopTableTestSuite::Ipv4NextHopTableTestSuite ()
+  : TestSuite ("ipv4-next-hop-table", UNIT)
+{
+  AddTestCase (new Ipv4NextHopTableTestCase, TestCase::QUICK);
+}
+
+static Ipv4NextHopTableTestSuite g_ipv4NextHopTableTestSuite;
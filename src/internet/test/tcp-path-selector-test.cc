@@ -0,0 +1,200 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+#include "tcp-general-test.h"
+#include "ns3/host-path-selector.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/node.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpPathSelectorTestSuite");
+
+class CountingPathSelector;
+
+/**
+ * \brief Check the hooks of a HostPathSelector installed on both ends
+ *
+ * Both sockets get a CountingPathSelector. Each end must bind its own fork
+ * once, with the right side, the data segments chosen by the sender must
+ * reach the receiver hook, the acknowledged bytes must reach PktsAcked, and
+ * the segments must carry the flow id given by the selector.
+ */
+class TcpPathSelectorTest : public TcpGeneralTest
+{
+public:
+  TcpPathSelectorTest (const std::string &desc);
+
+  uint32_t m_senderSetups;      //!< Setup calls with isSender
+  uint32_t m_receiverSetups;    //!< Setup calls without isSender
+  uint32_t m_dataSent;          //!< SendData calls of the sender
+  uint32_t m_dataReceived;      //!< ReceivedData calls of the receiver
+  uint32_t m_bytesAcked;        //!< bytes passed to PktsAcked
+
+protected:
+  virtual Ptr<TcpSocketMsgBase> CreateSenderSocket (Ptr<Node> node);
+  virtual Ptr<TcpSocketMsgBase> CreateReceiverSocket (Ptr<Node> node);
+  virtual void Rx (const Ptr<const Packet> p, const TcpHeader&h, SocketWho who);
+
+  virtual void ConfigureEnvironment ();
+
+  void FinalChecks ();
+
+private:
+  uint32_t m_highAck;           //!< last ACK number received by the sender
+  uint32_t m_badFlowIds;        //!< segments received without the selector flow id
+};
+
+/**
+ * \brief Counts the calls to its hooks in a TcpPathSelectorTest, and gives
+ * the segments a fixed flow id
+ */
+class CountingPathSelector : public HostPathSelector
+{
+public:
+  static const uint32_t FLOW_ID = 0xbeef;
+
+  static TypeId GetTypeId (void);
+  CountingPathSelector ()
+    : m_test (0)
+  {
+  }
+  CountingPathSelector (const CountingPathSelector &other)
+    : HostPathSelector (other),
+      m_test (other.m_test)
+  {
+  }
+  void SetTest (TcpPathSelectorTest *test)
+  {
+    m_test = test;
+  }
+
+  virtual Ptr<HostPathSelector> Fork (void)
+  {
+    return CopyObject<CountingPathSelector> (this);
+  }
+  virtual void Setup (Ptr<Node> node, uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr, bool isSender)
+  {
+    HostPathSelector::Setup (node, flowId, saddr, daddr, isSender);
+    isSender ? m_test->m_senderSetups++ : m_test->m_receiverSetups++;
+  }
+  virtual uint32_t GetFlowId (void) const
+  {
+    return FLOW_ID;
+  }
+  virtual uint32_t SendData (Ptr<Packet> p, bool isRetransmission)
+  {
+    if (m_isSender)
+      {
+        m_test->m_dataSent++;
+      }
+    return 0;
+  }
+  virtual void ReceivedData (Ptr<Packet> p)
+  {
+    if (!m_isSender)
+      {
+        m_test->m_dataReceived++;
+      }
+  }
+  virtual void PktsAcked (SequenceNumber32 highTxMark, SequenceNumber32 ackNumber,
+                          uint32_t bytesAcked, bool withECE)
+  {
+    m_test->m_bytesAcked += bytesAcked;
+  }
+
+private:
+  TcpPathSelectorTest *m_test;
+};
+
+TypeId
+CountingPathSelector::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::CountingPathSelector")
+    .SetParent<HostPathSelector> ()
+    .AddConstructor<CountingPathSelector> ()
+    .SetGroupName ("Internet")
+  ;
+  return tid;
+}
+
+TcpPathSelectorTest::TcpPathSelectorTest (const std::string &desc)
+  : TcpGeneralTest (desc),
+    m_senderSetups (0),
+    m_receiverSetups (0),
+    m_dataSent (0),
+    m_dataReceived (0),
+    m_bytesAcked (0),
+    m_highAck (0),
+    m_badFlowIds (0)
+{
+}
+
+void
+TcpPathSelectorTest::ConfigureEnvironment ()
+{
+  TcpGeneralTest::ConfigureEnvironment ();
+  SetAppPktCount (20);
+  SetMTU (500);
+}
+
+Ptr<TcpSocketMsgBase>
+TcpPathSelectorTest::CreateSenderSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> s = TcpGeneralTest::CreateSenderSocket (node);
+  Ptr<CountingPathSelector> selector = CreateObject<CountingPathSelector> ();
+  selector->SetTest (this);
+  s->SetPathSelector (selector);
+  return s;
+}
+
+Ptr<TcpSocketMsgBase>
+TcpPathSelectorTest::CreateReceiverSocket (Ptr<Node> node)
+{
+  Ptr<TcpSocketMsgBase> s = TcpGeneralTest::CreateReceiverSocket (node);
+  Ptr<CountingPathSelector> selector = CreateObject<CountingPathSelector> ();
+  selector->SetTest (this);
+  s->SetPathSelector (selector);
+  return s;
+}
+
+void
+TcpPathSelectorTest::Rx (const Ptr<const Packet> p, const TcpHeader &h, SocketWho who)
+{
+  FlowIdTag flowIdTag;
+  if (!p->PeekPacketTag (flowIdTag) || flowIdTag.GetFlowId () != CountingPathSelector::FLOW_ID)
+    {
+      m_badFlowIds++;
+    }
+  if (who == SENDER && (!(h.GetFlags () & TcpHeader::SYN)))
+    {
+      m_highAck = h.GetAckNumber ().GetValue ();
+    }
+}
+
+void
+TcpPathSelectorTest::FinalChecks ()
+{
+  NS_TEST_ASSERT_MSG_EQ (m_senderSetups, 1, "The sender selector was not set up once");
+  NS_TEST_ASSERT_MSG_EQ (m_receiverSetups, 1, "The receiver selector was not set up once");
+  NS_TEST_ASSERT_MSG_GT (m_dataSent, 0, "No data segment went through the sender selector");
+  NS_TEST_ASSERT_MSG_EQ (m_dataReceived, m_dataSent,
+                         "Not all data segments went through the receiver selector");
+  NS_TEST_ASSERT_MSG_EQ (m_bytesAcked / GetSegSize (SENDER), m_highAck / GetSegSize (SENDER),
+                         "Not all acked bytes have been passed to PktsAcked");
+  NS_TEST_ASSERT_MSG_EQ (m_badFlowIds, 0, "Segments without the flow id of the selector");
+}
+
+//-----------------------------------------------------------------------------
+
+static class TcpPathSelectorTestSuite : public TestSuite
+{
+public:
+  TcpPathSelectorTestSuite () : TestSuite ("tcp-path-selector-test", UNIT)
+  {
+    AddTestCase (new TcpPathSelectorTest ("Host path selector hooks on both ends"),
+                 TestCase::QUICK);
+  }
+} g_TcpPathSelectorTestSuite;
+
+} // namespace ns3
@@ -0,0 +1,319 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/packet.h"
+#include "ns3/tcp-header.h"
+#include "ns3/tcp-socket-base.h"
+#include "ns3/tcp-resequence-buffer.h"
+#include "ns3/uinteger.h"
+#include "ns3/log.h"
+
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TcpResequenceBufferTestSuite");
+
+/**
+ * \brief Socket recording the segments forwarded up by its resequence buffer
+ */
+class ResequenceSink : public TcpSocketBase
+{
+public:
+  /// A segment forwarded up, with the time and the reason of its flush
+  struct Delivery
+  {
+    uint32_t seq;
+    Time time;
+    TcpRBPopReason reason;
+  };
+
+  std::vector<Delivery> m_delivered;  //!< Segments forwarded up, in order
+
+  void Flush (uint32_t flowId, Time time, SequenceNumber32 seq,
+              uint32_t inOrderLength, uint32_t outOrderLength, TcpRBPopReason reason);
+
+protected:
+  virtual void DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
+                            const Address &toAddress);
+
+private:
+  TcpRBPopReason m_reason;  //!< Reason of the flush in progress
+};
+
+void
+ResequenceSink::Flush (uint32_t flowId, Time time, SequenceNumber32 seq,
+                       uint32_t inOrderLength, uint32_t outOrderLength, TcpRBPopReason reason)
+{
+  m_reason = reason;
+}
+
+void
+ResequenceSink::DoForwardUp (Ptr<Packet> packet, const Address &fromAddress,
+                             const Address &toAddress)
+{
+  TcpHeader header;
+  packet->PeekHeader (header);
+  Delivery delivery = { header.GetSequenceNumber ().GetValue (), Simulator::Now (), m_reason };
+  m_delivered.push_back (delivery);
+}
+
+/**
+ * \brief Common part of the resequence buffer tests
+ *
+ * The segments of 1000 bytes are given to the buffer of a ResequenceSink at
+ * the scheduled times, with the default time limits of 20 us for the in
+ * order queue and 50 us for the out of order one.
+ */
+class TcpResequenceBufferTestBase : public TestCase
+{
+public:
+  TcpResequenceBufferTestBase (const std::string &desc);
+
+protected:
+  virtual void DoSetup (void);
+  virtual void DoTeardown (void);
+
+  /// Give the segment seq to the buffer at the time (in us)
+  void Send (uint32_t seq, uint32_t us);
+  void DoSend (uint32_t seq);
+
+  /// Check the nth segment forwarded up
+  void CheckDelivery (uint32_t n, uint32_t seq, uint32_t us, TcpRBPopReason reason);
+
+  Ptr<ResequenceSink> m_sink;
+  Ptr<TcpResequenceBuffer> m_buffer;
+};
+
+TcpResequenceBufferTestBase::TcpResequenceBufferTestBase (const std::string &desc)
+  : TestCase (desc)
+{
+}
+
+void
+TcpResequenceBufferTestBase::DoSetup (void)
+{
+  m_sink = CreateObject<ResequenceSink> ();
+  m_buffer = m_sink->GetResequenceBuffer ();
+  m_buffer->TraceConnectWithoutContext ("Flush", MakeCallback (&ResequenceSink::Flush, m_sink));
+}
+
+void
+TcpResequenceBufferTestBase::DoTeardown (void)
+{
+  m_buffer->Stop ();
+  m_buffer = 0;
+  m_sink = 0;
+  Simulator::Destroy ();
+}
+
+void
+TcpResequenceBufferTestBase::Send (uint32_t seq, uint32_t us)
+{
+  Simulator::Schedule (MicroSeconds (us), &TcpResequenceBufferTestBase::DoSend, this, seq);
+}
+
+void
+TcpResequenceBufferTestBase::DoSend (uint32_t seq)
+{
+  Ptr<Packet> packet = Create<Packet> (1000);
+  TcpHeader header;
+  header.SetSequenceNumber (SequenceNumber32 (seq));
+  header.SetFlags (TcpHeader::ACK);
+  packet->AddHeader (header);
+  m_buffer->BufferPacket (packet, Address (), Address ());
+}
+
+void
+TcpResequenceBufferTestBase::CheckDelivery (uint32_t n, uint32_t seq, uint32_t us, TcpRBPopReason reason)
+{
+  NS_TEST_ASSERT_MSG_LT (n, m_sink->m_delivered.size (), "Segment " << seq << " not forwarded up");
+  NS_TEST_EXPECT_MSG_EQ (m_sink->m_delivered[n].seq, seq, "Wrong segment forwarded up at position " << n);
+  NS_TEST_EXPECT_MSG_EQ (m_sink->m_delivered[n].time, MicroSeconds (us), "Segment " << seq << " forwarded up at the wrong time");
+  NS_TEST_EXPECT_MSG_EQ (m_sink->m_delivered[n].reason, reason, "Segment " << seq << " flushed for a wrong reason");
+}
+
+/**
+ * \brief In order segments are held until the in order queue times out, or
+ * fills up
+ */
+class TcpResequenceBufferInOrderTest : public TcpResequenceBufferTestBase
+{
+public:
+  TcpResequenceBufferInOrderTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferInOrderTest::TcpResequenceBufferInOrderTest ()
+  : TcpResequenceBufferTestBase ("In order segments pass through the buffer")
+{
+}
+
+void
+TcpResequenceBufferInOrderTest::DoRun (void)
+{
+  Send (1, 1);
+  Send (1001, 1);
+  Send (2001, 1);
+  Simulator::Stop (MicroSeconds (30));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered.size (), 3, "In order segments not forwarded up");
+  CheckDelivery (0, 1, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (1, 1001, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (2, 2001, 21, IN_ORDER_TIMEOUT);
+
+  // A full in order queue is flushed at once
+  m_buffer->SetAttribute ("SizeLimit", UintegerValue (2000));
+  Send (3001, 10);
+  Send (4001, 11);
+  Simulator::Stop (MicroSeconds (20));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered.size (), 5, "Full in order queue not flushed");
+  CheckDelivery (3, 3001, 41, IN_ORDER_FULL);
+  CheckDelivery (4, 4001, 41, IN_ORDER_FULL);
+}
+
+/**
+ * \brief Out of order segments wait for the hole to be filled, then go up in
+ * sequence with the in order queue
+ */
+class TcpResequenceBufferHoleTest : public TcpResequenceBufferTestBase
+{
+public:
+  TcpResequenceBufferHoleTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferHoleTest::TcpResequenceBufferHoleTest ()
+  : TcpResequenceBufferTestBase ("A filled hole drains the out of order segments")
+{
+}
+
+void
+TcpResequenceBufferHoleTest::DoRun (void)
+{
+  Send (1, 1);
+  Send (3001, 2);
+  Send (2001, 3);
+  Send (1001, 4);
+  Simulator::Stop (MicroSeconds (100));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered.size (), 4, "Segments not forwarded up once each");
+  CheckDelivery (0, 1, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (1, 1001, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (2, 2001, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (3, 3001, 21, IN_ORDER_TIMEOUT);
+}
+
+/**
+ * \brief Duplicates of buffered segments are dropped, retransmissions of
+ * flushed segments go up at once
+ */
+class TcpResequenceBufferDuplicateTest : public TcpResequenceBufferTestBase
+{
+public:
+  TcpResequenceBufferDuplicateTest ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TcpResequenceBufferDuplicateTest::TcpResequenceBufferDuplicateTest ()
+  : TcpResequenceBufferTestBase ("Duplicate and retransmitted segments")
+{
+}
+
+void
+TcpResequenceBufferDuplicateTest::DoRun (void)
+{
+  Send (1, 1);
+  Send (1001, 2);
+  Send (1001, 3);   // Duplicate of an in order segment
+  Send (3001, 30);
+  Send (3001, 30);  // Duplicate of an out of order segment
+  Send (1001, 31);  // Retransmission of a flushed segment
+  Send (2001, 32);
+  Simulator::Stop (MicroSeconds (100));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered.size (), 5, "Segments not forwarded up once each");
+  CheckDelivery (0, 1, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (1, 1001, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (2, 1001, 31, RE_TRANS);
+  CheckDelivery (3, 2001, 51, IN_ORDER_TIMEOUT);
+  CheckDelivery (4, 3001, 51, IN_ORDER_TIMEOUT);
+}
+
+/**
+ * \brief Out of order segments go up in sequence when their queue times out,
+ * the timer following only the queues holding segments
+ */
+class TcpResequenceBufferTimerTest : public TcpResequenceBufferTestBase
+{
+public:
+  TcpResequenceBufferTimerTest ();
+
+private:
+  virtual void DoRun (void);
+  void CheckTimer (uint32_t us);
+};
+
+TcpResequenceBufferTimerTest::TcpResequenceBufferTimerTest ()
+  : TcpResequenceBufferTestBase ("Out of order segments flushed on timeout")
+{
+}
+
+void
+TcpResequenceBufferTimerTest::CheckTimer (uint32_t us)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_buffer->m_timerEvent.IsRunning (), true, "Timer not armed");
+  NS_TEST_EXPECT_MSG_EQ (m_buffer->m_timerDeadline, MicroSeconds (us), "Timer armed for a wrong deadline");
+}
+
+void
+TcpResequenceBufferTimerTest::DoRun (void)
+{
+  Send (1, 1);
+  Send (5001, 5);
+  Send (2001, 6);
+  Send (4001, 7);
+  // Once the in order queue is flushed, only the out of order deadline
+  // remains
+  Simulator::Schedule (MicroSeconds (30), &TcpResequenceBufferTimerTest::CheckTimer, this, 51);
+  Simulator::Stop (MicroSeconds (100));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_sink->m_delivered.size (), 4, "Segments not forwarded up once each");
+  CheckDelivery (0, 1, 21, IN_ORDER_TIMEOUT);
+  CheckDelivery (1, 2001, 51, OUT_ORDER_TIMEOUT);
+  CheckDelivery (2, 4001, 51, OUT_ORDER_TIMEOUT);
+  CheckDelivery (3, 5001, 51, OUT_ORDER_TIMEOUT);
+  NS_TEST_EXPECT_MSG_EQ (m_buffer->m_timerEvent.IsRunning (), false, "Timer armed on an empty buffer");
+}
+
+/**
+ * \brief TCP resequence buffer TestSuite
+ */
+class TcpResequenceBufferTestSuite : public TestSuite
+{
+public:
+  TcpResequenceBufferTestSuite () : TestSuite ("tcp-resequence-buffer", UNIT)
+  {
+    AddTestCase (new TcpResequenceBufferInOrderTest, TestCase::QUICK);
+    AddTestCase (new TcpResequenceBufferHoleTest, TestCase::QUICK);
+    AddTestCase (new TcpResequenceBufferDuplicateTest, TestCase::QUICK);
+    AddTestCase (new TcpResequenceBufferTimerTest, TestCase::QUICK);
+  }
+};
+
+static TcpResequenceBufferTestSuite g_tcpResequenceBufferTestSuite;
+
+} // namespace ns3
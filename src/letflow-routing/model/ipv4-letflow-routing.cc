@@ -8,6 +8,7 @@
 #include "ns3/channel.h"
 #include "ns3/node.h"
 #include "ns3/flow-id-tag.h"
+#include "ns3/uinteger.h"
 
 #include <algorithm>
 
@@ -22,6 +23,8 @@ Ipv4LetFlowRouting::Ipv4LetFlowRouting ():
     m_ipv4 (0)
 {
   NS_LOG_FUNCTION (this);
+  m_flowletTable.SetTimeout (m_flowletTimeout);
+  m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4LetFlowRouting::~Ipv4LetFlowRouting ()
@@ -36,6 +39,11 @@ Ipv4LetFlowRouting::GetTypeId (void)
       .SetParent<Object>()
       .SetGroupName ("Internet")
       .AddConstructor<Ipv4LetFlowRouting> ()
+      .AddAttribute ("FlowletTableSize", "The number of entries of the flowlet table",
+                     UintegerValue (4096),
+                     MakeUintegerAccessor (&Ipv4LetFlowRouting::SetFlowletTableSize,
+                                           &Ipv4LetFlowRouting::GetFlowletTableSize),
+                     MakeUintegerChecker<uint32_t> (FlowletTable::WAYS))
   ;
 
   return tid;
@@ -45,49 +53,46 @@ void
 Ipv4LetFlowRouting::AddRoute (Ipv4Address network, Ipv4Mask networkMask, uint32_t port)
 {
   NS_LOG_LOGIC (this << " Add LetFlow routing entry: " << network << "/" << networkMask << " would go through port: " << port);
-  LetFlowRouteEntry letFlowRouteEntry;
-  letFlowRouteEntry.network = network;
-  letFlowRouteEntry.networkMask = networkMask;
-  letFlowRouteEntry.port = port;
-  m_routeEntryList.push_back (letFlowRouteEntry);
+  m_routeLookup.Insert (network, networkMask, port);
 }
 
-std::vector<LetFlowRouteEntry>
-Ipv4LetFlowRouting::LookupLetFlowRouteEntries (Ipv4Address dest)
+int64_t
+Ipv4LetFlowRouting::AssignStreams (int64_t stream)
 {
-  std::vector<LetFlowRouteEntry> letFlowRouteEntries;
-  std::vector<LetFlowRouteEntry>::iterator itr = m_routeEntryList.begin ();
-  for ( ; itr != m_routeEntryList.end (); ++itr)
-  {
-    if((*itr).networkMask.IsMatch(dest, (*itr).network))
-    {
-      letFlowRouteEntries.push_back (*itr);
-    }
-  }
-  return letFlowRouteEntries;
+  NS_LOG_FUNCTION (this << stream);
+  m_rand->SetStream (stream);
+  return 1;
 }
 
-Ptr<Ipv4Route>
-Ipv4LetFlowRouting::ConstructIpv4Route (uint32_t port, Ipv4Address destAddress)
-{
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (port);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress(nextIf,0).GetLocal();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (port));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (port, 0).GetLocal ());
-  route->SetDestination (destAddress);
-  return route;
+Ipv4LpmSpan<uint32_t>
+Ipv4LetFlowRouting::LookupLetFlowRouteEntries (Ipv4Address dest)
+{
+  return m_routeLookup.Lookup (dest);
 }
 
 void
 Ipv4LetFlowRouting::SetFlowletTimeout (Time timeout)
 {
   m_flowletTimeout = timeout;
+  m_flowletTable.SetTimeout (timeout);
+}
+
+void
+Ipv4LetFlowRouting::SetFlowletTableSize (uint32_t nEntries)
+{
+  m_flowletTable.SetSize (nEntries);
+}
+
+uint32_t
+Ipv4LetFlowRouting::GetFlowletTableSize (void) const
+{
+  return m_flowletTable.GetSize ();
+}
+
+const FlowletTable &
+Ipv4LetFlowRouting::GetFlowletTable (void) const
+{
+  return m_flowletTable;
 }
 
 Ptr<Ipv4Route>
@@ -140,7 +145,7 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   }
   flowId = flowIdTag.GetFlowId ();
 
-  std::vector<LetFlowRouteEntry> routeEntries = Ipv4LetFlowRouting::LookupLetFlowRouteEntries (destAddress);
+  Ipv4LpmSpan<uint32_t> routeEntries = Ipv4LetFlowRouting::LookupLetFlowRouteEntries (destAddress);
 
   if (routeEntries.empty ())
   {
@@ -152,61 +157,56 @@ Ipv4LetFlowRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, P
   uint32_t selectedPort;
 
   // If the flowlet table entry is valid, return the port
-  std::map<uint32_t, struct LetFlowFlowlet>::iterator flowletItr = m_flowletTable.find (flowId);
-  if (flowletItr != m_flowletTable.end ())
+  FlowletEntry *flowlet = m_flowletTable.Lookup (flowId);
+  if (flowlet != NULL)
   {
-    LetFlowFlowlet flowlet = flowletItr->second;
-    if (now - flowlet.activeTime <= m_flowletTimeout)
+    if (now - flowlet->activeTime <= m_flowletTimeout)
     {
       // Do not forget to update the flowlet active time
-      flowlet.activeTime = now;
+      flowlet->activeTime = now;
 
       // Return the port information used for routing routine to select the port
-      selectedPort = flowlet.port;
-
-      Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
-      ucb (route, packet, header);
+      selectedPort = flowlet->port;
 
-      m_flowletTable[flowId] = flowlet;
-
-      return true;
+      return m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb);
     }
   }
+  else
+  {
+    flowlet = m_flowletTable.Insert (flowId, now);
+  }
 
   // Not hit. Random Select the Port
-  selectedPort = routeEntries[rand () % routeEntries.size ()].port;
-
-  LetFlowFlowlet flowlet;
-
-  flowlet.port = selectedPort;
-  flowlet.activeTime = now;
-
-  Ptr<Ipv4Route> route = Ipv4LetFlowRouting::ConstructIpv4Route (selectedPort, destAddress);
-  ucb (route, packet, header);
+  selectedPort = routeEntries[m_rand->GetInteger (0, routeEntries.size () - 1)];
 
-  m_flowletTable[flowId] = flowlet;
+  flowlet->port = selectedPort;
+  flowlet->activeTime = now;
 
-  return true;
+  return m_nextHopTable.Forward (selectedPort, packet, header, ucb, ecb);
 }
 
 void
 Ipv4LetFlowRouting::NotifyInterfaceUp (uint32_t interface)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4LetFlowRouting::NotifyInterfaceDown (uint32_t interface)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4LetFlowRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4LetFlowRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
@@ -215,6 +215,7 @@ Ipv4LetFlowRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_nextHopTable.SetIpv4 (ipv4);
 }
 
 void
@@ -227,6 +228,9 @@ void
 Ipv4LetFlowRouting::DoDispose (void)
 {
   m_ipv4=0;
+  m_nextHopTable.Clear ();
+  m_routeLookup.Clear ();
+  m_flowletTable.Clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
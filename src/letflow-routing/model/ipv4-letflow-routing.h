@@ -4,26 +4,19 @@
 
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-route.h"
+#include "ns3/ipv4-next-hop-table.h"
+#include "ns3/ipv4-lpm-trie.h"
+#include "ns3/flowlet-table.h"
 #include "ns3/object.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/data-rate.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 
 namespace ns3 {
 
-struct LetFlowFlowlet {
-  uint32_t port;
-  Time activeTime;
-};
-
-struct LetFlowRouteEntry {
-  Ipv4Address network;
-  Ipv4Mask networkMask;
-  uint32_t port;
-};
-
 class Ipv4LetFlowRouting : public Ipv4RoutingProtocol
 {
 public:
@@ -48,11 +41,17 @@ public:
 
   virtual void DoDispose (void);
 
-  std::vector<LetFlowRouteEntry> LookupLetFlowRouteEntries (Ipv4Address dest);
-  Ptr<Ipv4Route> ConstructIpv4Route (uint32_t port, Ipv4Address destAddress);
+  Ipv4LpmSpan<uint32_t> LookupLetFlowRouteEntries (Ipv4Address dest);
 
   void SetFlowletTimeout (Time timeout);
 
+  void SetFlowletTableSize (uint32_t nEntries);
+  uint32_t GetFlowletTableSize (void) const;
+  const FlowletTable & GetFlowletTable (void) const;
+
+  // Use a fixed stream for the port chosen for new flowlets, returns 1
+  int64_t AssignStreams (int64_t stream);
+
 private:
   // Flowlet Timeout
   Time m_flowletTimeout;
@@ -60,11 +59,16 @@ private:
   // Ipv4 associated with this router
   Ptr<Ipv4> m_ipv4;
 
+  // Shared next hop route of each output port
+  Ipv4NextHopTable m_nextHopTable;
+
   // Flowlet Table
-  std::map<uint32_t, LetFlowFlowlet> m_flowletTable;
+  FlowletTable m_flowletTable;
+
+  // Route table, longest prefix -> equal-cost output ports
+  Ipv4LpmTrie<uint32_t> m_routeLookup;
 
-  // Route table
-  std::vector<LetFlowRouteEntry> m_routeEntryList;
+  Ptr<UniformRandomVariable> m_rand;
 };
 
 }
@@ -6,6 +6,16 @@
 // An essential include is test.h
 #include "ns3/test.h"
 
+#include "ns3/simulator.h"
+#include "ns3/flow-id-tag.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-address-generator.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/node-container.h"
+
+#include <vector>
+
 // Do not put your test classes in namespace ns3.  You may find it useful
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
@@ -46,6 +56,111 @@ LetflowRoutingTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+/**
+ * Check that the ports LetFlow picks for new flowlets depend only on the
+ * stream given to AssignStreams: the same flows through routers with the
+ * same stream take the same ports, with another stream other ports.
+ */
+class LetflowRoutingStreamTestCase : public TestCase
+{
+public:
+  LetflowRoutingStreamTestCase ();
+
+private:
+  virtual void DoRun (void);
+
+  // Ports taken by 64 new flows through a router using the stream
+  std::vector<uint32_t> GetPorts (int64_t stream);
+  void Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header);
+
+  Ptr<Ipv4> m_ipv4;
+  std::vector<uint32_t> m_ports;
+};
+
+LetflowRoutingStreamTestCase::LetflowRoutingStreamTestCase ()
+  : TestCase ("LetFlow port choices reproducible from the assigned stream")
+{
+}
+
+void
+LetflowRoutingStreamTestCase::Forward (Ptr<Ipv4Route> route, Ptr<const Packet> packet, const Ipv4Header &header)
+{
+  m_ports.push_back (m_ipv4->GetInterfaceForDevice (route->GetOutputDevice ()));
+}
+
+std::vector<uint32_t>
+LetflowRoutingStreamTestCase::GetPorts (int64_t stream)
+{
+  Ptr<Ipv4LetFlowRouting> letflow = CreateObject<Ipv4LetFlowRouting> ();
+  letflow->SetIpv4 (m_ipv4);
+  for (uint32_t port = 2; port <= 5; port++)
+    {
+      letflow->AddRoute (Ipv4Address ("10.9.0.0"), Ipv4Mask ("255.255.0.0"), port);
+    }
+  NS_TEST_EXPECT_MSG_EQ (letflow->AssignStreams (stream), 1, "LetFlow uses one stream");
+
+  Ipv4Header header;
+  header.SetSource (Ipv4Address ("10.1.1.2"));
+  header.SetDestination (Ipv4Address ("10.9.0.1"));
+  m_ports.clear ();
+  for (uint32_t flowId = 1; flowId <= 64; flowId++)
+    {
+      Ptr<Packet> packet = Create<Packet> (100);
+      packet->AddPacketTag (FlowIdTag (flowId));
+      letflow->RouteInput (packet, header, m_ipv4->GetNetDevice (1),
+                           MakeCallback (&LetflowRoutingStreamTestCase::Forward, this),
+                           Ipv4RoutingProtocol::MulticastForwardCallback (),
+                           Ipv4RoutingProtocol::LocalDeliverCallback (),
+                           Ipv4RoutingProtocol::ErrorCallback ());
+    }
+  letflow->Dispose ();
+  return m_ports;
+}
+
+void
+LetflowRoutingStreamTestCase::DoRun (void)
+{
+  // A router with an input port and four output ports
+  NodeContainer router;
+  router.Create (1);
+  NodeContainer peers;
+  peers.Create (5);
+  InternetStackHelper internet;
+  internet.Install (router);
+  internet.Install (peers);
+  SimpleNetDeviceHelper devices;
+  Ipv4AddressHelper addresses;
+  addresses.SetBase ("10.1.1.0", "255.255.255.0");
+  for (uint32_t i = 0; i < peers.GetN (); i++)
+    {
+      addresses.Assign (devices.Install (NodeContainer (router.Get (0), peers.Get (i))));
+      addresses.NewNetwork ();
+    }
+  m_ipv4 = router.Get (0)->GetObject<Ipv4> ();
+
+  std::vector<uint32_t> first = GetPorts (7);
+  std::vector<uint32_t> again = GetPorts (7);
+  std::vector<uint32_t> other = GetPorts (8);
+
+  NS_TEST_ASSERT_MSG_EQ (first.size (), 64, "Flows not forwarded");
+  NS_TEST_ASSERT_MSG_EQ (again.size (), 64, "Flows not forwarded");
+  NS_TEST_ASSERT_MSG_EQ (other.size (), 64, "Flows not forwarded");
+  bool same = true;
+  bool differ = false;
+  for (uint32_t i = 0; i < first.size (); i++)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((first[i] >= 2 && first[i] <= 5), true, "Port " << first[i] << " not in the group");
+      same = same && first[i] == again[i];
+      differ = differ || first[i] != other[i];
+    }
+  NS_TEST_EXPECT_MSG_EQ (same, true, "Same stream, other ports");
+  NS_TEST_EXPECT_MSG_EQ (differ, true, "Other stream, same ports");
+
+  m_ipv4 = 0;
+  Simulator::Destroy ();
+  Ipv4AddressGenerator::Reset ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +176,7 @@ LetflowRoutingTestSuite::LetflowRoutingTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new LetflowRoutingTestCase1, TestCase::QUICK);
+  AddTestCase (new LetflowRoutingStreamTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
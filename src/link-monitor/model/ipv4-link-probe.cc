@@ -31,6 +31,8 @@ Ipv4LinkProbe::Ipv4LinkProbe (Ptr<Node> node, Ptr<LinkMonitor> linkMonitor)
 {
   NS_LOG_FUNCTION (this);
 
+  m_checkEvent.SetFunction (&Ipv4LinkProbe::CheckCurrentStatus, this);
+
   m_ipv4 = m_ipv4 = node->GetObject<Ipv4L3Protocol> ();
 
   // Notice, the interface at 0 is loopback, we simply ignore it
@@ -181,14 +183,14 @@ Ipv4LinkProbe::CheckCurrentStatus ()
     }
   }
 
-  m_checkEvent = Simulator::Schedule (m_checkTime, &Ipv4LinkProbe::CheckCurrentStatus, this);
+  m_checkEvent.Schedule (m_checkTime);
 
 }
 
 void
 Ipv4LinkProbe::Start ()
 {
-  m_checkEvent = Simulator::Schedule (m_checkTime, &Ipv4LinkProbe::CheckCurrentStatus, this);
+  m_checkEvent.Schedule (m_checkTime);
 }
 
 void
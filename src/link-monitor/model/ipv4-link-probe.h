@@ -7,7 +7,7 @@
 #include "ns3/node.h"
 #include "ns3/packet.h"
 #include "ns3/ipv4-l3-protocol.h"
-#include "ns3/event-id.h"
+#include "ns3/reusable-event.h"
 #include "ns3/data-rate.h"
 
 #include "ipv4-queue-probe.h"
@@ -49,7 +49,7 @@ private:
 
   Time m_checkTime;
 
-  EventId m_checkEvent;
+  ReusableEvent m_checkEvent;
 
   std::map<uint32_t, Ptr<Ipv4QueueProbe> > m_queueProbe;
 
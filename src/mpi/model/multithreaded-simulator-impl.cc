@@ -0,0 +1,851 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "ns3/simulator.h"
+#include "ns3/event-impl.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/node-list.h"
+#include "ns3/packet.h"
+#include "ns3/packet-metadata.h"
+#include "ns3/nstime.h"
+#include "ns3/uinteger.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED (MultithreadedSimulatorImpl);
+
+/// Time stamp of an empty event list
+static const uint64_t MAX_TS = 0xffffffffffffffffULL;
+
+/// Iterations a thread spins on the barrier before yielding the processor
+static const uint32_t BARRIER_SPINS = 1000;
+
+__thread MultithreadedSimulatorImpl::Partition *MultithreadedSimulatorImpl::g_current = 0;
+
+/**
+ * \brief Order the pending events of a heap, the earliest first
+ */
+struct IsLaterEvent
+{
+  template <typename T>
+  bool operator() (const T &a, const T &b) const
+  {
+    if (a.ts != b.ts)
+      {
+        return a.ts > b.ts;
+      }
+    if (a.sendTs != b.sendTs)
+      {
+        return a.sendTs > b.sendTs;
+      }
+    if (a.sender != b.sender)
+      {
+        return a.sender > b.sender;
+      }
+    return a.seq > b.seq;
+  }
+};
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::MultithreadedSimulatorImpl")
+    .SetParent<SimulatorImpl> ()
+    .SetGroupName ("Mpi")
+    .AddConstructor<MultithreadedSimulatorImpl> ()
+    .AddAttribute ("ThreadCount",
+                   "Number of threads running the nodes, 0 for one per online processor",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&MultithreadedSimulatorImpl::m_threadCount),
+                   MakeUintegerChecker<uint32_t> ())
+  ;
+  return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl ()
+  : m_globalSent (4),
+    m_threadCount (0),
+    m_lookAhead (MAX_TS),
+    m_stopTs (MAX_TS),
+    m_windowStopTs (MAX_TS),
+    m_stop (false),
+    m_running (false),
+    m_barrierCount (0),
+    m_barrierGeneration (0)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_global = new Partition;
+  m_global->impl = this;
+  m_global->id = 0xffffffff;
+  m_global->currentTs = 0;
+  m_global->currentContext = 0xffffffff;
+  m_global->nextTs = MAX_TS;
+  m_global->windowEnd = MAX_TS;
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_partitions.push_back (m_global);
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *p = m_partitions[i];
+      for (uint32_t j = 0; j < p->events.size (); ++j)
+        {
+          p->events[j].impl->Unref ();
+        }
+      for (uint32_t j = 0; j < p->outbox.size (); ++j)
+        {
+          for (uint32_t k = 0; k < p->outbox[j].size (); ++k)
+            {
+              p->outbox[j][k].impl->Unref ();
+            }
+        }
+      delete p;
+    }
+  m_partitions.clear ();
+  m_global = 0;
+  SimulatorImpl::DoDispose ();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy ()
+{
+  NS_LOG_FUNCTION (this);
+
+  while (!m_destroyEvents.empty ())
+    {
+      Ptr<EventImpl> ev = m_destroyEvents.front ().PeekEventImpl ();
+      m_destroyEvents.pop_front ();
+      NS_LOG_LOGIC ("handle destroy " << ev);
+      if (!ev->IsCancelled ())
+        {
+          ev->Invoke ();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler (ObjectFactory schedulerFactory)
+{
+  NS_LOG_FUNCTION (this << schedulerFactory);
+  // the order of the events must not depend on the thread count, which the
+  // keys of the schedulers can not express
+  NS_LOG_WARN ("The partitions keep their events in their own heaps, the scheduler is not used");
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::Current (void) const
+{
+  return g_current != 0 ? g_current : m_global;
+}
+
+MultithreadedSimulatorImpl::Partition *
+MultithreadedSimulatorImpl::PartitionOf (uint32_t context) const
+{
+  if (context < m_partitionOfNode.size ())
+    {
+      return m_partitions[m_partitionOfNode[context]];
+    }
+  return m_global;
+}
+
+bool
+MultithreadedSimulatorImpl::IsRemoteContext (uint32_t context)
+{
+  Partition *p = g_current;
+  // the global events are run while the other threads wait, but what they
+  // hand to a node is used later by the thread of that node
+  return p != 0 && p->impl->PartitionOf (context) != p;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions (void) const
+{
+  return m_partitions.size ();
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookAhead (void) const
+{
+  return m_lookAhead == MAX_TS ? GetMaximumSimulationTime () : TimeStep (m_lookAhead);
+}
+
+/**
+ * \brief Find the group of a node, halving the path on the way
+ */
+static uint32_t
+FindGroup (std::vector<uint32_t> &group, uint32_t node)
+{
+  while (group[node] != node)
+    {
+      group[node] = group[group[node]];
+      node = group[node];
+    }
+  return node;
+}
+
+/**
+ * \brief Order the groups of nodes by decreasing size, then by id
+ */
+static bool
+IsLargerGroup (const std::pair<uint32_t, uint32_t> &a, const std::pair<uint32_t, uint32_t> &b)
+{
+  return a.first > b.first || (a.first == b.first && a.second < b.second);
+}
+
+void
+MultithreadedSimulatorImpl::CreatePartitions (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t nNodes = NodeList::GetNNodes ();
+  uint32_t nThreads = 1;
+#ifdef HAVE_PTHREAD_H
+  nThreads = m_threadCount;
+  if (nThreads == 0)
+    {
+      long online = sysconf (_SC_NPROCESSORS_ONLN);
+      nThreads = online > 0 ? online : 1;
+    }
+#else
+  if (m_threadCount > 1)
+    {
+      NS_LOG_WARN ("Threads are not supported, running the nodes on one thread");
+    }
+#endif
+
+  m_partitionOfNode.assign (nNodes, 0);
+  uint32_t maxSystemId = 0;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      maxSystemId = std::max (maxSystemId, NodeList::GetNode (i)->GetSystemId ());
+    }
+
+  if (maxSystemId > 0)
+    {
+      // the script placed the nodes itself
+      nThreads = std::min (nThreads, maxSystemId + 1);
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          m_partitionOfNode[i] = NodeList::GetNode (i)->GetSystemId () % nThreads;
+        }
+    }
+  else
+    {
+      // Keep together the nodes of a shared channel, and the nodes with a
+      // single point to point link (the hosts) with their neighbour
+      std::vector<uint32_t> group (nNodes);
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          group[i] = i;
+        }
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          Ptr<Node> node = NodeList::GetNode (i);
+          uint32_t nLinks = 0;
+          uint32_t neighbour = i;
+          for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+            {
+              Ptr<NetDevice> device = node->GetDevice (j);
+              Ptr<Channel> channel = device->GetChannel ();
+              if (channel == 0)
+                {
+                  continue;
+                }
+              for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+                {
+                  uint32_t other = channel->GetDevice (k)->GetNode ()->GetId ();
+                  if (other == i)
+                    {
+                      continue;
+                    }
+                  if (!device->IsPointToPoint ())
+                    {
+                      group[FindGroup (group, other)] = FindGroup (group, i);
+                    }
+                  else
+                    {
+                      nLinks++;
+                      neighbour = other;
+                    }
+                }
+            }
+          if (nLinks == 1)
+            {
+              group[FindGroup (group, i)] = FindGroup (group, neighbour);
+            }
+        }
+
+      std::vector<uint32_t> weight (nNodes, 0);
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          weight[FindGroup (group, i)]++;
+        }
+      std::vector<std::pair<uint32_t, uint32_t> > groups;
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          if (weight[i] > 0)
+            {
+              groups.push_back (std::make_pair (weight[i], i));
+            }
+        }
+      std::sort (groups.begin (), groups.end (), &IsLargerGroup);
+      nThreads = std::max<uint32_t> (1, std::min<uint32_t> (nThreads, groups.size ()));
+
+      // the largest groups first, each on the least loaded thread
+      std::vector<uint32_t> load (nThreads, 0);
+      std::vector<uint32_t> partitionOfGroup (nNodes, 0);
+      for (uint32_t i = 0; i < groups.size (); ++i)
+        {
+          uint32_t target = std::min_element (load.begin (), load.end ()) - load.begin ();
+          load[target] += groups[i].first;
+          partitionOfGroup[groups[i].second] = target;
+        }
+      for (uint32_t i = 0; i < nNodes; ++i)
+        {
+          m_partitionOfNode[i] = partitionOfGroup[FindGroup (group, i)];
+        }
+    }
+
+  // the lookahead is the shortest link between two partitions
+  m_lookAhead = MAX_TS;
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      Ptr<Node> node = NodeList::GetNode (i);
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              uint32_t other = channel->GetDevice (k)->GetNode ()->GetId ();
+              if (m_partitionOfNode[other] == m_partitionOfNode[i])
+                {
+                  continue;
+                }
+              TimeValue delay;
+              if (!device->IsPointToPoint () || !channel->GetAttributeFailSafe ("Delay", delay))
+                {
+                  NS_FATAL_ERROR ("Only point to point links can join nodes " << i << " and " << other
+                                  << " of different threads");
+                }
+              if (!delay.Get ().IsStrictlyPositive ())
+                {
+                  NS_FATAL_ERROR ("The link between nodes " << i << " and " << other
+                                  << " of different threads has no delay");
+                }
+              m_lookAhead = std::min<uint64_t> (m_lookAhead, delay.Get ().GetTimeStep ());
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < nThreads; ++i)
+    {
+      Partition *p = new Partition;
+      p->impl = this;
+      p->id = i;
+      p->currentTs = m_global->currentTs;
+      p->currentContext = 0xffffffff;
+      // the partitions count the events scheduled by each of their nodes
+      p->sent.assign (nNodes, 4);
+      p->nextTs = MAX_TS;
+      p->windowEnd = MAX_TS;
+      p->outbox.resize (nThreads + 1);
+      m_partitions.push_back (p);
+    }
+
+  // the events of the nodes scheduled so far move to their partition
+  std::vector<PendingEvent> events;
+  events.swap (m_global->events);
+  for (uint32_t i = 0; i < events.size (); ++i)
+    {
+      Insert (PartitionOf (events[i].context), events[i]);
+    }
+
+  NS_LOG_INFO ("nodes on " << nThreads << " threads, lookahead " << GetLookAhead ());
+}
+
+void
+MultithreadedSimulatorImpl::Barrier (void)
+{
+  uint32_t generation = m_barrierGeneration;
+  __sync_synchronize ();
+  if (__sync_add_and_fetch (&m_barrierCount, 1) == m_partitions.size ())
+    {
+      m_barrierCount = 0;
+      __sync_synchronize ();
+      m_barrierGeneration = generation + 1;
+      return;
+    }
+  uint32_t spins = 0;
+  while (m_barrierGeneration == generation)
+    {
+#ifdef HAVE_PTHREAD_H
+      if (++spins > BARRIER_SPINS)
+        {
+          sched_yield ();
+        }
+#endif
+    }
+  __sync_synchronize ();
+}
+
+void
+MultithreadedSimulatorImpl::Drain (Partition *p)
+{
+  uint32_t slot = p == m_global ? m_partitions.size () : p->id;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      std::vector<PendingEvent> &mailbox = m_partitions[i]->outbox[slot];
+      for (uint32_t j = 0; j < mailbox.size (); ++j)
+        {
+          Insert (p, mailbox[j]);
+        }
+      mailbox.clear ();
+    }
+  p->nextTs = p->events.empty () ? MAX_TS : p->events.front ().ts;
+}
+
+MultithreadedSimulatorImpl::PendingEvent
+MultithreadedSimulatorImpl::MakeEvent (Partition *p, uint64_t ts, uint32_t context, EventImpl *event)
+{
+  PendingEvent ev;
+  ev.ts = ts;
+  ev.sendTs = p->currentTs;
+  ev.sender = p->currentContext;
+  // only the thread of the sender touches its count
+  if (p != m_global && ev.sender < p->sent.size ())
+    {
+      ev.seq = p->sent[ev.sender]++;
+    }
+  else
+    {
+      ev.seq = m_globalSent++;
+    }
+  ev.context = context;
+  ev.impl = event;
+  return ev;
+}
+
+void
+MultithreadedSimulatorImpl::Insert (Partition *p, const PendingEvent &ev)
+{
+  p->events.push_back (ev);
+  std::push_heap (p->events.begin (), p->events.end (), IsLaterEvent ());
+}
+
+bool
+MultithreadedSimulatorImpl::IsPending (const Partition *p, const EventId &id)
+{
+  // the events at the current time are at the top of the heap
+  std::vector<uint32_t> stack;
+  if (!p->events.empty ())
+    {
+      stack.push_back (0);
+    }
+  while (!stack.empty ())
+    {
+      uint32_t i = stack.back ();
+      stack.pop_back ();
+      const PendingEvent &ev = p->events[i];
+      if (ev.ts != p->currentTs)
+        {
+          continue;
+        }
+      if (ev.impl == id.PeekEventImpl () && static_cast<uint32_t> (ev.seq) == id.GetUid ())
+        {
+          return true;
+        }
+      for (uint32_t child = 2 * i + 1; child <= 2 * i + 2 && child < p->events.size (); ++child)
+        {
+          stack.push_back (child);
+        }
+    }
+  return false;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessOneEvent (Partition *p)
+{
+  std::pop_heap (p->events.begin (), p->events.end (), IsLaterEvent ());
+  PendingEvent next = p->events.back ();
+  p->events.pop_back ();
+
+  NS_ASSERT (next.ts >= p->currentTs);
+  p->currentTs = next.ts;
+  p->currentContext = next.context;
+  next.impl->Invoke ();
+  next.impl->Unref ();
+}
+
+void
+MultithreadedSimulatorImpl::Work (Partition *p)
+{
+  g_current = p;
+  while (true)
+    {
+      Drain (p);
+      if (p->id == 0)
+        {
+          Drain (m_global);
+          m_windowStopTs = m_stopTs;
+        }
+      Barrier ();
+
+      // every thread takes the same decision from the published times
+      uint64_t next = MAX_TS;
+      for (uint32_t i = 0; i < m_partitions.size (); ++i)
+        {
+          next = std::min (next, m_partitions[i]->nextTs);
+        }
+      uint64_t globalNext = m_global->nextTs;
+      uint64_t stopTs = m_windowStopTs;
+      uint64_t earliest = std::min (next, globalNext);
+      if (earliest == MAX_TS || earliest >= stopTs)
+        {
+          break;
+        }
+
+      if (globalNext <= next)
+        {
+          if (p->id == 0)
+            {
+              // the other threads wait at the barrier, so a stop requested
+              // by a global event applies at once
+              g_current = m_global;
+              while (!m_global->events.empty ()
+                     && m_global->events.front ().ts == globalNext
+                     && globalNext < m_stopTs)
+                {
+                  ProcessOneEvent (m_global);
+                }
+              g_current = p;
+            }
+        }
+      else
+        {
+          uint64_t windowEnd = MAX_TS - next > m_lookAhead ? next + m_lookAhead : MAX_TS;
+          // the stops requested during the window apply from the next
+          // barrier, at the same point whatever the timing of the threads
+          windowEnd = std::min (windowEnd, std::min (globalNext, stopTs));
+          p->windowEnd = windowEnd;
+          while (!p->events.empty ())
+            {
+              uint64_t ts = p->events.front ().ts;
+              if (ts >= windowEnd)
+                {
+                  break;
+                }
+              ProcessOneEvent (p);
+            }
+          p->windowEnd = MAX_TS;
+        }
+      Barrier ();
+    }
+  g_current = 0;
+}
+
+void
+MultithreadedSimulatorImpl::WorkerMain (Partition *p)
+{
+  p->impl->Work (p);
+  Packet::ReleaseThreadFreeLists ();
+  EventImpl::ReleaseThreadFreeLists ();
+}
+
+void
+MultithreadedSimulatorImpl::Run (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_partitions.empty ())
+    {
+      CreatePartitions ();
+    }
+  NS_ABORT_MSG_IF (m_partitions.size () > 1 && PacketMetadata::IsEnabled (),
+                   "The packet metadata is shared between the packets of the partitions, "
+                   "it must stay disabled with more than one thread");
+  m_stop = false;
+  m_stopTs = MAX_TS;
+  m_running = true;
+
+#ifdef HAVE_PTHREAD_H
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 1; i < m_partitions.size (); ++i)
+    {
+      threads.push_back (Create<SystemThread> (MakeBoundCallback (&MultithreadedSimulatorImpl::WorkerMain,
+                                                                  m_partitions[i])));
+      threads.back ()->Start ();
+    }
+#endif
+  Work (m_partitions[0]);
+#ifdef HAVE_PTHREAD_H
+  for (uint32_t i = 0; i < threads.size (); ++i)
+    {
+      threads[i]->Join ();
+    }
+#endif
+  m_running = false;
+
+  // all the partitions end at the time of the last event
+  uint64_t end = m_global->currentTs;
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      end = std::max (end, m_partitions[i]->currentTs);
+    }
+  m_partitions.push_back (m_global);
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      Partition *p = m_partitions[i];
+      p->currentTs = end;
+    }
+  m_partitions.pop_back ();
+  m_global->currentContext = 0xffffffff;
+  m_stop = m_stopTs != MAX_TS;
+  m_stopTs = MAX_TS;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished (void) const
+{
+  if (m_stop)
+    {
+      return true;
+    }
+  for (uint32_t i = 0; i < m_partitions.size (); ++i)
+    {
+      if (!m_partitions[i]->events.empty ())
+        {
+          return false;
+        }
+    }
+  return m_global->events.empty ();
+}
+
+void
+MultithreadedSimulatorImpl::RequestStop (uint64_t ts)
+{
+  uint64_t old = m_stopTs;
+  while (ts < old)
+    {
+      uint64_t seen = __sync_val_compare_and_swap (&m_stopTs, old, ts);
+      if (seen == old)
+        {
+          break;
+        }
+      old = seen;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_running)
+    {
+      // the other threads may run their events up to a lookahead further
+      RequestStop (Current ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Stop (Time const &delay)
+{
+  NS_LOG_FUNCTION (this << delay.GetTimeStep ());
+  Simulator::Schedule (delay, &Simulator::Stop);
+}
+
+//
+// Schedule an event for a _relative_ time in the future.
+//
+EventId
+MultithreadedSimulatorImpl::Schedule (Time const &delay, EventImpl *event)
+{
+  Partition *p = Current ();
+  Time tAbsolute = delay + TimeStep (p->currentTs);
+
+  NS_ASSERT (tAbsolute.IsPositive ());
+  NS_ASSERT (tAbsolute >= TimeStep (p->currentTs));
+  PendingEvent ev = MakeEvent (p, static_cast<uint64_t> (tAbsolute.GetTimeStep ()),
+                               p->currentContext, event);
+  Insert (p, ev);
+  return EventId (event, ev.ts, ev.context, static_cast<uint32_t> (ev.seq));
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event)
+{
+  Partition *from = Current ();
+  Partition *to = PartitionOf (context);
+  NS_LOG_FUNCTION (this << context << delay.GetTimeStep () << from->currentTs << event);
+
+  PendingEvent ev = MakeEvent (from, from->currentTs + delay.GetTimeStep (), context, event);
+  if (to == from || !m_running || from == m_global)
+    {
+      // the other threads are waiting
+      Insert (to, ev);
+      return;
+    }
+  if (ev.ts < from->windowEnd)
+    {
+      NS_FATAL_ERROR ("Event for context " << context << " at " << TimeStep (ev.ts)
+                      << " is earlier than the lookahead of the threads allows");
+    }
+  from->outbox[to == m_global ? m_partitions.size () : to->id].push_back (ev);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow (EventImpl *event)
+{
+  return Schedule (TimeStep (0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy (EventImpl *event)
+{
+  NS_LOG_FUNCTION (this << event);
+  NS_ASSERT_MSG (!m_running || Current () == m_global,
+                 "Destroy events can only be scheduled by the global events");
+
+  EventId id (Ptr<EventImpl> (event, false), m_global->currentTs, 0xffffffff, 2);
+  m_destroyEvents.push_back (id);
+  return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now (void) const
+{
+  return TimeStep (Current ()->currentTs);
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft (const EventId &id) const
+{
+  if (IsExpired (id))
+    {
+      return TimeStep (0);
+    }
+  else
+    {
+      return TimeStep (id.GetTs () - Current ()->currentTs);
+    }
+}
+
+void
+MultithreadedSimulatorImpl::Remove (const EventId &id)
+{
+  if (id.GetUid () == 2)
+    {
+      // destroy events.
+      for (DestroyEvents::iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              m_destroyEvents.erase (i);
+              break;
+            }
+        }
+      return;
+    }
+  if (IsExpired (id))
+    {
+      return;
+    }
+  NS_ASSERT_MSG (!m_running || PartitionOf (id.GetContext ()) == Current () || Current () == m_global,
+                 "Removing an event of a node run by another thread");
+  // the event stays in its heap, which releases it at its time
+  id.PeekEventImpl ()->Cancel ();
+}
+
+void
+MultithreadedSimulatorImpl::Cancel (const EventId &id)
+{
+  if (!IsExpired (id))
+    {
+      id.PeekEventImpl ()->Cancel ();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired (const EventId &id) const
+{
+  if (id.GetUid () == 2)
+    {
+      if (id.PeekEventImpl () == 0
+          || id.PeekEventImpl ()->IsCancelled ())
+        {
+          return true;
+        }
+      // destroy events.
+      for (DestroyEvents::const_iterator i = m_destroyEvents.begin (); i != m_destroyEvents.end (); i++)
+        {
+          if (*i == id)
+            {
+              return false;
+            }
+        }
+      return true;
+    }
+  Partition *p = PartitionOf (id.GetContext ());
+  if (id.PeekEventImpl () == 0
+      || id.GetTs () < p->currentTs
+      || id.PeekEventImpl ()->IsCancelled ())
+    {
+      return true;
+    }
+  if (id.GetTs () > p->currentTs)
+    {
+      return false;
+    }
+  return !IsPending (p, id);
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime (void) const
+{
+  return TimeStep (0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId (void) const
+{
+  return 0;
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext (void) const
+{
+  return Current ()->currentContext;
+}
+
+} // namespace ns3
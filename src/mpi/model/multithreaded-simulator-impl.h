@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#ifndef NS3_MULTITHREADED_SIMULATOR_IMPL_H
+#define NS3_MULTITHREADED_SIMULATOR_IMPL_H
+
+#include "ns3/simulator-impl.h"
+#include "ns3/event-impl.h"
+#include "ns3/object-factory.h"
+#include "ns3/ptr.h"
+
+#include <list>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup mpi
+ *
+ * \brief Conservative parallel simulator running the nodes of a single
+ * process on several threads
+ *
+ * On the first Run the nodes are split into one partition per thread,
+ * either by their system id when one is set, or by keeping every node with
+ * a single link together with its neighbour and balancing these groups over
+ * the threads. The lookahead is the smallest delay of the point to point
+ * channels joining two partitions.
+ *
+ * The threads then advance in windows: all of them agree on the earliest
+ * pending event T and process their own events below T plus the lookahead.
+ * An event scheduled on a node of another partition is posted to a mailbox
+ * of the sending thread, and the receiving thread moves it into its own
+ * event list after the next barrier, so the mailboxes need no locking.
+ * Events without a node context (applications started from main, global
+ * events scheduled from events without context) run on the main thread
+ * while the others wait.
+ *
+ * The models used by the nodes of different partitions must not share
+ * state. The point to point channel hands the packets to the receiving
+ * thread with Packet::CreateUnsharedCopy, and the flow monitor and the
+ * packet trace writer lock their shared tables, but packet metadata must
+ * stay disabled: Run aborts otherwise.
+ *
+ * The events at the same time stamp run in the order they were scheduled
+ * in, then by the context which scheduled them and their rank among the
+ * events scheduled by this context. None of these depends on the thread
+ * count, so the events of each node run in the same order whatever the
+ * number and the timing of the threads; only the tables shared under a
+ * lock may be filled in another order. The partitions keep their events in
+ * binary heaps on this key, SetScheduler has no effect. Remove cancels the
+ * event, which stays in its heap until its time. Nodes created after the
+ * first Run have their events run with the global ones.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+public:
+  static TypeId GetTypeId (void);
+
+  MultithreadedSimulatorImpl ();
+  ~MultithreadedSimulatorImpl ();
+
+  // virtual from SimulatorImpl
+  virtual void Destroy ();
+  virtual bool IsFinished (void) const;
+  virtual void Stop (void);
+  virtual void Stop (Time const &delay);
+  virtual EventId Schedule (Time const &delay, EventImpl *event);
+  virtual void ScheduleWithContext (uint32_t context, Time const &delay, EventImpl *event);
+  virtual EventId ScheduleNow (EventImpl *event);
+  virtual EventId ScheduleDestroy (EventImpl *event);
+  virtual void Remove (const EventId &id);
+  virtual void Cancel (const EventId &id);
+  virtual bool IsExpired (const EventId &id) const;
+  virtual void Run (void);
+  virtual Time Now (void) const;
+  virtual Time GetDelayLeft (const EventId &id) const;
+  virtual Time GetMaximumSimulationTime (void) const;
+  virtual void SetScheduler (ObjectFactory schedulerFactory);
+  virtual uint32_t GetSystemId (void) const;
+  virtual uint32_t GetContext (void) const;
+
+  /**
+   * \brief Whether an event scheduled on a node is handled by another thread
+   * than the one running the current event
+   *
+   * Always false outside of MultithreadedSimulatorImpl::Run. The objects
+   * passed to such an event must not be shared with the sending thread.
+   *
+   * \param context the node id of the event
+   * \returns true if the node belongs to another partition
+   */
+  static bool IsRemoteContext (uint32_t context);
+
+  /**
+   * \returns the number of partitions of the last Run, 0 before the first one
+   */
+  uint32_t GetNPartitions (void) const;
+
+  /**
+   * \returns the lookahead between the partitions
+   */
+  Time GetLookAhead (void) const;
+
+private:
+  /**
+   * \brief A pending event with its key
+   */
+  struct PendingEvent
+  {
+    uint64_t ts;                        //!< time stamp
+    uint64_t sendTs;                    //!< time at which it was scheduled
+    uint64_t seq;                       //!< rank among the events scheduled by the sender
+    uint32_t sender;                    //!< context which scheduled it
+    uint32_t context;                   //!< context of the event
+    EventImpl *impl;                    //!< the event, referenced by the list
+  };
+
+  /**
+   * \brief The nodes run by one thread, or the global events
+   */
+  struct Partition
+  {
+    MultithreadedSimulatorImpl *impl;   //!< the simulator
+    uint32_t id;                        //!< index in m_partitions
+    std::vector<PendingEvent> events;   //!< pending events, a heap with the earliest first
+    std::vector<uint64_t> sent;         //!< events scheduled so far, by context of the partition
+    uint64_t currentTs;                 //!< time of the current event
+    uint32_t currentContext;            //!< context of the current event
+    uint64_t nextTs;                    //!< earliest pending event, published after draining
+    uint64_t windowEnd;                 //!< end of the window being processed
+    /**
+     * Events posted to the other partitions in the current window, indexed
+     * by the destination; the last one is for the global events
+     */
+    std::vector<std::vector<PendingEvent> > outbox;
+  };
+
+  virtual void DoDispose (void);
+
+  /**
+   * \brief Split the nodes into partitions and compute the lookahead
+   */
+  void CreatePartitions (void);
+  /**
+   * \returns the partition of the thread calling, the global one outside
+   * of the threads
+   */
+  Partition * Current (void) const;
+  /**
+   * \returns the partition running the events of a context
+   */
+  Partition * PartitionOf (uint32_t context) const;
+  /**
+   * \brief Key a new event scheduled by the current event of a partition
+   * \param p the partition scheduling the event
+   * \param ts the time stamp of the event
+   * \param context the context of the event
+   * \param event the event
+   * \returns the event with its key
+   */
+  PendingEvent MakeEvent (Partition *p, uint64_t ts, uint32_t context, EventImpl *event);
+  /**
+   * \brief Add an event to the heap of a partition
+   */
+  static void Insert (Partition *p, const PendingEvent &ev);
+  /**
+   * \returns whether an event at the current time of a partition has not
+   * run yet
+   */
+  static bool IsPending (const Partition *p, const EventId &id);
+  /**
+   * \brief Run the next event of a partition
+   */
+  void ProcessOneEvent (Partition *p);
+  /**
+   * \brief Move the events posted to a partition into its event list
+   */
+  void Drain (Partition *p);
+  /**
+   * \brief Run the events of a partition until the next global step or
+   * the end of the simulation
+   */
+  void Work (Partition *p);
+  /**
+   * \brief Entry point of the worker threads
+   */
+  static void WorkerMain (Partition *p);
+  /**
+   * \brief Wait until all the threads reach the barrier
+   */
+  void Barrier (void);
+  /**
+   * \brief Lower the stop time of the current Run
+   */
+  void RequestStop (uint64_t ts);
+
+  typedef std::list<EventId> DestroyEvents;
+
+  DestroyEvents m_destroyEvents;              //!< events run by Destroy
+  std::vector<Partition *> m_partitions;      //!< one per thread
+  Partition *m_global;                        //!< global events, and all of them before the first Run
+  uint64_t m_globalSent;                      //!< events scheduled by the contexts without a partition
+  std::vector<uint32_t> m_partitionOfNode;    //!< partition index of each node
+  uint32_t m_threadCount;                     //!< threads requested, 0 for one per processor
+  uint64_t m_lookAhead;                       //!< smallest delay of the links between partitions
+  volatile uint64_t m_stopTs;                 //!< stop time requested in the current Run
+  uint64_t m_windowStopTs;                    //!< m_stopTs seen by all threads in the current step
+  bool m_stop;                                //!< whether the last Run was stopped
+  bool m_running;                             //!< whether the threads are running
+
+  volatile uint32_t m_barrierCount;           //!< threads waiting on the barrier
+  volatile uint32_t m_barrierGeneration;      //!< barriers passed
+
+  static __thread Partition *g_current;       //!< partition of the calling thread
+};
+
+} // namespace ns3
+
+#endif /* NS3_MULTITHREADED_SIMULATOR_IMPL_H */
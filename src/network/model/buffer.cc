@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "buffer.h"
+#include "packet-pool.h"
 #include "ns3/assert.h"
 #include "ns3/log.h"
 
@@ -50,7 +51,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("Buffer");
 
 
-uint32_t Buffer::g_recommendedStart = 0;
+__thread uint32_t Buffer::g_recommendedStart = 0;
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -75,13 +76,21 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED (x) && !IS_DESTROYED (x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
-uint32_t Buffer::g_maxSize = 0;
-Buffer::FreeList *Buffer::g_freeList = 0;
+__thread uint32_t Buffer::g_maxSize = 0;
+__thread Buffer::FreeList *Buffer::g_freeList = 0;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
 {
   NS_LOG_FUNCTION (this);
+  ReleaseThreadFreeList ();
+  g_freeList = DESTROYED;
+}
+
+void
+Buffer::ReleaseThreadFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
   if (IS_INITIALIZED (g_freeList))
     {
       for (Buffer::FreeList::iterator i = g_freeList->begin ();
@@ -90,7 +99,7 @@ Buffer::LocalStaticDestructor::~LocalStaticDestructor(void)
           Buffer::Deallocate (*i);
         }
       delete g_freeList;
-      g_freeList = DESTROYED;
+      g_freeList = UNINITIALIZED;
     }
 }
 
@@ -132,12 +141,20 @@ Buffer::Create (uint32_t dataSize)
           g_freeList->pop_back ();
           if (data->m_size >= dataSize) 
             {
+              PacketPool::NotifyHit (PacketPool::BUFFER);
               data->m_count = 1;
               return data;
             }
           Buffer::Deallocate (data);
         }
     }
+  PacketPool::NotifyMiss (PacketPool::BUFFER);
+  /* with the pools, allocate the largest size seen so that the data
+   * of the small packets, e.g. the acks, can be recycled too. */
+  if (PacketPool::IsEnabled ())
+    {
+      dataSize = std::max (dataSize, g_maxSize);
+    }
   struct Buffer::Data *data = Buffer::Allocate (dataSize);
   NS_ASSERT (data->m_count == 1);
   return data;
@@ -157,6 +174,11 @@ Buffer::Create (uint32_t size)
   NS_LOG_FUNCTION (size);
   return Allocate (size);
 }
+
+void
+Buffer::ReleaseThreadFreeList (void)
+{
+}
 #endif /* BUFFER_FREE_LIST */
 
 struct Buffer::Data *
@@ -555,6 +577,26 @@ Buffer::CreateFullCopy (void) const
   return *this;
 }
 
+Buffer
+Buffer::CreateUnsharedCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (CheckInternalState ());
+  // The zero area stays virtual, the real bytes on both of its sides are
+  // copied to a storage of our own
+  Buffer tmp (m_zeroAreaEnd - m_zeroAreaStart);
+  uint32_t dataStart = m_zeroAreaStart - m_start;
+  tmp.AddAtStart (dataStart);
+  tmp.Begin ().Write (m_data->m_data + m_start, dataStart);
+  uint32_t dataEnd = m_end - m_zeroAreaEnd;
+  tmp.AddAtEnd (dataEnd);
+  Buffer::Iterator i = tmp.End ();
+  i.Prev (dataEnd);
+  i.Write (m_data->m_data + m_zeroAreaStart, dataEnd);
+  NS_ASSERT (tmp.CheckInternalState ());
+  return tmp;
+}
+
 uint32_t 
 Buffer::GetSerializedSize (void) const
 {
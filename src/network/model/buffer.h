@@ -605,6 +605,26 @@ private:
    */
   uint32_t CopyData (uint8_t *buffer, uint32_t size) const;
 
+  /**
+   * \brief Create a copy of the buffer which shares no data storage with it
+   *
+   * The copies made by the copy constructor share their data storage until
+   * one of them is written, and count their references without locks. A
+   * buffer handed to another thread must be made with this method.
+   *
+   * \returns a copy of the buffer
+   */
+  Buffer CreateUnsharedCopy (void) const;
+
+  /**
+   * \brief Free the data storages kept for reuse by the calling thread
+   *
+   * Each thread keeps its own free list, which the static destructors only
+   * clear for the main thread. The other threads which create buffers call
+   * this before they exit.
+   */
+  static void ReleaseThreadFreeList (void);
+
   /**
    * \brief Copy constructor
    * \param o the buffer to copy
@@ -761,7 +781,7 @@ private:
    * writing data. i.e., m_start should be initialized to this 
    * value.
    */
-  static uint32_t g_recommendedStart;
+  static __thread uint32_t g_recommendedStart;
 
   /**
    * offset to the start of the virtual zero area from the start
@@ -792,8 +812,8 @@ private:
   {
     ~LocalStaticDestructor ();
   };
-  static uint32_t g_maxSize; //!< Max observed data size
-  static FreeList *g_freeList; //!< Buffer data container
+  static __thread uint32_t g_maxSize; //!< Max observed data size, per thread
+  static __thread FreeList *g_freeList; //!< Buffer data container, per thread
   static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
 };
@@ -18,6 +18,7 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "byte-tag-list.h"
+#include "packet-pool.h"
 #include "ns3/log.h"
 #include <vector>
 #include <cstring>
@@ -52,23 +53,31 @@ struct ByteTagListData {
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData *>
-{
-public:
-  ~ByteTagListDataFreeList ();
-} g_freeList; //!< Container for struct ByteTagListData
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+typedef std::vector<struct ByteTagListData *> ByteTagListDataFreeList;
+
+/**
+ * Container for struct ByteTagListData, per thread. Created on demand, and
+ * set to FREE_LIST_DESTROYED once the static destructors have run, as
+ * Buffer does.
+ */
+static __thread ByteTagListDataFreeList *g_freeList = 0;
+static __thread uint32_t g_maxSize = 0; //!< maximum data size (used for allocation), per thread
+
+#define FREE_LIST_DESTROYED ((ByteTagListDataFreeList *)~(long) 0)
 
-ByteTagListDataFreeList::~ByteTagListDataFreeList ()
+/**
+ * \ingroup packet
+ *
+ * \brief Frees the free list of the main thread at exit
+ */
+static struct ByteTagListDataFreeListDestructor
 {
-  NS_LOG_FUNCTION (this);
-  for (ByteTagListDataFreeList::iterator i = begin ();
-       i != end (); i++)
-    {
-      uint8_t *buffer = (uint8_t *)(*i);
-      delete [] buffer;
-    }
-}
+  ~ByteTagListDataFreeListDestructor ()
+  {
+    ByteTagList::ReleaseThreadFreeList ();
+    g_freeList = FREE_LIST_DESTROYED;
+  }
+} g_freeListDestructor; //!< Frees the free list of the main thread at exit
 #endif /* USE_FREE_LIST */
 
 ByteTagList::Iterator::Item::Item (TagBuffer buf_)
@@ -340,17 +349,36 @@ ByteTagList::AddAtStart (int32_t prependOffset)
 
 #ifdef USE_FREE_LIST
 
+void
+ByteTagList::ReleaseThreadFreeList (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  if (g_freeList != 0 && g_freeList != FREE_LIST_DESTROYED)
+    {
+      for (ByteTagListDataFreeList::iterator i = g_freeList->begin ();
+           i != g_freeList->end (); i++)
+        {
+          uint8_t *buffer = (uint8_t *)(*i);
+          delete [] buffer;
+        }
+      delete g_freeList;
+      g_freeList = 0;
+    }
+}
+
 struct ByteTagListData *
 ByteTagList::Allocate (uint32_t size)
 {
   NS_LOG_FUNCTION (this << size);
-  while (!g_freeList.empty ())
+  ByteTagListDataFreeList *freeList = g_freeList;
+  while (freeList != 0 && freeList != FREE_LIST_DESTROYED && !freeList->empty ())
     {
-      struct ByteTagListData *data = g_freeList.back ();
-      g_freeList.pop_back ();
+      struct ByteTagListData *data = freeList->back ();
+      freeList->pop_back ();
       NS_ASSERT (data != 0);
       if (data->size >= size)
         {
+          PacketPool::NotifyHit (PacketPool::BYTE_TAG);
           data->count = 1;
           data->dirty = 0;
           return data;
@@ -358,6 +386,7 @@ ByteTagList::Allocate (uint32_t size)
       uint8_t *buffer = (uint8_t *)data;
       delete [] buffer;
     }
+  PacketPool::NotifyMiss (PacketPool::BYTE_TAG);
   uint8_t *buffer = new uint8_t [std::max (size, g_maxSize) + sizeof (struct ByteTagListData) - 4];
   struct ByteTagListData *data = (struct ByteTagListData *)buffer;
   data->count = 1;
@@ -378,7 +407,12 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
   data->count--;
   if (data->count == 0)
     {
-      if (g_freeList.size () > FREE_LIST_SIZE ||
+      if (g_freeList == 0)
+        {
+          g_freeList = new ByteTagListDataFreeList ();
+        }
+      if (g_freeList == FREE_LIST_DESTROYED ||
+          g_freeList->size () > FREE_LIST_SIZE ||
           data->size < g_maxSize)
         {
           uint8_t *buffer = (uint8_t *)data;
@@ -386,7 +420,7 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
         }
       else
         {
-          g_freeList.push_back (data);
+          g_freeList->push_back (data);
         }
     }
 }
@@ -421,7 +455,29 @@ ByteTagList::Deallocate (struct ByteTagListData *data)
     }
 }
 
+void
+ByteTagList::ReleaseThreadFreeList (void)
+{
+}
+
 #endif /* USE_FREE_LIST */
 
+ByteTagList
+ByteTagList::CreateUnsharedCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  ByteTagList copy;
+  if (m_data != 0)
+    {
+      copy.m_data = copy.Allocate (m_used);
+      std::memcpy (&copy.m_data->data, &m_data->data, m_used);
+      copy.m_data->dirty = m_used;
+      copy.m_used = m_used;
+    }
+  copy.m_minStart = m_minStart;
+  copy.m_maxEnd = m_maxEnd;
+  copy.m_adjustment = m_adjustment;
+  return copy;
+}
 
 } // namespace ns3
@@ -225,6 +225,22 @@ private:
    */
   void AddAtStart (int32_t prependOffset);
 
+  /**
+   * \brief Create a copy of this list which shares no tag data with it
+   *
+   * See Buffer::CreateUnsharedCopy.
+   *
+   * \returns the copy
+   */
+  ByteTagList CreateUnsharedCopy (void) const;
+
+  /**
+   * \brief Free the tag data kept for reuse by the calling thread
+   *
+   * See Buffer::ReleaseThreadFreeList.
+   */
+  static void ReleaseThreadFreeList (void);
+
 private:
   /**
    * \brief Returns an iterator pointing to the very first tag in this list.
@@ -23,6 +23,7 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include "packet-metadata.h"
+#include "packet-pool.h"
 #include "buffer.h"
 #include "header.h"
 #include "trailer.h"
@@ -34,10 +35,16 @@ NS_LOG_COMPONENT_DEFINE ("PacketMetadata");
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
+__thread uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
 
+/**
+ * Size of the data created by the constructor, the only one created while
+ * the metadata is disabled, which the PacketPool recycles.
+ */
+static const uint32_t POOLED_DATA_SIZE = 10;
+
 PacketMetadata::DataFreeList::~DataFreeList ()
 {
   NS_LOG_FUNCTION (this);
@@ -62,6 +69,12 @@ PacketMetadata::Enable (void)
   m_enable = true;
 }
 
+bool
+PacketMetadata::IsEnabled (void)
+{
+  return m_enable;
+}
+
 void 
 PacketMetadata::EnableChecking (void)
 {
@@ -625,7 +638,15 @@ PacketMetadata::Allocate (uint32_t n)
       n = PACKET_METADATA_DATA_M_DATA_SIZE;
     }
   size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
-  uint8_t *buf = new uint8_t [size];
+  void *buf;
+  if (!m_enable && n == POOLED_DATA_SIZE)
+    {
+      buf = PacketPool::Allocate (PacketPool::METADATA, size);
+    }
+  else
+    {
+      buf = ::operator new (size);
+    }
   struct PacketMetadata::Data *data = (struct PacketMetadata::Data *)buf;
   data->m_size = n;
   data->m_count = 1;
@@ -636,8 +657,14 @@ void
 PacketMetadata::Deallocate (struct PacketMetadata::Data *data)
 {
   NS_LOG_FUNCTION (data);
-  uint8_t *buf = (uint8_t *)data;
-  delete [] buf;
+  if (data->m_size == POOLED_DATA_SIZE)
+    {
+      PacketPool::Deallocate (PacketPool::METADATA, data);
+    }
+  else
+    {
+      ::operator delete (data);
+    }
 }
 
 
@@ -651,6 +678,15 @@ PacketMetadata::CreateFragment (uint32_t start, uint32_t end) const
   return fragment;
 }
 
+PacketMetadata
+PacketMetadata::CreateUnsharedCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketMetadata copy = *this;
+  copy.ReserveCopy (0);
+  return copy;
+}
+
 void 
 PacketMetadata::AddHeader (const Header &header, uint32_t size)
 {
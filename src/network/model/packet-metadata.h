@@ -159,6 +159,10 @@ private:
    * \brief Enable the packet metadata checking
    */
   static void EnableChecking (void);
+  /**
+   * \returns true if the packet metadata is enabled
+   */
+  static bool IsEnabled (void);
 
   /**
    * \brief Constructor
@@ -217,6 +221,17 @@ private:
    */
   PacketMetadata CreateFragment (uint32_t start, uint32_t end) const;
 
+  /**
+   * \brief Creates a copy which shares no data with this metadata.
+   *
+   * \return the copy
+   *
+   * The copy can be handed to another thread as long as the metadata is
+   * not enabled: the free list of the enabled metadata is shared by all
+   * the threads.
+   */
+  PacketMetadata CreateUnsharedCopy (void) const;
+
   /**
    * \brief Add a metadata at the metadata start
    * \param o the metadata to add
@@ -667,7 +682,7 @@ public:
    */
   static bool m_metadataSkipped;
 
-  static uint32_t m_maxSize; //!< maximum metadata size
+  static __thread uint32_t m_maxSize; //!< maximum metadata size, per thread
   static uint16_t m_chunkUid; //!< Chunk Uid
 
   struct Data *m_data; //!< Metadata storage
@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "packet-pool.h"
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include <new>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketPool");
+
+namespace {
+
+/** Number of fixed size pools, the first kinds. */
+const uint32_t N_FIXED_POOLS = PacketPool::BUFFER;
+/** Most blocks kept per pool and thread. */
+const uint32_t POOL_MAX_BLOCKS = 1 << 16;
+
+/** A free block, linked to the next one of its pool. */
+struct FreeBlock
+{
+  FreeBlock *next; //!< next free block
+};
+
+__thread FreeBlock *g_freeBlocks[N_FIXED_POOLS];        //!< free blocks of the calling thread
+__thread uint32_t g_nFreeBlocks[N_FIXED_POOLS];         //!< number of free blocks of the calling thread
+__thread uint64_t g_hits[PacketPool::N_KINDS];          //!< hits of the calling thread
+__thread uint64_t g_misses[PacketPool::N_KINDS];        //!< misses of the calling thread
+__thread bool g_poolDestroyed = false;                  //!< whether the static destructors of the main thread have run
+uint64_t g_totalHits[PacketPool::N_KINDS];              //!< hits of the threads which released their lists
+uint64_t g_totalMisses[PacketPool::N_KINDS];            //!< misses of the threads which released their lists
+
+/** Release the free lists of the main thread at exit. */
+struct PacketPoolDestructor
+{
+  ~PacketPoolDestructor ()
+  {
+    PacketPool::ReleaseThreadFreeLists ();
+    g_poolDestroyed = true;
+  }
+} g_packetPoolDestructor; //!< releases the main thread free lists
+
+const char *g_kindNames[PacketPool::N_KINDS] = {
+  "Packet", "PacketTag", "Metadata", "Buffer", "ByteTag"
+};
+
+} // unnamed namespace
+
+bool PacketPool::m_enabled = false;
+
+void
+PacketPool::Enable (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  m_enabled = true;
+}
+
+bool
+PacketPool::IsEnabled (void)
+{
+  return m_enabled;
+}
+
+void *
+PacketPool::Allocate (enum Kind kind, std::size_t size)
+{
+  NS_ASSERT (kind < N_FIXED_POOLS);
+  if (!m_enabled)
+    {
+      return ::operator new (size);
+    }
+  FreeBlock *block = g_freeBlocks[kind];
+  if (block == 0)
+    {
+      g_misses[kind]++;
+      return ::operator new (size);
+    }
+  g_hits[kind]++;
+  g_freeBlocks[kind] = block->next;
+  g_nFreeBlocks[kind]--;
+  return block;
+}
+
+void
+PacketPool::Deallocate (enum Kind kind, void *p)
+{
+  NS_ASSERT (kind < N_FIXED_POOLS);
+  if (!m_enabled || g_poolDestroyed || g_nFreeBlocks[kind] >= POOL_MAX_BLOCKS)
+    {
+      ::operator delete (p);
+      return;
+    }
+  FreeBlock *block = static_cast<FreeBlock *> (p);
+  block->next = g_freeBlocks[kind];
+  g_freeBlocks[kind] = block;
+  g_nFreeBlocks[kind]++;
+}
+
+void
+PacketPool::NotifyHit (enum Kind kind)
+{
+  g_hits[kind]++;
+}
+
+void
+PacketPool::NotifyMiss (enum Kind kind)
+{
+  g_misses[kind]++;
+}
+
+uint64_t
+PacketPool::GetHits (enum Kind kind)
+{
+  return g_totalHits[kind] + g_hits[kind];
+}
+
+uint64_t
+PacketPool::GetMisses (enum Kind kind)
+{
+  return g_totalMisses[kind] + g_misses[kind];
+}
+
+void
+PacketPool::ResetStats (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  for (uint32_t i = 0; i < N_KINDS; i++)
+    {
+      g_totalHits[i] = 0;
+      g_totalMisses[i] = 0;
+      g_hits[i] = 0;
+      g_misses[i] = 0;
+    }
+}
+
+void
+PacketPool::Report (std::ostream &os)
+{
+  for (uint32_t i = 0; i < N_KINDS; i++)
+    {
+      enum Kind kind = static_cast<enum Kind> (i);
+      uint64_t hits = GetHits (kind);
+      uint64_t requests = hits + GetMisses (kind);
+      os << g_kindNames[i] << ": " << requests << " requests, " << hits << " hits";
+      if (requests > 0)
+        {
+          os << " (" << 100.0 * hits / requests << "%)";
+        }
+      os << std::endl;
+    }
+}
+
+void
+PacketPool::ReleaseThreadFreeLists (void)
+{
+  for (uint32_t i = 0; i < N_FIXED_POOLS; i++)
+    {
+      while (g_freeBlocks[i] != 0)
+        {
+          FreeBlock *block = g_freeBlocks[i];
+          g_freeBlocks[i] = block->next;
+          ::operator delete (block);
+        }
+      g_nFreeBlocks[i] = 0;
+    }
+  for (uint32_t i = 0; i < N_KINDS; i++)
+    {
+      __sync_fetch_and_add (&g_totalHits[i], g_hits[i]);
+      __sync_fetch_and_add (&g_totalMisses[i], g_misses[i]);
+      g_hits[i] = 0;
+      g_misses[i] = 0;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,120 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PACKET_POOL_H
+#define PACKET_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup packet
+ *
+ * \brief Per thread free lists of the storage of the packets
+ *
+ * Buffer and ByteTagList always recycle their data through per thread
+ * free lists. Once Packet::EnablePooling has been called, the Packet
+ * objects, the PacketTagList::TagData nodes and the data of the disabled
+ * packet metadata are recycled too, each through a free list of blocks of
+ * its size, and the Buffer data are allocated at the largest size seen so
+ * that the data of the small packets can be recycled as well: sending and
+ * forwarding a packet then seldom reaches malloc. The pools are off by
+ * default: they keep the memory of the peak number of packets, and hide
+ * the packets used after their release from memory checkers.
+ *
+ * Every pool counts the requests served from its free list (hits) and
+ * those which had to allocate (misses). The counters of a thread are added
+ * to the totals when it releases its free lists; GetHits and GetMisses
+ * return the totals plus the counters of the calling thread.
+ */
+class PacketPool
+{
+public:
+  /**
+   * The pools
+   */
+  enum Kind
+  {
+    PACKET = 0,   //!< Packet objects
+    PACKET_TAG,   //!< PacketTagList::TagData nodes
+    METADATA,     //!< PacketMetadata data, while the metadata is disabled
+    BUFFER,       //!< Buffer data
+    BYTE_TAG,     //!< ByteTagList data
+    N_KINDS       //!< number of pools
+  };
+
+  /**
+   * \brief Recycle the Packet objects, the packet tags and the metadata
+   */
+  static void Enable (void);
+  /**
+   * \returns true if Enable has been called
+   */
+  static bool IsEnabled (void);
+
+  /**
+   * \brief Allocate a block of a fixed size pool
+   *
+   * Allocates from the heap when the pools are disabled, without counting
+   * the request, or when the free list of the calling thread is empty.
+   *
+   * \param kind the pool, PACKET, PACKET_TAG or METADATA
+   * \param size the size of the block, the same for all the blocks of the pool
+   * \returns the block
+   */
+  static void * Allocate (enum Kind kind, std::size_t size);
+  /**
+   * \brief Release a block of a fixed size pool
+   *
+   * \param kind the pool the block was allocated from
+   * \param p the block
+   */
+  static void Deallocate (enum Kind kind, void *p);
+
+  /**
+   * \brief Count a request served from a free list
+   * \param kind the pool
+   */
+  static void NotifyHit (enum Kind kind);
+  /**
+   * \brief Count a request which had to allocate
+   * \param kind the pool
+   */
+  static void NotifyMiss (enum Kind kind);
+
+  /**
+   * \param kind the pool
+   * \returns the requests of the pool served from its free lists
+   */
+  static uint64_t GetHits (enum Kind kind);
+  /**
+   * \param kind the pool
+   * \returns the requests of the pool which had to allocate
+   */
+  static uint64_t GetMisses (enum Kind kind);
+  /**
+   * \brief Reset the counters of all the pools
+   *
+   * Only the totals and the counters of the calling thread are reset.
+   */
+  static void ResetStats (void);
+  /**
+   * \brief Print the hits and misses of every pool
+   * \param os the output stream
+   */
+  static void Report (std::ostream &os);
+
+  /**
+   * \brief Free the blocks kept by the calling thread and add its
+   * counters to the totals, see Packet::ReleaseThreadFreeLists
+   */
+  static void ReleaseThreadFreeLists (void);
+
+private:
+  static bool m_enabled; //!< whether the fixed size pools are in use
+};
+
+} // namespace ns3
+
+#endif /* PACKET_POOL_H */
@@ -26,6 +26,7 @@
 #include "packet-tag-list.h"
 #include "tag-buffer.h"
 #include "tag.h"
+#include "packet-pool.h"
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 #include <cstring>
@@ -34,6 +35,19 @@ namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("PacketTagList");
 
+void *
+PacketTagList::TagData::operator new (std::size_t size)
+{
+  NS_ASSERT (size == sizeof (TagData));
+  return PacketPool::Allocate (PacketPool::PACKET_TAG, size);
+}
+
+void
+PacketTagList::TagData::operator delete (void *p)
+{
+  PacketPool::Deallocate (PacketPool::PACKET_TAG, p);
+}
+
 bool
 PacketTagList::COWTraverse (Tag & tag, PacketTagList::COWWriter Writer)
 {
@@ -284,5 +298,22 @@ PacketTagList::Head (void) const
   return m_next;
 }
 
+PacketTagList
+PacketTagList::CreateUnsharedCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  PacketTagList copy;
+  struct TagData **tail = &copy.m_next;
+  for (const struct TagData *cur = m_next; cur != 0; cur = cur->next)
+    {
+      struct TagData *data = new struct TagData (*cur);
+      data->count = 1;
+      data->next = 0;
+      *tail = data;
+      tail = &data->next;
+    }
+  return copy;
+}
+
 } /* namespace ns3 */
 
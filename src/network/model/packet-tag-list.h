@@ -26,6 +26,7 @@
 */
 
 #include <stdint.h>
+#include <cstddef>
 #include <ostream>
 #include "ns3/type-id.h"
 
@@ -165,6 +166,18 @@ public:
     struct TagData * next;   /**< Pointer to next in list */
     TypeId tid;               /**< Type of the tag serialized into #data */
     uint32_t count;           /**< Number of incoming links */
+
+    /**
+     * Allocate from the PacketPool.
+     * \param size the size of the TagData
+     * \returns the memory of the TagData
+     */
+    static void * operator new (std::size_t size);
+    /**
+     * Return to the PacketPool.
+     * \param p the memory of the TagData
+     */
+    static void operator delete (void *p);
   };  /* struct TagData */
 
   /**
@@ -237,6 +250,15 @@ public:
    * \returns pointer to head of tag list
    */
   const struct PacketTagList::TagData *Head (void) const;
+  /**
+   * \brief Create a copy of this list which shares no \ref TagData with it
+   *
+   * The light-weight copies count their references without locks, a list
+   * handed to another thread must be made with this method.
+   *
+   * \returns the copy
+   */
+  PacketTagList CreateUnsharedCopy (void) const;
 
 private:
   /**
@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "packet-tag-slots.h"
+#include "tag.h"
+#include "tag-buffer.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <cstring>
+#include <vector>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketTagSlots");
+
+/**
+ * \brief The types given a slot, filled during the static initialization
+ */
+struct PacketTagSlotRegistry
+{
+  PacketTagSlotRegistry ()
+    : nSlots (0)
+  {
+  }
+
+  std::vector<int8_t> slotOfUid;                //!< [TypeId uid], -1 for none
+  TypeId tids[PacketTagSlots::N_SLOTS];         //!< [slot]
+  uint32_t nSlots;
+};
+
+static PacketTagSlotRegistry &
+GetPacketTagSlotRegistry (void)
+{
+  // Local, to be built before the registrations of the other files
+  static PacketTagSlotRegistry registry;
+  return registry;
+}
+
+PacketTagSlots::PacketTagSlots ()
+  : m_used (0)
+{
+}
+
+PacketTagSlots::PacketTagSlots (const PacketTagSlots &o)
+  : m_used (o.m_used)
+{
+  if (m_used != 0)
+    {
+      std::memcpy (m_data, o.m_data, sizeof (m_data));
+    }
+}
+
+PacketTagSlots &
+PacketTagSlots::operator = (const PacketTagSlots &o)
+{
+  m_used = o.m_used;
+  if (m_used != 0 && this != &o)
+    {
+      std::memcpy (m_data, o.m_data, sizeof (m_data));
+    }
+  return *this;
+}
+
+uint32_t
+PacketTagSlots::Register (TypeId tid)
+{
+  NS_LOG_FUNCTION (tid);
+  PacketTagSlotRegistry &registry = GetPacketTagSlotRegistry ();
+  int32_t slot = GetSlot (tid);
+  if (slot >= 0)
+    {
+      return slot;
+    }
+  NS_ABORT_MSG_IF (registry.nSlots == N_SLOTS, "No packet tag slot left for " << tid.GetName ());
+  if (tid.GetUid () >= registry.slotOfUid.size ())
+    {
+      registry.slotOfUid.resize (tid.GetUid () + 1, -1);
+    }
+  registry.slotOfUid[tid.GetUid ()] = registry.nSlots;
+  registry.tids[registry.nSlots] = tid;
+  return registry.nSlots++;
+}
+
+int32_t
+PacketTagSlots::GetSlot (TypeId tid)
+{
+  const std::vector<int8_t> &slotOfUid = GetPacketTagSlotRegistry ().slotOfUid;
+  uint16_t uid = tid.GetUid ();
+  return uid < slotOfUid.size () ? slotOfUid[uid] : -1;
+}
+
+TypeId
+PacketTagSlots::GetTypeId (uint32_t slot)
+{
+  NS_ASSERT (slot < GetPacketTagSlotRegistry ().nSlots);
+  return GetPacketTagSlotRegistry ().tids[slot];
+}
+
+void
+PacketTagSlots::Add (uint32_t slot, const Tag &tag) const
+{
+  NS_ASSERT_MSG ((m_used & (1 << slot)) == 0, "Error: cannot add the same kind of tag twice.");
+  NS_ABORT_MSG_IF (tag.GetSerializedSize () > SLOT_SIZE,
+                   tag.GetInstanceTypeId ().GetName () << " is too large for a packet tag slot");
+  PacketTagSlots *self = const_cast<PacketTagSlots *> (this);
+  tag.Serialize (TagBuffer (self->m_data[slot], self->m_data[slot] + tag.GetSerializedSize ()));
+  self->m_used |= 1 << slot;
+}
+
+bool
+PacketTagSlots::Peek (uint32_t slot, Tag &tag) const
+{
+  if ((m_used & (1 << slot)) == 0)
+    {
+      return false;
+    }
+  uint8_t *data = const_cast<uint8_t *> (m_data[slot]);
+  tag.Deserialize (TagBuffer (data, data + SLOT_SIZE));
+  return true;
+}
+
+bool
+PacketTagSlots::Remove (uint32_t slot, Tag &tag)
+{
+  if (!Peek (slot, tag))
+    {
+      return false;
+    }
+  m_used &= ~(1 << slot);
+  return true;
+}
+
+bool
+PacketTagSlots::Replace (uint32_t slot, const Tag &tag)
+{
+  bool found = (m_used & (1 << slot)) != 0;
+  m_used &= ~(1 << slot);
+  Add (slot, tag);
+  return found;
+}
+
+void
+PacketTagSlots::RemoveAll (void)
+{
+  m_used = 0;
+}
+
+uint32_t
+PacketTagSlots::GetNextUsed (uint32_t slot) const
+{
+  while (slot < N_SLOTS && (m_used & (1 << slot)) == 0)
+    {
+      ++slot;
+    }
+  return slot;
+}
+
+const uint8_t *
+PacketTagSlots::GetData (uint32_t slot) const
+{
+  NS_ASSERT ((m_used & (1 << slot)) != 0);
+  return m_data[slot];
+}
+
+} // namespace ns3
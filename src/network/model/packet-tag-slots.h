@@ -0,0 +1,134 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PACKET_TAG_SLOTS_H
+#define PACKET_TAG_SLOTS_H
+
+#include <stdint.h>
+#include "ns3/type-id.h"
+
+namespace ns3 {
+
+class Tag;
+
+/**
+ * \ingroup packet
+ *
+ * \brief Fixed slots holding the packet tags of the hot tag types
+ *
+ * The load balancers read or rewrite a few packet tags at every hop: the
+ * flow id, the XPath path id, the CONGA header, the ECN and TLB tags of
+ * TCP and the timestamps of the queue discs. In the PacketTagList every
+ * add, and every remove or replace of a shared tag, allocates a TagData.
+ *
+ * A tag type registered with Register gets a slot of its own in every
+ * Packet. Adding, peeking, replacing and removing a tag of that type
+ * serializes it into or out of its slot in place: no allocation and no
+ * list walk. The slots are copied by value with the packet, so that
+ * rewriting the tag of a copy does not touch the original. The tag types
+ * without a slot stay in the PacketTagList.
+ *
+ * A type must be registered before the first packet carries one of its
+ * tags, from the static initialization of its module through
+ * NS_PACKET_TAG_SLOT. The modules of the tree register 7 types; the other
+ * slots are left for the tags of the programs and tests.
+ *
+ * Every Packet carries the N_SLOTS * SLOT_SIZE bytes of the slots, 320
+ * bytes, whether it holds slotted tags or not; they are only copied with
+ * the packet when a slot holds a tag.
+ *
+ * This class is mostly private to the Packet implementation.
+ */
+class PacketTagSlots
+{
+public:
+  enum
+  {
+    N_SLOTS = 16,       //!< Number of slotted tag types
+    SLOT_SIZE = 20      //!< Largest serialized size of a slotted tag
+  };
+
+  PacketTagSlots ();
+  PacketTagSlots (const PacketTagSlots &o);
+  PacketTagSlots & operator = (const PacketTagSlots &o);
+
+  /**
+   * \brief Give a slot to the tags of a type
+   * \param tid the type of the tags, serializing to at most SLOT_SIZE bytes
+   * \returns the slot of the type
+   *
+   * Registering a type twice returns its slot.
+   */
+  static uint32_t Register (TypeId tid);
+
+  /**
+   * \param tid the type of a tag
+   * \returns the slot of the type, -1 if it has none
+   */
+  static int32_t GetSlot (TypeId tid);
+
+  /**
+   * \param slot a slot
+   * \returns the type the slot was given to
+   */
+  static TypeId GetTypeId (uint32_t slot);
+
+  /**
+   * \brief Add a tag, its slot must be empty
+   *
+   * As PacketTagList::Add, this does not change the other tags and is const.
+   * Aborts if the tag serializes to more than SLOT_SIZE bytes.
+   */
+  void Add (uint32_t slot, const Tag &tag) const;
+
+  /**
+   * \returns true if the slot held a tag, deserialized in tag
+   */
+  bool Peek (uint32_t slot, Tag &tag) const;
+
+  /**
+   * \returns true if the slot held a tag, deserialized in tag and removed
+   */
+  bool Remove (uint32_t slot, Tag &tag);
+
+  /**
+   * \brief Rewrite the tag of the slot, or add it
+   * \returns true if the slot held a tag
+   */
+  bool Replace (uint32_t slot, const Tag &tag);
+
+  void RemoveAll (void);
+
+  /**
+   * \param slot the first slot to look at
+   * \returns the first slot from slot on holding a tag, N_SLOTS if none
+   */
+  uint32_t GetNextUsed (uint32_t slot) const;
+
+  /**
+   * \returns the serialized tag of a slot holding one
+   */
+  const uint8_t * GetData (uint32_t slot) const;
+
+private:
+  uint16_t m_used;                      //!< bitmap of the slots holding a tag
+  uint8_t m_data[N_SLOTS][SLOT_SIZE];   //!< serialized tags
+};
+
+} // namespace ns3
+
+/**
+ * \ingroup packet
+ *
+ * \brief Keep the packet tags of a type in a PacketTagSlots slot, next to
+ * the NS_OBJECT_ENSURE_REGISTERED of the tag
+ *
+ * \param type the tag class
+ */
+#define NS_PACKET_TAG_SLOT(type)                                \
+  static struct PacketTagSlot ## type ## RegistrationClass      \
+  {                                                             \
+    PacketTagSlot ## type ## RegistrationClass () {             \
+      ns3::PacketTagSlots::Register (type::GetTypeId ());       \
+    }                                                           \
+  } PacketTagSlot ## type ## RegistrationVariable
+
+#endif /* PACKET_TAG_SLOTS_H */
@@ -81,40 +81,50 @@ ByteTagIterator::ByteTagIterator (ByteTagList::Iterator i)
 }
 
 
-PacketTagIterator::PacketTagIterator (const struct PacketTagList::TagData *head)
-  : m_current (head)
+PacketTagIterator::PacketTagIterator (const PacketTagSlots *slots, const struct PacketTagList::TagData *head)
+  : m_slots (slots),
+    m_slot (slots->GetNextUsed (0)),
+    m_current (head)
 {
 }
 bool
 PacketTagIterator::HasNext (void) const
 {
-  return m_current != 0;
+  return m_slot < PacketTagSlots::N_SLOTS || m_current != 0;
 }
 PacketTagIterator::Item
 PacketTagIterator::Next (void)
 {
   NS_ASSERT (HasNext ());
+  if (m_slot < PacketTagSlots::N_SLOTS)
+    {
+      uint32_t slot = m_slot;
+      m_slot = m_slots->GetNextUsed (slot + 1);
+      return PacketTagIterator::Item (PacketTagSlots::GetTypeId (slot), m_slots->GetData (slot),
+                                      PacketTagSlots::SLOT_SIZE);
+    }
   const struct PacketTagList::TagData *prev = m_current;
   m_current = m_current->next;
-  return PacketTagIterator::Item (prev);
+  return PacketTagIterator::Item (prev->tid, prev->data, PacketTagList::TagData::MAX_SIZE);
 }
 
-PacketTagIterator::Item::Item (const struct PacketTagList::TagData *data)
-  : m_data (data)
+PacketTagIterator::Item::Item (TypeId tid, const uint8_t *data, uint32_t size)
+  : m_tid (tid),
+    m_data (data),
+    m_size (size)
 {
 }
 TypeId
 PacketTagIterator::Item::GetTypeId (void) const
 {
-  return m_data->tid;
+  return m_tid;
 }
 void
 PacketTagIterator::Item::GetTag (Tag &tag) const
 {
-  NS_ASSERT (tag.GetInstanceTypeId () == m_data->tid);
-  tag.Deserialize (TagBuffer ((uint8_t*)m_data->data,
-                              (uint8_t*)m_data->data
-                              + PacketTagList::TagData::MAX_SIZE));
+  NS_ASSERT (tag.GetInstanceTypeId () == m_tid);
+  tag.Deserialize (TagBuffer ((uint8_t*)m_data,
+                              (uint8_t*)m_data + m_size));
 }
 
 
@@ -127,26 +137,78 @@ Packet::Copy (void) const
   return Ptr<Packet> (new Packet (*this), false);
 }
 
+Ptr<Packet>
+Packet::CreateUnsharedCopy (void) const
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<Packet> ret = Ptr<Packet> (new Packet (m_buffer.CreateUnsharedCopy (),
+                                             m_byteTagList.CreateUnsharedCopy (),
+                                             m_packetTagList.CreateUnsharedCopy (),
+                                             m_packetTagSlots,
+                                             m_metadata.CreateUnsharedCopy ()), false);
+  if (m_nixVector)
+    {
+      ret->m_nixVector = m_nixVector->Copy ();
+    }
+  return ret;
+}
+
+void
+Packet::ReleaseThreadFreeLists (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  Buffer::ReleaseThreadFreeList ();
+  ByteTagList::ReleaseThreadFreeList ();
+  PacketPool::ReleaseThreadFreeLists ();
+}
+
+void
+Packet::EnablePooling (void)
+{
+  NS_LOG_FUNCTION_NOARGS ();
+  PacketPool::Enable ();
+}
+
+void *
+Packet::operator new (std::size_t size)
+{
+  NS_ASSERT (size == sizeof (Packet));
+  return PacketPool::Allocate (PacketPool::PACKET, size);
+}
+
+void
+Packet::operator delete (void *p)
+{
+  PacketPool::Deallocate (PacketPool::PACKET, p);
+}
+
+uint32_t
+Packet::AllocateUid (void)
+{
+  return __sync_fetch_and_add (&m_globalUid, 1);
+}
+
 Packet::Packet ()
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
+    m_packetTagSlots (),
     /* The upper 32 bits of the packet id in 
      * metadata is for the system id. For non-
      * distributed simulations, this is simply 
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, 0),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), 0),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 
 Packet::Packet (const Packet &o)
   : m_buffer (o.m_buffer),
     m_byteTagList (o.m_byteTagList),
     m_packetTagList (o.m_packetTagList),
+    m_packetTagSlots (o.m_packetTagSlots),
     m_metadata (o.m_metadata)
 {
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy ()
@@ -163,6 +225,7 @@ Packet::operator = (const Packet &o)
   m_buffer = o.m_buffer;
   m_byteTagList = o.m_byteTagList;
   m_packetTagList = o.m_packetTagList;
+  m_packetTagSlots = o.m_packetTagSlots;
   m_metadata = o.m_metadata;
   o.m_nixVector ? m_nixVector = o.m_nixVector->Copy () 
     : m_nixVector = 0;
@@ -173,21 +236,22 @@ Packet::Packet (uint32_t size)
   : m_buffer (size),
     m_byteTagList (),
     m_packetTagList (),
+    m_packetTagSlots (),
     /* The upper 32 bits of the packet id in 
      * metadata is for the system id. For non-
      * distributed simulations, this is simply 
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
 }
 Packet::Packet (uint8_t const *buffer, uint32_t size, bool magic)
   : m_buffer (0, false),
     m_byteTagList (),
     m_packetTagList (),
+    m_packetTagSlots (),
     m_metadata (0,0),
     m_nixVector (0)
 {
@@ -199,26 +263,28 @@ Packet::Packet (uint8_t const*buffer, uint32_t size)
   : m_buffer (),
     m_byteTagList (),
     m_packetTagList (),
+    m_packetTagSlots (),
     /* The upper 32 bits of the packet id in 
      * metadata is for the system id. For non-
      * distributed simulations, this is simply 
      * zero.  The lower 32 bits are for the 
      * global UID
      */
-    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | m_globalUid, size),
+    m_metadata (static_cast<uint64_t> (Simulator::GetSystemId ()) << 32 | AllocateUid (), size),
     m_nixVector (0)
 {
-  m_globalUid++;
   m_buffer.AddAtStart (size);
   Buffer::Iterator i = m_buffer.Begin ();
   i.Write (buffer, size);
 }
 
 Packet::Packet (const Buffer &buffer,  const ByteTagList &byteTagList, 
-                const PacketTagList &packetTagList, const PacketMetadata &metadata)
+                const PacketTagList &packetTagList, const PacketTagSlots &packetTagSlots,
+                const PacketMetadata &metadata)
   : m_buffer (buffer),
     m_byteTagList (byteTagList),
     m_packetTagList (packetTagList),
+    m_packetTagSlots (packetTagSlots),
     m_metadata (metadata),
     m_nixVector (0)
 {
@@ -236,7 +302,7 @@ Packet::CreateFragment (uint32_t start, uint32_t length) const
   PacketMetadata metadata = m_metadata.CreateFragment (start, end);
   // again, call the constructor directly rather than
   // through Create because it is private.
-  Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, metadata), false);
+  Ptr<Packet> ret = Ptr<Packet> (new Packet (buffer, byteTagList, m_packetTagList, m_packetTagSlots, metadata), false);
   ret->SetNixVector (GetNixVector ());
   return ret;
 }
@@ -824,6 +890,12 @@ void
 Packet::AddPacketTag (const Tag &tag) const
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize ());
+  int32_t slot = PacketTagSlots::GetSlot (tag.GetInstanceTypeId ());
+  if (slot >= 0)
+    {
+      m_packetTagSlots.Add (slot, tag);
+      return;
+    }
   m_packetTagList.Add (tag);
 }
 
@@ -831,6 +903,11 @@ bool
 Packet::RemovePacketTag (Tag &tag)
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize ());
+  int32_t slot = PacketTagSlots::GetSlot (tag.GetInstanceTypeId ());
+  if (slot >= 0)
+    {
+      return m_packetTagSlots.Remove (slot, tag);
+    }
   bool found = m_packetTagList.Remove (tag);
   return found;
 }
@@ -838,6 +915,11 @@ bool
 Packet::ReplacePacketTag (Tag &tag)
 {
   NS_LOG_FUNCTION (this << tag.GetInstanceTypeId ().GetName () << tag.GetSerializedSize ());
+  int32_t slot = PacketTagSlots::GetSlot (tag.GetInstanceTypeId ());
+  if (slot >= 0)
+    {
+      return m_packetTagSlots.Replace (slot, tag);
+    }
   bool found = m_packetTagList.Replace (tag);
   return found;
 }
@@ -845,6 +927,11 @@ Packet::ReplacePacketTag (Tag &tag)
 bool 
 Packet::PeekPacketTag (Tag &tag) const
 {
+  int32_t slot = PacketTagSlots::GetSlot (tag.GetInstanceTypeId ());
+  if (slot >= 0)
+    {
+      return m_packetTagSlots.Peek (slot, tag);
+    }
   bool found = m_packetTagList.Peek (tag);
   return found;
 }
@@ -853,6 +940,7 @@ Packet::RemoveAllPacketTags (void)
 {
   NS_LOG_FUNCTION (this);
   m_packetTagList.RemoveAll ();
+  m_packetTagSlots.RemoveAll ();
 }
 
 void 
@@ -881,7 +969,7 @@ Packet::PrintPacketTags (std::ostream &os) const
 PacketTagIterator 
 Packet::GetPacketTagIterator (void) const
 {
-  return PacketTagIterator (m_packetTagList.Head ());
+  return PacketTagIterator (&m_packetTagSlots, m_packetTagList.Head ());
 }
 
 std::ostream& operator<< (std::ostream& os, const Packet &packet)
@@ -28,7 +28,9 @@
 #include "tag.h"
 #include "byte-tag-list.h"
 #include "packet-tag-list.h"
+#include "packet-tag-slots.h"
 #include "nix-vector.h"
+#include "packet-pool.h"
 #include "ns3/mac48-address.h"
 #include "ns3/callback.h"
 #include "ns3/assert.h"
@@ -124,7 +126,8 @@ private:
  * \ingroup packet
  * \brief Iterator over the set of packet tags in a packet
  *
- * This is a java-style iterator.
+ * This is a java-style iterator. The tags of the slots come first, then
+ * those of the list.
  */
 class PacketTagIterator
 {
@@ -152,10 +155,14 @@ private:
     friend class PacketTagIterator;
     /**
      * Constructor
-     * \param data the data to copy.
+     * \param tid the ns3::TypeId of the tag
+     * \param data the serialized tag
+     * \param size the size of the serialization buffer
      */
-    Item (const struct PacketTagList::TagData *data);
-    const struct PacketTagList::TagData *m_data; //!< the tag data
+    Item (TypeId tid, const uint8_t *data, uint32_t size);
+    TypeId m_tid;               //!< the ns3::TypeId of the tag
+    const uint8_t *m_data;      //!< the serialized tag
+    uint32_t m_size;            //!< the size of the serialization buffer
   };
   /**
    * \returns true if calling Next is safe, false otherwise.
@@ -169,9 +176,12 @@ private:
   friend class Packet;
   /**
    * Constructor
+   * \param slots the slotted tags
    * \param head head of the items
    */
-  PacketTagIterator (const struct PacketTagList::TagData *head);
+  PacketTagIterator (const PacketTagSlots *slots, const struct PacketTagList::TagData *head);
+  const PacketTagSlots *m_slots;  //!< the slotted tags
+  uint32_t m_slot;                //!< next slot holding a tag, PacketTagSlots::N_SLOTS after them
   const struct PacketTagList::TagData *m_current;  //!< actual position over the set of tags in a packet
 };
 
@@ -424,6 +434,49 @@ public:
    */
   Ptr<Packet> Copy (void) const;
 
+  /**
+   * \brief performs a deep copy of the packet.
+   *
+   * \returns a copy of the packet which shares none of its datasets.
+   *
+   * The reference counts of the packets and of their shared datasets are
+   * not atomic, so a packet handed to another thread must not share
+   * anything with the packets the sending thread keeps. The packet
+   * metadata must not be enabled (see PacketMetadata::CreateUnsharedCopy).
+   */
+  Ptr<Packet> CreateUnsharedCopy (void) const;
+
+  /**
+   * \brief Free the packet storage kept for reuse by the calling thread.
+   *
+   * The buffers, the byte tags and, with EnablePooling, the packets keep
+   * per thread free lists, those of the main thread are released at exit.
+   * The other threads which create packets call this before they exit.
+   */
+  static void ReleaseThreadFreeLists (void);
+
+  /**
+   * \brief Recycle the packets, their tags and their metadata through
+   * per thread free lists, see PacketPool.
+   *
+   * Call this during the simulation setup.
+   */
+  static void EnablePooling (void);
+
+  /**
+   * \brief Allocate a packet from the PacketPool.
+   *
+   * \param size the size of the packet
+   * \returns the memory of the packet
+   */
+  static void * operator new (std::size_t size);
+  /**
+   * \brief Return the memory of a packet to the PacketPool.
+   *
+   * \param p the memory of the packet
+   */
+  static void operator delete (void *p);
+
   /**
    * \brief Returns the packet's Uid.
    *
@@ -706,21 +759,29 @@ private:
    * \param buffer the packet buffer
    * \param byteTagList the ByteTag list
    * \param packetTagList the packet's Tag list
+   * \param packetTagSlots the packet's slotted Tags
    * \param metadata the packet's metadata
    */
   Packet (const Buffer &buffer, const ByteTagList &byteTagList, 
-          const PacketTagList &packetTagList, const PacketMetadata &metadata);
+          const PacketTagList &packetTagList, const PacketTagSlots &packetTagSlots,
+          const PacketMetadata &metadata);
 
   uint32_t Deserialize (uint8_t const*buffer, uint32_t size);
 
   Buffer m_buffer;                //!< the packet buffer (it's actual contents)
   ByteTagList m_byteTagList;      //!< the ByteTag list
   PacketTagList m_packetTagList;  //!< the packet's Tag list
+  PacketTagSlots m_packetTagSlots; //!< the packet's Tags of the slotted types
   PacketMetadata m_metadata;      //!< the packet's metadata
 
   /* Please see comments above about nix-vector */
   Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+  /**
+   * \returns a new packet Uid, the packets may be created by several threads
+   */
+  static uint32_t AllocateUid (void);
+
   static uint32_t m_globalUid; //!< Global counter of packets Uid
 };
 
@@ -772,6 +833,10 @@ std::ostream& operator<< (std::ostream& os, const Packet &packet);
  * dirty operations have been optimized for common use-cases which
  * means that most of the time, these operations will not trigger
  * data copies and will thus be still very fast.
+ *
+ * The packet tags of the types registered with PacketTagSlots are kept
+ * in fixed slots of the packet and copied with it, all the packet tag
+ * operations on them are non-dirty.
  */
 
 } // namespace ns3
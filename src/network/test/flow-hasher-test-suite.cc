@@ -0,0 +1,139 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/flow-hasher.h"
+#include "ns3/test.h"
+
+#include <cstring>
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * Check the hash kernels against their published reference vectors.
+ */
+class FlowHasherKernelTestCase : public TestCase
+{
+public:
+  FlowHasherKernelTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowHasherKernelTestCase::FlowHasherKernelTestCase ()
+  : TestCase ("Flow hasher kernels match reference vectors")
+{
+}
+
+void
+FlowHasherKernelTestCase::DoRun (void)
+{
+  const char *check = "123456789";
+  NS_TEST_ASSERT_MSG_EQ (FlowHasher::Crc32c (reinterpret_cast<const uint8_t *> (check), std::strlen (check), 0),
+                         0xE3069283, "CRC32C check value mismatch");
+
+  const char *hello = "Hello, world!";
+  NS_TEST_ASSERT_MSG_EQ (FlowHasher::Murmur3 (0, 0, 1), 0x514E28B7, "Murmur3 empty input mismatch");
+  NS_TEST_ASSERT_MSG_EQ (FlowHasher::Murmur3 (reinterpret_cast<const uint8_t *> (hello), std::strlen (hello), 1234),
+                         0xFAF6CDB3, "Murmur3 reference mismatch");
+
+  // Microsoft RSS verification suite, IPv4 with TCP ports
+  // 66.9.149.187:2794 -> 161.142.100.80:1766
+  const uint8_t rss[12] = { 66, 9, 149, 187, 161, 142, 100, 80, 0x0a, 0xea, 0x06, 0xe6 };
+  NS_TEST_ASSERT_MSG_EQ (FlowHasher::Toeplitz (rss, sizeof (rss)), 0x51ccc178, "Toeplitz RSS vector mismatch");
+}
+
+/**
+ * Check that the 5-tuple hash uses every field and the seed.
+ */
+class FlowHasherTupleTestCase : public TestCase
+{
+public:
+  FlowHasherTupleTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowHasherTupleTestCase::FlowHasherTupleTestCase ()
+  : TestCase ("Flow hasher 5-tuple covers source, destination and seed")
+{
+}
+
+void
+FlowHasherTupleTestCase::DoRun (void)
+{
+  Ipv4Address a ("10.1.0.1");
+  Ipv4Address b ("10.2.0.1");
+  FlowHasher::HashKernel kernels[] = { FlowHasher::CRC32C, FlowHasher::MURMUR3, FlowHasher::TOEPLITZ };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      FlowHasher hasher (kernels[i]);
+      uint32_t h = hasher.GetHash (a, b, 1000, 80, 6);
+      NS_TEST_ASSERT_MSG_EQ (hasher.GetHash (a, b, 1000, 80, 6), h, "Hash is not deterministic");
+      NS_TEST_ASSERT_MSG_NE (hasher.GetHash (Ipv4Address ("10.1.0.2"), b, 1000, 80, 6), h, "Source address ignored");
+      NS_TEST_ASSERT_MSG_NE (hasher.GetHash (a, b, 1001, 80, 6), h, "Source port ignored");
+      NS_TEST_ASSERT_MSG_NE (hasher.GetHash (a, b, 1000, 80, 17), h, "Protocol ignored");
+      NS_TEST_ASSERT_MSG_NE (hasher.GetHash (a, b, 1000, 80, 6, 64), h, "Seed ignored");
+      NS_TEST_ASSERT_MSG_NE (hasher.GetHash (h, 63), hasher.GetHash (h, 64), "Per-hop seed ignored");
+    }
+}
+
+/**
+ * Check that the per-hop hashes of a flow at two TTLs pick their ECMP
+ * buckets independently: every bucket at the first hop must lead to every
+ * bucket at the second one over enough flows.
+ */
+class FlowHasherHopTestCase : public TestCase
+{
+public:
+  FlowHasherHopTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowHasherHopTestCase::FlowHasherHopTestCase ()
+  : TestCase ("Flow hasher per-hop buckets are not functionally dependent")
+{
+}
+
+void
+FlowHasherHopTestCase::DoRun (void)
+{
+  FlowHasher::HashKernel kernels[] = { FlowHasher::CRC32C, FlowHasher::MURMUR3, FlowHasher::TOEPLITZ };
+  uint32_t sizes[] = { 2, 4, 8 };
+  for (uint32_t i = 0; i < 3; ++i)
+    {
+      FlowHasher hasher (kernels[i]);
+      for (uint32_t s = 0; s < 3; ++s)
+        {
+          uint32_t n = sizes[s];
+          std::vector<bool> seen (n * n, false);
+          for (uint32_t flow = 1; flow <= 2000; ++flow)
+            {
+              uint32_t flowId = flow * 2654435761u;
+              uint32_t first = hasher.GetHopHash (flowId, 0, 64) % n;
+              uint32_t second = hasher.GetHopHash (flowId, 0, 63) % n;
+              seen[first * n + second] = true;
+            }
+          for (uint32_t b = 0; b < n * n; ++b)
+            {
+              NS_TEST_EXPECT_MSG_EQ (seen[b], true, "Kernel " << i << " with " << n << " buckets never maps bucket "
+                                     << b / n << " to bucket " << b % n << " at the next hop");
+            }
+        }
+    }
+}
+
+class FlowHasherTestSuite : public TestSuite
+{
+public:
+  FlowHasherTestSuite ();
+};
+
+FlowHasherTestSuite::FlowHasherTestSuite ()
+  : TestSuite ("flow-hasher", UNIT)
+{
+  AddTestCase (new FlowHasherKernelTestCase, TestCase::QUICK);
+  AddTestCase (new FlowHasherTupleTestCase, TestCase::QUICK);
+  AddTestCase (new FlowHasherHopTestCase, TestCase::QUICK);
+}
+
+static FlowHasherTestSuite g_flowHasherTestSuite;
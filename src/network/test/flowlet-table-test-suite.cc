@@ -0,0 +1,74 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/flowlet-table.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Check flowlet insertion, lookup and age-based reuse in a single bucket.
+ */
+class FlowletTableReuseTestCase : public TestCase
+{
+public:
+  FlowletTableReuseTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+FlowletTableReuseTestCase::FlowletTableReuseTestCase ()
+  : TestCase ("Flowlet table reuses the oldest entry of a full bucket")
+{
+}
+
+void
+FlowletTableReuseTestCase::DoRun (void)
+{
+  // A single bucket, every flow collides
+  FlowletTable table (FlowletTable::WAYS);
+  table.SetTimeout (MicroSeconds (50));
+  NS_TEST_ASSERT_MSG_EQ (table.GetSize (), FlowletTable::WAYS, "Unexpected table size");
+  NS_TEST_ASSERT_MSG_EQ ((table.Lookup (1) == 0), true, "Empty table hit");
+
+  for (uint32_t flow = 1; flow <= FlowletTable::WAYS; ++flow)
+    {
+      FlowletEntry *entry = table.Insert (flow, MicroSeconds (flow));
+      entry->port = flow + 10;
+    }
+  NS_TEST_ASSERT_MSG_EQ (table.GetNCollisions (), 0, "Free ways not used first");
+  for (uint32_t flow = 1; flow <= FlowletTable::WAYS; ++flow)
+    {
+      FlowletEntry *entry = table.Lookup (flow);
+      NS_TEST_ASSERT_MSG_EQ ((entry != 0), true, "Flow lost");
+      NS_TEST_ASSERT_MSG_EQ (entry->port, flow + 10, "Flows share an entry");
+    }
+
+  // Bucket full, flow 1 is the oldest but still active: evicted
+  table.Insert (100, MicroSeconds (10));
+  NS_TEST_ASSERT_MSG_EQ (table.GetNCollisions (), 1, "Collision not counted");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNEvictions (), 1, "Eviction not counted");
+  NS_TEST_ASSERT_MSG_EQ ((table.Lookup (1) == 0), true, "Oldest entry not reused");
+
+  // Much later, every entry is idle: reused without eviction
+  table.Insert (200, MilliSeconds (1));
+  NS_TEST_ASSERT_MSG_EQ (table.GetNCollisions (), 2, "Collision not counted");
+  NS_TEST_ASSERT_MSG_EQ (table.GetNEvictions (), 1, "Idle entry reuse counted as eviction");
+  NS_TEST_ASSERT_MSG_EQ ((table.Lookup (2) == 0), true, "Oldest entry not reused");
+  NS_TEST_ASSERT_MSG_EQ (table.Insert (200, MilliSeconds (2)), table.Lookup (200), "Existing entry not returned");
+
+  table.Clear ();
+  NS_TEST_ASSERT_MSG_EQ ((table.Lookup (200) == 0), true, "Cleared table hit");
+}
+
+class FlowletTableTestSuite : public TestSuite
+{
+public:
+  FlowletTableTestSuite ();
+};
+
+FlowletTableTestSuite::FlowletTableTestSuite ()
+  : TestSuite ("flowlet-table", UNIT)
+{
+  AddTestCase (new FlowletTableReuseTestCase, TestCase::QUICK);
+}
+
+static FlowletTableTestSuite g_flowletTableTestSuite;
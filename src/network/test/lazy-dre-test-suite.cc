@@ -0,0 +1,58 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/lazy-dre.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Check that the lazy decay matches the periodic multiplication.
+ */
+class LazyDreDecayTestCase : public TestCase
+{
+public:
+  LazyDreDecayTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+LazyDreDecayTestCase::LazyDreDecayTestCase ()
+  : TestCase ("Lazy DRE applies (1 - alpha)^k on access")
+{
+}
+
+void
+LazyDreDecayTestCase::DoRun (void)
+{
+  LazyDre dre (MicroSeconds (10), 0.5);
+  DreRegister reg;
+
+  NS_TEST_ASSERT_MSG_EQ (dre.Add (reg, MicroSeconds (1), 1000), 1000, "Fresh register not empty");
+  NS_TEST_ASSERT_MSG_EQ (dre.Add (reg, MicroSeconds (9), 600), 1600, "Decayed within a period");
+  NS_TEST_ASSERT_MSG_EQ (dre.Get (reg, MicroSeconds (10)), 800, "One period not applied");
+  NS_TEST_ASSERT_MSG_EQ (dre.Get (reg, MicroSeconds (35)), 200, "Three periods not applied");
+
+  // Reading does not modify the register
+  NS_TEST_ASSERT_MSG_EQ (dre.Get (reg, MicroSeconds (9)), 1600, "Read modified the register");
+
+  NS_TEST_ASSERT_MSG_EQ (dre.Add (reg, MicroSeconds (20), 100), 500, "Decay not applied before add");
+  NS_TEST_ASSERT_MSG_EQ (dre.Get (reg, Seconds (1)), 0, "Idle register not cleared");
+
+  LazyDre frozen (MicroSeconds (10), 0);
+  DreRegister reg2;
+  frozen.Add (reg2, MicroSeconds (0), 42);
+  NS_TEST_ASSERT_MSG_EQ (frozen.Get (reg2, Seconds (1)), 42, "Null alpha decayed");
+}
+
+class LazyDreTestSuite : public TestSuite
+{
+public:
+  LazyDreTestSuite ();
+};
+
+LazyDreTestSuite::LazyDreTestSuite ()
+  : TestSuite ("lazy-dre", UNIT)
+{
+  AddTestCase (new LazyDreDecayTestCase, TestCase::QUICK);
+}
+
+static LazyDreTestSuite g_lazyDreTestSuite;
@@ -19,6 +19,9 @@
  */
 #include "ns3/packet.h"
 #include "ns3/packet-tag-list.h"
+#include "ns3/packet-tag-slots.h"
+#include "ns3/packet-pool.h"
+#include "ns3/flow-id-tag.h"
 #include "ns3/test.h"
 #include "ns3/unused.h"
 #include <limits>     // std:numeric_limits
@@ -847,6 +850,118 @@ PacketTagListTest::DoRun (void)
     
 }
 
+//--------------------------------------
+class PacketTagSlotsTest : public TestCase
+{
+public:
+  PacketTagSlotsTest ();
+private:
+  void DoRun (void);
+};
+
+PacketTagSlotsTest::PacketTagSlotsTest ()
+  : TestCase ("Packet tags kept in slots")
+{
+}
+
+void
+PacketTagSlotsTest::DoRun (void)
+{
+  // Use a type registered by its module, the slots are global and few
+  int32_t slot = PacketTagSlots::GetSlot (FlowIdTag::GetTypeId ());
+  NS_TEST_ASSERT_MSG_GT (slot, -1, "FlowIdTag has a slot");
+  NS_TEST_EXPECT_MSG_EQ (PacketTagSlots::Register (FlowIdTag::GetTypeId ()), (uint32_t) slot, "registered twice");
+  NS_TEST_EXPECT_MSG_EQ (PacketTagSlots::GetSlot (ATestTag<1>::GetTypeId ()), -1, "ATestTag<1> is in the list");
+
+  Ptr<Packet> p = Create<Packet> (100);
+  p->AddPacketTag (FlowIdTag (5));
+  p->AddPacketTag (ATestTag<1> (7));
+
+  FlowIdTag slotted;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (slotted), true, "slotted tag added");
+  NS_TEST_EXPECT_MSG_EQ (slotted.GetFlowId (), 5, "slotted tag value");
+
+  // Rewriting the tag of a copy leaves the original alone
+  Ptr<Packet> q = p->Copy ();
+  FlowIdTag rewritten (9);
+  NS_TEST_EXPECT_MSG_EQ (q->ReplacePacketTag (rewritten), true, "replaced in place");
+  p->PeekPacketTag (slotted);
+  NS_TEST_EXPECT_MSG_EQ (slotted.GetFlowId (), 5, "original after replace");
+  q->PeekPacketTag (slotted);
+  NS_TEST_EXPECT_MSG_EQ (slotted.GetFlowId (), 9, "copy after replace");
+
+  // The slots come first in the iteration, then the list
+  PacketTagIterator i = q->GetPacketTagIterator ();
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "slotted tag iterated");
+  PacketTagIterator::Item item = i.Next ();
+  NS_TEST_EXPECT_MSG_EQ (item.GetTypeId (), FlowIdTag::GetTypeId (), "slotted tag first");
+  item.GetTag (slotted);
+  NS_TEST_EXPECT_MSG_EQ (slotted.GetFlowId (), 9, "iterated slotted tag value");
+  NS_TEST_ASSERT_MSG_EQ (i.HasNext (), true, "list tag iterated");
+  NS_TEST_EXPECT_MSG_EQ (i.Next ().GetTypeId (), ATestTag<1>::GetTypeId (), "list tag second");
+  NS_TEST_EXPECT_MSG_EQ (i.HasNext (), false, "two tags");
+
+  NS_TEST_EXPECT_MSG_EQ (q->RemovePacketTag (slotted), true, "slotted tag removed");
+  NS_TEST_EXPECT_MSG_EQ (slotted.GetFlowId (), 9, "removed slotted tag value");
+  NS_TEST_EXPECT_MSG_EQ (q->RemovePacketTag (slotted), false, "slotted tag removed once");
+  NS_TEST_EXPECT_MSG_EQ (q->ReplacePacketTag (rewritten), false, "replace adds a missing tag");
+  NS_TEST_EXPECT_MSG_EQ (q->PeekPacketTag (slotted), true, "slotted tag added back");
+
+  Ptr<Packet> fragment = p->CreateFragment (0, 50);
+  NS_TEST_EXPECT_MSG_EQ (fragment->PeekPacketTag (slotted), true, "fragments keep the slotted tags");
+  NS_TEST_EXPECT_MSG_EQ (slotted.GetFlowId (), 5, "fragment slotted tag value");
+
+  p->RemoveAllPacketTags ();
+  ATestTag<1> listed;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (slotted), false, "slotted tag removed by RemoveAll");
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (listed), false, "list tag removed by RemoveAll");
+}
+
+//--------------------------------------
+class PacketPoolTest : public TestCase
+{
+public:
+  PacketPoolTest ();
+private:
+  void DoRun (void);
+};
+
+PacketPoolTest::PacketPoolTest ()
+  : TestCase ("Packets recycled through the pools")
+{
+}
+
+void
+PacketPoolTest::DoRun (void)
+{
+  Packet::EnablePooling ();
+  NS_TEST_ASSERT_MSG_EQ (PacketPool::IsEnabled (), true, "pools enabled");
+  PacketPool::ResetStats ();
+
+  Ptr<Packet> p = Create<Packet> (1000);
+  p->AddPacketTag (ATestTag<1> (3));
+  p->AddHeader (ATestHeader<10> ());
+  uint64_t packetMisses = PacketPool::GetMisses (PacketPool::PACKET);
+  p = 0;
+
+  // The packet, its tag and its data come back from the free lists
+  p = Create<Packet> (1000);
+  p->AddPacketTag (ATestTag<1> (4));
+  p->AddHeader (ATestHeader<10> ());
+  NS_TEST_EXPECT_MSG_EQ (PacketPool::GetMisses (PacketPool::PACKET), packetMisses, "packet recycled");
+  NS_TEST_EXPECT_MSG_GT (PacketPool::GetHits (PacketPool::PACKET), 0, "packet hit");
+  NS_TEST_EXPECT_MSG_GT (PacketPool::GetHits (PacketPool::PACKET_TAG), 0, "packet tag hit");
+  NS_TEST_EXPECT_MSG_GT (PacketPool::GetHits (PacketPool::BUFFER), 0, "buffer hit");
+
+  ATestTag<1> tag;
+  NS_TEST_EXPECT_MSG_EQ (p->PeekPacketTag (tag), true, "recycled tag found");
+  NS_TEST_EXPECT_MSG_EQ (tag.GetData (), 4, "recycled tag value");
+  ATestHeader<10> header;
+  p->RemoveHeader (header);
+  NS_TEST_EXPECT_MSG_EQ (header.m_error, false, "recycled header");
+  NS_TEST_EXPECT_MSG_EQ (p->GetSize (), 1000, "recycled packet size");
+}
+
 //-----------------------------------------------------------------------------
 class PacketTestSuite : public TestSuite
 {
@@ -859,6 +974,8 @@ PacketTestSuite::PacketTestSuite ()
 {
   AddTestCase (new PacketTest, TestCase::QUICK);
   AddTestCase (new PacketTagListTest, TestCase::QUICK);
+  AddTestCase (new PacketTagSlotsTest, TestCase::QUICK);
+  AddTestCase (new PacketPoolTest, TestCase::QUICK);
 }
 
 static PacketTestSuite g_packetTestSuite;
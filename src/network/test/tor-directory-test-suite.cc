@@ -0,0 +1,55 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/tor-directory.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Check the ToR of the addresses of the /24 per leaf plan.
+ */
+class TorDirectoryLookupTestCase : public TestCase
+{
+public:
+  TorDirectoryLookupTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+TorDirectoryLookupTestCase::TorDirectoryLookupTestCase ()
+  : TestCase ("ToR directory finds the ToR by prefix")
+{
+}
+
+void
+TorDirectoryLookupTestCase::DoRun (void)
+{
+  TorDirectory directory (Ipv4Address ("10.1.1.0"), Ipv4Mask ("255.255.255.0"), 300);
+  uint32_t torId = 12345;
+
+  NS_TEST_ASSERT_MSG_EQ (directory.FindTor (Ipv4Address ("10.1.1.1"), torId), true, "First server not found");
+  NS_TEST_ASSERT_MSG_EQ (torId, 0, "Wrong ToR of the first network");
+  NS_TEST_ASSERT_MSG_EQ (directory.FindTor (Ipv4Address ("10.1.8.254"), torId), true, "Server not found");
+  NS_TEST_ASSERT_MSG_EQ (torId, 7, "Wrong ToR");
+  // Past 10.1.255.0 the plan goes on in 10.2.0.0
+  NS_TEST_ASSERT_MSG_EQ (directory.FindTor (Ipv4Address ("10.2.0.3"), torId), true, "Server past 10.1 not found");
+  NS_TEST_ASSERT_MSG_EQ (torId, 255, "Wrong ToR past 10.1");
+  NS_TEST_ASSERT_MSG_EQ (directory.GetTorNetwork (299), Ipv4Address ("10.2.44.0"), "Wrong network of the last ToR");
+
+  NS_TEST_ASSERT_MSG_EQ (directory.FindTor (Ipv4Address ("10.2.45.1"), torId), false, "Address past the last ToR found");
+  NS_TEST_ASSERT_MSG_EQ (directory.FindTor (Ipv4Address ("10.1.0.1"), torId), false, "Address before the first ToR found");
+  NS_TEST_ASSERT_MSG_EQ (directory.FindTor (Ipv4Address ("9.255.255.1"), torId), false, "Address before the first ToR found");
+}
+
+class TorDirectoryTestSuite : public TestSuite
+{
+public:
+  TorDirectoryTestSuite ();
+};
+
+TorDirectoryTestSuite::TorDirectoryTestSuite ()
+  : TestSuite ("tor-directory", UNIT)
+{
+  AddTestCase (new TorDirectoryLookupTestCase, TestCase::QUICK);
+}
+
+static TorDirectoryTestSuite g_torDirectoryTestSuite;
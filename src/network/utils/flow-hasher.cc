@@ -0,0 +1,235 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "flow-hasher.h"
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowHasher");
+
+namespace {
+
+/**
+ * Reflected CRC32C (Castagnoli, polynomial 0x1EDC6F41) lookup table,
+ * built once at load time.
+ */
+class Crc32cTable
+{
+public:
+  Crc32cTable ()
+  {
+    for (uint32_t i = 0; i < 256; ++i)
+      {
+        uint32_t crc = i;
+        for (int j = 0; j < 8; ++j)
+          {
+            crc = (crc & 1) ? (crc >> 1) ^ 0x82F63B78 : (crc >> 1);
+          }
+        m_table[i] = crc;
+      }
+  }
+  uint32_t m_table[256];
+};
+
+const Crc32cTable g_crc32cTable;
+
+/**
+ * Default Microsoft RSS Toeplitz key.
+ */
+const uint8_t g_toeplitzKey[40] = {
+  0x6d, 0x5a, 0x56, 0xda, 0x25, 0x5b, 0x0e, 0xc2,
+  0x41, 0x67, 0x25, 0x3d, 0x43, 0xa3, 0x8f, 0xb0,
+  0xd0, 0xca, 0x2b, 0xcb, 0xae, 0x7b, 0x30, 0xb4,
+  0x77, 0xcb, 0x2d, 0xa3, 0x80, 0x30, 0xf2, 0x0c,
+  0x6a, 0x42, 0xb7, 0x3b, 0xbe, 0xac, 0x01, 0xfa
+};
+
+inline uint32_t
+Rotl32 (uint32_t x, int8_t r)
+{
+  return (x << r) | (x >> (32 - r));
+}
+
+inline void
+WriteU32 (uint8_t *buf, uint32_t v)
+{
+  buf[0] = (v >> 24) & 0xff;
+  buf[1] = (v >> 16) & 0xff;
+  buf[2] = (v >> 8) & 0xff;
+  buf[3] = v & 0xff;
+}
+
+inline void
+WriteU16 (uint8_t *buf, uint16_t v)
+{
+  buf[0] = (v >> 8) & 0xff;
+  buf[1] = v & 0xff;
+}
+
+} // anonymous namespace
+
+FlowHasher::FlowHasher ()
+  : m_kernel (CRC32C)
+{
+}
+
+FlowHasher::FlowHasher (HashKernel kernel)
+  : m_kernel (kernel)
+{
+}
+
+void
+FlowHasher::SetKernel (HashKernel kernel)
+{
+  m_kernel = kernel;
+}
+
+FlowHasher::HashKernel
+FlowHasher::GetKernel (void) const
+{
+  return m_kernel;
+}
+
+uint32_t
+FlowHasher::GetHash (const Ipv4Address &saddr, const Ipv4Address &daddr,
+                     uint16_t sport, uint16_t dport, uint8_t protocol, uint32_t seed) const
+{
+  uint8_t tuple[13];
+  WriteU32 (tuple, saddr.Get ());
+  WriteU32 (tuple + 4, daddr.Get ());
+  WriteU16 (tuple + 8, sport);
+  WriteU16 (tuple + 10, dport);
+  tuple[12] = protocol;
+  return GetHash (tuple, sizeof (tuple), seed);
+}
+
+uint32_t
+FlowHasher::GetHash (uint32_t flowId, uint32_t seed) const
+{
+  uint8_t key[4];
+  WriteU32 (key, flowId);
+  return GetHash (key, sizeof (key), seed);
+}
+
+uint32_t
+FlowHasher::GetHopHash (uint32_t flowId, uint32_t seed, uint32_t hop) const
+{
+  return Fmix32 (GetHash (flowId, seed) ^ Fmix32 (hop));
+}
+
+uint32_t
+FlowHasher::GetHash (const uint8_t *buffer, size_t size, uint32_t seed) const
+{
+  switch (m_kernel)
+    {
+    case CRC32C:
+      return FlowHasher::Crc32c (buffer, size, seed);
+    case MURMUR3:
+      return FlowHasher::Murmur3 (buffer, size, seed);
+    case TOEPLITZ:
+      {
+        // Toeplitz has no notion of a seed, it is hashed as a trailing input
+        // field, which is how switches salt their RSS-style hash units
+        NS_ASSERT (size + 4 <= 36);
+        uint8_t input[36];
+        for (size_t i = 0; i < size; ++i)
+          {
+            input[i] = buffer[i];
+          }
+        WriteU32 (input + size, seed);
+        return FlowHasher::Toeplitz (input, size + 4);
+      }
+    default:
+      NS_FATAL_ERROR ("Unknown flow hash kernel: " << m_kernel);
+    }
+  return 0;
+}
+
+uint32_t
+FlowHasher::Crc32c (const uint8_t *buffer, size_t size, uint32_t seed)
+{
+  uint32_t crc = ~seed;
+  for (size_t i = 0; i < size; ++i)
+    {
+      crc = g_crc32cTable.m_table[(crc ^ buffer[i]) & 0xff] ^ (crc >> 8);
+    }
+  return ~crc;
+}
+
+uint32_t
+FlowHasher::Murmur3 (const uint8_t *buffer, size_t size, uint32_t seed)
+{
+  const uint32_t c1 = 0xcc9e2d51;
+  const uint32_t c2 = 0x1b873593;
+  const size_t nblocks = size / 4;
+
+  uint32_t h1 = seed;
+
+  for (size_t i = 0; i < nblocks; ++i)
+    {
+      const uint8_t *p = buffer + i * 4;
+      uint32_t k1 = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t) p[3] << 24);
+      k1 *= c1;
+      k1 = Rotl32 (k1, 15);
+      k1 *= c2;
+      h1 ^= k1;
+      h1 = Rotl32 (h1, 13);
+      h1 = h1 * 5 + 0xe6546b64;
+    }
+
+  const uint8_t *tail = buffer + nblocks * 4;
+  uint32_t k1 = 0;
+  switch (size & 3)
+    {
+    case 3:
+      k1 ^= tail[2] << 16;
+      // fall through
+    case 2:
+      k1 ^= tail[1] << 8;
+      // fall through
+    case 1:
+      k1 ^= tail[0];
+      k1 *= c1;
+      k1 = Rotl32 (k1, 15);
+      k1 *= c2;
+      h1 ^= k1;
+    }
+
+  h1 ^= (uint32_t) size;
+  return Fmix32 (h1);
+}
+
+uint32_t
+FlowHasher::Fmix32 (uint32_t h)
+{
+  h ^= h >> 16;
+  h *= 0x85ebca6b;
+  h ^= h >> 13;
+  h *= 0xc2b2ae35;
+  h ^= h >> 16;
+  return h;
+}
+
+uint32_t
+FlowHasher::Toeplitz (const uint8_t *buffer, size_t size)
+{
+  NS_ASSERT (size <= sizeof (g_toeplitzKey) - 4);
+  uint32_t result = 0;
+  uint32_t window = ((uint32_t) g_toeplitzKey[0] << 24) | (g_toeplitzKey[1] << 16)
+    | (g_toeplitzKey[2] << 8) | g_toeplitzKey[3];
+  for (size_t i = 0; i < size; ++i)
+    {
+      uint8_t nextKeyByte = g_toeplitzKey[i + 4];
+      for (int bit = 7; bit >= 0; --bit)
+        {
+          if (buffer[i] & (1 << bit))
+            {
+              result ^= window;
+            }
+          window = (window << 1) | ((nextKeyByte >> bit) & 1);
+        }
+    }
+  return result;
+}
+
+} // namespace ns3
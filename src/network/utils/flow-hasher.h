@@ -0,0 +1,113 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOW_HASHER_H
+#define FLOW_HASHER_H
+
+#include "ns3/ipv4-address.h"
+
+#include <stdint.h>
+#include <cstddef>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Allocation-free hashing of a packed binary 5-tuple.
+ *
+ * The 5-tuple is packed into a 13 byte stack buffer in network byte order
+ * (source address, destination address, source port, destination port,
+ * protocol), which is the field order used by RSS, and fed to one of the
+ * selectable hash kernels, without building any intermediate string.
+ *
+ * CRC32C and Toeplitz are linear in their seed: changing the seed only
+ * XORs a constant into the hash. The per-hop hashes of a multi-tier fabric
+ * must come from GetHopHash, which mixes the hop in through a nonlinear
+ * finalizer, else the choices of successive hops are correlated.
+ */
+class FlowHasher
+{
+public:
+  enum HashKernel
+  {
+    CRC32C,     //!< Castagnoli CRC, as found in most switch ASIC hash units
+    MURMUR3,    //!< MurmurHash3 x86_32
+    TOEPLITZ    //!< Toeplitz hash with the default Microsoft RSS key
+  };
+
+  FlowHasher ();
+  FlowHasher (HashKernel kernel);
+
+  void SetKernel (HashKernel kernel);
+  HashKernel GetKernel (void) const;
+
+  /**
+   * \brief Hash a 5-tuple
+   * \param saddr source address
+   * \param daddr destination address
+   * \param sport source port
+   * \param dport destination port
+   * \param protocol IP protocol number
+   * \param seed seed mixed into the hash
+   * \returns the 32 bit hash
+   */
+  uint32_t GetHash (const Ipv4Address &saddr, const Ipv4Address &daddr,
+                    uint16_t sport, uint16_t dport, uint8_t protocol, uint32_t seed = 0) const;
+
+  /**
+   * \brief Re-hash an existing flow id with a seed, e.g. a per-hop seed
+   * \param flowId the flow id carried by the packet
+   * \param seed seed mixed into the hash
+   * \returns the 32 bit hash
+   */
+  uint32_t GetHash (uint32_t flowId, uint32_t seed) const;
+
+  /**
+   * \brief Hash a flow id for one hop of a multi-tier fabric
+   *
+   * The hash of the flow id by the selected kernel is XORed with the mixed
+   * hop and mixed again with the MurmurHash3 finalizer, so that the hashes
+   * of one flow at two hops are not functionally dependent, whatever the
+   * kernel.
+   * \param flowId the flow id carried by the packet
+   * \param seed router specific salt
+   * \param hop the hop, e.g. the TTL of the packet
+   * \returns the 32 bit hash
+   */
+  uint32_t GetHopHash (uint32_t flowId, uint32_t seed, uint32_t hop) const;
+
+  /**
+   * \brief Hash an arbitrary buffer with the selected kernel
+   * \param buffer the data to hash
+   * \param size the size of the buffer in bytes
+   * \param seed seed mixed into the hash
+   * \returns the 32 bit hash
+   */
+  uint32_t GetHash (const uint8_t *buffer, size_t size, uint32_t seed) const;
+
+  /**
+   * \returns CRC32C of the buffer, the seed being the initial (pre-inverted) value
+   */
+  static uint32_t Crc32c (const uint8_t *buffer, size_t size, uint32_t seed);
+
+  /**
+   * \returns MurmurHash3 x86_32 of the buffer
+   */
+  static uint32_t Murmur3 (const uint8_t *buffer, size_t size, uint32_t seed);
+
+  /**
+   * \returns the MurmurHash3 32 bit finalizer of h, a nonlinear bijection
+   */
+  static uint32_t Fmix32 (uint32_t h);
+
+  /**
+   * \returns the RSS Toeplitz hash of at most 36 bytes of buffer
+   */
+  static uint32_t Toeplitz (const uint8_t *buffer, size_t size);
+
+private:
+  HashKernel m_kernel;
+};
+
+} // namespace ns3
+
+#endif /* FLOW_HASHER_H */
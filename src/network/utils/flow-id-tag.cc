@@ -19,12 +19,14 @@
  */
 #include "flow-id-tag.h"
 #include "ns3/log.h"
+#include "ns3/packet-tag-slots.h"
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("FlowIdTag");
 
 NS_OBJECT_ENSURE_REGISTERED (FlowIdTag);
+NS_PACKET_TAG_SLOT (FlowIdTag);
 
 TypeId 
 FlowIdTag::GetTypeId (void)
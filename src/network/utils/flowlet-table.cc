@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "flowlet-table.h"
+#include "flow-hasher.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("FlowletTable");
+
+namespace {
+
+const uint32_t CACHE_LINE = 64;
+
+FlowletEntry
+MakeFreeEntry (void)
+{
+  FlowletEntry entry;
+  entry.activeTime = Time::Min ();
+  entry.flowId = 0;
+  entry.port = 0;
+  return entry;
+}
+
+} // anonymous namespace
+
+FlowletTable::FlowletTable (uint32_t nEntries)
+  : m_entries (0),
+    m_bucketMask (0),
+    m_timeout (MicroSeconds (50)),
+    m_nCollisions (0),
+    m_nEvictions (0)
+{
+  NS_ASSERT (sizeof (FlowletEntry) * WAYS == CACHE_LINE);
+  SetSize (nEntries);
+}
+
+FlowletTable::FlowletTable (const FlowletTable &other)
+  : m_entries (0),
+    m_bucketMask (0),
+    m_timeout (other.m_timeout),
+    m_nCollisions (0),
+    m_nEvictions (0)
+{
+  SetSize (other.GetSize ());
+}
+
+FlowletTable &
+FlowletTable::operator= (const FlowletTable &other)
+{
+  if (this != &other)
+    {
+      m_timeout = other.m_timeout;
+      m_nCollisions = 0;
+      m_nEvictions = 0;
+      SetSize (other.GetSize ());
+    }
+  return *this;
+}
+
+void
+FlowletTable::SetSize (uint32_t nEntries)
+{
+  uint32_t nBuckets = 1;
+  while (nBuckets * WAYS < nEntries)
+    {
+      nBuckets <<= 1;
+    }
+  m_bucketMask = nBuckets - 1;
+
+  // One spare bucket so that the first entry can be moved to a cache line
+  // boundary
+  m_storage.assign ((nBuckets + 1) * WAYS, MakeFreeEntry ());
+  uintptr_t base = reinterpret_cast<uintptr_t> (&m_storage[0]);
+  uintptr_t aligned = (base + CACHE_LINE - 1) & ~static_cast<uintptr_t> (CACHE_LINE - 1);
+  m_entries = reinterpret_cast<FlowletEntry *> (aligned);
+  NS_LOG_LOGIC ("Flowlet table of " << nBuckets * WAYS << " entries");
+}
+
+uint32_t
+FlowletTable::GetSize (void) const
+{
+  return (m_bucketMask + 1) * WAYS;
+}
+
+void
+FlowletTable::SetTimeout (Time timeout)
+{
+  m_timeout = timeout;
+}
+
+Time
+FlowletTable::GetTimeout (void) const
+{
+  return m_timeout;
+}
+
+FlowletEntry *
+FlowletTable::Lookup (uint32_t flowId)
+{
+  FlowletEntry *bucket = m_entries + GetBucket (flowId) * WAYS;
+  for (uint32_t way = 0; way < WAYS; ++way)
+    {
+      if (bucket[way].flowId == flowId && !IsFree (bucket[way]))
+        {
+          return &bucket[way];
+        }
+    }
+  return 0;
+}
+
+FlowletEntry *
+FlowletTable::Insert (uint32_t flowId, Time now)
+{
+  FlowletEntry *bucket = m_entries + GetBucket (flowId) * WAYS;
+  FlowletEntry *victim = 0;
+  for (uint32_t way = 0; way < WAYS; ++way)
+    {
+      FlowletEntry &entry = bucket[way];
+      if (IsFree (entry))
+        {
+          if (victim == 0 || !IsFree (*victim))
+            {
+              victim = &entry;
+            }
+          continue;
+        }
+      if (entry.flowId == flowId)
+        {
+          return &entry;
+        }
+      if (victim == 0 || (!IsFree (*victim) && entry.activeTime < victim->activeTime))
+        {
+          victim = &entry;
+        }
+    }
+
+  if (!IsFree (*victim))
+    {
+      m_nCollisions++;
+      if (now - victim->activeTime <= m_timeout)
+        {
+          m_nEvictions++;
+          NS_LOG_LOGIC ("Flow " << flowId << " evicts the active flowlet of flow " << victim->flowId);
+        }
+    }
+  victim->flowId = flowId;
+  victim->port = 0;
+  victim->activeTime = now;
+  return victim;
+}
+
+void
+FlowletTable::Clear (void)
+{
+  std::fill (m_storage.begin (), m_storage.end (), MakeFreeEntry ());
+}
+
+uint64_t
+FlowletTable::GetNCollisions (void) const
+{
+  return m_nCollisions;
+}
+
+uint64_t
+FlowletTable::GetNEvictions (void) const
+{
+  return m_nEvictions;
+}
+
+uint32_t
+FlowletTable::GetBucket (uint32_t flowId) const
+{
+  // Flow ids may be sequential
+  return FlowHasher::Fmix32 (flowId) & m_bucketMask;
+}
+
+bool
+FlowletTable::IsFree (const FlowletEntry &entry)
+{
+  return entry.activeTime == Time::Min ();
+}
+
+} // namespace ns3
@@ -0,0 +1,112 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef FLOWLET_TABLE_H
+#define FLOWLET_TABLE_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief One slot of a FlowletTable
+ */
+struct FlowletEntry
+{
+  Time activeTime;      //!< last time a packet of the flowlet was seen
+  uint32_t flowId;      //!< flow owning the slot
+  uint32_t port;        //!< port (or path) the flowlet is pinned to
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Bounded flowlet table, as implemented in switch ASICs
+ *
+ * The table is a fixed array of FlowletEntry grouped in buckets of WAYS
+ * entries, each bucket filling exactly one cache line. A flow is hashed to
+ * one bucket and may occupy any of its ways; the flow id is kept as a tag
+ * so that flows sharing a bucket do not share their flowlet.
+ *
+ * When a flow needs an entry and its bucket has no free way, the least
+ * recently active entry of the bucket is reused. Entries idle for longer
+ * than the timeout are reused silently, reusing an entry that is still
+ * active evicts the flowlet of another flow. Both events are counted so
+ * that the table size can be studied.
+ */
+class FlowletTable
+{
+public:
+  static const uint32_t WAYS = 4;
+
+  /**
+   * \param nEntries the number of entries, rounded up to a power of two
+   * multiple of WAYS
+   */
+  FlowletTable (uint32_t nEntries = 4096);
+  FlowletTable (const FlowletTable &other);
+  FlowletTable & operator= (const FlowletTable &other);
+
+  /**
+   * \brief Resize the table, dropping all entries
+   * \param nEntries the number of entries, rounded up to a power of two
+   * multiple of WAYS
+   */
+  void SetSize (uint32_t nEntries);
+  uint32_t GetSize (void) const;
+
+  /**
+   * \brief Set the idle time after which an entry may be reused silently
+   * \param timeout the flowlet timeout of the owner
+   */
+  void SetTimeout (Time timeout);
+  Time GetTimeout (void) const;
+
+  /**
+   * \brief Find the entry of a flow
+   * \param flowId the flow id
+   * \returns the entry, or 0 if the flow has none (it may have been reused)
+   */
+  FlowletEntry * Lookup (uint32_t flowId);
+
+  /**
+   * \brief Get the entry of a flow, claiming one if it has none
+   * \param flowId the flow id
+   * \param now the current time, set as active time of a claimed entry
+   * \returns the entry, the port of a claimed entry is 0
+   */
+  FlowletEntry * Insert (uint32_t flowId, Time now);
+
+  /**
+   * \brief Drop all entries, the counters are kept
+   */
+  void Clear (void);
+
+  /**
+   * \returns the number of insertions that found their bucket full
+   */
+  uint64_t GetNCollisions (void) const;
+
+  /**
+   * \returns the number of insertions that reused an entry still active
+   */
+  uint64_t GetNEvictions (void) const;
+
+private:
+  uint32_t GetBucket (uint32_t flowId) const;
+  static bool IsFree (const FlowletEntry &entry);
+
+  std::vector<FlowletEntry> m_storage;  //!< backing store, over-allocated for alignment
+  FlowletEntry *m_entries;              //!< first cache aligned entry of m_storage
+  uint32_t m_bucketMask;                //!< number of buckets - 1
+  Time m_timeout;
+  uint64_t m_nCollisions;
+  uint64_t m_nEvictions;
+};
+
+} // namespace ns3
+
+#endif /* FLOWLET_TABLE_H */
@@ -0,0 +1,117 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "lazy-dre.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("LazyDre");
+
+namespace {
+
+// Longest table of cached factors, only reached for tiny alphas
+const uint32_t MAX_FACTORS = 1 << 16;
+
+} // anonymous namespace
+
+LazyDre::LazyDre ()
+  : m_period (MicroSeconds (200)),
+    m_alpha (0)
+{
+  SetAlpha (0.2);
+}
+
+LazyDre::LazyDre (Time period, double alpha)
+  : m_period (period),
+    m_alpha (0)
+{
+  SetAlpha (alpha);
+}
+
+void
+LazyDre::SetPeriod (Time period)
+{
+  NS_ASSERT (period.IsStrictlyPositive ());
+  m_period = period;
+}
+
+Time
+LazyDre::GetPeriod (void) const
+{
+  return m_period;
+}
+
+void
+LazyDre::SetAlpha (double alpha)
+{
+  NS_ASSERT (alpha >= 0 && alpha <= 1);
+  m_alpha = alpha;
+  m_factors.clear ();
+  if (alpha == 0)
+    {
+      return;
+    }
+
+  // Stop once the factor clears even a full register
+  double factor = 1;
+  while (factor * 4294967296.0 >= 1 && m_factors.size () < MAX_FACTORS)
+    {
+      m_factors.push_back (factor);
+      factor *= 1 - alpha;
+    }
+  NS_LOG_LOGIC ("Cached " << m_factors.size () << " decay factors for alpha " << alpha);
+}
+
+double
+LazyDre::GetAlpha (void) const
+{
+  return m_alpha;
+}
+
+uint32_t
+LazyDre::Get (const DreRegister &reg, Time now) const
+{
+  int64_t k = GetEpoch (now) - reg.epoch;
+  if (k <= 0 || reg.value == 0)
+    {
+      return reg.value;
+    }
+  return static_cast<uint32_t> (reg.value * GetFactor (k));
+}
+
+uint32_t
+LazyDre::Add (DreRegister &reg, Time now, uint32_t bytes) const
+{
+  reg.value = Get (reg, now) + bytes;
+  reg.epoch = GetEpoch (now);
+  return reg.value;
+}
+
+int64_t
+LazyDre::GetEpoch (Time now) const
+{
+  return now.GetTimeStep () / m_period.GetTimeStep ();
+}
+
+double
+LazyDre::GetFactor (int64_t k) const
+{
+  if (m_alpha == 0)
+    {
+      return 1;
+    }
+  if (k < static_cast<int64_t> (m_factors.size ()))
+    {
+      return m_factors[k];
+    }
+  if (m_factors.size () < MAX_FACTORS)
+    {
+      return 0;
+    }
+  return std::pow (1 - m_alpha, static_cast<double> (k));
+}
+
+} // namespace ns3
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef LAZY_DRE_H
+#define LAZY_DRE_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief One Discounting Rate Estimator register
+ *
+ * Holds the byte count of a link (or path) as of the last decay period it
+ * was brought up to date with. It is only meaningful through a LazyDre.
+ */
+struct DreRegister
+{
+  DreRegister ()
+    : value (0),
+      epoch (0)
+  {
+  }
+
+  uint32_t value;       //!< byte count as of the decay period epoch
+  int64_t epoch;        //!< index of the last decay period applied
+};
+
+/**
+ * \ingroup network
+ *
+ * \brief Discounting Rate Estimator decayed on access
+ *
+ * The DRE of CONGA multiplies every register by (1 - alpha) at the end of
+ * every period. Instead of running a timer per switch, the registers
+ * remember the period they were last updated in and the k pending decays
+ * are applied at once as (1 - alpha)^k when the register is read or
+ * written. Periods are aligned on multiples of the period since time 0.
+ *
+ * One LazyDre holds the parameters and the cached decay factors for all
+ * the registers of its owner.
+ */
+class LazyDre
+{
+public:
+  LazyDre ();
+  LazyDre (Time period, double alpha);
+
+  void SetPeriod (Time period);
+  Time GetPeriod (void) const;
+
+  void SetAlpha (double alpha);
+  double GetAlpha (void) const;
+
+  /**
+   * \brief Read a register
+   * \param reg the register
+   * \param now the current time
+   * \returns the decayed byte count
+   */
+  uint32_t Get (const DreRegister &reg, Time now) const;
+
+  /**
+   * \brief Bring a register up to date and add bytes to it
+   * \param reg the register
+   * \param now the current time
+   * \param bytes the bytes sent
+   * \returns the new byte count
+   */
+  uint32_t Add (DreRegister &reg, Time now, uint32_t bytes) const;
+
+private:
+  int64_t GetEpoch (Time now) const;
+  double GetFactor (int64_t k) const;
+
+  Time m_period;
+  double m_alpha;
+  std::vector<double> m_factors;        //!< (1 - alpha)^k, until it clears any register
+};
+
+} // namespace ns3
+
+#endif /* LAZY_DRE_H */
@@ -0,0 +1,39 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "tor-directory.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+
+namespace ns3 {
+
+TorDirectory::TorDirectory (Ipv4Address firstNetwork, Ipv4Mask mask, uint32_t nTors)
+  : m_firstNetwork (firstNetwork.Get () & mask.Get ()),
+    m_mask (mask.Get ()),
+    m_hostBits (32 - mask.GetPrefixLength ()),
+    m_nTors (nTors)
+{
+  NS_ABORT_MSG_IF (m_hostBits == 32, "The ToR networks need a mask");
+  NS_ABORT_MSG_IF (m_nTors > 0 && m_nTors - 1 > (0xffffffffu - m_firstNetwork) >> m_hostBits,
+                   "The ToR networks go past 255.255.255.255");
+}
+
+uint32_t
+TorDirectory::GetNTors (void) const
+{
+  return m_nTors;
+}
+
+Ipv4Address
+TorDirectory::GetTorNetwork (uint32_t torId) const
+{
+  NS_ASSERT (torId < m_nTors);
+  return Ipv4Address (m_firstNetwork + (torId << m_hostBits));
+}
+
+Ipv4Mask
+TorDirectory::GetMask (void) const
+{
+  return Ipv4Mask (m_mask);
+}
+
+} // namespace ns3
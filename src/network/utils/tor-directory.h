@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TOR_DIRECTORY_H
+#define TOR_DIRECTORY_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/ipv4-address.h"
+
+#include <stdint.h>
+
+namespace ns3 {
+
+/**
+ * \ingroup network
+ *
+ * \brief Maps the address of a server to the ToR (leaf) switch it hangs from
+ *
+ * The servers of ToR i live in the i-th of consecutive networks of the
+ * same mask, starting at the first network; e.g. the /24 per leaf plan of
+ * the datacenter examples, where leaf i gets 10.1.(i + 1).0/24. The ToR of
+ * an address is then found by prefix arithmetic, without any per address
+ * state, so one directory built for the whole network is shared by all the
+ * load balancers instead of registering every server on every host.
+ *
+ * The directory is immutable once built.
+ */
+class TorDirectory : public SimpleRefCount<TorDirectory>
+{
+public:
+  /**
+   * \param firstNetwork the network of ToR 0
+   * \param mask the mask of the network of every ToR
+   * \param nTors the number of ToRs
+   */
+  TorDirectory (Ipv4Address firstNetwork, Ipv4Mask mask, uint32_t nTors);
+
+  /**
+   * \param address the address of a server
+   * \param torId the ToR of the server, if any
+   * \returns false if the address is not in the network of any ToR
+   */
+  bool FindTor (Ipv4Address address, uint32_t &torId) const
+  {
+    // Unsigned wrap around sends the addresses below the first network out of range
+    uint32_t index = ((address.Get () & m_mask) - m_firstNetwork) >> m_hostBits;
+    if (index >= m_nTors)
+      {
+        return false;
+      }
+    torId = index;
+    return true;
+  }
+
+  uint32_t GetNTors (void) const;
+
+  /**
+   * \returns the network of the ToR
+   */
+  Ipv4Address GetTorNetwork (uint32_t torId) const;
+
+  Ipv4Mask GetMask (void) const;
+
+private:
+  uint32_t m_firstNetwork;
+  uint32_t m_mask;
+  uint32_t m_hostBits;
+  uint32_t m_nTors;
+};
+
+} // namespace ns3
+
+#endif /* TOR_DIRECTORY_H */
@@ -0,0 +1,830 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/datacenter-topology-helper.h"
+
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/config.h"
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-list-routing-helper.h"
+#include "ns3/ipv4-static-routing-helper.h"
+#include "ns3/ipv4-global-routing-helper.h"
+#include "ns3/ipv4-global-routing.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/traffic-control-layer.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/ipv4-clove.h"
+#include "ns3/ipv4-xpath-routing-helper.h"
+#include "ns3/ipv4-conga-routing-helper.h"
+#include "ns3/ipv4-drb-routing-helper.h"
+#include "ns3/ipv4-drill-routing-helper.h"
+#include "ns3/ipv4-letflow-routing-helper.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("DatacenterTopologyHelper");
+
+namespace {
+
+// XPath reads one port per two decimal digits of the path id
+const uint32_t XPATH_PORT_BASE = 100;
+
+const uint32_t MAX_SERVERS_PER_TOR = 127;
+const uint32_t MAX_FABRIC_NETWORKS = 1 << 21;
+
+void
+EnablePerflowEcmp (Ptr<Node> node)
+{
+  Ptr<Ipv4RoutingProtocol> routing = node->GetObject<Ipv4> ()->GetRoutingProtocol ();
+  Ptr<Ipv4ListRouting> list = DynamicCast<Ipv4ListRouting> (routing);
+  if (list == 0)
+    {
+      Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (routing);
+      if (global != 0)
+        {
+          global->SetAttribute ("PerflowEcmpRouting", BooleanValue (true));
+        }
+      return;
+    }
+  for (uint32_t i = 0; i < list->GetNRoutingProtocols (); ++i)
+    {
+      int16_t priority;
+      Ptr<Ipv4GlobalRouting> global = DynamicCast<Ipv4GlobalRouting> (list->GetRoutingProtocol (i, priority));
+      if (global != 0)
+        {
+          global->SetAttribute ("PerflowEcmpRouting", BooleanValue (true));
+        }
+    }
+}
+
+} // anonymous namespace
+
+DatacenterTopologyHelper::DatacenterTopologyHelper ()
+  : m_tiers (LEAF_SPINE),
+    m_nTors (0),
+    m_nSpines (0),
+    m_nCores (0),
+    m_nServersPerTor (0),
+    m_nLinks (1),
+    m_k (0),
+    m_lb (ECMP),
+    m_flowletTimeout (Time (0)),
+    m_fabricRate (DataRate ("10Gbps")),
+    m_hasSwitchQueueDisc (false),
+    m_hasServerQueueDisc (false),
+    m_defaultQueueDisc (TrafficControlHelper::Default ()),
+    m_serverBase ("10.1.0.0"),
+    m_fabricBase ("10.128.0.0"),
+    m_nFabricNetworks (0)
+{
+  SetServerLinkAttributes (DataRate ("10Gbps"), MicroSeconds (10));
+  SetFabricLinkAttributes (DataRate ("10Gbps"), MicroSeconds (10));
+}
+
+void
+DatacenterTopologyHelper::SetLeafSpine (uint32_t nSpines, uint32_t nLeaves, uint32_t nServersPerLeaf, uint32_t nLinks)
+{
+  NS_ABORT_MSG_IF (nSpines == 0 || nLeaves == 0 || nLinks == 0, "Empty leaf-spine");
+  m_tiers = LEAF_SPINE;
+  m_nTors = nLeaves;
+  m_nSpines = nSpines;
+  m_nCores = 0;
+  m_nServersPerTor = nServersPerLeaf;
+  m_nLinks = nLinks;
+  m_k = 0;
+}
+
+void
+DatacenterTopologyHelper::SetFatTree (uint32_t k, uint32_t nServersPerEdge)
+{
+  NS_ABORT_MSG_IF (k < 2 || k % 2 != 0, "The arity of a fat-tree must be even");
+  m_tiers = FAT_TREE;
+  m_k = k;
+  m_nTors = k * k / 2;
+  m_nSpines = k * k / 2;
+  m_nCores = k * k / 4;
+  m_nServersPerTor = nServersPerEdge == 0 ? k / 2 : nServersPerEdge;
+  m_nLinks = 1;
+}
+
+void
+DatacenterTopologyHelper::SetServerLinkAttributes (DataRate rate, Time delay)
+{
+  m_serverLink.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+  m_serverLink.SetChannelAttribute ("Delay", TimeValue (delay));
+}
+
+void
+DatacenterTopologyHelper::SetFabricLinkAttributes (DataRate rate, Time delay)
+{
+  m_fabricRate = rate;
+  m_fabricLink.SetDeviceAttribute ("DataRate", DataRateValue (rate));
+  m_fabricLink.SetChannelAttribute ("Delay", TimeValue (delay));
+}
+
+void
+DatacenterTopologyHelper::SetDeviceQueue (std::string type,
+                                          std::string n1, const AttributeValue &v1,
+                                          std::string n2, const AttributeValue &v2)
+{
+  m_serverLink.SetQueue (type, n1, v1, n2, v2);
+  m_fabricLink.SetQueue (type, n1, v1, n2, v2);
+}
+
+void
+DatacenterTopologyHelper::SetSwitchQueueDisc (std::string type,
+                                              std::string n1, const AttributeValue &v1,
+                                              std::string n2, const AttributeValue &v2,
+                                              std::string n3, const AttributeValue &v3,
+                                              std::string n4, const AttributeValue &v4)
+{
+  m_switchQueueDisc = ObjectFactory ();
+  m_switchQueueDisc.SetTypeId (type);
+  m_switchQueueDisc.Set (n1, v1);
+  m_switchQueueDisc.Set (n2, v2);
+  m_switchQueueDisc.Set (n3, v3);
+  m_switchQueueDisc.Set (n4, v4);
+  m_hasSwitchQueueDisc = true;
+}
+
+void
+DatacenterTopologyHelper::SetServerQueueDisc (std::string type,
+                                              std::string n1, const AttributeValue &v1,
+                                              std::string n2, const AttributeValue &v2)
+{
+  m_serverQueueDisc = ObjectFactory ();
+  m_serverQueueDisc.SetTypeId (type);
+  m_serverQueueDisc.Set (n1, v1);
+  m_serverQueueDisc.Set (n2, v2);
+  m_hasServerQueueDisc = true;
+}
+
+void
+DatacenterTopologyHelper::SetLoadBalancer (std::string name)
+{
+  if (name == "ECMP")
+    {
+      m_lb = ECMP;
+    }
+  else if (name == "FlowBender")
+    {
+      m_lb = FLOWBENDER;
+    }
+  else if (name == "TLB")
+    {
+      m_lb = TLB;
+    }
+  else if (name == "Conga")
+    {
+      m_lb = CONGA;
+    }
+  else if (name == "Conga-flow")
+    {
+      m_lb = CONGA_FLOW;
+    }
+  else if (name == "Conga-ECMP")
+    {
+      m_lb = CONGA_ECMP;
+    }
+  else if (name == "Presto" || name == "Weighted-Presto")
+    {
+      m_lb = PRESTO;
+    }
+  else if (name == "DRB")
+    {
+      m_lb = DRB;
+    }
+  else if (name == "Clove")
+    {
+      m_lb = CLOVE;
+    }
+  else if (name == "DRILL")
+    {
+      m_lb = DRILL;
+    }
+  else if (name == "LetFlow")
+    {
+      m_lb = LETFLOW;
+    }
+  else
+    {
+      NS_ABORT_MSG ("Unknown load balancer " << name);
+    }
+}
+
+void
+DatacenterTopologyHelper::SetFlowletTimeout (Time timeout)
+{
+  m_flowletTimeout = timeout;
+}
+
+void
+DatacenterTopologyHelper::SetAddressBases (Ipv4Address serverBase, Ipv4Address fabricBase)
+{
+  m_serverBase = serverBase;
+  m_fabricBase = fabricBase;
+}
+
+bool
+DatacenterTopologyHelper::UsesGlobalRouting (void) const
+{
+  return m_lb == ECMP || m_lb == FLOWBENDER || m_lb == TLB || m_lb == CLOVE
+         || m_lb == PRESTO || m_lb == DRB;
+}
+
+bool
+DatacenterTopologyHelper::UsesXPath (void) const
+{
+  return m_lb == TLB || m_lb == CLOVE || m_lb == PRESTO || m_lb == DRB;
+}
+
+void
+DatacenterTopologyHelper::Install (void)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (m_nTors == 0, "Set the topology first");
+  NS_ABORT_MSG_IF (m_nServersPerTor == 0 || m_nServersPerTor > MAX_SERVERS_PER_TOR,
+                   "A ToR holds 1 to " << MAX_SERVERS_PER_TOR << " servers");
+  NS_ABORT_MSG_IF (m_tiers == FAT_TREE && (m_lb == CONGA || m_lb == CONGA_FLOW || m_lb == CONGA_ECMP),
+                   "CONGA only supports the leaf-spine topology");
+
+  m_servers.Create (m_nTors * m_nServersPerTor);
+  m_tors.Create (m_nTors);
+  m_spines.Create (m_nSpines);
+  m_cores.Create (m_nCores);
+  InstallStacks ();
+
+  NS_LOG_INFO ("Connect the servers");
+  Ipv4Mask torMask ("255.255.255.0");
+  m_serverDevices.resize (m_servers.GetN ());
+  m_serverPorts.resize (m_servers.GetN ());
+  for (uint32_t tor = 0; tor < m_nTors; ++tor)
+    {
+      uint32_t network = GetTorNetwork (tor).Get ();
+      for (uint32_t j = 0; j < m_nServersPerTor; ++j)
+        {
+          uint32_t server = tor * m_nServersPerTor + j;
+          uint32_t serverPort;
+          m_serverDevices[server] = Connect (m_servers.Get (server), m_tors.Get (tor), true,
+                                             Ipv4Address (network + 2 * j + 1), Ipv4Address (network + 2 * j + 2),
+                                             torMask, serverPort, m_serverPorts[server]);
+        }
+    }
+
+  NS_LOG_INFO ("Connect the switches");
+  m_torUpPorts.assign (m_nTors, std::vector<uint32_t> ());
+  m_spineDownPorts.assign (m_nSpines, std::vector<uint32_t> ());
+  if (m_tiers == LEAF_SPINE)
+    {
+      for (uint32_t tor = 0; tor < m_nTors; ++tor)
+        {
+          m_torUpPorts[tor].resize (m_nSpines * m_nLinks);
+          for (uint32_t spine = 0; spine < m_nSpines; ++spine)
+            {
+              m_spineDownPorts[spine].resize (m_nTors * m_nLinks);
+              for (uint32_t link = 0; link < m_nLinks; ++link)
+                {
+                  ConnectFabric (m_tors.Get (tor), m_spines.Get (spine),
+                                 m_torUpPorts[tor][spine * m_nLinks + link],
+                                 m_spineDownPorts[spine][tor * m_nLinks + link]);
+                }
+            }
+        }
+    }
+  else
+    {
+      uint32_t half = m_k / 2;
+      m_spineUpPorts.assign (m_nSpines, std::vector<uint32_t> (half));
+      m_coreDownPorts.assign (m_nCores, std::vector<uint32_t> (m_k));
+      for (uint32_t pod = 0; pod < m_k; ++pod)
+        {
+          for (uint32_t edge = 0; edge < half; ++edge)
+            {
+              uint32_t tor = pod * half + edge;
+              m_torUpPorts[tor].resize (half);
+              for (uint32_t agg = 0; agg < half; ++agg)
+                {
+                  uint32_t spine = pod * half + agg;
+                  m_spineDownPorts[spine].resize (half);
+                  ConnectFabric (m_tors.Get (tor), m_spines.Get (spine),
+                                 m_torUpPorts[tor][agg], m_spineDownPorts[spine][edge]);
+                }
+            }
+          for (uint32_t agg = 0; agg < half; ++agg)
+            {
+              uint32_t spine = pod * half + agg;
+              for (uint32_t c = 0; c < half; ++c)
+                {
+                  uint32_t core = agg * half + c;
+                  ConnectFabric (m_spines.Get (spine), m_cores.Get (core),
+                                 m_spineUpPorts[spine][c], m_coreDownPorts[core][pod]);
+                }
+            }
+        }
+    }
+
+  m_torDirectory = Create<TorDirectory> (GetTorNetwork (0), torMask, m_nTors);
+  InstallRoutes ();
+}
+
+void
+DatacenterTopologyHelper::InstallStacks (void)
+{
+  NS_LOG_INFO ("Install the Internet stacks");
+  InternetStackHelper internet;
+  Ipv4GlobalRoutingHelper globalRoutingHelper;
+  Ipv4StaticRoutingHelper staticRoutingHelper;
+  Ipv4XPathRoutingHelper xpathRoutingHelper;
+  Ipv4ListRoutingHelper listRoutingHelper;
+  NodeContainer switches (m_tors, m_spines, m_cores);
+
+  switch (m_lb)
+    {
+    case ECMP:
+    case FLOWBENDER:
+      internet.SetRoutingHelper (globalRoutingHelper);
+      internet.Install (m_servers);
+      internet.Install (switches);
+      if (m_lb == FLOWBENDER)
+        {
+          // The FlowBender parameters are left to ns3::TcpFlowBender
+          Config::SetDefault ("ns3::TcpSocketBase::FlowBender", BooleanValue (true));
+        }
+      break;
+    case TLB:
+    case CLOVE:
+      if (m_lb == TLB)
+        {
+          internet.SetTLB (true);
+        }
+      else
+        {
+          internet.SetClove (true);
+        }
+      internet.Install (m_servers);
+      internet.SetTLB (false);
+      internet.SetClove (false);
+      listRoutingHelper.Add (xpathRoutingHelper, 1);
+      listRoutingHelper.Add (globalRoutingHelper, 0);
+      internet.SetRoutingHelper (listRoutingHelper);
+      internet.Install (switches);
+      break;
+    case PRESTO:
+    case DRB:
+      {
+        Ipv4DrbRoutingHelper drbRoutingHelper;
+        listRoutingHelper.Add (drbRoutingHelper, 1);
+        listRoutingHelper.Add (globalRoutingHelper, 0);
+        internet.SetRoutingHelper (listRoutingHelper);
+        internet.Install (m_servers);
+        listRoutingHelper.Clear ();
+        listRoutingHelper.Add (xpathRoutingHelper, 1);
+        listRoutingHelper.Add (globalRoutingHelper, 0);
+        internet.SetRoutingHelper (listRoutingHelper);
+        internet.Install (switches);
+      }
+      break;
+    case CONGA:
+    case CONGA_FLOW:
+    case CONGA_ECMP:
+      internet.SetRoutingHelper (staticRoutingHelper);
+      internet.Install (m_servers);
+      internet.SetRoutingHelper (Ipv4CongaRoutingHelper ());
+      internet.Install (switches);
+      break;
+    case DRILL:
+      internet.SetRoutingHelper (staticRoutingHelper);
+      internet.Install (m_servers);
+      internet.SetRoutingHelper (Ipv4DrillRoutingHelper ());
+      internet.Install (switches);
+      break;
+    case LETFLOW:
+      internet.SetRoutingHelper (staticRoutingHelper);
+      internet.Install (m_servers);
+      internet.SetRoutingHelper (Ipv4LetFlowRoutingHelper ());
+      internet.Install (switches);
+      break;
+    }
+
+  if (UsesGlobalRouting ())
+    {
+      NodeContainer all (m_servers, switches);
+      for (uint32_t i = 0; i < all.GetN (); ++i)
+        {
+          EnablePerflowEcmp (all.Get (i));
+        }
+    }
+}
+
+Ptr<NetDevice>
+DatacenterTopologyHelper::Connect (Ptr<Node> a, Ptr<Node> b, bool isServerLink,
+                                   Ipv4Address addrA, Ipv4Address addrB, Ipv4Mask mask,
+                                   uint32_t &ifA, uint32_t &ifB)
+{
+  NetDeviceContainer devices = isServerLink ? m_serverLink.Install (a, b) : m_fabricLink.Install (a, b);
+  InstallQueueDisc (devices.Get (0), isServerLink);
+  InstallQueueDisc (devices.Get (1), false);
+
+  Ptr<Ipv4> ipv4A = a->GetObject<Ipv4> ();
+  ifA = ipv4A->AddInterface (devices.Get (0));
+  ipv4A->AddAddress (ifA, Ipv4InterfaceAddress (addrA, mask));
+  ipv4A->SetMetric (ifA, 1);
+  ipv4A->SetUp (ifA);
+
+  Ptr<Ipv4> ipv4B = b->GetObject<Ipv4> ();
+  ifB = ipv4B->AddInterface (devices.Get (1));
+  ipv4B->AddAddress (ifB, Ipv4InterfaceAddress (addrB, mask));
+  ipv4B->SetMetric (ifB, 1);
+  ipv4B->SetUp (ifB);
+
+  NS_LOG_LOGIC ("Node " << a->GetId () << " port " << ifA << " " << addrA << " <-> node "
+                        << b->GetId () << " port " << ifB << " " << addrB);
+  return devices.Get (0);
+}
+
+void
+DatacenterTopologyHelper::ConnectFabric (Ptr<Node> a, Ptr<Node> b, uint32_t &ifA, uint32_t &ifB)
+{
+  NS_ABORT_MSG_IF (m_nFabricNetworks >= MAX_FABRIC_NETWORKS, "Too many fabric links");
+  uint32_t network = m_fabricBase.Get () + 4 * m_nFabricNetworks++;
+  Connect (a, b, false, Ipv4Address (network + 1), Ipv4Address (network + 2),
+           Ipv4Mask ("255.255.255.252"), ifA, ifB);
+  NS_ABORT_MSG_IF (UsesXPath () && (ifA >= XPATH_PORT_BASE || ifB >= XPATH_PORT_BASE),
+                   "XPath cannot address more than " << XPATH_PORT_BASE - 1 << " ports per switch");
+}
+
+void
+DatacenterTopologyHelper::InstallQueueDisc (Ptr<NetDevice> device, bool isServer)
+{
+  ObjectFactory *factory = 0;
+  if (isServer && m_hasServerQueueDisc)
+    {
+      factory = &m_serverQueueDisc;
+    }
+  else if (!isServer && m_hasSwitchQueueDisc)
+    {
+      factory = &m_switchQueueDisc;
+    }
+  if (factory == 0)
+    {
+      m_defaultQueueDisc.Install (device);
+      return;
+    }
+  Ptr<QueueDisc> queueDisc = factory->Create<QueueDisc> ();
+  queueDisc->SetNetDevice (device);
+  device->GetNode ()->GetObject<TrafficControlLayer> ()->SetRootQueueDiscOnDevice (device, queueDisc);
+}
+
+void
+DatacenterTopologyHelper::AddSwitchRoute (Ptr<Node> node, Ipv4Address network, Ipv4Mask mask, uint32_t port) const
+{
+  Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+  if (UsesGlobalRouting ())
+    {
+      // Same prefix on several ports is an ECMP group of the global routing
+      Ptr<Ipv4GlobalRouting> globalRouting = node->GetObject<GlobalRouter> ()->GetRoutingProtocol ();
+      if (mask == Ipv4Mask::GetOnes ())
+        {
+          globalRouting->AddHostRouteTo (network, network, port);
+        }
+      else
+        {
+          // The next hop is the other end of the /30 fabric link
+          Ipv4Address nextHop (ipv4->GetAddress (port, 0).GetLocal ().Get () ^ 3);
+          globalRouting->AddNetworkRouteTo (network, mask, nextHop, port);
+        }
+    }
+  else if (m_lb == DRILL)
+    {
+      Ipv4DrillRoutingHelper ().GetDrillRouting (ipv4)->AddRoute (network, mask, port);
+    }
+  else if (m_lb == LETFLOW)
+    {
+      Ipv4LetFlowRoutingHelper ().GetLetFlowRouting (ipv4)->AddRoute (network, mask, port);
+    }
+  else
+    {
+      Ipv4CongaRoutingHelper ().GetCongaRouting (ipv4)->AddRoute (network, mask, port);
+    }
+}
+
+void
+DatacenterTopologyHelper::InstallRoutes (void)
+{
+  NS_LOG_INFO ("Install the routes");
+  Ipv4Mask torMask ("255.255.255.0");
+  Ipv4Mask hostMask ("255.255.255.255");
+  Ipv4Mask defaultMask ("0.0.0.0");
+  Ipv4Address any ("0.0.0.0");
+
+  if (m_lb == TLB || m_lb == CLOVE)
+    {
+      for (uint32_t src = 0; src < m_nTors; ++src)
+        {
+          std::vector<Ptr<Ipv4TLB> > tlbs;
+          std::vector<Ptr<Ipv4Clove> > cloves;
+          for (uint32_t j = 0; j < m_nServersPerTor; ++j)
+            {
+              Ptr<Node> server = m_servers.Get (src * m_nServersPerTor + j);
+              if (m_lb == TLB)
+                {
+                  tlbs.push_back (server->GetObject<Ipv4TLB> ());
+                  tlbs.back ()->SetTorDirectory (m_torDirectory);
+                }
+              else
+                {
+                  cloves.push_back (server->GetObject<Ipv4Clove> ());
+                  cloves.back ()->SetTorDirectory (m_torDirectory);
+                }
+            }
+          for (uint32_t dst = 0; dst < m_nTors; ++dst)
+            {
+              if (dst == src)
+                {
+                  continue;
+                }
+              std::vector<uint32_t> paths = GetPaths (src, dst);
+              for (uint32_t p = 0; p < paths.size (); ++p)
+                {
+                  for (uint32_t j = 0; j < tlbs.size (); ++j)
+                    {
+                      tlbs[j]->AddAvailPath (dst, paths[p]);
+                    }
+                  for (uint32_t j = 0; j < cloves.size (); ++j)
+                    {
+                      cloves[j]->AddAvailPath (dst, paths[p]);
+                    }
+                }
+            }
+        }
+    }
+  else if (m_lb == PRESTO || m_lb == DRB)
+    {
+      // The servers pick the ToR uplink, the next hops balance with ECMP
+      Ipv4DrbRoutingHelper drbRoutingHelper;
+      for (uint32_t server = 0; server < m_servers.GetN (); ++server)
+        {
+          Ptr<Ipv4DrbRouting> drb = drbRoutingHelper.GetDrbRouting (m_servers.Get (server)->GetObject<Ipv4> ());
+          drb->SetAttribute ("Mode", UintegerValue (m_lb == DRB ? 0 : 1));
+          const std::vector<uint32_t> &upPorts = m_torUpPorts[GetTor (server)];
+          for (uint32_t u = 0; u < upPorts.size (); ++u)
+            {
+              drb->AddPath (upPorts[u]);
+            }
+        }
+    }
+
+  // Default routes up, routes per ToR network down, instead of one SPF per
+  // node: the last hop of XPath and the ECMP schemes use the global routing,
+  // CONGA, DRILL and LetFlow their own tables.
+  Ipv4StaticRoutingHelper staticRoutingHelper;
+  for (uint32_t server = 0; server < m_servers.GetN (); ++server)
+    {
+      Ptr<Node> node = m_servers.Get (server);
+      Ptr<Ipv4> ipv4 = node->GetObject<Ipv4> ();
+      uint32_t serverIf = ipv4->GetInterfaceForDevice (m_serverDevices[server]);
+      if (UsesGlobalRouting ())
+        {
+          Ipv4Address gateway (GetServerAddress (server).Get () + 1);
+          node->GetObject<GlobalRouter> ()->GetRoutingProtocol ()->AddNetworkRouteTo (any, defaultMask, gateway, serverIf);
+        }
+      else
+        {
+          staticRoutingHelper.GetStaticRouting (ipv4)->AddNetworkRouteTo (any, defaultMask, serverIf);
+        }
+    }
+  for (uint32_t tor = 0; tor < m_nTors; ++tor)
+    {
+      Ptr<Node> node = m_tors.Get (tor);
+      for (uint32_t j = 0; j < m_nServersPerTor; ++j)
+        {
+          uint32_t server = tor * m_nServersPerTor + j;
+          AddSwitchRoute (node, GetServerAddress (server), hostMask, m_serverPorts[server]);
+        }
+      for (uint32_t u = 0; u < m_torUpPorts[tor].size (); ++u)
+        {
+          AddSwitchRoute (node, any, defaultMask, m_torUpPorts[tor][u]);
+        }
+
+      if (m_lb == CONGA || m_lb == CONGA_FLOW || m_lb == CONGA_ECMP)
+        {
+          Ptr<Ipv4CongaRouting> conga = Ipv4CongaRoutingHelper ().GetCongaRouting (node->GetObject<Ipv4> ());
+          conga->SetLeafId (tor);
+          conga->SetTDre (MicroSeconds (30));
+          conga->SetAlpha (0.2);
+          conga->SetLinkCapacity (m_fabricRate);
+          conga->SetTorDirectory (m_torDirectory);
+          if (m_lb == CONGA_FLOW)
+            {
+              conga->SetFlowletTimeout (MilliSeconds (13));
+            }
+          else if (!m_flowletTimeout.IsZero ())
+            {
+              conga->SetFlowletTimeout (m_flowletTimeout);
+            }
+          if (m_lb == CONGA_ECMP)
+            {
+              conga->EnableEcmpMode ();
+            }
+        }
+      else if (m_lb == LETFLOW && !m_flowletTimeout.IsZero ())
+        {
+          Ipv4LetFlowRoutingHelper ().GetLetFlowRouting (node->GetObject<Ipv4> ())->SetFlowletTimeout (m_flowletTimeout);
+        }
+    }
+
+  if (m_tiers == LEAF_SPINE)
+    {
+      for (uint32_t spine = 0; spine < m_nSpines; ++spine)
+        {
+          for (uint32_t down = 0; down < m_spineDownPorts[spine].size (); ++down)
+            {
+              AddSwitchRoute (m_spines.Get (spine), GetTorNetwork (down / m_nLinks), torMask,
+                              m_spineDownPorts[spine][down]);
+            }
+        }
+    }
+  else
+    {
+      uint32_t half = m_k / 2;
+      for (uint32_t spine = 0; spine < m_nSpines; ++spine)
+        {
+          uint32_t pod = spine / half;
+          for (uint32_t edge = 0; edge < half; ++edge)
+            {
+              AddSwitchRoute (m_spines.Get (spine), GetTorNetwork (pod * half + edge), torMask,
+                              m_spineDownPorts[spine][edge]);
+            }
+          for (uint32_t c = 0; c < half; ++c)
+            {
+              AddSwitchRoute (m_spines.Get (spine), any, defaultMask, m_spineUpPorts[spine][c]);
+            }
+        }
+      for (uint32_t core = 0; core < m_nCores; ++core)
+        {
+          for (uint32_t tor = 0; tor < m_nTors; ++tor)
+            {
+              AddSwitchRoute (m_cores.Get (core), GetTorNetwork (tor), torMask,
+                              m_coreDownPorts[core][tor / half]);
+            }
+        }
+    }
+}
+
+int64_t
+DatacenterTopologyHelper::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  NodeContainer switches (m_tors, m_spines, m_cores);
+  int64_t currentStream = stream;
+  currentStream += InternetStackHelper ().AssignStreams (NodeContainer (m_servers, switches), currentStream);
+  for (uint32_t i = 0; i < m_servers.GetN () && (m_lb == PRESTO || m_lb == DRB); ++i)
+    {
+      Ptr<Ipv4> ipv4 = m_servers.Get (i)->GetObject<Ipv4> ();
+      currentStream += Ipv4DrbRoutingHelper ().GetDrbRouting (ipv4)->AssignStreams (currentStream);
+    }
+  for (uint32_t i = 0; i < switches.GetN (); ++i)
+    {
+      Ptr<Ipv4> ipv4 = switches.Get (i)->GetObject<Ipv4> ();
+      if (m_lb == DRILL)
+        {
+          currentStream += Ipv4DrillRoutingHelper ().GetDrillRouting (ipv4)->AssignStreams (currentStream);
+        }
+      else if (m_lb == LETFLOW)
+        {
+          currentStream += Ipv4LetFlowRoutingHelper ().GetLetFlowRouting (ipv4)->AssignStreams (currentStream);
+        }
+      else if (m_lb == CONGA || m_lb == CONGA_FLOW || m_lb == CONGA_ECMP)
+        {
+          currentStream += Ipv4CongaRoutingHelper ().GetCongaRouting (ipv4)->AssignStreams (currentStream);
+        }
+    }
+  return currentStream - stream;
+}
+
+std::vector<uint32_t>
+DatacenterTopologyHelper::GetPaths (uint32_t srcTor, uint32_t dstTor) const
+{
+  NS_ASSERT (srcTor < m_nTors && dstTor < m_nTors);
+  const uint32_t base = XPATH_PORT_BASE;
+  std::vector<uint32_t> paths;
+  if (srcTor == dstTor)
+    {
+      return paths;
+    }
+
+  const std::vector<uint32_t> &upPorts = m_torUpPorts[srcTor];
+  if (m_tiers == LEAF_SPINE)
+    {
+      // Leaf uplink, then spine downlink
+      for (uint32_t spine = 0; spine < m_nSpines; ++spine)
+        {
+          for (uint32_t up = 0; up < m_nLinks; ++up)
+            {
+              for (uint32_t down = 0; down < m_nLinks; ++down)
+                {
+                  paths.push_back (upPorts[spine * m_nLinks + up]
+                                   + base * m_spineDownPorts[spine][dstTor * m_nLinks + down]);
+                }
+            }
+        }
+      return paths;
+    }
+
+  uint32_t half = m_k / 2;
+  uint32_t srcPod = srcTor / half;
+  uint32_t dstPod = dstTor / half;
+  uint32_t dstEdge = dstTor % half;
+  for (uint32_t agg = 0; agg < half; ++agg)
+    {
+      if (srcPod == dstPod)
+        {
+          // Edge uplink, then aggregation downlink
+          paths.push_back (upPorts[agg] + base * m_spineDownPorts[srcPod * half + agg][dstEdge]);
+          continue;
+        }
+      // Edge uplink, aggregation uplink, core downlink, aggregation downlink
+      for (uint32_t c = 0; c < half; ++c)
+        {
+          paths.push_back (upPorts[agg]
+                           + base * m_spineUpPorts[srcPod * half + agg][c]
+                           + base * base * m_coreDownPorts[agg * half + c][dstPod]
+                           + base * base * base * m_spineDownPorts[dstPod * half + agg][dstEdge]);
+        }
+    }
+  return paths;
+}
+
+NodeContainer
+DatacenterTopologyHelper::GetServers (void) const
+{
+  return m_servers;
+}
+
+NodeContainer
+DatacenterTopologyHelper::GetTors (void) const
+{
+  return m_tors;
+}
+
+NodeContainer
+DatacenterTopologyHelper::GetSpines (void) const
+{
+  return m_spines;
+}
+
+NodeContainer
+DatacenterTopologyHelper::GetCores (void) const
+{
+  return m_cores;
+}
+
+uint32_t
+DatacenterTopologyHelper::GetNServersPerTor (void) const
+{
+  return m_nServersPerTor;
+}
+
+uint32_t
+DatacenterTopologyHelper::GetTor (uint32_t server) const
+{
+  return server / m_nServersPerTor;
+}
+
+Ipv4Address
+DatacenterTopologyHelper::GetTorNetwork (uint32_t tor) const
+{
+  return Ipv4Address (m_serverBase.Get () + ((tor + 1) << 8));
+}
+
+Ipv4Address
+DatacenterTopologyHelper::GetServerAddress (uint32_t server) const
+{
+  return Ipv4Address (GetTorNetwork (GetTor (server)).Get () + 2 * (server % m_nServersPerTor) + 1);
+}
+
+Ptr<NetDevice>
+DatacenterTopologyHelper::GetServerDevice (uint32_t server) const
+{
+  return m_serverDevices[server];
+}
+
+Ptr<QueueDisc>
+DatacenterTopologyHelper::GetServerQueueDisc (uint32_t server) const
+{
+  Ptr<NetDevice> device = m_serverDevices[server];
+  return device->GetNode ()->GetObject<TrafficControlLayer> ()->GetRootQueueDiscOnDevice (device);
+}
+
+Ptr<const TorDirectory>
+DatacenterTopologyHelper::GetTorDirectory (void) const
+{
+  return m_torDirectory;
+}
+
+} // namespace ns3
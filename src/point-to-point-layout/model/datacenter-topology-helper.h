@@ -0,0 +1,236 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef DATACENTER_TOPOLOGY_HELPER_H
+#define DATACENTER_TOPOLOGY_HELPER_H
+
+#include <string>
+#include <vector>
+
+#include "ns3/node-container.h"
+#include "ns3/object-factory.h"
+#include "ns3/attribute.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/tor-directory.h"
+#include "ns3/queue-disc.h"
+#include "ns3/traffic-control-helper.h"
+#include "point-to-point-helper.h"
+
+namespace ns3 {
+
+/**
+ * \ingroup point-to-point-layout
+ *
+ * \brief A helper to build the 2-tier leaf-spine and 3-tier k-ary fat-tree
+ * datacenter topologies with a load balancing scheme and an AQM
+ *
+ * Addresses are assigned arithmetically instead of through
+ * Ipv4AddressHelper: the servers of ToR t are in the /24 following
+ * t + 1 /24s after the server base (10.1.0.0 by default), server j of the
+ * rack gets host 2j + 1 and the ToR port towards it host 2j + 2. Every
+ * fabric link is a /30 taken in order from the fabric base (10.128.0.0 by
+ * default).
+ *
+ * In a fat-tree of arity k, pod p holds the edges (ToRs) p * k/2 + e and
+ * the aggregations p * k/2 + a; aggregation a of every pod connects to the
+ * cores a * k/2 + c.
+ *
+ * The XPath path ids and all the routes are computed from the port layout
+ * in closed form, so building a topology of ten thousand hosts takes
+ * seconds: the routes towards the servers are written directly into the
+ * global routing, with one entry per port for ECMP, or into the tables of
+ * CONGA, DRILL and LetFlow. No SPF is run; the global routing tables hold
+ * no routes towards the fabric addresses of the switches.
+ *
+ * The load balancer is chosen by the runMode names of the rtt-variations
+ * examples: ECMP, FlowBender, TLB, Conga, Conga-flow, Conga-ECMP, Presto,
+ * Weighted-Presto (installed as Presto), DRB, Clove, DRILL and LetFlow.
+ * CONGA only supports the leaf-spine topology.
+ */
+class DatacenterTopologyHelper
+{
+public:
+  DatacenterTopologyHelper ();
+
+  /**
+   * \param nSpines number of spine switches
+   * \param nLeaves number of leaf (ToR) switches
+   * \param nServersPerLeaf number of servers under every leaf, at most 127
+   * \param nLinks number of parallel links between a leaf and a spine
+   */
+  void SetLeafSpine (uint32_t nSpines, uint32_t nLeaves, uint32_t nServersPerLeaf, uint32_t nLinks = 1);
+
+  /**
+   * \param k the arity of the fat-tree, even
+   * \param nServersPerEdge number of servers under every edge, k/2 if 0
+   */
+  void SetFatTree (uint32_t k, uint32_t nServersPerEdge = 0);
+
+  void SetServerLinkAttributes (DataRate rate, Time delay);
+  void SetFabricLinkAttributes (DataRate rate, Time delay);
+
+  /**
+   * \brief Set the device queue of every link, see PointToPointHelper::SetQueue
+   */
+  void SetDeviceQueue (std::string type,
+                       std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                       std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+
+  /**
+   * \brief Set the root queue disc of every switch port, e.g.
+   * ns3::TCNQueueDisc or ns3::ECNSharpQueueDisc
+   *
+   * The ports without a queue disc get the TrafficControlHelper default.
+   */
+  void SetSwitchQueueDisc (std::string type,
+                           std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                           std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue (),
+                           std::string n3 = "", const AttributeValue &v3 = EmptyAttributeValue (),
+                           std::string n4 = "", const AttributeValue &v4 = EmptyAttributeValue ());
+
+  /**
+   * \brief Set the root queue disc of every server port
+   */
+  void SetServerQueueDisc (std::string type,
+                           std::string n1 = "", const AttributeValue &v1 = EmptyAttributeValue (),
+                           std::string n2 = "", const AttributeValue &v2 = EmptyAttributeValue ());
+
+  /**
+   * \param name the runMode name of the scheme, ECMP by default
+   */
+  void SetLoadBalancer (std::string name);
+
+  /**
+   * \brief The flowlet timeout of CONGA and LetFlow, their default if not set
+   */
+  void SetFlowletTimeout (Time timeout);
+
+  void SetAddressBases (Ipv4Address serverBase, Ipv4Address fabricBase);
+
+  /**
+   * \brief Create the nodes, the stacks, the links and the routes
+   */
+  void Install (void);
+
+  /**
+   * \brief Use fixed random variable streams for the Internet stacks and
+   * the load balancers of all the nodes, after Install
+   *
+   * \param stream first stream index to use
+   * \returns the number of stream indices assigned
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  NodeContainer GetServers (void) const;
+
+  /**
+   * \returns the leaves of a leaf-spine, the edges of a fat-tree
+   */
+  NodeContainer GetTors (void) const;
+
+  /**
+   * \returns the spines of a leaf-spine, the aggregations of a fat-tree
+   */
+  NodeContainer GetSpines (void) const;
+
+  /**
+   * \returns the cores of a fat-tree, none for a leaf-spine
+   */
+  NodeContainer GetCores (void) const;
+
+  uint32_t GetNServersPerTor (void) const;
+  uint32_t GetTor (uint32_t server) const;
+  Ipv4Address GetServerAddress (uint32_t server) const;
+  Ptr<NetDevice> GetServerDevice (uint32_t server) const;
+  Ptr<QueueDisc> GetServerQueueDisc (uint32_t server) const;
+  Ptr<const TorDirectory> GetTorDirectory (void) const;
+
+  /**
+   * \returns the XPath ids of all the paths from a ToR to another one
+   */
+  std::vector<uint32_t> GetPaths (uint32_t srcTor, uint32_t dstTor) const;
+
+private:
+  enum Tiers
+  {
+    LEAF_SPINE,
+    FAT_TREE
+  };
+
+  enum LoadBalancer
+  {
+    ECMP,
+    FLOWBENDER,
+    TLB,
+    CONGA,
+    CONGA_FLOW,
+    CONGA_ECMP,
+    PRESTO,
+    DRB,
+    CLOVE,
+    DRILL,
+    LETFLOW
+  };
+
+  void InstallStacks (void);
+  void InstallRoutes (void);
+
+  /**
+   * \brief Connect two nodes and add the addresses of the link
+   * \param a the first node, a server for the server links
+   * \returns the device on a
+   */
+  Ptr<NetDevice> Connect (Ptr<Node> a, Ptr<Node> b, bool isServerLink,
+                          Ipv4Address addrA, Ipv4Address addrB, Ipv4Mask mask,
+                          uint32_t &ifA, uint32_t &ifB);
+  void ConnectFabric (Ptr<Node> a, Ptr<Node> b, uint32_t &ifA, uint32_t &ifB);
+  void AddSwitchRoute (Ptr<Node> node, Ipv4Address network, Ipv4Mask mask, uint32_t port) const;
+  void InstallQueueDisc (Ptr<NetDevice> device, bool isServer);
+
+  Ipv4Address GetTorNetwork (uint32_t tor) const;
+
+  bool UsesGlobalRouting (void) const;
+  bool UsesXPath (void) const;
+
+  Tiers m_tiers;
+  uint32_t m_nTors;
+  uint32_t m_nSpines;        // spines, or aggregations of all pods
+  uint32_t m_nCores;
+  uint32_t m_nServersPerTor;
+  uint32_t m_nLinks;
+  uint32_t m_k;
+
+  LoadBalancer m_lb;
+  Time m_flowletTimeout;
+  DataRate m_fabricRate;
+
+  PointToPointHelper m_serverLink;
+  PointToPointHelper m_fabricLink;
+  ObjectFactory m_switchQueueDisc;
+  ObjectFactory m_serverQueueDisc;
+  bool m_hasSwitchQueueDisc;
+  bool m_hasServerQueueDisc;
+  TrafficControlHelper m_defaultQueueDisc;
+
+  Ipv4Address m_serverBase;
+  Ipv4Address m_fabricBase;
+  uint32_t m_nFabricNetworks;
+
+  NodeContainer m_servers;
+  NodeContainer m_tors;
+  NodeContainer m_spines;
+  NodeContainer m_cores;
+  std::vector<Ptr<NetDevice> > m_serverDevices;
+  Ptr<TorDirectory> m_torDirectory;
+
+  // Interface indexes, i.e. the XPath ports, of every link
+  std::vector<uint32_t> m_serverPorts;                // [server], on the ToR
+  std::vector<std::vector<uint32_t> > m_torUpPorts;   // [tor][spine * nLinks + link] or [tor][aggregation in pod]
+  std::vector<std::vector<uint32_t> > m_spineDownPorts; // [spine][tor * nLinks + link] or [aggregation][edge in pod]
+  std::vector<std::vector<uint32_t> > m_spineUpPorts; // [aggregation][core of its group]
+  std::vector<std::vector<uint32_t> > m_coreDownPorts; // [core][pod]
+};
+
+} // namespace ns3
+
+#endif /* DATACENTER_TOPOLOGY_HELPER_H */
@@ -0,0 +1,390 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+#include "ns3/packet.h"
+#include "ns3/ipv4.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/datacenter-topology-helper.h"
+
+#include <map>
+#include <set>
+
+using namespace ns3;
+
+namespace {
+
+/**
+ * \returns the device at the other end of the point to point link of device
+ */
+Ptr<NetDevice>
+GetPeerDevice (Ptr<NetDevice> device)
+{
+  Ptr<Channel> channel = device->GetChannel ();
+  return channel->GetDevice (channel->GetDevice (0) == device ? 1 : 0);
+}
+
+/**
+ * \brief Walk an XPath path id, one port per two decimal digits
+ * \param node the first switch
+ * \param path the path id
+ * \param hops the number of links crossed
+ * \returns the node reached
+ */
+Ptr<Node>
+FollowPath (Ptr<Node> node, uint32_t path, uint32_t &hops)
+{
+  hops = 0;
+  while (path != 0)
+    {
+      Ptr<NetDevice> device = node->GetObject<Ipv4> ()->GetNetDevice (path % 100);
+      node = GetPeerDevice (device)->GetNode ();
+      path /= 100;
+      hops++;
+    }
+  return node;
+}
+
+} // anonymous namespace
+
+/**
+ * \brief Test the addresses and the XPath path ids of
+ * DatacenterTopologyHelper against the links actually built
+ */
+class DatacenterTopologyLayoutTest : public TestCase
+{
+public:
+  /**
+   * \param fatTree a k=4 fat-tree if true, else a leaf-spine with two
+   * links between every leaf and spine
+   */
+  DatacenterTopologyLayoutTest (bool fatTree);
+
+private:
+  virtual void DoRun (void);
+
+  bool m_fatTree; //!< whether to build a fat-tree
+};
+
+DatacenterTopologyLayoutTest::DatacenterTopologyLayoutTest (bool fatTree)
+  : TestCase (fatTree ? "Addresses and paths of a k=4 fat-tree" : "Addresses and paths of a leaf-spine"),
+    m_fatTree (fatTree)
+{
+}
+
+void
+DatacenterTopologyLayoutTest::DoRun (void)
+{
+  DatacenterTopologyHelper topology;
+  if (m_fatTree)
+    {
+      topology.SetFatTree (4);
+    }
+  else
+    {
+      topology.SetLeafSpine (2, 3, 2, 2);
+    }
+  topology.SetLoadBalancer ("DRB");
+  topology.Install ();
+
+  NodeContainer servers = topology.GetServers ();
+  NodeContainer tors = topology.GetTors ();
+  uint32_t nTors = m_fatTree ? 8 : 3;
+  NS_TEST_ASSERT_MSG_EQ (tors.GetN (), nTors, "Wrong number of ToRs");
+  NS_TEST_ASSERT_MSG_EQ (topology.GetSpines ().GetN (), m_fatTree ? 8 : 2, "Wrong number of spines");
+  NS_TEST_ASSERT_MSG_EQ (topology.GetCores ().GetN (), m_fatTree ? 4 : 0, "Wrong number of cores");
+  NS_TEST_ASSERT_MSG_EQ (servers.GetN (), nTors * 2, "Wrong number of servers");
+
+  for (uint32_t s = 0; s < servers.GetN (); ++s)
+    {
+      uint32_t tor = s / 2;
+      Ipv4Address expected ((10 << 24) + (1 << 16) + ((tor + 1) << 8) + 2 * (s % 2) + 1);
+      NS_TEST_EXPECT_MSG_EQ (topology.GetTor (s), tor, "Server " << s << " under the wrong ToR");
+      NS_TEST_EXPECT_MSG_EQ (topology.GetServerAddress (s), expected, "Wrong address of server " << s);
+
+      Ptr<NetDevice> device = topology.GetServerDevice (s);
+      Ptr<Ipv4> ipv4 = servers.Get (s)->GetObject<Ipv4> ();
+      NS_TEST_EXPECT_MSG_EQ (ipv4->GetAddress (ipv4->GetInterfaceForDevice (device), 0).GetLocal (), expected,
+                             "Server " << s << " does not hold its address");
+      Ptr<NetDevice> peer = GetPeerDevice (device);
+      NS_TEST_EXPECT_MSG_EQ (peer->GetNode (), tors.Get (tor), "Server " << s << " not linked to its ToR");
+      Ptr<Ipv4> torIpv4 = peer->GetNode ()->GetObject<Ipv4> ();
+      NS_TEST_EXPECT_MSG_EQ (torIpv4->GetAddress (torIpv4->GetInterfaceForDevice (peer), 0).GetLocal (),
+                             Ipv4Address (expected.Get () + 1), "Wrong ToR port address towards server " << s);
+    }
+
+  // The fabric links are /30s taken in order from 10.128.0.0
+  Ptr<Ipv4> firstTor = tors.Get (0)->GetObject<Ipv4> ();
+  uint32_t upPort = 0;
+  for (uint32_t i = 1; i < firstTor->GetNInterfaces (); ++i)
+    {
+      if (firstTor->GetAddress (i, 0).GetLocal () == Ipv4Address ("10.128.0.1"))
+        {
+          upPort = i;
+        }
+    }
+  NS_TEST_ASSERT_MSG_NE (upPort, 0, "No port of ToR 0 on the first fabric link");
+  Ptr<NetDevice> peer = GetPeerDevice (firstTor->GetNetDevice (upPort));
+  Ptr<Ipv4> peerIpv4 = peer->GetNode ()->GetObject<Ipv4> ();
+  NS_TEST_EXPECT_MSG_EQ (peerIpv4->GetAddress (peerIpv4->GetInterfaceForDevice (peer), 0).GetLocal (),
+                         Ipv4Address ("10.128.0.2"), "Wrong address at the far end of the first fabric link");
+
+  for (uint32_t src = 0; src < nTors; ++src)
+    {
+      NS_TEST_EXPECT_MSG_EQ (topology.GetPaths (src, src).size (), 0, "Paths from a ToR to itself");
+      for (uint32_t dst = 0; dst < nTors; ++dst)
+        {
+          if (dst == src)
+            {
+              continue;
+            }
+          bool samePod = src / 2 == dst / 2;
+          uint32_t nPaths = m_fatTree ? (samePod ? 2 : 4) : 2 * 2 * 2;
+          uint32_t nHops = m_fatTree && !samePod ? 4 : 2;
+          std::vector<uint32_t> paths = topology.GetPaths (src, dst);
+          NS_TEST_EXPECT_MSG_EQ (paths.size (), nPaths, "Wrong number of paths from " << src << " to " << dst);
+          std::set<uint32_t> distinct (paths.begin (), paths.end ());
+          NS_TEST_EXPECT_MSG_EQ (distinct.size (), paths.size (), "Duplicated paths from " << src << " to " << dst);
+          for (uint32_t p = 0; p < paths.size (); ++p)
+            {
+              uint32_t hops;
+              Ptr<Node> end = FollowPath (tors.Get (src), paths[p], hops);
+              NS_TEST_EXPECT_MSG_EQ (hops, nHops, "Path " << paths[p] << " has a wrong length");
+              NS_TEST_EXPECT_MSG_EQ (end, tors.Get (dst), "Path " << paths[p] << " from " << src
+                                                                   << " does not lead to " << dst);
+            }
+        }
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test the routes of DatacenterTopologyHelper: every server opens
+ * a TCP connection to the next server and one under another ToR, and all
+ * the bytes must arrive
+ */
+class DatacenterTopologyDeliveryTest : public TestCase
+{
+public:
+  /**
+   * \param lb the load balancer
+   * \param fatTree a k=4 fat-tree if true, else a leaf-spine
+   */
+  DatacenterTopologyDeliveryTest (std::string lb, bool fatTree);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Read the bytes of an accepted connection
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Count the bytes received
+   */
+  void Receive (Ptr<Socket> socket);
+
+  std::string m_lb;     //!< load balancer
+  bool m_fatTree;       //!< whether to build a fat-tree
+  uint64_t m_received;  //!< bytes received by all the servers
+};
+
+DatacenterTopologyDeliveryTest::DatacenterTopologyDeliveryTest (std::string lb, bool fatTree)
+  : TestCase ("Delivery with " + lb + (fatTree ? " in a k=4 fat-tree" : " in a leaf-spine")),
+    m_lb (lb),
+    m_fatTree (fatTree),
+    m_received (0)
+{
+}
+
+void
+DatacenterTopologyDeliveryTest::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&DatacenterTopologyDeliveryTest::Receive, this));
+}
+
+void
+DatacenterTopologyDeliveryTest::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received += packet->GetSize ();
+    }
+}
+
+void
+DatacenterTopologyDeliveryTest::DoRun (void)
+{
+  const uint16_t port = 9;
+  const uint32_t size = 20000;
+
+  DatacenterTopologyHelper topology;
+  if (m_fatTree)
+    {
+      topology.SetFatTree (4);
+    }
+  else
+    {
+      topology.SetLeafSpine (2, 3, 2);
+    }
+  topology.SetLoadBalancer (m_lb);
+  topology.Install ();
+  topology.AssignStreams (0);
+
+  NodeContainer servers = topology.GetServers ();
+  for (uint32_t s = 0; s < servers.GetN (); ++s)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (servers.Get (s), TcpSocketFactory::GetTypeId ());
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+      sink->Listen ();
+      sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&DatacenterTopologyDeliveryTest::Accept, this));
+    }
+  // the next server, under the same ToR or the next one, and a server two
+  // ToRs away, in another pod of the fat-tree
+  uint32_t nFlows = 0;
+  for (uint32_t s = 0; s < servers.GetN (); ++s)
+    {
+      uint32_t dsts[2] = { (s + 1) % servers.GetN (), (s + 5) % servers.GetN () };
+      for (uint32_t d = 0; d < 2; ++d)
+        {
+          Ptr<Socket> source = Socket::CreateSocket (servers.Get (s), TcpSocketFactory::GetTypeId ());
+          source->Bind ();
+          source->Connect (InetSocketAddress (topology.GetServerAddress (dsts[d]), port));
+          source->Send (Create<Packet> (size));
+          nFlows++;
+        }
+    }
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (m_received, (uint64_t) nFlows * size, "Bytes lost with " << m_lb);
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test the length of the paths taken with ECMP: server 0 opens
+ * several TCP connections to a server under another ToR of its pod and to
+ * one in another pod, and every packet must reach them with the TTL left by
+ * the shortest path
+ */
+class DatacenterTopologyHopTest : public TestCase
+{
+public:
+  /**
+   * \param fatTree a k=4 fat-tree if true, else a leaf-spine
+   */
+  DatacenterTopologyHopTest (bool fatTree);
+
+private:
+  virtual void DoRun (void);
+  /**
+   * \brief Record the TTL of a packet delivered to a server
+   */
+  void Deliver (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface);
+
+  bool m_fatTree;                                     //!< whether to build a fat-tree
+  std::map<Ipv4Address, std::set<uint32_t> > m_ttls;  //!< TTLs seen, by destination
+};
+
+DatacenterTopologyHopTest::DatacenterTopologyHopTest (bool fatTree)
+  : TestCase (fatTree ? "Hops of the ECMP paths in a k=4 fat-tree" : "Hops of the ECMP paths in a leaf-spine"),
+    m_fatTree (fatTree)
+{
+}
+
+void
+DatacenterTopologyHopTest::Deliver (const Ipv4Header &header, Ptr<const Packet> packet, uint32_t interface)
+{
+  m_ttls[header.GetDestination ()].insert (header.GetTtl ());
+}
+
+void
+DatacenterTopologyHopTest::DoRun (void)
+{
+  const uint16_t port = 9;
+
+  DatacenterTopologyHelper topology;
+  if (m_fatTree)
+    {
+      topology.SetFatTree (4);
+    }
+  else
+    {
+      topology.SetLeafSpine (2, 3, 2);
+    }
+  topology.SetLoadBalancer ("ECMP");
+  topology.Install ();
+  topology.AssignStreams (0);
+
+  // A server under the next ToR, in the same pod of the fat-tree, and a
+  // server in the next pod. The routers on the way decrement the TTL: the
+  // two ToRs and a spine or aggregation switch, plus an aggregation
+  // switch and a core between pods
+  NodeContainer servers = topology.GetServers ();
+  uint32_t dsts[2] = { 2, 4 };
+  uint32_t ttls[2] = { 64 - 3, m_fatTree ? 64 - 5 : 64 - 3 };
+  for (uint32_t d = 0; d < 2; ++d)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (servers.Get (dsts[d]), TcpSocketFactory::GetTypeId ());
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+      sink->Listen ();
+      servers.Get (dsts[d])->GetObject<Ipv4> ()->TraceConnectWithoutContext (
+        "LocalDeliver", MakeCallback (&DatacenterTopologyHopTest::Deliver, this));
+      // The flows differ by their source port, hence their hashes
+      for (uint32_t f = 0; f < 16; ++f)
+        {
+          Ptr<Socket> source = Socket::CreateSocket (servers.Get (0), TcpSocketFactory::GetTypeId ());
+          source->Bind ();
+          source->Connect (InetSocketAddress (topology.GetServerAddress (dsts[d]), port));
+          source->Send (Create<Packet> (2000));
+        }
+    }
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+
+  for (uint32_t d = 0; d < 2; ++d)
+    {
+      const std::set<uint32_t> &seen = m_ttls[topology.GetServerAddress (dsts[d])];
+      NS_TEST_EXPECT_MSG_EQ (seen.size (), 1, "Paths of different lengths towards server " << dsts[d]);
+      NS_TEST_EXPECT_MSG_EQ ((seen.empty () ? 0 : *seen.begin ()), ttls[d],
+                             "Not the shortest path towards server " << dsts[d]);
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief TestSuite for DatacenterTopologyHelper
+ */
+class DatacenterTopologyHelperTestSuite : public TestSuite
+{
+public:
+  DatacenterTopologyHelperTestSuite ();
+};
+
+DatacenterTopologyHelperTestSuite::DatacenterTopologyHelperTestSuite ()
+  : TestSuite ("datacenter-topology-helper", UNIT)
+{
+  AddTestCase (new DatacenterTopologyLayoutTest (false), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyLayoutTest (true), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyDeliveryTest ("ECMP", false), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyDeliveryTest ("ECMP", true), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyDeliveryTest ("DRB", false), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyDeliveryTest ("DRB", true), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyDeliveryTest ("Conga", false), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyHopTest (false), TestCase::QUICK);
+  AddTestCase (new DatacenterTopologyHopTest (true), TestCase::QUICK);
+}
+
+static DatacenterTopologyHelperTestSuite g_datacenterTopologyHelperTestSuite; //!< The testsuite
@@ -0,0 +1,160 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/uinteger.h"
+#include "ns3/socket.h"
+#include "ns3/tcp-socket-factory.h"
+#include "ns3/inet-socket-address.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/point-to-point-partition-helper.h"
+#include "ns3/datacenter-topology-helper.h"
+
+using namespace ns3;
+
+/**
+ * \brief Test TCP across the links cut between the threads of
+ * MultithreadedSimulatorImpl
+ *
+ * Every server of a leaf-spine sends a TCP flow to the server of the same
+ * rank under the other leaf. The partition puts the leaves on different
+ * threads, so that all the flows cross the cut uplinks. With one and with
+ * two threads, every flow must deliver all its bytes, and the last byte of
+ * each flow must arrive at the same time.
+ */
+class MultithreadedTcpTest : public TestCase
+{
+public:
+  MultithreadedTcpTest ();
+
+private:
+  virtual void DoRun (void);
+
+  /**
+   * \brief Run the flows
+   * \param threads the number of threads
+   */
+  void RunFlows (uint32_t threads);
+  /**
+   * \brief Read the bytes of an accepted connection
+   */
+  void Accept (Ptr<Socket> socket, const Address &from);
+  /**
+   * \brief Count the bytes received by a server
+   */
+  void Receive (Ptr<Socket> socket);
+
+  std::vector<uint64_t> m_received;  //!< bytes received, by node id
+  std::vector<Time> m_lastArrival;   //!< time of the last byte, by node id
+  uint32_t m_nPartitions;            //!< partitions of the last run
+};
+
+MultithreadedTcpTest::MultithreadedTcpTest ()
+  : TestCase ("TCP across the links cut between two threads"),
+    m_nPartitions (0)
+{
+}
+
+void
+MultithreadedTcpTest::Accept (Ptr<Socket> socket, const Address &from)
+{
+  socket->SetRecvCallback (MakeCallback (&MultithreadedTcpTest::Receive, this));
+}
+
+void
+MultithreadedTcpTest::Receive (Ptr<Socket> socket)
+{
+  // each server writes its own entries from its own thread
+  uint32_t id = socket->GetNode ()->GetId ();
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received[id] += packet->GetSize ();
+      m_lastArrival[id] = Simulator::Now ();
+    }
+}
+
+void
+MultithreadedTcpTest::RunFlows (uint32_t threads)
+{
+  const uint16_t port = 9;
+  const uint32_t size = 100000;
+
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  impl->SetAttribute ("ThreadCount", UintegerValue (threads));
+  Simulator::SetImplementation (impl);
+
+  DatacenterTopologyHelper topology;
+  topology.SetLeafSpine (2, 2, 2);
+  topology.SetServerLinkAttributes (DataRate ("1Gbps"), MicroSeconds (10));
+  topology.SetFabricLinkAttributes (DataRate ("1Gbps"), MicroSeconds (10));
+  topology.Install ();
+  topology.AssignStreams (0);
+
+  PointToPointPartitionHelper partition;
+  partition.Partition (NodeContainer::GetGlobal (), threads);
+
+  NodeContainer servers = topology.GetServers ();
+  m_received.assign (NodeContainer::GetGlobal ().GetN (), 0);
+  m_lastArrival.assign (NodeContainer::GetGlobal ().GetN (), Time (0));
+  for (uint32_t s = 0; s < servers.GetN (); ++s)
+    {
+      Ptr<Socket> sink = Socket::CreateSocket (servers.Get (s), TcpSocketFactory::GetTypeId ());
+      sink->Bind (InetSocketAddress (Ipv4Address::GetAny (), port));
+      sink->Listen ();
+      sink->SetAcceptCallback (MakeNullCallback<bool, Ptr<Socket>, const Address &> (),
+                               MakeCallback (&MultithreadedTcpTest::Accept, this));
+    }
+  for (uint32_t s = 0; s < servers.GetN (); ++s)
+    {
+      Ptr<Socket> source = Socket::CreateSocket (servers.Get (s), TcpSocketFactory::GetTypeId ());
+      source->Bind ();
+      source->Connect (InetSocketAddress (topology.GetServerAddress ((s + 2) % servers.GetN ()), port));
+      source->Send (Create<Packet> (size));
+    }
+
+  Simulator::Stop (Seconds (1));
+  Simulator::Run ();
+  m_nPartitions = impl->GetNPartitions ();
+
+  for (uint32_t s = 0; s < servers.GetN (); ++s)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[servers.Get (s)->GetId ()], size,
+                             "Bytes lost towards server " << s << " with " << threads << " threads");
+    }
+  Simulator::Destroy ();
+}
+
+void
+MultithreadedTcpTest::DoRun (void)
+{
+  RunFlows (1);
+  NS_TEST_ASSERT_MSG_EQ (m_nPartitions, 1, "Not on one thread");
+  std::vector<Time> sequential = m_lastArrival;
+
+  RunFlows (2);
+  NS_TEST_ASSERT_MSG_EQ (m_nPartitions, 2, "Not on two threads");
+  for (uint32_t i = 0; i < sequential.size (); ++i)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_lastArrival[i], sequential[i], "Node " << i << " got its last byte at another time");
+    }
+}
+
+/**
+ * \brief TestSuite for MultithreadedSimulatorImpl on a datacenter fabric
+ */
+class MultithreadedSimulatorTestSuite : public TestSuite
+{
+public:
+  MultithreadedSimulatorTestSuite ();
+};
+
+MultithreadedSimulatorTestSuite::MultithreadedSimulatorTestSuite ()
+  : TestSuite ("multithreaded-simulator", UNIT)
+{
+  AddTestCase (new MultithreadedTcpTest, TestCase::QUICK);
+}
+
+static MultithreadedSimulatorTestSuite g_multithreadedSimulatorTestSuite; //!< The testsuite
@@ -0,0 +1,387 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "point-to-point-partition-helper.h"
+#include "ns3/point-to-point-net-device.h"
+#include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-remote-channel.h"
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/node-list.h"
+#include "ns3/uinteger.h"
+#include "ns3/abort.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PointToPointPartitionHelper");
+
+/// Rank of the nodes not in the partitioned container
+static const uint32_t NO_RANK = 0xffffffff;
+
+/// Passes moving the groups to a better rank, at most
+static const uint32_t REFINE_PASSES = 16;
+
+PointToPointPartitionHelper::PointToPointPartitionHelper ()
+  : m_imbalance (0.1),
+    m_packetSize (1500),
+    m_nCutLinks (0),
+    m_cutTraffic (0)
+{
+}
+
+void
+PointToPointPartitionHelper::SetImbalance (double imbalance)
+{
+  m_imbalance = imbalance;
+}
+
+void
+PointToPointPartitionHelper::SetPacketSize (uint32_t bytes)
+{
+  NS_ABORT_MSG_IF (bytes == 0, "The packet size must be positive");
+  m_packetSize = bytes;
+}
+
+void
+PointToPointPartitionHelper::SetLinkTraffic (Ptr<Node> a, Ptr<Node> b, DataRate traffic)
+{
+  std::pair<uint32_t, uint32_t> key (std::min (a->GetId (), b->GetId ()),
+                                     std::max (a->GetId (), b->GetId ()));
+  m_linkTraffic[key] = traffic.GetBitRate ();
+}
+
+/**
+ * \brief Find the group of a node, halving the path on the way
+ */
+static uint32_t
+FindGroup (std::vector<uint32_t> &group, uint32_t node)
+{
+  while (group[node] != node)
+    {
+      group[node] = group[group[node]];
+      node = group[node];
+    }
+  return node;
+}
+
+void
+PointToPointPartitionHelper::CollectLinks (NodeContainer nodes, std::vector<uint32_t> &group)
+{
+  uint32_t nNodes = NodeList::GetNNodes ();
+  std::vector<bool> inContainer (nNodes, false);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      inContainer[(*i)->GetId ()] = true;
+    }
+
+  group.resize (nNodes);
+  for (uint32_t i = 0; i < nNodes; ++i)
+    {
+      group[i] = i;
+    }
+  m_links.clear ();
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      Ptr<Node> node = *i;
+      uint32_t id = node->GetId ();
+      uint32_t nLinks = 0;
+      uint32_t neighbour = id;
+      for (uint32_t j = 0; j < node->GetNDevices (); ++j)
+        {
+          Ptr<NetDevice> device = node->GetDevice (j);
+          Ptr<Channel> channel = device->GetChannel ();
+          if (channel == 0)
+            {
+              continue;
+            }
+          for (uint32_t k = 0; k < channel->GetNDevices (); ++k)
+            {
+              uint32_t other = channel->GetDevice (k)->GetNode ()->GetId ();
+              if (other == id || !inContainer[other])
+                {
+                  continue;
+                }
+              Ptr<PointToPointChannel> p2pChannel = DynamicCast<PointToPointChannel> (channel);
+              if (p2pChannel == 0)
+                {
+                  // a shared channel can not be cut
+                  group[FindGroup (group, other)] = FindGroup (group, id);
+                  continue;
+                }
+              nLinks++;
+              neighbour = other;
+              if (other < id)
+                {
+                  // each link once
+                  continue;
+                }
+              Link link;
+              link.a = id;
+              link.b = other;
+              TimeValue delay;
+              p2pChannel->GetAttribute ("Delay", delay);
+              link.delay = delay.Get ();
+              std::map<std::pair<uint32_t, uint32_t>, uint64_t>::const_iterator it =
+                m_linkTraffic.find (std::make_pair (id, other));
+              if (it != m_linkTraffic.end ())
+                {
+                  link.traffic = it->second;
+                }
+              else
+                {
+                  DataRateValue rate;
+                  device->GetAttribute ("DataRate", rate);
+                  link.traffic = 2 * rate.Get ().GetBitRate ();
+                }
+              m_links.push_back (link);
+            }
+        }
+      if (nLinks == 1)
+        {
+          group[FindGroup (group, id)] = FindGroup (group, neighbour);
+        }
+    }
+}
+
+void
+PointToPointPartitionHelper::Partition (NodeContainer nodes, uint32_t nRanks)
+{
+  NS_LOG_FUNCTION (this << nRanks);
+  NS_ABORT_MSG_IF (nRanks == 0, "At least one rank is needed");
+
+  std::vector<uint32_t> group;
+  CollectLinks (nodes, group);
+  uint32_t nNodes = group.size ();
+
+  // The traffic handled by a group is the traffic of the links of its nodes,
+  // and the groups exchange the traffic of the links between them
+  std::vector<uint64_t> groupTraffic (nNodes, 0);
+  std::vector<std::map<uint32_t, uint64_t> > exchange (nNodes);
+  uint64_t totalTraffic = 0;
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      const Link &link = m_links[i];
+      uint32_t ga = FindGroup (group, link.a);
+      uint32_t gb = FindGroup (group, link.b);
+      groupTraffic[ga] += link.traffic;
+      groupTraffic[gb] += link.traffic;
+      totalTraffic += 2 * link.traffic;
+      if (ga != gb)
+        {
+          exchange[ga][gb] += link.traffic;
+          exchange[gb][ga] += link.traffic;
+        }
+    }
+
+  std::vector<std::pair<uint64_t, uint32_t> > groups;
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      uint32_t id = (*i)->GetId ();
+      if (FindGroup (group, id) == id)
+        {
+          // larger groups first, then by id
+          groups.push_back (std::make_pair (~groupTraffic[id], id));
+        }
+    }
+  std::sort (groups.begin (), groups.end ());
+
+  uint64_t capacity = static_cast<uint64_t> ((1 + m_imbalance) * totalTraffic / nRanks);
+  std::vector<uint32_t> rankOfGroup (nNodes, NO_RANK);
+  m_rankTraffic.assign (nRanks, 0);
+  std::vector<uint32_t> rankGroups (nRanks, 0);
+
+  // Each group goes to the rank it exchanges the most with, among the ranks
+  // with room left, or else to the least loaded rank
+  for (uint32_t i = 0; i < groups.size (); ++i)
+    {
+      uint32_t g = groups[i].second;
+      std::vector<uint64_t> toRank (nRanks, 0);
+      for (std::map<uint32_t, uint64_t>::const_iterator it = exchange[g].begin (); it != exchange[g].end (); ++it)
+        {
+          if (rankOfGroup[it->first] != NO_RANK)
+            {
+              toRank[rankOfGroup[it->first]] += it->second;
+            }
+        }
+      uint32_t best = std::min_element (m_rankTraffic.begin (), m_rankTraffic.end ()) - m_rankTraffic.begin ();
+      for (uint32_t r = 0; r < nRanks; ++r)
+        {
+          if (m_rankTraffic[r] + groupTraffic[g] <= capacity
+              && (toRank[r] > toRank[best]
+                  || (toRank[r] == toRank[best] && m_rankTraffic[r] < m_rankTraffic[best])))
+            {
+              best = r;
+            }
+        }
+      rankOfGroup[g] = best;
+      m_rankTraffic[best] += groupTraffic[g];
+      rankGroups[best]++;
+    }
+
+  // Then move the groups while it lowers the traffic between ranks
+  for (uint32_t pass = 0; pass < REFINE_PASSES; ++pass)
+    {
+      bool moved = false;
+      for (uint32_t i = 0; i < groups.size (); ++i)
+        {
+          uint32_t g = groups[i].second;
+          uint32_t from = rankOfGroup[g];
+          if (rankGroups[from] == 1)
+            {
+              continue;
+            }
+          std::vector<uint64_t> toRank (nRanks, 0);
+          for (std::map<uint32_t, uint64_t>::const_iterator it = exchange[g].begin (); it != exchange[g].end (); ++it)
+            {
+              toRank[rankOfGroup[it->first]] += it->second;
+            }
+          uint32_t best = from;
+          for (uint32_t r = 0; r < nRanks; ++r)
+            {
+              if (r != from && toRank[r] > toRank[best]
+                  && m_rankTraffic[r] + groupTraffic[g] <= capacity)
+                {
+                  best = r;
+                }
+            }
+          if (best != from)
+            {
+              rankOfGroup[g] = best;
+              m_rankTraffic[from] -= groupTraffic[g];
+              m_rankTraffic[best] += groupTraffic[g];
+              rankGroups[from]--;
+              rankGroups[best]++;
+              moved = true;
+            }
+        }
+      if (!moved)
+        {
+          break;
+        }
+    }
+
+  m_rankOfNode.assign (nNodes, NO_RANK);
+  for (NodeContainer::Iterator i = nodes.Begin (); i != nodes.End (); ++i)
+    {
+      uint32_t id = (*i)->GetId ();
+      m_rankOfNode[id] = rankOfGroup[FindGroup (group, id)];
+      (*i)->SetAttribute ("SystemId", UintegerValue (m_rankOfNode[id]));
+    }
+
+  m_nCutLinks = 0;
+  m_cutTraffic = 0;
+  m_lookAhead = Time::Max ();
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      const Link &link = m_links[i];
+      if (m_rankOfNode[link.a] != m_rankOfNode[link.b])
+        {
+          m_nCutLinks++;
+          m_cutTraffic += link.traffic;
+          m_lookAhead = std::min (m_lookAhead, link.delay);
+        }
+    }
+
+  if (MpiInterface::IsEnabled ())
+    {
+      Rewire ();
+    }
+}
+
+void
+PointToPointPartitionHelper::Rewire (void)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t local = MpiInterface::GetSystemId ();
+  for (uint32_t i = 0; i < m_links.size (); ++i)
+    {
+      const Link &link = m_links[i];
+      // only the cut links with an end on the local rank
+      if (m_rankOfNode[link.a] == m_rankOfNode[link.b]
+          || (m_rankOfNode[link.a] != local && m_rankOfNode[link.b] != local))
+        {
+          continue;
+        }
+
+      Ptr<Node> a = NodeList::GetNode (link.a);
+      for (uint32_t j = 0; j < a->GetNDevices (); ++j)
+        {
+          Ptr<PointToPointNetDevice> devA = DynamicCast<PointToPointNetDevice> (a->GetDevice (j));
+          if (devA == 0)
+            {
+              continue;
+            }
+          Ptr<PointToPointChannel> channel = DynamicCast<PointToPointChannel> (devA->GetChannel ());
+          if (channel == 0 || DynamicCast<PointToPointRemoteChannel> (channel) != 0)
+            {
+              continue;
+            }
+          Ptr<PointToPointNetDevice> devB = channel->GetPointToPointDevice (channel->GetPointToPointDevice (0) == devA ? 1 : 0);
+          if (devB->GetNode ()->GetId () != link.b)
+            {
+              continue;
+            }
+
+          // as PointToPointHelper::Install does for the nodes of other ranks
+          Ptr<PointToPointRemoteChannel> remote = CreateObject<PointToPointRemoteChannel> ();
+          remote->SetAttribute ("Delay", TimeValue (link.delay));
+          Ptr<MpiReceiver> mpiRecA = CreateObject<MpiReceiver> ();
+          Ptr<MpiReceiver> mpiRecB = CreateObject<MpiReceiver> ();
+          mpiRecA->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devA));
+          mpiRecB->SetReceiveCallback (MakeCallback (&PointToPointNetDevice::Receive, devB));
+          devA->AggregateObject (mpiRecA);
+          devB->AggregateObject (mpiRecB);
+          devA->Attach (remote);
+          devB->Attach (remote);
+        }
+    }
+}
+
+Time
+PointToPointPartitionHelper::GetLookAhead (void) const
+{
+  return m_lookAhead;
+}
+
+uint32_t
+PointToPointPartitionHelper::GetNCutLinks (void) const
+{
+  return m_nCutLinks;
+}
+
+DataRate
+PointToPointPartitionHelper::GetCutTraffic (void) const
+{
+  return DataRate (m_cutTraffic);
+}
+
+double
+PointToPointPartitionHelper::GetMessageRate (void) const
+{
+  return m_cutTraffic / (8.0 * m_packetSize);
+}
+
+DataRate
+PointToPointPartitionHelper::GetRankTraffic (uint32_t rank) const
+{
+  NS_ASSERT (rank < m_rankTraffic.size ());
+  return DataRate (m_rankTraffic[rank]);
+}
+
+void
+PointToPointPartitionHelper::Report (std::ostream &os) const
+{
+  for (uint32_t r = 0; r < m_rankTraffic.size (); ++r)
+    {
+      os << "rank " << r << ": " << std::count (m_rankOfNode.begin (), m_rankOfNode.end (), r)
+         << " nodes, traffic " << m_rankTraffic[r] / 1e9 << " Gbps" << std::endl;
+    }
+  os << "cut links " << m_nCutLinks << ", traffic " << m_cutTraffic / 1e9 << " Gbps" << std::endl;
+  os << "lookahead " << m_lookAhead.GetMicroSeconds () << " us, "
+     << GetMessageRate () << " packets/s between ranks at " << m_packetSize << " bytes" << std::endl;
+}
+
+} // namespace ns3
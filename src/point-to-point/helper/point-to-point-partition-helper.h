@@ -0,0 +1,151 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef POINT_TO_POINT_PARTITION_HELPER_H
+#define POINT_TO_POINT_PARTITION_HELPER_H
+
+#include "ns3/node-container.h"
+#include "ns3/data-rate.h"
+#include "ns3/nstime.h"
+
+#include <map>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Split a built point to point topology into the ranks of a parallel
+ * simulation
+ *
+ * Partition takes the nodes once the whole topology is installed, before
+ * Simulator::Run. The nodes with a single link (the hosts) stay with their
+ * neighbour, as do the nodes of a shared channel. The groups are then placed
+ * on the ranks so that the expected traffic crossing ranks is small while
+ * the traffic handled by each rank stays within the allowed imbalance:
+ * every group goes to the rank it exchanges the most traffic with, among
+ * those with room left, and groups keep moving to the rank that lowers the
+ * cut while it does.
+ *
+ * The expected traffic of a link is its data rate in both directions,
+ * unless given with SetLinkTraffic. In a leaf-spine fabric this places each
+ * leaf with its servers, and spreads the leaves and the spines over the
+ * ranks.
+ *
+ * The rank of each node is written in its SystemId attribute, which both
+ * the distributed simulators and MultithreadedSimulatorImpl follow. When
+ * MPI is enabled, the links leaving the local rank are moved onto
+ * PointToPointRemoteChannel, as PointToPointHelper::Install does for the
+ * nodes created with a system id.
+ */
+class PointToPointPartitionHelper
+{
+public:
+  PointToPointPartitionHelper ();
+
+  /**
+   * \param imbalance the traffic a rank may handle above the mean, as a
+   * fraction of the mean
+   */
+  void SetImbalance (double imbalance);
+
+  /**
+   * \param bytes mean size of the packets crossing ranks, for the
+   * predicted message rate
+   */
+  void SetPacketSize (uint32_t bytes);
+
+  /**
+   * \brief Give the expected traffic of the link between two nodes, in both
+   * directions, instead of its data rate
+   *
+   * \param a a node
+   * \param b a node linked to a
+   * \param traffic the expected traffic
+   */
+  void SetLinkTraffic (Ptr<Node> a, Ptr<Node> b, DataRate traffic);
+
+  /**
+   * \brief Split the nodes into ranks, set their system ids and rewire the
+   * links between ranks
+   *
+   * \param nodes all the nodes of the topology
+   * \param nRanks the number of ranks
+   */
+  void Partition (NodeContainer nodes, uint32_t nRanks);
+
+  /**
+   * \returns the smallest delay of the links between ranks, Time::Max ()
+   * when no link is cut
+   */
+  Time GetLookAhead (void) const;
+
+  /**
+   * \returns the number of links between ranks
+   */
+  uint32_t GetNCutLinks (void) const;
+
+  /**
+   * \returns the expected traffic between ranks
+   */
+  DataRate GetCutTraffic (void) const;
+
+  /**
+   * \returns the expected number of packets crossing ranks per second
+   */
+  double GetMessageRate (void) const;
+
+  /**
+   * \param rank a rank
+   * \returns the expected traffic handled by the nodes of the rank
+   */
+  DataRate GetRankTraffic (uint32_t rank) const;
+
+  /**
+   * \brief Print the node count and the traffic of each rank, the cut, the
+   * lookahead and the predicted message rate
+   *
+   * \param os the output stream
+   */
+  void Report (std::ostream &os) const;
+
+private:
+  /**
+   * \brief A point to point link of the topology
+   */
+  struct Link
+  {
+    uint32_t a;           //!< node id of one end
+    uint32_t b;           //!< node id of the other end
+    uint64_t traffic;     //!< expected traffic in bit/s
+    Time delay;           //!< propagation delay
+  };
+
+  /**
+   * \brief Collect the point to point links of the nodes, and group the
+   * nodes that must share a rank
+   *
+   * \param nodes all the nodes of the topology
+   * \param group set to the group of each node
+   */
+  void CollectLinks (NodeContainer nodes, std::vector<uint32_t> &group);
+
+  /**
+   * \brief Move the links leaving the local rank onto remote channels
+   */
+  void Rewire (void);
+
+  double m_imbalance;                   //!< allowed traffic of a rank above the mean
+  uint32_t m_packetSize;                //!< mean packet size in bytes
+  std::map<std::pair<uint32_t, uint32_t>, uint64_t> m_linkTraffic; //!< expected traffic by node ids
+
+  std::vector<Link> m_links;            //!< links of the last partition
+  std::vector<uint32_t> m_rankOfNode;   //!< rank of each node id
+  std::vector<uint64_t> m_rankTraffic;  //!< traffic handled by each rank
+  uint32_t m_nCutLinks;                 //!< links between ranks
+  uint64_t m_cutTraffic;                //!< traffic between ranks in bit/s
+  Time m_lookAhead;                     //!< smallest delay between ranks
+};
+
+} // namespace ns3
+
+#endif /* POINT_TO_POINT_PARTITION_HELPER_H */
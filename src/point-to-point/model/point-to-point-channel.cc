@@ -21,6 +21,8 @@
 #include "ns3/trace-source-accessor.h"
 #include "ns3/packet.h"
 #include "ns3/simulator.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -80,6 +82,13 @@ PointToPointChannel::Attach (Ptr<PointToPointNetDevice> device)
       m_link[1].m_dst = m_link[0].m_src;
       m_link[0].m_state = IDLE;
       m_link[1].m_state = IDLE;
+      for (uint32_t i = 0; i < N_DEVICES; ++i)
+        {
+          if (m_link[i].m_dst->GetNode () != 0)
+            {
+              m_link[i].m_dstNodeId = m_link[i].m_dst->GetNode ()->GetId ();
+            }
+        }
     }
 }
 
@@ -96,13 +105,34 @@ PointToPointChannel::TransmitStart (
   NS_ASSERT (m_link[1].m_state != INITIALIZING);
 
   uint32_t wire = src == m_link[0].m_src ? 0 : 1;
+  Link &link = m_link[wire];
+  if (link.m_dstNodeId == 0xffffffff)
+    {
+      // the device was attached before being added to its node
+      link.m_dstNodeId = link.m_dst->GetNode ()->GetId ();
+    }
 
-  Simulator::ScheduleWithContext (m_link[wire].m_dst->GetNode ()->GetId (),
-                                  txTime + m_delay, &PointToPointNetDevice::Receive,
-                                  m_link[wire].m_dst, p);
+  if (MultithreadedSimulatorImpl::IsRemoteContext (link.m_dstNodeId))
+    {
+      // The receiving node runs on another thread, which must not touch the
+      // reference counts of the sender: pass the device by pointer and a
+      // packet sharing nothing with p
+      Simulator::ScheduleWithContext (link.m_dstNodeId,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      PeekPointer (link.m_dst), p->CreateUnsharedCopy ());
+    }
+  else
+    {
+      Simulator::ScheduleWithContext (link.m_dstNodeId,
+                                      txTime + m_delay, &PointToPointNetDevice::Receive,
+                                      link.m_dst, p);
+    }
 
   // Call the tx anim callback on the net device
-  m_txrxPointToPoint (p, src, m_link[wire].m_dst, txTime, txTime + m_delay);
+  if (!m_txrxPointToPoint.IsEmpty ())
+    {
+      m_txrxPointToPoint (p, src, link.m_dst, txTime, txTime + m_delay);
+    }
   return true;
 }
 
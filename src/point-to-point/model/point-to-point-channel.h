@@ -194,11 +194,12 @@ public:
     /** \brief Create the link, it will be in INITIALIZING state
      *
      */
-    Link() : m_state (INITIALIZING), m_src (0), m_dst (0) {}
+    Link() : m_state (INITIALIZING), m_src (0), m_dst (0), m_dstNodeId (0xffffffff) {}
 
-    WireState                  m_state; //!< State of the link
-    Ptr<PointToPointNetDevice> m_src;   //!< First NetDevice
-    Ptr<PointToPointNetDevice> m_dst;   //!< Second NetDevice
+    WireState                  m_state;     //!< State of the link
+    Ptr<PointToPointNetDevice> m_src;       //!< First NetDevice
+    Ptr<PointToPointNetDevice> m_dst;       //!< Second NetDevice
+    uint32_t                   m_dstNodeId; //!< Node of m_dst, the context of the receive events
   };
 
   Link    m_link[N_DEVICES]; //!< Link model
@@ -23,6 +23,11 @@
 #include "ns3/simulator.h"
 #include "ns3/point-to-point-net-device.h"
 #include "ns3/point-to-point-channel.h"
+#include "ns3/point-to-point-helper.h"
+#include "ns3/point-to-point-partition-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -98,6 +103,189 @@ PointToPointTest::DoRun (void)
   Simulator::Destroy ();
 }
 
+/**
+ * \brief Test the PointToPoint model under MultithreadedSimulatorImpl
+ *
+ * Two nodes with different system ids, hence on different threads, send
+ * packets to each other from their own events and from global events. All
+ * the packets must arrive after the transmission and propagation delays.
+ */
+class PointToPointMultithreadedTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointMultithreadedTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Send one packet of 100 bytes from a device
+   *
+   * \param device NetDevice sending the packet
+   */
+  void SendOnePacket (Ptr<PointToPointNetDevice> device);
+
+  /**
+   * \brief Record the arrival time of a packet
+   *
+   * \returns true
+   */
+  bool Receive (Ptr<NetDevice> device, Ptr<const Packet> p, uint16_t protocol, const Address &from);
+
+  std::vector<Time> m_arrivals[2]; //!< arrival times on each node
+};
+
+PointToPointMultithreadedTest::PointToPointMultithreadedTest ()
+  : TestCase ("PointToPoint on two threads")
+{
+}
+
+void
+PointToPointMultithreadedTest::SendOnePacket (Ptr<PointToPointNetDevice> device)
+{
+  Ptr<Packet> p = Create<Packet> (100);
+  device->Send (p, device->GetBroadcast (), 0x800);
+}
+
+bool
+PointToPointMultithreadedTest::Receive (Ptr<NetDevice> device, Ptr<const Packet> p,
+                                        uint16_t protocol, const Address &from)
+{
+  // each node writes its own vector from its own thread
+  m_arrivals[device->GetNode ()->GetSystemId ()].push_back (Simulator::Now ());
+  return true;
+}
+
+void
+PointToPointMultithreadedTest::DoRun (void)
+{
+  Ptr<MultithreadedSimulatorImpl> impl = CreateObject<MultithreadedSimulatorImpl> ();
+  impl->SetAttribute ("ThreadCount", UintegerValue (2));
+  Simulator::SetImplementation (impl);
+
+  Ptr<Node> nodes[2] = { CreateObject<Node> (0), CreateObject<Node> (1) };
+  Ptr<PointToPointChannel> channel = CreateObject<PointToPointChannel> ();
+  channel->SetAttribute ("Delay", TimeValue (MilliSeconds (2)));
+  Ptr<PointToPointNetDevice> devices[2];
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      devices[i] = CreateObject<PointToPointNetDevice> ();
+      devices[i]->SetAddress (Mac48Address::Allocate ());
+      devices[i]->SetDataRate (DataRate ("1Mbps"));
+      devices[i]->SetQueue (CreateObject<DropTailQueue> ());
+      nodes[i]->AddDevice (devices[i]);
+      devices[i]->Attach (channel);
+      devices[i]->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+      devices[i]->SetReceiveCallback (MakeCallback (&PointToPointMultithreadedTest::Receive, this));
+    }
+
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      for (uint32_t j = 0; j < 3; ++j)
+        {
+          Simulator::ScheduleWithContext (nodes[i]->GetId (), MilliSeconds (1000 + 100 * j),
+                                          &PointToPointMultithreadedTest::SendOnePacket, this, devices[i]);
+        }
+      Simulator::Schedule (MilliSeconds (1300), &PointToPointMultithreadedTest::SendOnePacket, this, devices[i]);
+    }
+
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (impl->GetNPartitions (), 2, "The nodes are not on two threads");
+  NS_TEST_ASSERT_MSG_EQ (impl->GetLookAhead (), MilliSeconds (2), "The lookahead is not the link delay");
+  // 100 bytes and the PPP header at 1Mbps, then 2ms of propagation
+  Time delay = DataRate ("1Mbps").CalculateBytesTxTime (102) + MilliSeconds (2);
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_arrivals[i].size (), 4, "Node " << i << " did not receive all the packets");
+      for (uint32_t j = 0; j < m_arrivals[i].size (); ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (m_arrivals[i][j], MilliSeconds (1000 + 100 * j) + delay,
+                                 "Packet " << j << " arrived on node " << i << " at the wrong time");
+        }
+    }
+  NS_TEST_ASSERT_MSG_EQ (Simulator::Now (), MilliSeconds (1300) + delay, "The simulation did not end on the last arrival");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \brief Test PointToPointPartitionHelper on a leaf-spine fabric
+ *
+ * Two leaves with two servers each and two spines, all links at the same
+ * rate, split over two ranks: each leaf must keep its servers, and share
+ * its rank with one spine.
+ */
+class PointToPointPartitionTest : public TestCase
+{
+public:
+  /**
+   * \brief Create the test
+   */
+  PointToPointPartitionTest ();
+
+  /**
+   * \brief Run the test
+   */
+  virtual void DoRun (void);
+};
+
+PointToPointPartitionTest::PointToPointPartitionTest ()
+  : TestCase ("PointToPoint partition of a leaf-spine fabric")
+{
+}
+
+void
+PointToPointPartitionTest::DoRun (void)
+{
+  NodeContainer spines;
+  spines.Create (2);
+  NodeContainer leaves;
+  leaves.Create (2);
+  NodeContainer servers[2];
+
+  PointToPointHelper p2p;
+  p2p.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("1Gbps")));
+  p2p.SetChannelAttribute ("Delay", TimeValue (MicroSeconds (10)));
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      servers[i].Create (2);
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          p2p.Install (leaves.Get (i), servers[i].Get (j));
+          p2p.Install (leaves.Get (i), spines.Get (j));
+        }
+    }
+
+  PointToPointPartitionHelper partition;
+  partition.Partition (NodeContainer::GetGlobal (), 2);
+
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      for (uint32_t j = 0; j < 2; ++j)
+        {
+          NS_TEST_ASSERT_MSG_EQ (servers[i].Get (j)->GetSystemId (), leaves.Get (i)->GetSystemId (),
+                                 "Server " << j << " is not with leaf " << i);
+        }
+      // the server links count on both of their ends, the uplinks on one
+      NS_TEST_ASSERT_MSG_EQ (partition.GetRankTraffic (i), DataRate ("16Gbps"), "Rank " << i << " is not balanced");
+    }
+  NS_TEST_ASSERT_MSG_NE (leaves.Get (0)->GetSystemId (), leaves.Get (1)->GetSystemId (), "The leaves share a rank");
+  NS_TEST_ASSERT_MSG_NE (spines.Get (0)->GetSystemId (), spines.Get (1)->GetSystemId (), "The spines share a rank");
+  NS_TEST_ASSERT_MSG_EQ (partition.GetNCutLinks (), 2, "Not one uplink of each leaf is cut");
+  NS_TEST_ASSERT_MSG_EQ (partition.GetLookAhead (), MicroSeconds (10), "The lookahead is not the link delay");
+  NS_TEST_ASSERT_MSG_EQ_TOL (partition.GetMessageRate (), 4e9 / (8 * 1500), 1e-3,
+                             "Wrong packet rate between the ranks");
+
+  Simulator::Destroy ();
+}
+
 /**
  * \brief TestSuite for PointToPoint module
  */
@@ -114,6 +302,8 @@ PointToPointTestSuite::PointToPointTestSuite ()
   : TestSuite ("devices-point-to-point", UNIT)
 {
   AddTestCase (new PointToPointTest, TestCase::QUICK);
+  AddTestCase (new PointToPointMultithreadedTest, TestCase::QUICK);
+  AddTestCase (new PointToPointPartitionTest, TestCase::QUICK);
 }
 
 static PointToPointTestSuite g_pointToPointTestSuite; //!< The testsuite
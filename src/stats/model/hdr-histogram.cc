@@ -0,0 +1,132 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "hdr-histogram.h"
+
+#include "ns3/assert.h"
+
+#include <cmath>
+#include <limits>
+
+namespace ns3 {
+
+HdrHistogram::HdrHistogram (uint32_t precision)
+  : m_precision (precision),
+    m_count (0),
+    m_min (std::numeric_limits<uint64_t>::max ()),
+    m_max (0),
+    m_sum (0)
+{
+  NS_ASSERT (precision > 0 && precision < 32);
+}
+
+void
+HdrHistogram::Add (uint64_t value)
+{
+  uint32_t index = GetIndex (value);
+  if (index >= m_counts.size ())
+    {
+      m_counts.resize (index + 1, 0);
+    }
+  m_counts[index]++;
+  m_count++;
+  m_sum += value;
+  if (value < m_min)
+    {
+      m_min = value;
+    }
+  if (value > m_max)
+    {
+      m_max = value;
+    }
+}
+
+void
+HdrHistogram::Clear (void)
+{
+  m_counts.clear ();
+  m_count = 0;
+  m_min = std::numeric_limits<uint64_t>::max ();
+  m_max = 0;
+  m_sum = 0;
+}
+
+uint64_t
+HdrHistogram::GetCount (void) const
+{
+  return m_count;
+}
+
+uint64_t
+HdrHistogram::GetMin (void) const
+{
+  return m_count ? m_min : 0;
+}
+
+uint64_t
+HdrHistogram::GetMax (void) const
+{
+  return m_max;
+}
+
+double
+HdrHistogram::GetMean (void) const
+{
+  return m_count ? m_sum / m_count : 0;
+}
+
+uint64_t
+HdrHistogram::GetPercentile (double percentile) const
+{
+  if (m_count == 0)
+    {
+      return 0;
+    }
+  uint64_t rank = static_cast<uint64_t> (std::ceil (percentile / 100 * m_count));
+  if (rank == 0)
+    {
+      rank = 1;
+    }
+  uint64_t seen = 0;
+  for (uint32_t index = 0; index < m_counts.size (); ++index)
+    {
+      seen += m_counts[index];
+      if (seen >= rank)
+        {
+          uint64_t value = GetHighestEquivalent (index);
+          return value < m_max ? value : m_max;
+        }
+    }
+  return m_max;
+}
+
+uint32_t
+HdrHistogram::GetIndex (uint64_t value) const
+{
+  uint64_t subBuckets = static_cast<uint64_t> (1) << m_precision;
+  if (value < subBuckets)
+    {
+      return value;
+    }
+  uint32_t msb = 63;
+  while (!(value >> msb))
+    {
+      msb--;
+    }
+  uint32_t shift = msb - m_precision;
+  // The mantissa is in [subBuckets, 2 * subBuckets)
+  return subBuckets * (shift + 1) + (value >> shift) - subBuckets;
+}
+
+uint64_t
+HdrHistogram::GetHighestEquivalent (uint32_t index) const
+{
+  uint64_t subBuckets = static_cast<uint64_t> (1) << m_precision;
+  if (index < subBuckets)
+    {
+      return index;
+    }
+  uint32_t shift = index / subBuckets - 1;
+  uint64_t mantissa = index % subBuckets + subBuckets;
+  return ((mantissa + 1) << shift) - 1;
+}
+
+} // namespace ns3
@@ -0,0 +1,57 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef HDR_HISTOGRAM_H
+#define HDR_HISTOGRAM_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup stats
+ *
+ * \brief Log-linear histogram for online percentiles
+ *
+ * Values below 2^precision are counted exactly. Above, every power of two
+ * range is split in 2^precision sub-buckets, so a percentile is reported
+ * with a relative error below 2^-precision whatever the range of the
+ * values, in O(1) per value and a few KB of counters.
+ */
+class HdrHistogram
+{
+public:
+  /**
+   * \param precision the log2 of the sub-buckets per power of two
+   */
+  HdrHistogram (uint32_t precision = 7);
+
+  void Add (uint64_t value);
+  void Clear (void);
+
+  uint64_t GetCount (void) const;
+  uint64_t GetMin (void) const;
+  uint64_t GetMax (void) const;
+  double GetMean (void) const;
+
+  /**
+   * \param percentile between 0 and 100
+   * \returns the highest value equivalent to the value at this
+   * percentile, 0 for an empty histogram
+   */
+  uint64_t GetPercentile (double percentile) const;
+
+private:
+  uint32_t GetIndex (uint64_t value) const;
+  uint64_t GetHighestEquivalent (uint32_t index) const;
+
+  uint32_t m_precision;
+  std::vector<uint64_t> m_counts;
+  uint64_t m_count;
+  uint64_t m_min;
+  uint64_t m_max;
+  double m_sum;
+};
+
+} // namespace ns3
+
+#endif /* HDR_HISTOGRAM_H */
@@ -0,0 +1,326 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "packet-trace-writer.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/simulator.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-thread.h"
+#include "ns3/system-mutex.h"
+#include "ns3/system-condition.h"
+#endif
+
+#include <cstring>
+#include <fstream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("PacketTraceWriter");
+
+namespace {
+
+// Blocks handed to the writer thread before the simulation waits for it
+const uint32_t MAX_PENDING_BLOCKS = 4;
+
+// Upper bound of a wait, in case a wake up is missed
+const uint64_t WAIT_NS = 100000000;
+
+} // anonymous namespace
+
+const char PacketTraceWriter::MAGIC[8] = {'N', 'S', '3', 'P', 'K', 'T', 'R', '1'};
+
+PacketTraceWriter::PacketTraceWriter (const std::string &filename, uint32_t blockRecords)
+  : m_filename (filename),
+    m_file (0),
+    m_blockRecords (blockRecords),
+    m_nRecords (0),
+    m_closed (false),
+    m_stopping (false),
+    m_thread (0),
+    m_mutex (0),
+    m_appendMutex (0),
+    m_hasWork (0),
+    m_hasRoom (0)
+{
+  NS_LOG_FUNCTION (this << filename << blockRecords);
+  NS_ASSERT (blockRecords > 0);
+
+  m_file = std::fopen (filename.c_str (), "wb");
+  if (m_file == 0)
+    {
+      NS_FATAL_ERROR ("Cannot open packet trace file " << filename);
+    }
+  if (std::fwrite (MAGIC, sizeof (MAGIC), 1, m_file) != 1)
+    {
+      NS_FATAL_ERROR ("Cannot write packet trace file " << filename);
+    }
+  m_current.reserve (m_blockRecords);
+
+#ifdef HAVE_PTHREAD_H
+  m_mutex = new SystemMutex ();
+  m_appendMutex = new SystemMutex ();
+  m_hasWork = new SystemCondition ();
+  m_hasRoom = new SystemCondition ();
+  m_thread = new SystemThread (MakeCallback (&PacketTraceWriter::WriterThread, this));
+  m_thread->Start ();
+#endif
+}
+
+PacketTraceWriter::~PacketTraceWriter ()
+{
+  NS_LOG_FUNCTION (this);
+  Close ();
+#ifdef HAVE_PTHREAD_H
+  // Kept until now, for the records ignored after Close
+  delete m_appendMutex;
+#endif
+}
+
+void
+PacketTraceWriter::Write (PacketTraceRecord::Kind kind, uint32_t sourceId, uint32_t size, uint32_t flowId)
+{
+  PacketTraceRecord record;
+  record.timeNs = Simulator::Now ().GetNanoSeconds ();
+  record.sourceId = sourceId;
+  record.size = size;
+  record.flowId = flowId;
+  record.kind = kind;
+  std::memset (record.padding, 0, sizeof (record.padding));
+  Write (record);
+}
+
+void
+PacketTraceWriter::Write (const PacketTraceRecord &record)
+{
+#ifdef HAVE_PTHREAD_H
+  CriticalSection cs (*m_appendMutex);
+#endif
+  if (m_closed)
+    {
+      return;
+    }
+  m_current.push_back (record);
+  m_nRecords++;
+  if (m_current.size () >= m_blockRecords)
+    {
+      Submit ();
+    }
+}
+
+uint64_t
+PacketTraceWriter::GetNRecords (void) const
+{
+  return m_nRecords;
+}
+
+void
+PacketTraceWriter::Submit (void)
+{
+#ifdef HAVE_PTHREAD_H
+  while (true)
+    {
+      m_mutex->Lock ();
+      if (m_pending.size () < MAX_PENDING_BLOCKS)
+        {
+          m_pending.push_back (std::vector<PacketTraceRecord> ());
+          m_pending.back ().swap (m_current);
+          if (!m_free.empty ())
+            {
+              m_current.swap (m_free.back ());
+              m_free.pop_back ();
+            }
+          m_hasWork->SetCondition (true);
+          m_mutex->Unlock ();
+          m_hasWork->Signal ();
+          break;
+        }
+      NS_LOG_LOGIC ("Waiting for the writer thread");
+      m_hasRoom->SetCondition (false);
+      m_mutex->Unlock ();
+      m_hasRoom->TimedWait (WAIT_NS);
+    }
+  m_current.reserve (m_blockRecords);
+#else
+  WriteBlock (m_current);
+  m_current.clear ();
+#endif
+}
+
+void
+PacketTraceWriter::WriteBlock (const std::vector<PacketTraceRecord> &block)
+{
+  if (block.empty ())
+    {
+      return;
+    }
+  if (std::fwrite (&block[0], sizeof (PacketTraceRecord), block.size (), m_file) != block.size ())
+    {
+      NS_LOG_ERROR ("Short write to packet trace file " << m_filename);
+    }
+}
+
+void
+PacketTraceWriter::WriterThread (void)
+{
+#ifdef HAVE_PTHREAD_H
+  std::vector<PacketTraceRecord> block;
+  while (true)
+    {
+      bool stopping;
+      m_mutex->Lock ();
+      if (!m_pending.empty ())
+        {
+          block.swap (m_pending.front ());
+          m_pending.pop_front ();
+          m_hasRoom->SetCondition (true);
+        }
+      stopping = m_stopping;
+      m_hasWork->SetCondition (false);
+      m_mutex->Unlock ();
+
+      if (!block.empty ())
+        {
+          m_hasRoom->Signal ();
+          WriteBlock (block);
+          block.clear ();
+          CriticalSection cs (*m_mutex);
+          m_free.push_back (std::vector<PacketTraceRecord> ());
+          m_free.back ().swap (block);
+          continue;
+        }
+      if (stopping)
+        {
+          break;
+        }
+      m_hasWork->TimedWait (WAIT_NS);
+    }
+#endif
+}
+
+void
+PacketTraceWriter::Close (void)
+{
+  NS_LOG_FUNCTION (this);
+  if (m_closed)
+    {
+      return;
+    }
+  m_closed = true;
+
+#ifdef HAVE_PTHREAD_H
+  if (!m_current.empty ())
+    {
+      Submit ();
+    }
+  m_mutex->Lock ();
+  m_stopping = true;
+  m_hasWork->SetCondition (true);
+  m_mutex->Unlock ();
+  m_hasWork->Signal ();
+  m_thread->Join ();
+
+  delete m_thread;
+  delete m_hasRoom;
+  delete m_hasWork;
+  delete m_mutex;
+  m_thread = 0;
+  m_hasRoom = 0;
+  m_hasWork = 0;
+  m_mutex = 0;
+#else
+  WriteBlock (m_current);
+#endif
+  m_current.clear ();
+  m_pending.clear ();
+  m_free.clear ();
+
+  std::fclose (m_file);
+  m_file = 0;
+}
+
+std::FILE *
+PacketTraceReader::Open (const std::string &filename)
+{
+  std::FILE *file = std::fopen (filename.c_str (), "rb");
+  if (file == 0)
+    {
+      return 0;
+    }
+  char magic[sizeof (PacketTraceWriter::MAGIC)];
+  if (std::fread (magic, sizeof (magic), 1, file) != 1
+      || std::memcmp (magic, PacketTraceWriter::MAGIC, sizeof (magic)) != 0)
+    {
+      std::fclose (file);
+      return 0;
+    }
+  return file;
+}
+
+bool
+PacketTraceReader::Read (const std::string &filename, std::vector<PacketTraceRecord> &records)
+{
+  std::FILE *file = Open (filename);
+  if (file == 0)
+    {
+      return false;
+    }
+
+  PacketTraceRecord buffer[1024];
+  size_t n;
+  while ((n = std::fread (buffer, sizeof (PacketTraceRecord), 1024, file)) > 0)
+    {
+      records.insert (records.end (), buffer, buffer + n);
+    }
+  std::fclose (file);
+  return true;
+}
+
+bool
+PacketTraceReader::ConvertToText (const std::string &filename,
+                                  const std::string &sentFile,
+                                  const std::string &receivedFile)
+{
+  std::FILE *file = Open (filename);
+  if (file == 0)
+    {
+      return false;
+    }
+
+  std::ofstream sent;
+  std::ofstream received;
+  if (!sentFile.empty ())
+    {
+      sent.open (sentFile.c_str ());
+    }
+  if (!receivedFile.empty ())
+    {
+      received.open (receivedFile.c_str ());
+    }
+  if ((!sentFile.empty () && !sent.is_open ()) || (!receivedFile.empty () && !received.is_open ()))
+    {
+      std::fclose (file);
+      return false;
+    }
+
+  PacketTraceRecord buffer[1024];
+  size_t n;
+  while ((n = std::fread (buffer, sizeof (PacketTraceRecord), 1024, file)) > 0)
+    {
+      for (size_t i = 0; i < n; ++i)
+        {
+          std::ofstream &os = buffer[i].kind == PacketTraceRecord::SENT ? sent : received;
+          if (os.is_open ())
+            {
+              os << "[" << buffer[i].timeNs / 1000000 << "] SourceIDTag: " << buffer[i].sourceId
+                 << ", size: " << buffer[i].size << "\n";
+            }
+        }
+    }
+  std::fclose (file);
+  return true;
+}
+
+} // namespace ns3
@@ -0,0 +1,159 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef PACKET_TRACE_WRITER_H
+#define PACKET_TRACE_WRITER_H
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <deque>
+
+namespace ns3 {
+
+class SystemThread;
+class SystemMutex;
+class SystemCondition;
+
+/**
+ * \ingroup stats
+ *
+ * \brief One fixed size record of a packet trace file
+ *
+ * The records are written in host byte order after an 8 byte file magic.
+ */
+struct PacketTraceRecord
+{
+  enum Kind
+  {
+    SENT = 0,
+    RECEIVED = 1
+  };
+
+  int64_t timeNs;       //!< simulation time in nanoseconds
+  uint32_t sourceId;    //!< application defined source id
+  uint32_t size;        //!< packet size in bytes
+  uint32_t flowId;      //!< flow id, 0 when unknown
+  uint8_t kind;         //!< PacketTraceRecord::Kind
+  uint8_t padding[3];
+};
+
+/**
+ * \ingroup stats
+ *
+ * \brief Buffered binary per packet trace
+ *
+ * The records are appended to an in memory block. Full blocks are handed
+ * to a background thread that writes them to the file, so the simulation
+ * only pays for a copy per packet. The simulation blocks when the writer
+ * falls behind by more than a few blocks. Without threading support the
+ * blocks are written by the caller.
+ *
+ * Several sources may share one writer, e.g. the senders and the sinks of
+ * a scenario, also when they run on different simulation threads. Use
+ * PacketTraceReader to get the records back.
+ */
+class PacketTraceWriter : public SimpleRefCount<PacketTraceWriter>
+{
+public:
+  /**
+   * \param filename the trace file, truncated
+   * \param blockRecords the number of records per block
+   */
+  PacketTraceWriter (const std::string &filename, uint32_t blockRecords = 65536);
+  ~PacketTraceWriter ();
+
+  /**
+   * \brief Record a packet at the current simulation time
+   */
+  void Write (PacketTraceRecord::Kind kind, uint32_t sourceId, uint32_t size, uint32_t flowId = 0);
+
+  /**
+   * \brief Record a packet
+   */
+  void Write (const PacketTraceRecord &record);
+
+  /**
+   * \brief Write every pending record and close the file
+   *
+   * Called by the destructor, further records are ignored.
+   */
+  void Close (void);
+
+  uint64_t GetNRecords (void) const;
+
+  static const char MAGIC[8];
+
+private:
+  PacketTraceWriter (const PacketTraceWriter &);
+  PacketTraceWriter &operator= (const PacketTraceWriter &);
+
+  void Submit (void);
+  void WriteBlock (const std::vector<PacketTraceRecord> &block);
+  void WriterThread (void);
+
+  std::string m_filename;
+  std::FILE *m_file;
+  uint32_t m_blockRecords;
+  uint64_t m_nRecords;
+  bool m_closed;
+
+  std::vector<PacketTraceRecord> m_current;
+
+  // Shared with the writer thread
+  std::deque<std::vector<PacketTraceRecord> > m_pending;
+  std::vector<std::vector<PacketTraceRecord> > m_free;
+  bool m_stopping;
+  SystemThread *m_thread;
+  SystemMutex *m_mutex;
+  SystemMutex *m_appendMutex;   //!< serializes the simulation threads
+  SystemCondition *m_hasWork;   //!< signalled by the simulation
+  SystemCondition *m_hasRoom;   //!< signalled by the writer thread
+};
+
+/**
+ * \ingroup stats
+ *
+ * \brief Reads back the files of PacketTraceWriter
+ */
+class PacketTraceReader
+{
+public:
+  /**
+   * \brief Read a whole trace file
+   * \param filename the trace file
+   * \param records the records read, appended
+   * \returns false if the file cannot be read or is not a packet trace
+   */
+  static bool Read (const std::string &filename, std::vector<PacketTraceRecord> &records);
+
+  /**
+   * \brief Convert a trace file to the text layout of the sent_ms.dat and
+   * received_ms.dat files, one line per packet:
+   * "[<time in ms>] SourceIDTag: <source id>, size: <size>"
+   *
+   * \param filename the trace file
+   * \param sentFile the file for the sent packets, skipped if empty
+   * \param receivedFile the file for the received packets, skipped if empty
+   * \returns false if the trace cannot be read or a file cannot be written
+   *
+   * The trace is streamed, a block of records at a time.
+   */
+  static bool ConvertToText (const std::string &filename,
+                             const std::string &sentFile,
+                             const std::string &receivedFile);
+
+private:
+  /**
+   * \param filename the trace file
+   * \returns the file positioned on the first record, 0 if it cannot be
+   * read or is not a packet trace
+   */
+  static std::FILE * Open (const std::string &filename);
+};
+
+} // namespace ns3
+
+#endif /* PACKET_TRACE_WRITER_H */
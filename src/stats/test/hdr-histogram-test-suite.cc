@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/hdr-histogram.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * Check the percentiles against the exact ones, within the precision.
+ */
+class HdrHistogramPercentileTestCase : public TestCase
+{
+public:
+  HdrHistogramPercentileTestCase ();
+private:
+  virtual void DoRun (void);
+};
+
+HdrHistogramPercentileTestCase::HdrHistogramPercentileTestCase ()
+  : TestCase ("HDR histogram percentiles are within the relative precision")
+{
+}
+
+void
+HdrHistogramPercentileTestCase::DoRun (void)
+{
+  HdrHistogram histogram (7);
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetPercentile (50), 0, "Empty histogram percentile");
+
+  // Small values are exact
+  for (uint64_t value = 1; value <= 100; ++value)
+    {
+      histogram.Add (value);
+    }
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetPercentile (50), 50, "Exact range median");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetPercentile (99), 99, "Exact range p99");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetPercentile (100), 100, "Exact range max");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetMin (), 1, "Wrong min");
+  NS_TEST_ASSERT_MSG_EQ_TOL (histogram.GetMean (), 50.5, 1e-9, "Wrong mean");
+
+  // Flow completion times in ns, from 10us to 10s
+  histogram.Clear ();
+  for (uint64_t i = 1; i <= 10000; ++i)
+    {
+      histogram.Add (i * 1000000);
+    }
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetCount (), 10000, "Values lost");
+  double p50 = histogram.GetPercentile (50);
+  double p99 = histogram.GetPercentile (99);
+  double p999 = histogram.GetPercentile (99.9);
+  NS_TEST_ASSERT_MSG_EQ_TOL (p50, 5000e6, 5000e6 / 128, "Median out of precision");
+  NS_TEST_ASSERT_MSG_EQ_TOL (p99, 9900e6, 9900e6 / 128, "p99 out of precision");
+  NS_TEST_ASSERT_MSG_EQ_TOL (p999, 9990e6, 9990e6 / 128, "p99.9 out of precision");
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetPercentile (100), 10000000000ULL, "Max not clamped");
+
+  histogram.Add (0xffffffffffffffffULL);
+  NS_TEST_ASSERT_MSG_EQ (histogram.GetPercentile (100), 0xffffffffffffffffULL, "Largest value lost");
+}
+
+class HdrHistogramTestSuite : public TestSuite
+{
+public:
+  HdrHistogramTestSuite ();
+};
+
+HdrHistogramTestSuite::HdrHistogramTestSuite ()
+  : TestSuite ("hdr-histogram", UNIT)
+{
+  AddTestCase (new HdrHistogramPercentileTestCase, TestCase::QUICK);
+}
+
+static HdrHistogramTestSuite g_hdrHistogramTestSuite;
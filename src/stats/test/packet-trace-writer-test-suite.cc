@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/packet-trace-writer.h"
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+
+#include <fstream>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * Write records across several blocks, read them back and convert them.
+ */
+class PacketTraceWriterRoundTripTestCase : public TestCase
+{
+public:
+  PacketTraceWriterRoundTripTestCase ();
+private:
+  virtual void DoRun (void);
+  void WriteSome (Ptr<PacketTraceWriter> writer);
+};
+
+PacketTraceWriterRoundTripTestCase::PacketTraceWriterRoundTripTestCase ()
+  : TestCase ("Packet trace records survive the writer thread in order")
+{
+}
+
+void
+PacketTraceWriterRoundTripTestCase::WriteSome (Ptr<PacketTraceWriter> writer)
+{
+  for (uint32_t i = 0; i < 1000; ++i)
+    {
+      writer->Write (i % 2 ? PacketTraceRecord::RECEIVED : PacketTraceRecord::SENT, i, 1440, i / 2);
+    }
+}
+
+void
+PacketTraceWriterRoundTripTestCase::DoRun (void)
+{
+  std::string trace = CreateTempDirFilename ("packets.bin");
+
+  // Tiny blocks to go through the writer thread and its back pressure
+  Ptr<PacketTraceWriter> writer = Create<PacketTraceWriter> (trace, 7);
+  Simulator::Schedule (MilliSeconds (3), &PacketTraceWriterRoundTripTestCase::WriteSome, this, writer);
+  Simulator::Run ();
+  Simulator::Destroy ();
+  NS_TEST_ASSERT_MSG_EQ (writer->GetNRecords (), 1000, "Records lost before the writer");
+  writer->Close ();
+  writer->Write (PacketTraceRecord::SENT, 0, 0);
+  NS_TEST_ASSERT_MSG_EQ (writer->GetNRecords (), 1000, "Record accepted after close");
+
+  std::vector<PacketTraceRecord> records;
+  NS_TEST_ASSERT_MSG_EQ (PacketTraceReader::Read (trace, records), true, "Cannot read the trace");
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 1000, "Records lost by the writer");
+  for (uint32_t i = 0; i < records.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (records[i].sourceId, i, "Records reordered");
+      NS_TEST_ASSERT_MSG_EQ (records[i].flowId, i / 2, "Wrong flow id");
+      NS_TEST_ASSERT_MSG_EQ (records[i].timeNs, 3000000, "Wrong time");
+    }
+
+  std::string sent = CreateTempDirFilename ("sent_ms.dat");
+  std::string received = CreateTempDirFilename ("received_ms.dat");
+  NS_TEST_ASSERT_MSG_EQ (PacketTraceReader::ConvertToText (trace, sent, received), true, "Cannot convert");
+
+  std::ifstream is (received.c_str ());
+  std::string line;
+  std::getline (is, line);
+  NS_TEST_ASSERT_MSG_EQ (line, "[3] SourceIDTag: 1, size: 1440", "Wrong text layout");
+  uint32_t lines = 1;
+  while (std::getline (is, line))
+    {
+      lines++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (lines, 500, "Wrong number of received packets");
+
+  NS_TEST_ASSERT_MSG_EQ (PacketTraceReader::Read (sent, records), false, "Text file taken for a trace");
+}
+
+class PacketTraceWriterTestSuite : public TestSuite
+{
+public:
+  PacketTraceWriterTestSuite ();
+};
+
+PacketTraceWriterTestSuite::PacketTraceWriterTestSuite ()
+  : TestSuite ("packet-trace-writer", UNIT)
+{
+  AddTestCase (new PacketTraceWriterRoundTripTestCase, TestCase::QUICK);
+}
+
+static PacketTraceWriterTestSuite g_packetTraceWriterTestSuite;
@@ -2,10 +2,82 @@
 
 #include "tlb-probing-helper.h"
 
+#include "ns3/assert.h"
+#include "ns3/node.h"
+#include "ns3/ipv4-tlb.h"
+
 namespace ns3 {
 
-/* ... */
+TLBProbingHelper::TLBProbingHelper ()
+{
+    m_factory.SetTypeId ("ns3::Ipv4TLBProbing");
+}
 
+void
+TLBProbingHelper::SetAttribute (std::string name, const AttributeValue &value)
+{
+    m_factory.Set (name, value);
+}
 
+void
+TLBProbingHelper::AddTor (NodeContainer servers, std::vector<Ipv4Address> addresses)
+{
+    NS_ASSERT_MSG (servers.GetN () == addresses.size (), "One address per server is needed");
+    NS_ASSERT_MSG (servers.GetN () > 0, "A ToR needs at least one server");
+    Tor tor;
+    tor.servers = servers;
+    tor.addresses = addresses;
+    m_tors.push_back (tor);
 }
 
+std::vector<Ptr<Ipv4TLBProbing> >
+TLBProbingHelper::Install (void) const
+{
+    std::vector<Ptr<Ipv4TLBProbing> > probings;
+    for (uint32_t s = 0; s < m_tors.size (); ++s)
+    {
+        const Tor &src = m_tors[s];
+        uint32_t first = probings.size ();
+        for (uint32_t k = 0; k < src.servers.GetN (); ++k)
+        {
+            Ptr<Ipv4TLBProbing> probing = m_factory.Create<Ipv4TLBProbing> ();
+            probing->SetNode (src.servers.Get (k));
+            probing->SetSourceAddress (src.addresses[k]);
+            probing->Init ();
+            for (uint32_t j = 0; j < src.servers.GetN (); ++j)
+            {
+                if (j != k)
+                {
+                    probing->AddSubscriber (src.servers.Get (j)->GetObject<Ipv4TLB> ());
+                }
+            }
+            probings.push_back (probing);
+        }
+
+        for (uint32_t d = 0; d < m_tors.size (); ++d)
+        {
+            if (d == s)
+            {
+                continue;
+            }
+            // Spread both the probers and the probed servers
+            const Tor &dst = m_tors[d];
+            Ptr<Ipv4TLBProbing> prober = probings[first + d % src.servers.GetN ()];
+            prober->AddProbeAddress (dst.addresses[s % dst.servers.GetN ()]);
+        }
+    }
+    return probings;
+}
+
+int64_t
+TLBProbingHelper::AssignStreams (const std::vector<Ptr<Ipv4TLBProbing> > &probings, int64_t stream)
+{
+    int64_t currentStream = stream;
+    for (uint32_t i = 0; i < probings.size (); ++i)
+    {
+        currentStream += probings[i]->AssignStreams (currentStream);
+    }
+    return currentStream - stream;
+}
+
+}
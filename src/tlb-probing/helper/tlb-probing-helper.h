@@ -3,12 +3,65 @@
 #define IPV4_TLB_PROBING_HELPER_H
 
 #include "ns3/ipv4-tlb-probing.h"
+#include "ns3/object-factory.h"
+#include "ns3/node-container.h"
+#include "ns3/ipv4-address.h"
+
+#include <vector>
 
 namespace ns3 {
 
-/* ... */
+/**
+ * Installs aggregated TLB probing on the servers of a leaf-spine network
+ *
+ * For every pair of ToRs one server of the source ToR probes one server of
+ * the destination ToR, and publishes the results to the Ipv4TLB of all the
+ * servers under its ToR. The probing of the destination ToRs is spread over
+ * the servers of the source ToR, so each server runs at most
+ * ceil (ToRs / servers) probes per round instead of one per ToR.
+ *
+ * Every server gets one Ipv4TLBProbing, which also replies to the probes
+ * of the other ToRs. The Ipv4TLB of the servers must already know the ToR
+ * of every address and the available paths.
+ */
+class TLBProbingHelper
+{
+public:
+    TLBProbingHelper ();
 
-}
+    // Set an attribute of the installed Ipv4TLBProbing
+    void SetAttribute (std::string name, const AttributeValue &value);
+
+    /**
+     * \param servers the servers under the ToR
+     * \param addresses the address of every server
+     */
+    void AddTor (NodeContainer servers, std::vector<Ipv4Address> addresses);
+
+    /**
+     * \returns the probing of every server, ToR after ToR
+     */
+    std::vector<Ptr<Ipv4TLBProbing> > Install (void) const;
 
-#endif /* TLB_PROBING_HELPER_H */
+    /**
+     * \brief Use fixed random variable streams for installed probings
+     * \param probings the probings returned by Install
+     * \param stream first stream index to use
+     * \returns the number of stream indices assigned
+     */
+    static int64_t AssignStreams (const std::vector<Ptr<Ipv4TLBProbing> > &probings, int64_t stream);
+
+private:
+    struct Tor
+    {
+        NodeContainer servers;
+        std::vector<Ipv4Address> addresses;
+    };
+
+    ObjectFactory m_factory;
+    std::vector<Tor> m_tors;
+};
+
+}
 
+#endif /* IPV4_TLB_PROBING_HELPER_H */
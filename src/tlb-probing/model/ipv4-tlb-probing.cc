@@ -17,7 +17,7 @@
 #include "ns3/ipv4-xpath-tag.h"
 
 #include <sys/socket.h>
-#include <set>
+#include <limits>
 
 namespace ns3 {
 
@@ -36,6 +36,22 @@ Ipv4TLBProbing::GetTypeId (void)
                       TimeValue (MicroSeconds (100)),
                       MakeTimeAccessor (&Ipv4TLBProbing::m_probeInterval),
                       MakeTimeChecker ())
+        .AddAttribute ("ProbeTimeout", "The deadline of a probing round",
+                      TimeValue (Seconds (0.1)),
+                      MakeTimeAccessor (&Ipv4TLBProbing::m_probeTimeout),
+                      MakeTimeChecker ())
+        .AddAttribute ("PathsPerRound", "The number of paths probed per destination in a round",
+                      UintegerValue (2),
+                      MakeUintegerAccessor (&Ipv4TLBProbing::m_pathsPerRound),
+                      MakeUintegerChecker<uint32_t> (1))
+        .AddTraceSource ("ProbeRecv",
+                         "When the reply of a probe is received",
+                         MakeTraceSourceAccessor (&Ipv4TLBProbing::m_probeRecvTrace),
+                         "ns3::Ipv4TLBProbing::ProbeRecvCallback")
+        .AddTraceSource ("ProbeTimeout",
+                         "When a probe is not replied before the deadline of its round",
+                         MakeTraceSourceAccessor (&Ipv4TLBProbing::m_probeTimeoutTrace),
+                         "ns3::Ipv4TLBProbing::ProbeTimeoutCallback")
     ;
 
     return tid;
@@ -49,34 +65,27 @@ Ipv4TLBProbing::GetInstanceTypeId () const
 
 Ipv4TLBProbing::Ipv4TLBProbing ()
     : m_sourceAddress (Ipv4Address ("127.0.0.1")),
-      m_probeAddress (Ipv4Address ("127.0.0.1")),
       m_probeTimeout (Seconds (0.1)),
       m_probeInterval (MicroSeconds (100)),
+      m_pathsPerRound (2),
       m_id (0),
-      m_hasBestPath (false),
-      m_bestPath (0),
-      m_bestPathRtt (Seconds (666)),
-      //m_bestPathECN (false),
-      //m_bestPathSize (0),
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::Ipv4TLBProbing (const Ipv4TLBProbing &other)
     : m_sourceAddress (other.m_sourceAddress),
-      m_probeAddress (other.m_probeAddress),
+      m_probeAddresses (other.m_probeAddresses),
       m_probeTimeout (other.m_probeTimeout),
       m_probeInterval (other.m_probeInterval),
+      m_pathsPerRound (other.m_pathsPerRound),
       m_id (0),
-      m_hasBestPath (false),
-      m_bestPath (0),
-      m_bestPathRtt (Seconds (666)),
-      //m_bestPathECN (false),
-      //m_bestPathSize (0),
       m_node ()
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLBProbing::~Ipv4TLBProbing ()
@@ -87,13 +96,13 @@ Ipv4TLBProbing::~Ipv4TLBProbing ()
 void
 Ipv4TLBProbing::DoDispose ()
 {
-    std::map <uint32_t, EventId>::iterator itr =
-        m_probingTimeoutMap.begin ();
-    for ( ; itr != m_probingTimeoutMap.end (); ++itr)
-    {
-        (itr->second).Cancel ();
-        m_probingTimeoutMap.erase (itr);
-    }
+    m_probeEvent.Cancel ();
+    m_roundTimeoutEvent.Cancel ();
+    m_rounds.clear ();
+    m_subscribers.clear ();
+    m_socket = 0;
+    m_node = 0;
+    Object::DoDispose ();
 }
 
 void
@@ -105,7 +114,20 @@ Ipv4TLBProbing::SetSourceAddress (Ipv4Address address)
 void
 Ipv4TLBProbing::SetProbeAddress (Ipv4Address address)
 {
-    m_probeAddress = address;
+    m_probeAddresses.clear ();
+    m_probeAddresses.push_back (address);
+}
+
+void
+Ipv4TLBProbing::AddProbeAddress (Ipv4Address address)
+{
+    m_probeAddresses.push_back (address);
+}
+
+void
+Ipv4TLBProbing::AddSubscriber (Ptr<Ipv4TLB> ipv4TLB)
+{
+    m_subscribers.push_back (ipv4TLB);
 }
 
 void
@@ -130,14 +152,14 @@ Ipv4TLBProbing::Init ()
 }
 
 void
-Ipv4TLBProbing::SendProbe (uint32_t path)
+Ipv4TLBProbing::SendProbe (Ipv4Address probeAddress, uint32_t path)
 {
-    Address to = InetSocketAddress (m_probeAddress, 0);
+    Address to = InetSocketAddress (probeAddress, 0);
 
     Ptr<Packet> packet = Create<Packet> (0);
     Ipv4Header newHeader;
     newHeader.SetSource (m_sourceAddress);
-    newHeader.SetDestination (m_probeAddress);
+    newHeader.SetDestination (probeAddress);
     newHeader.SetProtocol (0);
     newHeader.SetPayloadSize (packet->GetSize ());
     newHeader.SetEcn (Ipv4Header::ECN_ECT1);
@@ -149,11 +171,11 @@ Ipv4TLBProbing::SendProbe (uint32_t path)
     ipv4XPathTag.SetPathId (path);
     packet->AddPacketTag (ipv4XPathTag);
 
-    // Probing tag
+    // Probing tag, the id is the one of the round
     Ipv4TLBProbingTag probingTag;
     probingTag.SetId (m_id);
     probingTag.SetPath (path);
-    probingTag.SetProbeAddress (m_probeAddress);
+    probingTag.SetProbeAddress (probeAddress);
     probingTag.SetIsReply (0);
     probingTag.SetTime (Simulator::Now ());
     probingTag.SetIsCE (0);
@@ -161,22 +183,83 @@ Ipv4TLBProbing::SendProbe (uint32_t path)
     packet->AddPacketTag (probingTag);
 
     m_socket->SendTo (packet, 0, to);
-    m_id ++;
 
-    // Add timeout
-    m_probingTimeoutMap[m_id] =
-        Simulator::Schedule (m_probeTimeout, &Ipv4TLBProbing::ProbeEventTimeout, this, m_id, path);
-
-    Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-    ipv4TLB->ProbeSend (m_probeAddress, path);
+    m_node->GetObject<Ipv4TLB> ()->ProbeSend (probeAddress, path);
+    for (uint32_t i = 0; i < m_subscribers.size (); ++i)
+    {
+        m_subscribers[i]->ProbeSend (probeAddress, path);
+    }
 }
 
 void
-Ipv4TLBProbing::ProbeEventTimeout (uint32_t id, uint32_t path)
+Ipv4TLBProbing::ProbeRoundTimeout (void)
 {
-    m_probingTimeoutMap.erase (id);
+    Time now = Simulator::Now ();
     Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-    ipv4TLB->ProbeTimeout (path, m_probeAddress);
+    while (!m_rounds.empty ())
+    {
+        ProbeRound &round = m_rounds.front ();
+        if (!round.pending.empty ())
+        {
+            if (round.deadline > now)
+            {
+                break;
+            }
+            for (uint32_t i = 0; i < round.pending.size (); ++i)
+            {
+                const PendingProbe &probe = round.pending[i];
+                m_probeTimeoutTrace (probe.path, probe.probeAddress);
+                ipv4TLB->ProbeTimeout (probe.path, probe.probeAddress);
+                for (uint32_t j = 0; j < m_subscribers.size (); ++j)
+                {
+                    m_subscribers[j]->ProbeTimeout (probe.path, probe.probeAddress);
+                }
+            }
+        }
+        m_rounds.pop_front ();
+    }
+
+    if (!m_rounds.empty ())
+    {
+        m_roundTimeoutEvent = Simulator::Schedule (m_rounds.front ().deadline - now,
+                &Ipv4TLBProbing::ProbeRoundTimeout, this);
+    }
+}
+
+bool
+Ipv4TLBProbing::ReplyReceived (uint16_t id, Ipv4Address probeAddress, uint32_t path)
+{
+    if (m_rounds.empty ())
+    {
+        return false;
+    }
+
+    // Round ids are consecutive, the offset wraps as the ids do
+    uint16_t offset = id - m_rounds.front ().id;
+    if (offset >= m_rounds.size ())
+    {
+        // The round has expired
+        return false;
+    }
+
+    std::vector<PendingProbe> &pending = m_rounds[offset].pending;
+    bool found = false;
+    for (uint32_t i = 0; i < pending.size () && !found; ++i)
+    {
+        if (pending[i].path == path && pending[i].probeAddress == probeAddress)
+        {
+            pending[i] = pending.back ();
+            pending.pop_back ();
+            found = true;
+        }
+    }
+
+    // Drop the replied rounds, the timer finds out by itself that they are gone
+    while (!m_rounds.empty () && m_rounds.front ().pending.empty ())
+    {
+        m_rounds.pop_front ();
+    }
+    return found;
 }
 
 void
@@ -232,46 +315,36 @@ Ipv4TLBProbing::ReceivePacket (Ptr<Socket> socket)
     }
     else
     {
-        std::map<uint32_t, EventId>::iterator itr =
-                m_probingTimeoutMap.find (probingTag.GetId ());
-
-        if (itr == m_probingTimeoutMap.end () && !probingTag.GetIsBroadcast ())
-        {
-            // The reply has incurred timeout
-            return;
-        }
-
-        if (!probingTag.GetIsBroadcast ())
-        {
-            // Cancel the probing timeout timer
-            (itr->second).Cancel ();
-            m_probingTimeoutMap.erase (itr);
-        }
-
         uint32_t path = probingTag.GetPath ();
+        Ipv4Address probeAddress = probingTag.GetProbeAddres ();
         Time oneWayRtt = probingTag.GetTime ();
         bool isCE = probingTag.GetIsCE () == 1 ? true : false;
         uint32_t size = packet->GetSize () + ipv4Header.GetSerializedSize ();
 
-        if (oneWayRtt < m_bestPathRtt)
+        if (!probingTag.GetIsBroadcast ())
         {
-            m_hasBestPath = true;
-            //m_bestPath = path;
-            //m_bestPathRtt = oneWayRtt;
-            //m_bestPathECN = isCE;
-            //m_bestPathSize = size;
+            if (!ReplyReceived (probingTag.GetId (), probeAddress, path))
+            {
+                // The reply has incurred timeout
+                return;
+            }
+            m_probeRecvTrace (path, probeAddress, oneWayRtt, isCE);
         }
 
         Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-        ipv4TLB->ProbeRecv (path, probingTag.GetProbeAddres (), size, isCE, oneWayRtt);
+        ipv4TLB->ProbeRecv (path, probeAddress, size, isCE, oneWayRtt);
 
         if (!probingTag.GetIsBroadcast ())
         {
-            // Forward path information to servers under the same rack
+            // Publish path information to servers under the same rack
+            for (uint32_t i = 0; i < m_subscribers.size (); ++i)
+            {
+                m_subscribers[i]->ProbeRecv (path, probeAddress, size, isCE, oneWayRtt);
+            }
             std::vector<Ipv4Address>::iterator broadcastItr = m_broadcastAddresses.begin ();
             for ( ; broadcastItr != m_broadcastAddresses.end (); broadcastItr ++)
             {
-                Ipv4TLBProbing::ForwardPathInfoTo(*broadcastItr, path, oneWayRtt, isCE);
+                Ipv4TLBProbing::ForwardPathInfoTo(*broadcastItr, probeAddress, path, oneWayRtt, isCE);
             }
         }
     }
@@ -280,6 +353,11 @@ Ipv4TLBProbing::ReceivePacket (Ptr<Socket> socket)
 void
 Ipv4TLBProbing::StartProbe ()
 {
+    if (m_probeAddresses.empty ())
+    {
+        // Only replies to the probes of the others
+        return;
+    }
     m_probeEvent = Simulator::ScheduleNow (&Ipv4TLBProbing::DoProbe, this);
 }
 
@@ -289,49 +367,66 @@ Ipv4TLBProbing::StopProbe (Time stopTime)
     Simulator::Schedule (stopTime, &Ipv4TLBProbing::DoStop, this);
 }
 
+int64_t
+Ipv4TLBProbing::AssignStreams (int64_t stream)
+{
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
+
 void
 Ipv4TLBProbing::DoProbe ()
 {
-    uint32_t probingCount = 3;
+    ProbeRound round;
+    round.id = m_id;
+    round.deadline = Simulator::Now () + m_probeTimeout;
 
-    std::set<uint32_t> pathSet;
-
-    if (m_hasBestPath && m_bestPath != 0)
+    Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
+    std::vector<Ipv4Address>::const_iterator addrItr = m_probeAddresses.begin ();
+    for ( ; addrItr != m_probeAddresses.end (); ++addrItr)
     {
-        /*
-        std::vector<Ipv4Address>::iterator itr = m_broadcastAddresses.begin ();
-        for ( ; itr != m_broadcastAddresses.end (); itr ++)
+        std::vector<uint32_t> availPaths = ipv4TLB->GetAvailPath (*addrItr);
+        if (availPaths.empty ())
         {
-            Ipv4TLBProbing::BroadcastBestPathTo (*itr);
+            continue;
         }
-        */
-
-        Ipv4TLBProbing::SendProbe (m_bestPath);
-        probingCount --;
-        pathSet.insert (m_bestPath);
-    }
-    Ptr<Ipv4TLB> ipv4TLB = m_node->GetObject<Ipv4TLB> ();
-    std::vector<uint32_t> availPaths = ipv4TLB->GetAvailPath (m_probeAddress);
-    if (!availPaths.empty ())
-    {
-        for (uint32_t i = 0; i < 10; i++) // Try 8 times
+        uint32_t first = round.pending.size ();
+        for (uint32_t i = 0; i < 10; i++) // Try 10 times
         {
-            uint32_t path = availPaths[rand() % availPaths.size ()];
-            if (pathSet.find (path) != pathSet.end ())
+            uint32_t path = availPaths[m_rand->GetInteger (0, availPaths.size () - 1)];
+            bool isProbed = false;
+            for (uint32_t j = first; j < round.pending.size (); ++j)
+            {
+                isProbed = isProbed || round.pending[j].path == path;
+            }
+            if (isProbed)
             {
                 continue;
             }
-            probingCount --;
-            if (probingCount == 0)
+            PendingProbe probe;
+            probe.probeAddress = *addrItr;
+            probe.path = path;
+            round.pending.push_back (probe);
+            Ipv4TLBProbing::SendProbe (*addrItr, path);
+            if (round.pending.size () - first == m_pathsPerRound)
             {
                 break;
             }
-            pathSet.insert (path);
-            Ipv4TLBProbing::SendProbe (path);
         }
     }
-    m_hasBestPath = false;
-    m_bestPathRtt = Seconds (666);
+
+    if (!round.pending.empty ())
+    {
+        // Rounds are kept with consecutive ids, so a reply finds its round by offset
+        m_id++;
+        m_rounds.push_back (round);
+        if (!m_roundTimeoutEvent.IsRunning ())
+        {
+            m_roundTimeoutEvent = Simulator::Schedule (m_probeTimeout,
+                    &Ipv4TLBProbing::ProbeRoundTimeout, this);
+        }
+    }
 
     m_probeEvent = Simulator::Schedule (m_probeInterval, &Ipv4TLBProbing::DoProbe, this);
 }
@@ -342,39 +437,8 @@ Ipv4TLBProbing::DoStop ()
     m_probeEvent.Cancel ();
 }
 
-/*
 void
-Ipv4TLBProbing::BroadcastBestPathTo (Ipv4Address addr)
-{
-    Address to = InetSocketAddress (addr, 0);
-
-    Ptr<Packet> packet = Create<Packet> (0);
-    Ipv4Header newHeader;
-    newHeader.SetSource (m_sourceAddress);
-    newHeader.SetDestination (addr);
-    newHeader.SetProtocol (0);
-    newHeader.SetPayloadSize (packet->GetSize ());
-    newHeader.SetEcn (Ipv4Header::ECN_ECT1);
-    newHeader.SetTtl (255);
-    packet->AddHeader (newHeader);
-
-    // Probing tag
-    Ipv4TLBProbingTag probingTag;
-    probingTag.SetId (0);
-    probingTag.SetPath (m_bestPath);
-    probingTag.SetProbeAddress (m_probeAddress);
-    probingTag.SetIsReply (1);
-    probingTag.SetTime (m_bestPathRtt);
-    probingTag.SetIsCE (m_bestPathECN);
-    probingTag.SetIsBroadcast (1);
-    packet->AddPacketTag (probingTag);
-
-    m_socket->SendTo (packet, 0, to);
-}
-*/
-
-void
-Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayRtt, bool isCE)
+Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, Ipv4Address probeAddress, uint32_t path, Time oneWayRtt, bool isCE)
 {
     Address to = InetSocketAddress (addr, 0);
 
@@ -392,7 +456,7 @@ Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayR
     Ipv4TLBProbingTag probingTag;
     probingTag.SetId (0);
     probingTag.SetPath (path);
-    probingTag.SetProbeAddress (m_probeAddress);
+    probingTag.SetProbeAddress (probeAddress);
     probingTag.SetIsReply (1);
     probingTag.SetTime (oneWayRtt);
     probingTag.SetIsCE (isCE);
@@ -404,4 +468,3 @@ Ipv4TLBProbing::ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayR
 }
 
 }
-
@@ -8,9 +8,10 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
 
 #include <vector>
-#include <map>
+#include <deque>
 
 namespace ns3 {
 
@@ -18,7 +19,22 @@ class Packet;
 class Socket;
 class Node;
 class Ipv4Header;
-
+class Ipv4TLB;
+
+/**
+ * Probes the paths towards one or more destinations
+ *
+ * Every probe interval a round sends probes on two random available paths
+ * of every probe address; the replies are reported to the Ipv4TLB of the
+ * node and of the subscribers. All the probes of a round share one
+ * deadline, and a single timer expires the rounds in order, so a round
+ * answered in time costs no timer event.
+ *
+ * Aggregated probing: one server per ToR probes a destination ToR on
+ * behalf of the servers under the same ToR, which subscribe their Ipv4TLB
+ * instead of probing themselves (see TLBProbingHelper). Otherwise every
+ * server probes, and forwards the replies to the broadcast addresses.
+ */
 class Ipv4TLBProbing : public Object
 {
 public:
@@ -32,24 +48,35 @@ public:
     virtual void DoDispose (void);
 
     void SetSourceAddress (Ipv4Address address);
+    // Probe this destination only
     void SetProbeAddress (Ipv4Address address);
 
+    // Probe one more destination in every round
+    void AddProbeAddress (Ipv4Address address);
+
+    // Report the probing results to this Ipv4TLB as well
+    void AddSubscriber (Ptr<Ipv4TLB> ipv4TLB);
+
     void SetNode (Ptr<Node> node);
 
     void AddBroadCastAddress (Ipv4Address addr);
 
     void Init (void);
 
-    void SendProbe (uint32_t path);
-
     void ReceivePacket (Ptr<Socket> socket);
 
-    void ProbeEventTimeout (uint32_t id, uint32_t path);
+    void ProbeRoundTimeout (void);
 
     void StartProbe ();
 
     void StopProbe (Time stopTime);
 
+    // Use a fixed stream for the paths probed in every round, returns 1
+    int64_t AssignStreams (int64_t stream);
+
+    typedef void (* ProbeRecvCallback) (uint32_t path, Ipv4Address probeAddress, Time oneWayRtt, bool isCE);
+    typedef void (* ProbeTimeoutCallback) (uint32_t path, Ipv4Address probeAddress);
+
 private:
 
     void DoProbe ();
@@ -57,39 +84,59 @@ private:
 
     //void BroadcastBestPathTo (Ipv4Address addr);
 
-    void ForwardPathInfoTo (Ipv4Address addr, uint32_t path, Time oneWayRtt, bool isCE);
+    void SendProbe (Ipv4Address probeAddress, uint32_t path);
+
+    // Returns false if the probe has timed out already
+    bool ReplyReceived (uint16_t id, Ipv4Address probeAddress, uint32_t path);
+
+    void ForwardPathInfoTo (Ipv4Address addr, Ipv4Address probeAddress, uint32_t path, Time oneWayRtt, bool isCE);
+
+    struct PendingProbe
+    {
+        Ipv4Address probeAddress;
+        uint32_t path;
+    };
+
+    struct ProbeRound
+    {
+        uint16_t id;
+        Time deadline;
+        std::vector<PendingProbe> pending; // Probes not replied yet
+    };
 
     // Parameters
     Ipv4Address m_sourceAddress;
-    Ipv4Address m_probeAddress; // The flow destination
+    std::vector<Ipv4Address> m_probeAddresses; // The flow destinations
 
     Time m_probeTimeout;
     Time m_probeInterval;
 
-    uint32_t m_id;
+    uint32_t m_pathsPerRound;
 
-    std::map <uint32_t, EventId> m_probingTimeoutMap;
+    uint16_t m_id; // Id of the next round
 
-    /* Best path related */
-    bool m_hasBestPath;
-    uint32_t m_bestPath;
+    std::deque<ProbeRound> m_rounds; // Rounds with pending probes, oldest first
 
-    Time m_bestPathRtt;
-    //bool m_bestPathECN;
-    //uint32_t m_bestPathSize;
-    /* ----------------- */
+    EventId m_roundTimeoutEvent;
 
     EventId m_probeEvent;
 
+    std::vector<Ptr<Ipv4TLB> > m_subscribers;
+
     Ptr<Socket> m_socket;
 
     std::vector<Ipv4Address> m_broadcastAddresses;
 
     Ptr<Node> m_node;
 
+    Ptr<UniformRandomVariable> m_rand;
+
+    TracedCallback<uint32_t, Ipv4Address, Time, bool> m_probeRecvTrace;
+    TracedCallback<uint32_t, Ipv4Address> m_probeTimeoutTrace;
+
 };
 
 }
 
-#endif /* CONGESTION_PROBING_H */
+#endif /* IPV4_TLB_PROBING_H */
 
@@ -2,6 +2,15 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-tlb-probing.h"
+#include "ns3/tlb-probing-helper.h"
+#include "ns3/ipv4-tlb.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-interface-container.h"
+#include "ns3/nstime.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -10,46 +19,119 @@
 // to use the using directive to access the ns3 namespace directly
 using namespace ns3;
 
-// This is an example TestCase.
-class TlbProbingTestCase1 : public TestCase
+// Two ToRs of two servers, one server per ToR probes the other ToR
+class TlbProbingRoundTestCase : public TestCase
 {
 public:
-  TlbProbingTestCase1 ();
-  virtual ~TlbProbingTestCase1 ();
+  TlbProbingRoundTestCase ();
 
 private:
   virtual void DoRun (void);
+  void ProbeRecv (uint32_t path, Ipv4Address probeAddress, Time oneWayRtt, bool isCE);
+  void ProbeTimeout (uint32_t path, Ipv4Address probeAddress);
+
+  Time m_start;
+  uint32_t m_nRecv;
+  uint32_t m_nTimeout;
 };
 
-// Add some help text to this case to describe what it is intended to test
-TlbProbingTestCase1::TlbProbingTestCase1 ()
-  : TestCase ("TlbProbing test case (does nothing)")
+TlbProbingRoundTestCase::TlbProbingRoundTestCase ()
+  : TestCase ("TlbProbing aggregated rounds"),
+    m_start (MilliSeconds (10)),
+    m_nRecv (0),
+    m_nTimeout (0)
 {
 }
 
-// This destructor does nothing but we include it as a reminder that
-// the test case should clean up after itself
-TlbProbingTestCase1::~TlbProbingTestCase1 ()
+void
+TlbProbingRoundTestCase::ProbeRecv (uint32_t path, Ipv4Address probeAddress, Time oneWayRtt, bool isCE)
 {
+  if (Simulator::Now () >= m_start)
+    {
+      m_nRecv++;
+    }
 }
 
-//
-// This method is the pure virtual method from class TestCase that every
-// TestCase must implement
-//
 void
-TlbProbingTestCase1::DoRun (void)
+TlbProbingRoundTestCase::ProbeTimeout (uint32_t path, Ipv4Address probeAddress)
 {
-  // A wide variety of test macros are available in src/core/test.h
-  NS_TEST_ASSERT_MSG_EQ (true, true, "true doesn't equal true for some reason");
-  // Use this one for floating point comparisons
-  NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
+  if (Simulator::Now () >= m_start)
+    {
+      m_nTimeout++;
+    }
+}
+
+void
+TlbProbingRoundTestCase::DoRun (void)
+{
+  NodeContainer servers;
+  servers.Create (4);
+  SimpleNetDeviceHelper simple;
+  NetDeviceContainer devices = simple.Install (servers);
+  InternetStackHelper internet;
+  internet.SetTLB (true);
+  internet.Install (servers);
+  Ipv4AddressHelper ipv4;
+  ipv4.SetBase ("10.1.1.0", "255.255.255.0");
+  Ipv4InterfaceContainer interfaces = ipv4.Assign (devices);
+
+  // An address nobody answers, as a third ToR
+  Ipv4Address lost ("10.1.1.99");
+  for (uint32_t k = 0; k < servers.GetN (); ++k)
+    {
+      Ptr<Ipv4TLB> tlb = servers.Get (k)->GetObject<Ipv4TLB> ();
+      for (uint32_t j = 0; j < servers.GetN (); ++j)
+        {
+          tlb->AddAddressWithTor (interfaces.GetAddress (j), j / 2);
+        }
+      tlb->AddAddressWithTor (lost, 2);
+      for (uint32_t path = 1; path <= 3; ++path)
+        {
+          tlb->AddAvailPath (1 - k / 2, path);
+          tlb->AddAvailPath (2, path);
+        }
+    }
+
+  TLBProbingHelper helper;
+  for (uint32_t tor = 0; tor < 2; ++tor)
+    {
+      std::vector<Ipv4Address> addresses;
+      addresses.push_back (interfaces.GetAddress (tor * 2));
+      addresses.push_back (interfaces.GetAddress (tor * 2 + 1));
+      helper.AddTor (NodeContainer (servers.Get (tor * 2), servers.Get (tor * 2 + 1)), addresses);
+    }
+  std::vector<Ptr<Ipv4TLBProbing> > probings = helper.Install ();
+  NS_TEST_ASSERT_MSG_EQ (probings.size (), 4, "One probing per server");
+
+  Ptr<Ipv4TLBProbing> lostProbing = CreateObject<Ipv4TLBProbing> ();
+  lostProbing->SetAttribute ("ProbeTimeout", TimeValue (MilliSeconds (1)));
+  lostProbing->SetNode (servers.Get (0));
+  lostProbing->SetSourceAddress (interfaces.GetAddress (0));
+  lostProbing->SetProbeAddress (lost);
+  lostProbing->AddSubscriber (servers.Get (1)->GetObject<Ipv4TLB> ());
+  lostProbing->Init ();
+  probings.push_back (lostProbing);
+
+  for (uint32_t i = 0; i < probings.size (); ++i)
+    {
+      probings[i]->TraceConnectWithoutContext ("ProbeRecv", MakeCallback (&TlbProbingRoundTestCase::ProbeRecv, this));
+      probings[i]->TraceConnectWithoutContext ("ProbeTimeout", MakeCallback (&TlbProbingRoundTestCase::ProbeTimeout, this));
+      probings[i]->StartProbe ();
+      probings[i]->StopProbe (m_start + MicroSeconds (950));
+    }
+
+  // Count from m_start on, once ARP has resolved the addresses
+  Simulator::Stop (MilliSeconds (15));
+  Simulator::Run ();
+
+  // 10 rounds of 2 paths for each of the 2 pairs of ToRs, and the 20 rounds
+  // of the lost ToR whose deadline is after m_start
+  NS_TEST_ASSERT_MSG_EQ (m_nRecv, 40, "Probes not replied");
+  NS_TEST_ASSERT_MSG_EQ (m_nTimeout, 40, "Lost probes not timed out");
+
+  Simulator::Destroy ();
 }
 
-// The TestSuite class names the TestSuite, identifies what type of TestSuite,
-// and enables the TestCases to be run.  Typically, only the constructor for
-// this class must be defined
-//
 class TlbProbingTestSuite : public TestSuite
 {
 public:
@@ -59,10 +141,8 @@ public:
 TlbProbingTestSuite::TlbProbingTestSuite ()
   : TestSuite ("tlb-probing", UNIT)
 {
-  // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
-  AddTestCase (new TlbProbingTestCase1, TestCase::QUICK);
+  AddTestCase (new TlbProbingRoundTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
 static TlbProbingTestSuite tlbProbingTestSuite;
-
@@ -9,7 +9,9 @@
 #include "ns3/boolean.h"
 
 #include <cstdio>
+#include <cstring>
 #include <algorithm>
+#include <cmath>
 
 #define RANDOM_BASE 100
 #define SMOOTH_BASE 100
@@ -61,9 +63,13 @@ Ipv4TLB::Ipv4TLB ():
     m_epAgingTime (MicroSeconds (10000)),
     */
     // Added at Jan 12nd
-    m_flowletTimeout (MicroSeconds (5000000))
+    m_flowletTimeout (MicroSeconds (5000000)),
+    m_ackletDieTime (MilliSeconds (100)),
+    m_lastFlowAging (Seconds (0)),
+    m_dre (m_dreTime, m_dreAlpha)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
@@ -105,9 +111,13 @@ Ipv4TLB::Ipv4TLB (const Ipv4TLB &other):
     m_epCheckTime (other.m_epCheckTime),
     m_epAgingTime (other.m_epAgingTime),
     */
-    m_flowletTimeout (other.m_flowletTimeout)
+    m_flowletTimeout (other.m_flowletTimeout),
+    m_ackletDieTime (other.m_ackletDieTime),
+    m_lastFlowAging (Seconds (0)),
+    m_dre (other.m_dre)
 {
     NS_LOG_FUNCTION (this);
+    m_rand = CreateObject<UniformRandomVariable> ();
 }
 
 TypeId
@@ -152,7 +162,7 @@ Ipv4TLB::GetTypeId (void)
         .AddAttribute ("T1", "The path aging time interval",
                       TimeValue (MicroSeconds (320)),
                       MakeTimeAccessor (&Ipv4TLB::m_T1),
-                      MakeTimeChecker ())
+                      MakeTimeChecker (TimeStep (1)))
         .AddAttribute ("ECNPortionLow", "The ECN portion used in judging a good path",
                       DoubleValue (0.3),
                       MakeDoubleAccessor (&Ipv4TLB::m_ecnPortionLow),
@@ -169,6 +179,10 @@ Ipv4TLB::GetTypeId (void)
                       TimeValue (MicroSeconds (300)),
                       MakeTimeAccessor (&Ipv4TLB::m_ackletTimeout),
                       MakeTimeChecker ())
+        .AddAttribute ("AckletDieTime", "The idle time after which an ACK flowlet is dropped",
+                      TimeValue (MilliSeconds (100)),
+                      MakeTimeAccessor (&Ipv4TLB::m_ackletDieTime),
+                      MakeTimeChecker ())
         .AddAttribute ("FlowletTimeout", "The flowlet timeout",
                       TimeValue (MicroSeconds (500)),
                       MakeTimeAccessor (&Ipv4TLB::m_flowletTimeout),
@@ -190,19 +204,47 @@ void
 Ipv4TLB::AddAddressWithTor (Ipv4Address address, uint32_t torId)
 {
     m_ipTorMap[address] = torId;
+    if (torId >= m_destTors.size ())
+    {
+        m_destTors.resize (torId + 1);
+    }
+}
+
+void
+Ipv4TLB::SetTorDirectory (Ptr<const TorDirectory> directory)
+{
+    m_torDirectory = directory;
+    if (directory != 0 && directory->GetNTors () > m_destTors.size ())
+    {
+        m_destTors.resize (directory->GetNTors ());
+    }
 }
 
 void
 Ipv4TLB::AddAvailPath (uint32_t destTor, uint32_t path)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    if (destTor >= m_destTors.size ())
     {
-        std::vector<uint32_t> paths;
-        m_availablePath[destTor] = paths;
-        itr = m_availablePath.find (destTor);
+        m_destTors.resize (destTor + 1);
     }
-    (itr->second).push_back (path);
+    TLBDestTor &tor = m_destTors[destTor];
+    uint32_t slot = Ipv4TLB::FindPathSlot (tor, path);
+    if (slot < tor.nAvailPaths)
+    {
+        NS_LOG_WARN ("Path " << path << " is already available towards ToR " << destTor);
+        return;
+    }
+    if (slot == tor.pathIds.size ())
+    {
+        tor.pathIds.push_back (path);
+        tor.hasPathInfo.push_back (0);
+        tor.pathInfo.push_back (TLBPathInfo ());
+    }
+    // Move the path to the end of the available ones
+    std::swap (tor.pathIds[slot], tor.pathIds[tor.nAvailPaths]);
+    std::swap (tor.hasPathInfo[slot], tor.hasPathInfo[tor.nAvailPaths]);
+    std::swap (tor.pathInfo[slot], tor.pathInfo[tor.nAvailPaths]);
+    tor.nAvailPaths++;
 }
 
 std::vector<uint32_t>
@@ -216,28 +258,28 @@ Ipv4TLB::GetAvailPath (Ipv4Address daddr)
         return emptyVector;
     }
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+    TLBDestTor *tor = Ipv4TLB::GetDestTor (destTor);
+    if (tor == 0)
     {
         return emptyVector;
     }
-    return itr->second;
+    return std::vector<uint32_t> (tor->pathIds.begin (), tor->pathIds.begin () + tor->nAvailPaths);
 }
 
 uint32_t
 Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
-    struct TLBAcklet acklet;
-    std::map<uint32_t, TLBAcklet>::iterator ackletItr = m_acklets.find (flowId);
+    Ipv4TLB::AgeFlows ();
 
-    if (ackletItr != m_acklets.end ())
+    TLBAcklet *ackletItr = m_acklets.Find (flowId);
+
+    if (ackletItr != 0)
     {
         // Existing flow
-        acklet = ackletItr->second;
+        TLBAcklet &acklet = *ackletItr;
         if (Simulator::Now () - acklet.activeTime <= m_ackletTimeout) // Timeout
         {
             acklet.activeTime = Simulator::Now ();
-            m_acklets[flowId] = acklet;
             return acklet.pathId;
         }
 
@@ -268,8 +310,6 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
             acklet.pathId = newPath.pathId;
             acklet.activeTime = Simulator::Now ();
 
-            m_acklets[flowId] = acklet;
-
             return newPath.pathId;
         }
     }
@@ -283,31 +323,22 @@ Ipv4TLB::GetAckPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     }
 
     struct PathInfo newPath;
-    if (!Ipv4TLB::WhereToChange (destTor, newPath, false, 0))
+    if (!Ipv4TLB::WhereToChange (destTor, newPath, false, 0, m_judgedPaths))
     {
         newPath = Ipv4TLB::SelectRandomPath (destTor);
     }
 
+    TLBAcklet &acklet = m_acklets.Insert (flowId);
     acklet.pathId = newPath.pathId;
     acklet.activeTime = Simulator::Now ();
 
-    m_acklets[flowId] = acklet;
-
     return newPath.pathId;
 }
 
 uint32_t
 Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 {
-    if (!m_agingEvent.IsRunning ())
-    {
-        m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
-    }
-
-    if (!m_dreEvent.IsRunning ())
-    {
-        m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
-    }
+    Ipv4TLB::AgeFlows ();
 
     uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
@@ -322,21 +353,21 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find source tor id based on the given source address");
     }
 
-    std::map<uint32_t, TLBFlowInfo>::iterator flowItr = m_flowInfo.find (flowId);
+    TLBFlowInfo *flowItr = m_flowInfo.Find (flowId);
 
     // First check if the flow is a new flow
-    if (flowItr == m_flowInfo.end ())
+    if (flowItr == 0)
     {
         // New flow
         struct PathInfo newPath;
-        if (Ipv4TLB::WhereToChange (destTor, newPath, false, 0))
+        if (Ipv4TLB::WhereToChange (destTor, newPath, false, 0, m_judgedPaths))
         {
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, false, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            Ipv4TLB::NotifyPathSelect (flowId, sourceTor, destTor, newPath, false, m_judgedPaths);
         }
         else
         {
             newPath = Ipv4TLB::SelectRandomPath (destTor);
-            m_pathSelectTrace (flowId, sourceTor, destTor, newPath.pathId, true, newPath, Ipv4TLB::GatherParallelPaths (destTor));
+            Ipv4TLB::NotifyPathSelect (flowId, sourceTor, destTor, newPath, true, m_judgedPaths);
         }
         Ipv4TLB::UpdateFlowPath (flowId, newPath.pathId, destTor);
         Ipv4TLB::AssignFlowToPath (flowId, destTor, newPath.pathId);
@@ -344,22 +375,22 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     }
     else if (m_rerouteEnable)
     {
-        Time flowActiveTime = (flowItr->second).activeTime;
-        (flowItr->second).activeTime = Simulator::Now ();
+        Time flowActiveTime = flowItr->activeTime;
+        flowItr->activeTime = Simulator::Now ();
 
         // Old flow
-        uint32_t oldPath = (flowItr->second).path;
+        uint32_t oldPath = flowItr->path;
         struct PathInfo oldPathInfo = Ipv4TLB::JudgePath (destTor, oldPath);
         if (0 == 1
-                && ((flowItr->second).retransmissionSize > m_flowRetransVeryHigh
-                || (flowItr->second).timeoutCount >= 1))
+                && (flowItr->retransmissionSize > m_flowRetransVeryHigh
+                || flowItr->timeoutCount >= 1))
         {
             struct PathInfo newPath;
-            if (Ipv4TLB::WhereToChange (destTor, newPath, true, oldPath))
+            if (Ipv4TLB::WhereToChange (destTor, newPath, true, oldPath, m_judgedPaths))
             {
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                    Ipv4TLB::NotifyPathChange (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, m_judgedPaths);
                 }
             }
             else
@@ -367,7 +398,7 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
                 newPath = Ipv4TLB::SelectRandomPath (destTor);
                 if (newPath.pathId != oldPath)
                 {
-                    m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, Ipv4TLB::GatherParallelPaths (destTor));
+                    Ipv4TLB::NotifyPathChange (flowId, sourceTor, destTor, newPath.pathId, oldPath, true, m_judgedPaths);
                 }
             }
 
@@ -383,31 +414,32 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
         }
         else if ((oldPathInfo.pathType == BadPath || Simulator::Now () - flowActiveTime > m_flowletTimeout) // Trigger for rerouting
                 && oldPathInfo.quantifiedDre <= m_dreMultiply * 8  // TODO To be fixed
-                && (flowItr->second).size >= m_S
-                /*&& ((static_cast<double> ((flowItr->second).ecnSize) / (flowItr->second).size > m_ecnPortionHigh && Simulator::Now () - (flowItr->second).timeStamp >= m_T) || (flowItr->second).retransmissionSize > m_flowRetransHigh)*/
-                && Simulator::Now() - (flowItr->second).tryChangePath > MicroSeconds (100))
+                && flowItr->size >= m_S
+                /*&& ((static_cast<double> (flowItr->ecnSize) / flowItr->size > m_ecnPortionHigh && Simulator::Now () - flowItr->timeStamp >= m_T) || flowItr->retransmissionSize > m_flowRetransHigh)*/
+                && Simulator::Now() - flowItr->tryChangePath > MicroSeconds (100))
         {
-            if (rand () % RANDOM_BASE < static_cast<int> (RANDOM_BASE - m_pathChangePoss))
+            if (m_rand->GetInteger (0, RANDOM_BASE - 1) + m_pathChangePoss < RANDOM_BASE)
             {
-                (flowItr->second).tryChangePath = Simulator::Now ();
+                flowItr->tryChangePath = Simulator::Now ();
                 return oldPath;
             }
             struct PathInfo newPath;
-            if (Ipv4TLB::WhereToChange (destTor, newPath, true, oldPath))
+            if (Ipv4TLB::WhereToChange (destTor, newPath, true, oldPath, m_judgedPaths))
             {
                 if (newPath.pathId == oldPath)
                 {
                     return oldPath;
                 }
 
-                m_pathChangeTrace (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, Ipv4TLB::GatherParallelPaths (destTor));
+                Ipv4TLB::NotifyPathChange (flowId, sourceTor, destTor, newPath.pathId, oldPath, false, m_judgedPaths);
+
+                // Change path
+                Ipv4TLB::UpdateFlowPath (flowId, newPath.pathId, destTor);
 
                 // Calculate the pause time
                 Time pauseTime = oldPathInfo.rttMin - newPath.rttMin;
-                m_pauseTime[flowId] = std::max (pauseTime, MicroSeconds (1));
+                flowItr->pauseTime = std::max (pauseTime, MicroSeconds (1));
 
-                // Change path
-                Ipv4TLB::UpdateFlowPath (flowId, newPath.pathId, destTor);
                 Ipv4TLB::RemoveFlowFromPath (flowId, destTor, oldPath);
                 Ipv4TLB::AssignFlowToPath (flowId, destTor, newPath.pathId);
                 return newPath.pathId;
@@ -425,9 +457,9 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
     }
     else
     {
-        (flowItr->second).activeTime = Simulator::Now ();
+        flowItr->activeTime = Simulator::Now ();
 
-        uint32_t oldPath = (flowItr->second).path;
+        uint32_t oldPath = flowItr->path;
         return oldPath;
     }
 }
@@ -435,12 +467,12 @@ Ipv4TLB::GetPath (uint32_t flowId, Ipv4Address saddr, Ipv4Address daddr)
 Time
 Ipv4TLB::GetPauseTime (uint32_t flowId)
 {
-   std::map<uint32_t, Time>::iterator itr = m_pauseTime.find (flowId);
-   if (itr == m_pauseTime.end ())
+   TLBFlowInfo *flowInfo = m_flowInfo.Find (flowId);
+   if (flowInfo == 0)
    {
         return MicroSeconds (0);
    }
-   return itr->second;
+   return flowInfo->pauseTime;
 }
 
 void
@@ -523,14 +555,15 @@ Ipv4TLB::FlowFinish (uint32_t flowId, Ipv4Address daddr)
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    TLBFlowInfo *flowInfo = m_flowInfo.Find (flowId);
+    if (flowInfo == 0)
     {
         NS_LOG_ERROR ("Cannot finish a non-existing flow");
         return;
     }
 
-    Ipv4TLB::RemoveFlowFromPath (flowId, destTor, (itr->second).path);
+    Ipv4TLB::RemoveFlowFromPath (flowId, destTor, flowInfo->path);
+    m_flowInfo.Remove (flowId);
 
 }
 
@@ -543,14 +576,8 @@ Ipv4TLB::ProbeSend (Ipv4Address daddr, uint32_t path)
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    if (itr == m_pathInfo.end ())
-    {
-        m_pathInfo[key] = Ipv4TLB::GetInitPathInfo (path);
-    }
-
+    bool isNew;
+    Ipv4TLB::InsertPathInfo (destTor, path, isNew);
 }
 
 void
@@ -568,14 +595,15 @@ Ipv4TLB::ProbeRecv (uint32_t path, Ipv4Address daddr, uint32_t size, bool withEC
 
 void
 Ipv4TLB::ProbeTimeout (uint32_t path, Ipv4Address daddr)
-{   uint32_t destTor = 0;
+{
+    uint32_t destTor = 0;
     if (!Ipv4TLB::FindTorId (daddr, destTor))
     {
         NS_LOG_ERROR ("Cannot find dest tor id based on the given dest address");
         return;
     }
 
-    Ipv4TLB::TimeoutPath (path, destTor, true, false);
+    Ipv4TLB::TimeoutPath (destTor, path, true, false);
 }
 
 
@@ -605,34 +633,34 @@ Ipv4TLB::PacketReceive (uint32_t flowId, uint32_t path, uint32_t destTorId,
 bool
 Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool withECN, Time rtt)
 {
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    TLBFlowInfo *itr = m_flowInfo.Find (flowId);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot update info for a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    if (itr->path != path)
     {
         return false;
     }
-    (itr->second).size += size;
+    itr->size += size;
     if (withECN)
     {
-        (itr->second).ecnSize += size;
+        itr->ecnSize += size;
     }
-    (itr->second).liveTime = Simulator::Now ();
+    itr->liveTime = Simulator::Now ();
 
     // Added Dec 23rd
     /*
     if (m_isSmooth)
     {
-        (itr->second).rtt = (SMOOTH_BASE - m_smoothAlpha) * (itr->second).rtt / SMOOTH_BASE + m_smoothAlpha * rtt / SMOOTH_BASE;
+        itr->rtt = (SMOOTH_BASE - m_smoothAlpha) * itr->rtt / SMOOTH_BASE + m_smoothAlpha * rtt / SMOOTH_BASE;
     }
     else
     {
-        if (rtt < (itr->second).rtt)
+        if (rtt < itr->rtt)
         {
-            (itr->second).rtt = rtt;
+            itr->rtt = rtt;
         }
     }
     */
@@ -640,19 +668,19 @@ Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool wit
 
     // Added Jan 11st
     /*
-    (itr->second).epAckSize += size;
+    itr->epAckSize += size;
     if (withECN)
     {
-        (itr->second).epEcnSize += size;
+        itr->epEcnSize += size;
     }
-    if (Simulator::Now () - (itr->second).epTimeStamp > m_epCheckTime)
+    if (Simulator::Now () - itr->epTimeStamp > m_epCheckTime)
     {
-        double originalEcnPortion = (itr->second).epEcnPortion;
-        double newEcnPortition = static_cast<double> ((itr->second).epEcnSize) / (itr->second).epAckSize;
-        (itr->second).epAckSize = 1;
-        (itr->second).epEcnSize = 0;
-        (itr->second).epEcnPortion = m_epAlpha * originalEcnPortion + (1.0 - m_epAlpha) * newEcnPortition;
-        (itr->second).epTimeStamp = Simulator::Now ();
+        double originalEcnPortion = itr->epEcnPortion;
+        double newEcnPortition = static_cast<double> (itr->epEcnSize) / itr->epAckSize;
+        itr->epAckSize = 1;
+        itr->epEcnSize = 0;
+        itr->epEcnPortion = m_epAlpha * originalEcnPortion + (1.0 - m_epAlpha) * newEcnPortition;
+        itr->epTimeStamp = Simulator::Now ();
     }
     */
     // --
@@ -663,17 +691,11 @@ Ipv4TLB::UpdateFlowInfo (uint32_t flowId, uint32_t path, uint32_t size, bool wit
 void
 Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool withECN, Time rtt)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
-    {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
+    bool isNew;
+    TLBPathInfo &pathInfo = *Ipv4TLB::InsertPathInfo (destTor, path, isNew);
+    if (!isNew)
     {
-        pathInfo = itr->second;
+        Ipv4TLB::AgePathInfo (pathInfo);
     }
 
     pathInfo.size += size;
@@ -712,26 +734,24 @@ Ipv4TLB::UpdatePathInfo (uint32_t destTor, uint32_t path, uint32_t size, bool wi
     }
     */
     // --
-
-    m_pathInfo[key] = pathInfo;
 }
 
 bool
 Ipv4TLB::TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout)
 {
     isVeryTimeout = false;
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    TLBFlowInfo *itr = m_flowInfo.Find (flowId);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    if (itr->path != path)
     {
         return false;
     }
-    (itr->second).timeoutCount ++;
-    if ((itr->second).timeoutCount >= m_flowTimeoutCount)
+    itr->timeoutCount ++;
+    if (itr->timeoutCount >= m_flowTimeoutCount)
     {
         isVeryTimeout = true;
     }
@@ -741,33 +761,31 @@ Ipv4TLB::TimeoutFlow (uint32_t flowId, uint32_t path, bool &isVeryTimeout)
 bool
 Ipv4TLB::SendFlow (uint32_t flowId, uint32_t path, uint32_t size)
 {
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    TLBFlowInfo *itr = m_flowInfo.Find (flowId);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot retransmit a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    if (itr->path != path)
     {
         return false;
     }
-    (itr->second).sendSize += size;
+    itr->sendSize += size;
     return true;
 }
 
 void
 Ipv4TLB::SendPath (uint32_t destTor, uint32_t path, uint32_t size)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *pathInfo = Ipv4TLB::FindPathInfo (destTor, path);
+    if (pathInfo == 0)
     {
         NS_LOG_ERROR ("Cannot send a non-existing path");
         return;
     }
 
-    (itr->second).dreValue += size;
+    m_dre.Add (pathInfo->dre, Simulator::Now (), size);
 }
 
 bool
@@ -775,26 +793,26 @@ Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needR
 {
     needRetranPath = false;
     needHighRetransPath = false;
-    std::map<uint32_t, TLBFlowInfo>::iterator itr = m_flowInfo.find (flowId);
-    if (itr == m_flowInfo.end ())
+    TLBFlowInfo *itr = m_flowInfo.Find (flowId);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot retransmit a non-existing flow");
         return false;
     }
-    if ((itr->second).path != path)
+    if (itr->path != path)
     {
         return false;
     }
-    if (Simulator::Now () - (itr->second).timeStamp < MicroSeconds (1000))
+    if (Simulator::Now () - itr->timeStamp < MicroSeconds (1000))
     {
         return false;
     }
-    (itr->second).retransmissionSize += size;
-    if ((itr->second).retransmissionSize > m_flowRetransHigh)
+    itr->retransmissionSize += size;
+    if (itr->retransmissionSize > m_flowRetransHigh)
     {
         needRetranPath = true;
     }
-    if ((itr->second).retransmissionSize > m_flowRetransVeryHigh)
+    if (itr->retransmissionSize > m_flowRetransVeryHigh)
     {
         needHighRetransPath = true;
     }
@@ -805,48 +823,49 @@ Ipv4TLB::RetransFlow (uint32_t flowId, uint32_t path, uint32_t size, bool &needR
 void
 Ipv4TLB::TimeoutPath (uint32_t destTor, uint32_t path, bool isProbing, bool isVeryTimeout)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *itr = Ipv4TLB::FindPathInfo (destTor, path);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
+    Ipv4TLB::AgePathInfo (*itr);
     if (!isProbing)
     {
-        (itr->second).isTimeout = true;
+        itr->isTimeout = true;
         if (isVeryTimeout)
         {
-            (itr->second).isVeryTimeout = true;
+            itr->isVeryTimeout = true;
         }
     }
     else
     {
-        (itr->second).isProbingTimeout = true;
+        itr->isProbingTimeout = true;
     }
 }
 
 void
 Ipv4TLB::RetransPath (uint32_t destTor, uint32_t path, bool needHighRetransPath)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *itr = Ipv4TLB::FindPathInfo (destTor, path);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot timeout a non-existing path");
         return;
     }
-    (itr->second).isRetransmission = true;
+    Ipv4TLB::AgePathInfo (*itr);
+    itr->isRetransmission = true;
     if (needHighRetransPath)
     {
-        (itr->second).isHighRetransmission = true;
+        itr->isHighRetransmission = true;
     }
 }
 
 void
 Ipv4TLB::UpdateFlowPath (uint32_t flowId, uint32_t path, uint32_t destTor)
 {
-    TLBFlowInfo flowInfo;
+    TLBFlowInfo &flowInfo = m_flowInfo.Insert (flowId);
+    flowInfo.flowId = flowId;
     flowInfo.path = path;
     flowInfo.destTor = destTor;
     flowInfo.size = 0;
@@ -873,8 +892,7 @@ Ipv4TLB::UpdateFlowPath (uint32_t flowId, uint32_t path, uint32_t destTor)
 
     // Added Jan 12nd
     flowInfo.activeTime = Simulator::Now ();
-
-    m_flowInfo[flowId] = flowInfo;
+    flowInfo.pauseTime = Time ();
 }
 
 TLBPathInfo
@@ -895,7 +913,7 @@ Ipv4TLB::GetInitPathInfo (uint32_t path)
     pathInfo.timeStamp1 = Simulator::Now ();
     pathInfo.timeStamp2 = Simulator::Now ();
     pathInfo.timeStamp3 = Simulator::Now ();
-    pathInfo.dreValue = 0;
+    pathInfo.dre = DreRegister ();
 
     // Added Jan 11st
     // Path ECN portion default value
@@ -912,65 +930,64 @@ Ipv4TLB::GetInitPathInfo (uint32_t path)
 void
 Ipv4TLB::AssignFlowToPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-
-    TLBPathInfo pathInfo;
-    if (itr == m_pathInfo.end ())
-    {
-        pathInfo = Ipv4TLB::GetInitPathInfo (path);
-    }
-    else
+    bool isNew;
+    TLBPathInfo &pathInfo = *Ipv4TLB::InsertPathInfo (destTor, path, isNew);
+    if (!isNew)
     {
-        pathInfo = itr->second;
+        Ipv4TLB::AgePathInfo (pathInfo);
     }
 
     pathInfo.flowCounter ++;
-    m_pathInfo[key] = pathInfo;
 }
 
 void
 Ipv4TLB::RemoveFlowFromPath (uint32_t flowId, uint32_t destTor, uint32_t path)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair(destTor, path);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
-    if (itr == m_pathInfo.end ())
+    TLBPathInfo *itr = Ipv4TLB::FindPathInfo (destTor, path);
+    if (itr == 0)
     {
         NS_LOG_ERROR ("Cannot remove flow from a non-existing path");
         return;
     }
-    if ((itr->second).flowCounter == 0)
+    if (itr->flowCounter == 0)
     {
         NS_LOG_ERROR ("Cannot decrease from counter while it has reached 0");
         return;
     }
-    (itr->second).flowCounter --;
+    itr->flowCounter --;
 
 }
 
 bool
-Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, uint32_t oldPath)
+Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, uint32_t oldPath,
+                        std::vector<PathInfo> &paths)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
+    TLBDestTor *tor = Ipv4TLB::GetDestTor (destTor);
+    paths.clear ();
 
-    if (itr == m_availablePath.end ())
+    if (tor == 0 || tor->nAvailPaths == 0)
     {
         NS_LOG_ERROR ("Cannot find available paths");
         return false;
     }
 
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
+    // Judge every path once, the passes below only read the judgements
+    for (uint32_t slot = 0; slot < tor->nAvailPaths; ++slot)
+    {
+        paths.push_back (Ipv4TLB::JudgePathSlot (*tor, slot));
+    }
+    std::vector<PathInfo>::iterator vectorItr = paths.begin ();
 
     // Firstly, checking good path
     uint32_t minCounter = std::numeric_limits<uint32_t>::max ();
     Time minRTT = Seconds (666);
     uint32_t minRTTLevel = 5;
     uint32_t minDre = std::pow (2, m_dreQ);
-    std::vector<PathInfo> candidatePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    std::vector<PathInfo> &candidatePaths = m_candidatePaths;
+    candidatePaths.clear ();
+    for ( ; vectorItr != paths.end (); ++vectorItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        struct PathInfo pathInfo = *vectorItr;
         if (pathInfo.pathType == GoodPath)
         {
             if (m_runMode == TLB_RUNMODE_COUNTER)
@@ -1048,20 +1065,20 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
         {
             if (minCounter <= m_K)
             {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
+                newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
             }
         }
         else if (m_runMode == TLB_RUNMODE_MINRTT)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         else
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         NS_LOG_LOGIC ("Find Good Path: " << newPath.pathId);
         return true;
@@ -1086,11 +1103,10 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
     minRTT = Seconds (666);
     minDre = std::pow (2, m_dreQ);
     candidatePaths.clear ();
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    vectorItr = paths.begin ();
+    for ( ; vectorItr != paths.end (); ++vectorItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        struct PathInfo pathInfo = *vectorItr;
         if (pathInfo.pathType == GreyPath
             && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
         {
@@ -1169,32 +1185,31 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
         {
             if (minCounter <= m_K)
             {
-                newPath = candidatePaths[rand () % candidatePaths.size ()];
+                newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
             }
         }
         else if (m_runMode == TLB_RUNMODE_MINRTT)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         else if (m_runMode == TLB_RUNMODE_RTT_COUNTER || m_runMode == TLB_RUNMODE_RTT_DRE)
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
 
         else
         {
-            newPath = candidatePaths[rand () % candidatePaths.size ()];
+            newPath = candidatePaths[m_rand->GetInteger (0, candidatePaths.size () - 1)];
         }
         NS_LOG_LOGIC ("Find Grey Path: " << newPath.pathId);
         return true;
     }
 
    // Thirdly, checking bad path
-    vectorItr = (itr->second).begin ();
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    vectorItr = paths.begin ();
+    for ( ; vectorItr != paths.end (); ++vectorItr)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        struct PathInfo pathInfo = *vectorItr;
         if (pathInfo.pathType == BadPath
             && Ipv4TLB::PathLIsBetterR (pathInfo, originalPath))
         {
@@ -1212,9 +1227,9 @@ Ipv4TLB::WhereToChange (uint32_t destTor, PathInfo &newPath, bool hasOldPath, ui
 struct PathInfo
 Ipv4TLB::SelectRandomPath (uint32_t destTor)
 {
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
+    TLBDestTor *tor = Ipv4TLB::GetDestTor (destTor);
 
-    if (itr == m_availablePath.end ())
+    if (tor == 0 || tor->nAvailPaths == 0)
     {
         NS_LOG_ERROR ("Cannot find available paths");
         PathInfo pathInfo;
@@ -1222,12 +1237,11 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
         return pathInfo;
     }
 
-    std::vector<uint32_t>::iterator vectorItr = (itr->second).begin ();
-    std::vector<PathInfo> availablePaths;
-    for ( ; vectorItr != (itr->second).end (); ++vectorItr)
+    std::vector<PathInfo> &availablePaths = m_candidatePaths;
+    availablePaths.clear ();
+    for (uint32_t slot = 0; slot < tor->nAvailPaths; ++slot)
     {
-        uint32_t pathId = *vectorItr;
-        struct PathInfo pathInfo = JudgePath (destTor, pathId);
+        struct PathInfo pathInfo = Ipv4TLB::JudgePathSlot (*tor, slot);
         if (pathInfo.pathType == GoodPath || pathInfo.pathType == GreyPath || pathInfo.pathType == BadPath)
         {
             availablePaths.push_back (pathInfo);
@@ -1237,12 +1251,11 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
     struct PathInfo newPath;
     if (!availablePaths.empty ())
     {
-        newPath = availablePaths[rand() % availablePaths.size ()];
+        newPath = availablePaths[m_rand->GetInteger (0, availablePaths.size () - 1)];
     }
     else
     {
-        uint32_t pathId = (itr->second)[rand() % (itr->second).size ()];
-        newPath = Ipv4TLB::JudgePath (destTor, pathId);
+        newPath = Ipv4TLB::JudgePathSlot (*tor, m_rand->GetInteger (0, tor->nAvailPaths - 1));
     }
     NS_LOG_LOGIC ("Random selection return path: " << newPath.pathId);
     return newPath;
@@ -1251,12 +1264,30 @@ Ipv4TLB::SelectRandomPath (uint32_t destTor)
 struct PathInfo
 Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
 {
-    std::pair<uint32_t, uint32_t> key = std::make_pair (destTor, pathId);
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.find (key);
+    TLBDestTor *tor = Ipv4TLB::GetDestTor (destTor);
+    uint32_t slot = tor == 0 ? 0 : Ipv4TLB::FindPathSlot (*tor, pathId);
+    if (tor != 0 && slot < tor->pathIds.size ())
+    {
+        return Ipv4TLB::JudgePathSlot (*tor, slot);
+    }
 
     struct PathInfo path;
     path.pathId = pathId;
-    if (itr == m_pathInfo.end ())
+    path.pathType = GreyPath;
+    path.rttMin = m_minRtt;
+    path.size = 0;
+    path.ecnPortion = 0.3;
+    path.counter = 0;
+    path.quantifiedDre = 0;
+    return path;
+}
+
+struct PathInfo
+Ipv4TLB::JudgePathSlot (TLBDestTor &tor, uint32_t slot)
+{
+    struct PathInfo path;
+    path.pathId = tor.pathIds[slot];
+    if (!tor.hasPathInfo[slot])
     {
         path.pathType = GreyPath;
         /*path.pathType = GoodPath;*/
@@ -1268,12 +1299,13 @@ Ipv4TLB::JudgePath (uint32_t destTor, uint32_t pathId)
         path.quantifiedDre = 0;
         return path;
     }
-    TLBPathInfo pathInfo = itr->second;
+    TLBPathInfo &pathInfo = tor.pathInfo[slot];
+    Ipv4TLB::AgePathInfo (pathInfo);
     path.rttMin = pathInfo.minRtt;
     path.size = pathInfo.size;
     path.ecnPortion = static_cast<double>(pathInfo.ecnSize) / pathInfo.size;
     path.counter = pathInfo.flowCounter;
-    path.quantifiedDre = Ipv4TLB::QuantifyDre (pathInfo.dreValue);
+    path.quantifiedDre = Ipv4TLB::QuantifyDre (m_dre.Get (pathInfo.dre, Simulator::Now ()));
     if ((pathInfo.minRtt < m_minRtt
             && (pathInfo.size > m_ecnSampleMin && static_cast<double>(pathInfo.ecnSize) / pathInfo.size < m_ecnPortionLow))
             && (pathInfo.isRetransmission) == false
@@ -1325,133 +1357,258 @@ Ipv4TLB::FindTorId (Ipv4Address daddr, uint32_t &destTorId)
 {
     std::map<Ipv4Address, uint32_t>::iterator torItr = m_ipTorMap.find (daddr);
 
-    if (torItr == m_ipTorMap.end ())
+    if (torItr != m_ipTorMap.end ())
     {
-        return false;
+        destTorId = torItr->second;
+        return true;
     }
-    destTorId = torItr->second;
-    return true;
+    return m_torDirectory != 0 && m_torDirectory->FindTor (daddr, destTorId);
 }
 
-void
-Ipv4TLB::PathAging (void)
+TLBDestTor *
+Ipv4TLB::GetDestTor (uint32_t destTor)
 {
-    NS_LOG_LOGIC (this << " Path Info: " << (Simulator::Now ()));
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
-    {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        NS_LOG_LOGIC ("\t" << " Size: " << (itr->second).size
-                           << " ECN Size: " << (itr->second).ecnSize
-                           << " Min RTT: " << (itr->second).minRtt
-                           << " Is Retransmission: " << (itr->second).isRetransmission
-                           << " Is HRetransmission: " << (itr->second).isHighRetransmission
-                           << " Is Timeout: " << (itr->second).isTimeout
-                           << " Is VTimeout: " << (itr->second).isVeryTimeout
-                           << " Is ProbingTimeout: " << (itr->second).isProbingTimeout
-                           << " Flow Counter: " << (itr->second).flowCounter);
-        if (Simulator::Now() - (itr->second).timeStamp1 > m_T1)
-        {
-            (itr->second).size = 1;
-            (itr->second).ecnSize = 0;
-            (itr->second).isTimeout = false;
-            (itr->second).timeStamp1 = Simulator::Now ();
-        }
-        if (Simulator::Now () - (itr->second).timeStamp2 > m_T2)
+    if (destTor >= m_destTors.size ())
+    {
+        return 0;
+    }
+    return &m_destTors[destTor];
+}
+
+uint32_t
+Ipv4TLB::FindPathSlot (const TLBDestTor &tor, uint32_t path)
+{
+    uint32_t nPaths = tor.pathIds.size ();
+    for (uint32_t slot = 0; slot < nPaths; ++slot)
+    {
+        if (tor.pathIds[slot] == path)
         {
-            (itr->second).isRetransmission = false;
-            (itr->second).isHighRetransmission = false;
-            (itr->second).isVeryTimeout = false;
-            (itr->second).isProbingTimeout = false;
-            (itr->second).timeStamp2 = Simulator::Now ();
+            return slot;
         }
-        if (Simulator::Now () - (itr->second).timeStamp3 > m_T1)
+    }
+    return nPaths;
+}
+
+TLBPathInfo *
+Ipv4TLB::FindPathInfo (uint32_t destTor, uint32_t path)
+{
+    TLBDestTor *tor = Ipv4TLB::GetDestTor (destTor);
+    if (tor == 0)
+    {
+        return 0;
+    }
+    uint32_t slot = Ipv4TLB::FindPathSlot (*tor, path);
+    if (slot == tor->pathIds.size () || !tor->hasPathInfo[slot])
+    {
+        return 0;
+    }
+    return &tor->pathInfo[slot];
+}
+
+TLBPathInfo *
+Ipv4TLB::InsertPathInfo (uint32_t destTor, uint32_t path, bool &isNew)
+{
+    if (destTor >= m_destTors.size ())
+    {
+        m_destTors.resize (destTor + 1);
+    }
+    TLBDestTor &tor = m_destTors[destTor];
+    uint32_t slot = Ipv4TLB::FindPathSlot (tor, path);
+    if (slot == tor.pathIds.size ())
+    {
+        // Feedback on a path that is not available, give it a slot anyway
+        tor.pathIds.push_back (path);
+        tor.hasPathInfo.push_back (0);
+        tor.pathInfo.push_back (TLBPathInfo ());
+    }
+    isNew = !tor.hasPathInfo[slot];
+    if (isNew)
+    {
+        tor.pathInfo[slot] = Ipv4TLB::GetInitPathInfo (path);
+        tor.hasPathInfo[slot] = 1;
+    }
+    return &tor.pathInfo[slot];
+}
+
+void
+Ipv4TLB::AgePathInfo (TLBPathInfo &pathInfo)
+{
+    Time now = Simulator::Now ();
+    if (now - pathInfo.timeStamp1 > m_T1)
+    {
+        pathInfo.size = 1;
+        pathInfo.ecnSize = 0;
+        pathInfo.isTimeout = false;
+        pathInfo.timeStamp1 = now;
+    }
+    if (now - pathInfo.timeStamp2 > m_T2)
+    {
+        pathInfo.isRetransmission = false;
+        pathInfo.isHighRetransmission = false;
+        pathInfo.isVeryTimeout = false;
+        pathInfo.isProbingTimeout = false;
+        pathInfo.timeStamp2 = now;
+    }
+    if (now - pathInfo.timeStamp3 > m_T1)
+    {
+        if (m_isSmooth)
         {
-            if (m_isSmooth)
+            // Apply at once the smoothing steps of the T1 periods the path went
+            // without RTT sample, each moving the RTT by a factor beta towards
+            // the desired value, on which it settles
+            Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
+            int64_t steps = ((now - pathInfo.timeStamp3).GetTimeStep () - 1) / m_T1.GetTimeStep ();
+            double desired = desiredRtt.GetTimeStep ();
+            double rtt = pathInfo.minRtt.GetTimeStep ();
+            if (rtt < desired)
             {
-                Time desiredRtt = m_minRtt * m_smoothDesired / SMOOTH_BASE;
-                if ((itr->second).minRtt < desiredRtt)
-                {
-                    (itr->second).minRtt = std::min (desiredRtt, (itr->second).minRtt * m_smoothBeta1 / SMOOTH_BASE);
-                }
-                else
-                {
-                    (itr->second).minRtt = std::max (desiredRtt, (itr->second).minRtt * m_smoothBeta2 / SMOOTH_BASE);
-                }
+                rtt = std::min (desired, rtt * std::pow (m_smoothBeta1 / (double) SMOOTH_BASE, (double) steps));
             }
             else
             {
-                (itr->second).minRtt = Seconds (666);
+                rtt = std::max (desired, rtt * std::pow (m_smoothBeta2 / (double) SMOOTH_BASE, (double) steps));
             }
-            (itr->second).timeStamp3 = Simulator::Now ();
+            pathInfo.minRtt = Time (rtt);
         }
-
-        /*
-        if (Simulator::Now () - (itr->second).epTimeStamp > m_epAgingTime)
+        else
         {
-            (itr->second).epAckSize = 1;
-            (itr->second).epEcnSize = 0;
-            (itr->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr->second).epTimeStamp = Simulator::Now ();
+            pathInfo.minRtt = Seconds (666);
         }
-        */
+        pathInfo.timeStamp3 = now;
+    }
+    NS_LOG_LOGIC ("Path: " << pathInfo.pathId
+                           << " Size: " << pathInfo.size
+                           << " ECN Size: " << pathInfo.ecnSize
+                           << " Min RTT: " << pathInfo.minRtt
+                           << " Is Retransmission: " << pathInfo.isRetransmission
+                           << " Is HRetransmission: " << pathInfo.isHighRetransmission
+                           << " Is Timeout: " << pathInfo.isTimeout
+                           << " Is VTimeout: " << pathInfo.isVeryTimeout
+                           << " Is ProbingTimeout: " << pathInfo.isProbingTimeout
+                           << " Flow Counter: " << pathInfo.flowCounter);
+}
+
+void
+Ipv4TLB::AgeFlows (void)
+{
+    Time now = Simulator::Now ();
+    if (now - m_lastFlowAging < m_agingCheckTime)
+    {
+        return;
     }
+    m_lastFlowAging = now;
 
-    std::map<uint32_t, TLBFlowInfo>::iterator itr2 = m_flowInfo.begin ();
-    for ( ; itr2 != m_flowInfo.end (); ++itr2)
+    for (uint32_t slot = 0; slot < m_flowInfo.GetNSlots (); ++slot)
     {
-        if (Simulator::Now () - (itr2->second).liveTime >= m_flowDieTime)
+        if (!m_flowInfo.IsUsed (slot))
         {
-            Ipv4TLB::RemoveFlowFromPath ((itr2->second).flowId, (itr2->second).destTor, (itr2->second).path);
-            m_flowInfo.erase (itr2);
+            continue;
         }
+        TLBFlowInfo &flowInfo = m_flowInfo.GetValue (slot);
+        if (now - flowInfo.liveTime >= m_flowDieTime)
+        {
+            Ipv4TLB::RemoveFlowFromPath (flowInfo.flowId, flowInfo.destTor, flowInfo.path);
+            m_flowInfo.Remove (flowInfo.flowId);
+        }
+    }
 
-        /*
-        else if (Simulator::Now () - (itr2->second).epTimeStamp > m_epAgingTime)
+    for (uint32_t slot = 0; slot < m_acklets.GetNSlots (); ++slot)
+    {
+        if (m_acklets.IsUsed (slot)
+            && now - m_acklets.GetValue (slot).activeTime >= m_ackletDieTime)
         {
-            (itr2->second).epAckSize = 1;
-            (itr2->second).epEcnSize = 0;
-            (itr2->second).epEcnPortion = m_epDefaultEcnPortion;
-            (itr2->second).epTimeStamp = Simulator::Now ();
+            m_acklets.Remove (m_acklets.GetFlowId (slot));
         }
-        */
     }
+}
 
-    m_agingEvent = Simulator::Schedule (m_agingCheckTime, &Ipv4TLB::PathAging, this);
+void
+Ipv4TLB::SetDecisionLog (Ptr<TLBDecisionLog> log)
+{
+    m_decisionLog = log;
 }
 
-std::vector<PathInfo>
-Ipv4TLB::GatherParallelPaths (uint32_t destTor)
+int64_t
+Ipv4TLB::AssignStreams (int64_t stream)
 {
-    std::vector<PathInfo> paths;
+    NS_LOG_FUNCTION (this << stream);
+    m_rand->SetStream (stream);
+    return 1;
+}
 
-    std::map<uint32_t, std::vector<uint32_t> >::iterator itr = m_availablePath.find (destTor);
-    if (itr == m_availablePath.end ())
+void
+Ipv4TLB::NotifyPathSelect (uint32_t flowId, uint32_t fromTor, uint32_t toTor, const PathInfo &newPath, bool isRandom,
+                           const std::vector<PathInfo> &judgedPaths)
+{
+    // The parallel paths are only gathered for a connected sink
+    if (!m_pathSelectTrace.IsEmpty ())
     {
-        return paths;
+        m_pathSelectTrace (flowId, fromTor, toTor, newPath.pathId, isRandom, newPath, Ipv4TLB::GatherParallelPaths (toTor));
     }
-
-    std::vector<uint32_t>::iterator innerItr = (itr->second).begin ();
-    for ( ; innerItr != (itr->second).end (); ++innerItr )
+    if (m_decisionLog != 0)
     {
-        paths.push_back(Ipv4TLB::JudgePath ((itr->first), *innerItr));
+        Ipv4TLB::RecordDecision (flowId, fromTor, toTor, newPath.pathId, 0, isRandom, true, judgedPaths);
     }
+}
 
-    return paths;
+void
+Ipv4TLB::NotifyPathChange (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t newPath, uint32_t oldPath, bool isRandom,
+                           const std::vector<PathInfo> &judgedPaths)
+{
+    if (!m_pathChangeTrace.IsEmpty ())
+    {
+        m_pathChangeTrace (flowId, fromTor, toTor, newPath, oldPath, isRandom, Ipv4TLB::GatherParallelPaths (toTor));
+    }
+    if (m_decisionLog != 0)
+    {
+        Ipv4TLB::RecordDecision (flowId, fromTor, toTor, newPath, oldPath, isRandom, false, judgedPaths);
+    }
 }
 
 void
-Ipv4TLB::DreAging (void)
+Ipv4TLB::RecordDecision (uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+                         uint32_t newPath, uint32_t oldPath, bool isRandom, bool isNewFlow,
+                         const std::vector<PathInfo> &judgedPaths)
+{
+    TLBDecisionRecord record;
+    std::memset (&record, 0, sizeof (record));
+    record.timeNs = Simulator::Now ().GetNanoSeconds ();
+    record.nodeId = m_node != 0 ? m_node->GetId () : 0;
+    record.flowId = flowId;
+    record.fromTor = fromTor;
+    record.toTor = toTor;
+    record.newPath = newPath;
+    record.oldPath = oldPath;
+    record.isRandom = isRandom;
+    record.isNewFlow = isNewFlow;
+
+    uint32_t nPaths = std::min<uint32_t> (judgedPaths.size (), 32);
+    for (uint32_t i = 0; i < nPaths; ++i)
+    {
+        record.pathTypes |= static_cast<uint64_t> (judgedPaths[i].pathType) << (2 * i);
+    }
+    record.nPaths = std::min<uint32_t> (judgedPaths.size (), 255);
+
+    m_decisionLog->Record (record);
+}
+
+std::vector<PathInfo>
+Ipv4TLB::GatherParallelPaths (uint32_t destTor)
 {
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo>::iterator itr = m_pathInfo.begin ();
-    for ( ; itr != m_pathInfo.end (); ++itr)
+    std::vector<PathInfo> paths;
+
+    TLBDestTor *tor = Ipv4TLB::GetDestTor (destTor);
+    if (tor == 0)
     {
-        NS_LOG_LOGIC ("<" << (itr->first).first << "," << (itr->first).second << ">");
-        (itr->second).dreValue *= (1 - m_dreAlpha);
-        NS_LOG_LOGIC ("\tDre value :" << Ipv4TLB::QuantifyDre ((itr->second).dreValue));
+        return paths;
     }
 
-    m_dreEvent = Simulator::Schedule (m_dreTime, &Ipv4TLB::DreAging, this);
+    for (uint32_t slot = 0; slot < tor->nAvailPaths; ++slot)
+    {
+        paths.push_back (Ipv4TLB::JudgePathSlot (*tor, slot));
+    }
+
+    return paths;
 }
 
 uint32_t
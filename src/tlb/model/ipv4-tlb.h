@@ -8,8 +8,12 @@
 #include "ns3/ipv4-address.h"
 #include "ns3/data-rate.h"
 #include "ns3/event-id.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/tor-directory.h"
 #include "tlb-flow-info.h"
 #include "tlb-path-info.h"
+#include "tlb-flow-table.h"
+#include "tlb-decision-log.h"
 
 #include <vector>
 #include <map>
@@ -46,6 +50,17 @@ struct TLBAcklet {
     Time activeTime;
 };
 
+// Path state towards one destination ToR, indexed by a dense path slot
+// The first nAvailPaths slots are the available paths, in the order they were
+// added, the other ones are paths that only got feedback (e.g. probes)
+struct TLBDestTor {
+    TLBDestTor () : nAvailPaths (0) {}
+    uint32_t nAvailPaths;
+    std::vector<uint32_t> pathIds;
+    std::vector<uint8_t> hasPathInfo;
+    std::vector<TLBPathInfo> pathInfo;
+};
+
 class Node;
 
 class Ipv4TLB : public Object
@@ -61,6 +76,10 @@ public:
 
     void AddAddressWithTor (Ipv4Address address, uint32_t torId);
 
+    // Find the ToR of the addresses added one by one first, the directory
+    // is the fallback
+    void SetTorDirectory (Ptr<const TorDirectory> directory);
+
     void AddAvailPath (uint32_t destTor, uint32_t path);
 
     std::vector<uint32_t> GetAvailPath (Ipv4Address daddr);
@@ -90,6 +109,12 @@ public:
     // Node
     void SetNode (Ptr<Node> node);
 
+    // Record the path decisions, 0 to stop recording
+    void SetDecisionLog (Ptr<TLBDecisionLog> log);
+
+    // Use a fixed stream for the random path choices, returns 1
+    int64_t AssignStreams (int64_t stream);
+
     static std::string GetPathType (PathType type);
 
     static std::string GetLogo (void);
@@ -123,22 +148,50 @@ private:
 
     void RemoveFlowFromPath (uint32_t flowId, uint32_t destTor, uint32_t path);
 
-    bool WhereToChange (uint32_t destTor, struct PathInfo &newPath, bool hasOldPath, uint32_t oldPath);
+    // Judge every path towards destTor into judgedPaths and pick the new one
+    bool WhereToChange (uint32_t destTor, struct PathInfo &newPath, bool hasOldPath, uint32_t oldPath,
+                        std::vector<PathInfo> &judgedPaths);
 
     struct PathInfo SelectRandomPath (uint32_t destTor);
 
     struct PathInfo JudgePath (uint32_t destTor, uint32_t path);
 
+    struct PathInfo JudgePathSlot (TLBDestTor &tor, uint32_t slot);
+
     bool PathLIsBetterR (struct PathInfo pathL, struct PathInfo pathR);
 
     bool FindTorId (Ipv4Address daddr, uint32_t &destTorId);
 
-    void PathAging (void);
+    TLBDestTor *GetDestTor (uint32_t destTor);
+
+    // Returns the path slot, the number of slots if the path has none
+    static uint32_t FindPathSlot (const TLBDestTor &tor, uint32_t path);
+
+    // Returns the state of the path, 0 if the path has not been used yet
+    TLBPathInfo *FindPathInfo (uint32_t destTor, uint32_t path);
 
-    void DreAging (void);
+    // Returns the state of the path, initialized if the path had none
+    TLBPathInfo *InsertPathInfo (uint32_t destTor, uint32_t path, bool &isNew);
+
+    // Reset the path statistics that went stale since the last access
+    void AgePathInfo (TLBPathInfo &pathInfo);
+
+    // Drop the dead flows, at most once every aging check time
+    void AgeFlows (void);
 
     std::vector<PathInfo> GatherParallelPaths (uint32_t destTor);
 
+    // judgedPaths are the paths towards toTor judged for this decision
+    void NotifyPathSelect (uint32_t flowId, uint32_t fromTor, uint32_t toTor, const PathInfo &newPath, bool isRandom,
+                           const std::vector<PathInfo> &judgedPaths);
+
+    void NotifyPathChange (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t newPath, uint32_t oldPath, bool isRandom,
+                           const std::vector<PathInfo> &judgedPaths);
+
+    void RecordDecision (uint32_t flowId, uint32_t fromTor, uint32_t toTor,
+                         uint32_t newPath, uint32_t oldPath, bool isRandom, bool isNewFlow,
+                         const std::vector<PathInfo> &judgedPaths);
+
     uint32_t QuantifyRtt (Time rtt);
     uint32_t QuantifyDre (uint32_t dre);
 
@@ -215,25 +268,33 @@ private:
     Time m_flowletTimeout;
     // --
 
+    Time m_ackletDieTime; // Idle acklets are dropped after this time
+
     // Variables
-    std::map<uint32_t, TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
-    std::map<std::pair<uint32_t, uint32_t>, TLBPathInfo> m_pathInfo; /* <DestTorId, PathId>, TLBPathInfo> */
+    TLBFlowTable<TLBFlowInfo> m_flowInfo; /* <FlowId, TLBFlowInfo> */
 
-    std::map<uint32_t, TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
+    std::vector<TLBDestTor> m_destTors; /* <DestTorId, paths and TLBPathInfo> */
 
+    TLBFlowTable<TLBAcklet> m_acklets; /* <FlowId, TLBAcklet> */
+
+    Ptr<const TorDirectory> m_torDirectory;
     std::map<Ipv4Address, uint32_t> m_ipTorMap; /* <DestAddress, DestTorId> */
 
-    std::map<uint32_t, std::vector<uint32_t> > m_availablePath; /* <DestTorId, List<PathId>> */
+    // Scratch space of the path selection
+    std::vector<PathInfo> m_judgedPaths;
+    std::vector<PathInfo> m_candidatePaths;
 
     std::map<uint32_t, Ipv4Address> m_probingAgent; /* <DestTorId, ProbingAgentAddress>*/
 
-    EventId m_agingEvent;
+    Time m_lastFlowAging;
 
-    EventId m_dreEvent;
+    LazyDre m_dre;
 
     Ptr<Node> m_node;
 
-    std::map<uint32_t, Time> m_pauseTime; // Used in the TCP pause, not mandatory
+    Ptr<TLBDecisionLog> m_decisionLog;
+
+    Ptr<UniformRandomVariable> m_rand;
 
     typedef void (* TLBPathCallback) (uint32_t flowId, uint32_t fromTor,
             uint32_t toTor, uint32_t path, bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
@@ -1,7 +1,10 @@
 #include "ns3/tcp-tlb-tag.h"
+#include "ns3/packet-tag-slots.h"
 
 namespace ns3 {
 
+NS_PACKET_TAG_SLOT (TcpTLBTag);
+
 TypeId
 TcpTLBTag::GetTypeId (void)
 {
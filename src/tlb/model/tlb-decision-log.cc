@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "tlb-decision-log.h"
+
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/core-config.h"
+
+#ifdef HAVE_PTHREAD_H
+#include "ns3/system-mutex.h"
+#endif
+
+#include <cstdio>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("TLBDecisionLog");
+
+const char TLBDecisionLog::MAGIC[8] = {'N', 'S', '3', 'T', 'L', 'B', 'D', '1'};
+
+TLBDecisionLog::TLBDecisionLog (uint32_t capacity)
+    : m_records (capacity),
+      m_next (0),
+      m_total (0),
+      m_mutex (0)
+{
+    NS_ASSERT (capacity > 0);
+#ifdef HAVE_PTHREAD_H
+    m_mutex = new SystemMutex ();
+#endif
+}
+
+TLBDecisionLog::~TLBDecisionLog ()
+{
+#ifdef HAVE_PTHREAD_H
+    delete m_mutex;
+#endif
+}
+
+void
+TLBDecisionLog::Record (const TLBDecisionRecord &record)
+{
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (*m_mutex);
+#endif
+    m_records[m_next] = record;
+    m_next = m_next + 1 == m_records.size () ? 0 : m_next + 1;
+    m_total++;
+}
+
+uint32_t
+TLBDecisionLog::GetCapacity (void) const
+{
+    return m_records.size ();
+}
+
+uint32_t
+TLBDecisionLog::GetNRecords (void) const
+{
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (*m_mutex);
+#endif
+    return m_total < m_records.size () ? m_total : m_records.size ();
+}
+
+uint64_t
+TLBDecisionLog::GetNTotal (void) const
+{
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (*m_mutex);
+#endif
+    return m_total;
+}
+
+void
+TLBDecisionLog::GetRecords (std::vector<TLBDecisionRecord> &records) const
+{
+#ifdef HAVE_PTHREAD_H
+    CriticalSection cs (*m_mutex);
+#endif
+    CopyRecords (records);
+}
+
+void
+TLBDecisionLog::CopyRecords (std::vector<TLBDecisionRecord> &records) const
+{
+    if (m_total > m_records.size ())
+    {
+        // The ring wrapped, the oldest record is the next one to be overwritten
+        records.insert (records.end (), m_records.begin () + m_next, m_records.end ());
+    }
+    records.insert (records.end (), m_records.begin (), m_records.begin () + m_next);
+}
+
+bool
+TLBDecisionLog::Write (const std::string &filename) const
+{
+    std::FILE *file = std::fopen (filename.c_str (), "wb");
+    if (file == 0)
+    {
+        NS_LOG_ERROR ("Cannot open " << filename);
+        return false;
+    }
+
+    std::vector<TLBDecisionRecord> records;
+    uint64_t total;
+    {
+#ifdef HAVE_PTHREAD_H
+        CriticalSection cs (*m_mutex);
+#endif
+        CopyRecords (records);
+        total = m_total;
+    }
+    uint32_t recordSize = sizeof (TLBDecisionRecord);
+    uint32_t count = records.size ();
+    uint64_t overwritten = total - count;
+
+    bool ok = std::fwrite (MAGIC, sizeof (MAGIC), 1, file) == 1
+        && std::fwrite (&recordSize, sizeof (recordSize), 1, file) == 1
+        && std::fwrite (&count, sizeof (count), 1, file) == 1
+        && std::fwrite (&overwritten, sizeof (overwritten), 1, file) == 1
+        && (count == 0 || std::fwrite (&records[0], recordSize, count, file) == count);
+    ok = std::fclose (file) == 0 && ok;
+    if (!ok)
+    {
+        NS_LOG_ERROR ("Cannot write " << filename);
+    }
+    return ok;
+}
+
+bool
+TLBDecisionLog::Read (const std::string &filename, std::vector<TLBDecisionRecord> &records)
+{
+    std::FILE *file = std::fopen (filename.c_str (), "rb");
+    if (file == 0)
+    {
+        return false;
+    }
+
+    char magic[8];
+    uint32_t recordSize = 0;
+    uint32_t count = 0;
+    uint64_t overwritten = 0;
+    bool ok = std::fread (magic, sizeof (magic), 1, file) == 1
+        && std::memcmp (magic, MAGIC, sizeof (magic)) == 0
+        && std::fread (&recordSize, sizeof (recordSize), 1, file) == 1
+        && recordSize == sizeof (TLBDecisionRecord)
+        && std::fread (&count, sizeof (count), 1, file) == 1
+        && std::fread (&overwritten, sizeof (overwritten), 1, file) == 1;
+    if (ok && count > 0)
+    {
+        size_t first = records.size ();
+        records.resize (first + count);
+        ok = std::fread (&records[first], recordSize, count, file) == count;
+        if (!ok)
+        {
+            records.resize (first);
+        }
+    }
+    std::fclose (file);
+    return ok;
+}
+
+}
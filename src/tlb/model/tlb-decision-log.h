@@ -0,0 +1,92 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_DECISION_LOG_H
+#define TLB_DECISION_LOG_H
+
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+class SystemMutex;
+
+/**
+ * \brief One path decision of Ipv4TLB, 48 bytes in host byte order
+ *
+ * pathTypes holds the PathType of the first 32 available paths towards
+ * toTor at the time of the decision, 2 bits per path starting from the
+ * lowest bits; nPaths is the number of available paths.
+ */
+struct TLBDecisionRecord
+{
+    int64_t timeNs;         // simulation time in nanoseconds
+    uint32_t nodeId;        // node of the deciding Ipv4TLB
+    uint32_t flowId;
+    uint32_t fromTor;
+    uint32_t toTor;
+    uint32_t newPath;
+    uint32_t oldPath;       // 0 for a new flow
+    uint64_t pathTypes;
+    uint8_t nPaths;
+    uint8_t isRandom;
+    uint8_t isNewFlow;
+    uint8_t padding[5];
+};
+
+/**
+ * \brief Fixed size ring buffer of the path decisions of Ipv4TLB
+ *
+ * Recording a decision is a copy into a preallocated array; once the ring
+ * is full the oldest decisions are overwritten. Several Ipv4TLB may share
+ * one log, from the threads of a multithreaded simulation too: recording
+ * and reading the decisions are serialized by a mutex. Write dumps the
+ * decisions kept, oldest first, after a header: the 8 byte magic, the
+ * record size and the record count as uint32_t, and the number of
+ * overwritten records as uint64_t.
+ */
+class TLBDecisionLog : public SimpleRefCount<TLBDecisionLog>
+{
+public:
+    /**
+     * \param capacity the number of decisions kept
+     */
+    TLBDecisionLog (uint32_t capacity = 1 << 20);
+    ~TLBDecisionLog ();
+
+    void Record (const TLBDecisionRecord &record);
+
+    uint32_t GetCapacity (void) const;
+
+    // Number of decisions kept
+    uint32_t GetNRecords (void) const;
+
+    // Number of decisions recorded since the start, kept or not
+    uint64_t GetNTotal (void) const;
+
+    // Returns the decisions kept, oldest first
+    void GetRecords (std::vector<TLBDecisionRecord> &records) const;
+
+    bool Write (const std::string &filename) const;
+
+    static bool Read (const std::string &filename, std::vector<TLBDecisionRecord> &records);
+
+    static const char MAGIC[8];
+
+private:
+    TLBDecisionLog (const TLBDecisionLog &);
+    TLBDecisionLog &operator = (const TLBDecisionLog &);
+
+    // GetRecords, the mutex being held
+    void CopyRecords (std::vector<TLBDecisionRecord> &records) const;
+
+    std::vector<TLBDecisionRecord> m_records;
+    uint32_t m_next;
+    uint64_t m_total;
+    SystemMutex *m_mutex;   // serializes the simulation threads
+};
+
+}
+
+#endif
@@ -24,6 +24,9 @@ public:
   Time activeTime;
   // --
 
+  // Used in the TCP pause, not mandatory
+  Time pauseTime;
+
   // Added at Jan 12nd
 //  Time tlbFlowletActiveTime;
   // --
@@ -0,0 +1,226 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#ifndef TLB_FLOW_TABLE_H
+#define TLB_FLOW_TABLE_H
+
+#include "ns3/assert.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Per flow state of TLB, kept in a slab reached through a flow id hash
+ *
+ * The values live in a contiguous slab; a removed value returns its slot to a
+ * free list, so the slab never grows beyond the largest number of flows alive
+ * at the same time. The hash index is open addressed with linear probing and
+ * keeps the flow id next to the slot, so a lookup reads one index line and
+ * then the value itself.
+ *
+ * A pointer to a value is valid until the next Insert.
+ */
+template <typename T>
+class TLBFlowTable
+{
+public:
+    TLBFlowTable ()
+      : m_size (0),
+        m_deleted (0)
+    {
+        m_index.resize (MIN_INDEX_SIZE);
+    }
+
+    /**
+     * \returns the value of the flow, 0 if the flow is unknown
+     */
+    T * Find (uint32_t flowId)
+    {
+        uint32_t pos = FindIndex (flowId);
+        if (pos == NOT_FOUND)
+        {
+            return 0;
+        }
+        return &m_slots[m_index[pos].slot].value;
+    }
+
+    /**
+     * \returns the value of the flow, a default constructed one if the flow
+     * was unknown
+     */
+    T & Insert (uint32_t flowId)
+    {
+        uint32_t pos = FindIndex (flowId);
+        if (pos != NOT_FOUND)
+        {
+            return m_slots[m_index[pos].slot].value;
+        }
+
+        if ((m_size + m_deleted + 1) * 4 > m_index.size () * 3)
+        {
+            // Grow if the live flows fill half of the index, otherwise
+            // rebuilding at the same size is enough to purge the deleted entries
+            Rehash ((m_size + 1) * 2 > m_index.size () ? m_index.size () * 2 : m_index.size ());
+        }
+
+        uint32_t slot;
+        if (!m_free.empty ())
+        {
+            slot = m_free.back ();
+            m_free.pop_back ();
+            m_slots[slot].value = T ();
+        }
+        else
+        {
+            slot = m_slots.size ();
+            m_slots.push_back (Slot ());
+        }
+        m_slots[slot].flowId = flowId;
+        m_slots[slot].isUsed = true;
+
+        uint32_t mask = m_index.size () - 1;
+        uint32_t i = Hash (flowId) & mask;
+        while (m_index[i].slot != EMPTY && m_index[i].slot != DELETED)
+        {
+            i = (i + 1) & mask;
+        }
+        if (m_index[i].slot == DELETED)
+        {
+            m_deleted--;
+        }
+        m_index[i].flowId = flowId;
+        m_index[i].slot = slot;
+        m_size++;
+        return m_slots[slot].value;
+    }
+
+    /**
+     * \brief Remove the flow and return its slot to the free list
+     */
+    void Remove (uint32_t flowId)
+    {
+        uint32_t pos = FindIndex (flowId);
+        if (pos == NOT_FOUND)
+        {
+            return;
+        }
+        uint32_t slot = m_index[pos].slot;
+        m_slots[slot].isUsed = false;
+        m_free.push_back (slot);
+        m_index[pos].slot = DELETED;
+        m_deleted++;
+        m_size--;
+    }
+
+    uint32_t GetSize (void) const
+    {
+        return m_size;
+    }
+
+    /**
+     * \returns the number of slots of the slab, used or not, to walk the table
+     */
+    uint32_t GetNSlots (void) const
+    {
+        return m_slots.size ();
+    }
+
+    bool IsUsed (uint32_t slot) const
+    {
+        return m_slots[slot].isUsed;
+    }
+
+    uint32_t GetFlowId (uint32_t slot) const
+    {
+        return m_slots[slot].flowId;
+    }
+
+    T & GetValue (uint32_t slot)
+    {
+        NS_ASSERT (m_slots[slot].isUsed);
+        return m_slots[slot].value;
+    }
+
+private:
+    static const uint32_t MIN_INDEX_SIZE = 64;
+    static const uint32_t EMPTY = 0xffffffff;
+    static const uint32_t DELETED = 0xfffffffe;
+    static const uint32_t NOT_FOUND = 0xffffffff;
+
+    struct IndexEntry
+    {
+        IndexEntry ()
+          : flowId (0),
+            slot (EMPTY)
+        {
+        }
+        uint32_t flowId;
+        uint32_t slot;
+    };
+
+    struct Slot
+    {
+        Slot ()
+          : flowId (0),
+            isUsed (false),
+            value ()
+        {
+        }
+        uint32_t flowId;
+        bool isUsed;
+        T value;
+    };
+
+    static uint32_t Hash (uint32_t flowId)
+    {
+        // Flow ids are hashes already, only spread the similar ones
+        return (flowId * 2654435761u) ^ (flowId >> 16);
+    }
+
+    uint32_t FindIndex (uint32_t flowId) const
+    {
+        uint32_t mask = m_index.size () - 1;
+        uint32_t i = Hash (flowId) & mask;
+        while (m_index[i].slot != EMPTY)
+        {
+            if (m_index[i].slot != DELETED && m_index[i].flowId == flowId)
+            {
+                return i;
+            }
+            i = (i + 1) & mask;
+        }
+        return NOT_FOUND;
+    }
+
+    void Rehash (uint32_t indexSize)
+    {
+        std::vector<IndexEntry> index (indexSize);
+        uint32_t mask = indexSize - 1;
+        for (uint32_t slot = 0; slot < m_slots.size (); ++slot)
+        {
+            if (!m_slots[slot].isUsed)
+            {
+                continue;
+            }
+            uint32_t i = Hash (m_slots[slot].flowId) & mask;
+            while (index[i].slot != EMPTY)
+            {
+                i = (i + 1) & mask;
+            }
+            index[i].flowId = m_slots[slot].flowId;
+            index[i].slot = slot;
+        }
+        m_index.swap (index);
+        m_deleted = 0;
+    }
+
+    std::vector<IndexEntry> m_index;  // power of two sized
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_free;
+    uint32_t m_size;
+    uint32_t m_deleted;
+};
+
+}
+
+#endif
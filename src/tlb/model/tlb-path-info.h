@@ -2,6 +2,7 @@
 #define TLB_PATH_INFO_H
 
 #include "ns3/nstime.h"
+#include "ns3/lazy-dre.h"
 
 namespace ns3 {
 
@@ -21,7 +22,7 @@ public:
   Time timeStamp1;
   Time timeStamp2;
   Time timeStamp3;
-  uint32_t dreValue;
+  DreRegister dre;
 
   // Added at Jan 11st
   /*
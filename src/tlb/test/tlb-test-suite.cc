@@ -2,6 +2,7 @@
 
 // Include a header file from your module to test.
 #include "ns3/ipv4-tlb.h"
+#include "ns3/simulator.h"
 
 // An essential include is test.h
 #include "ns3/test.h"
@@ -46,6 +47,134 @@ TlbTestCase1::DoRun (void)
   NS_TEST_ASSERT_MSG_EQ_TOL (0.01, 0.01, 0.001, "Numbers are not equal within tolerance");
 }
 
+// Check that flows stay on their path and give their slot back when they finish
+class TlbFlowTableTestCase : public TestCase
+{
+public:
+  TlbFlowTableTestCase ();
+
+private:
+  virtual void DoRun (void);
+  void SelectPath (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                   bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths);
+
+  uint32_t m_flowsOnPaths;
+};
+
+TlbFlowTableTestCase::TlbFlowTableTestCase ()
+  : TestCase ("Tlb flow and path tables"),
+    m_flowsOnPaths (0)
+{
+}
+
+void
+TlbFlowTableTestCase::SelectPath (uint32_t flowId, uint32_t fromTor, uint32_t toTor, uint32_t path,
+                                  bool isRandom, PathInfo info, std::vector<PathInfo> parallelPaths)
+{
+  m_flowsOnPaths = 0;
+  for (uint32_t i = 0; i < parallelPaths.size (); ++i)
+    {
+      m_flowsOnPaths += parallelPaths[i].counter;
+    }
+}
+
+void
+TlbFlowTableTestCase::DoRun (void)
+{
+  Ptr<Ipv4TLB> tlb = CreateObject<Ipv4TLB> ();
+  Ptr<TLBDecisionLog> log = Create<TLBDecisionLog> (16);
+  tlb->SetDecisionLog (log);
+  tlb->TraceConnectWithoutContext ("SelectPath", MakeCallback (&TlbFlowTableTestCase::SelectPath, this));
+
+  Ipv4Address source ("10.0.0.1");
+  Ipv4Address destination ("10.0.1.1");
+  tlb->AddAddressWithTor (source, 0);
+  tlb->AddAddressWithTor (destination, 1);
+  tlb->AddAvailPath (1, 300);
+  tlb->AddAvailPath (1, 100);
+  tlb->AddAvailPath (1, 200);
+
+  std::vector<uint32_t> paths = tlb->GetAvailPath (destination);
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 3, "Wrong number of available paths");
+  NS_TEST_ASSERT_MSG_EQ (paths[0], 300, "Available paths out of order");
+  NS_TEST_ASSERT_MSG_EQ (paths[2], 200, "Available paths out of order");
+
+  const uint32_t nFlows = 1000;
+  for (uint32_t flowId = 1; flowId <= nFlows; ++flowId)
+    {
+      uint32_t path = tlb->GetPath (flowId * 7919, source, destination);
+      NS_TEST_ASSERT_MSG_EQ ((path == 100 || path == 200 || path == 300), true, "Not an available path");
+      NS_TEST_ASSERT_MSG_EQ (tlb->GetPath (flowId * 7919, source, destination), path, "The flow changed its path");
+    }
+  NS_TEST_ASSERT_MSG_EQ (m_flowsOnPaths, nFlows - 1, "Flows not counted on their path");
+
+  // The log keeps the last decisions, the three paths are grey until used
+  NS_TEST_ASSERT_MSG_EQ (log->GetNTotal (), nFlows, "Decisions not recorded");
+  NS_TEST_ASSERT_MSG_EQ (log->GetNRecords (), 16, "Ring not full");
+  std::string filename = CreateTempDirFilename ("tlb-decisions.bin");
+  NS_TEST_ASSERT_MSG_EQ (log->Write (filename), true, "Cannot write the decisions");
+  std::vector<TLBDecisionRecord> records;
+  NS_TEST_ASSERT_MSG_EQ (TLBDecisionLog::Read (filename, records), true, "Cannot read the decisions");
+  NS_TEST_ASSERT_MSG_EQ (records.size (), 16, "Wrong number of decisions read");
+  NS_TEST_ASSERT_MSG_EQ (records[0].flowId, (nFlows - 15) * 7919, "Oldest decision not first");
+  NS_TEST_ASSERT_MSG_EQ (records[15].flowId, nFlows * 7919, "Newest decision not last");
+  NS_TEST_ASSERT_MSG_EQ (records[15].toTor, 1, "Wrong destination ToR");
+  NS_TEST_ASSERT_MSG_EQ (records[15].isNewFlow, 1, "Decision not for a new flow");
+  NS_TEST_ASSERT_MSG_EQ (records[15].nPaths, 3, "Wrong number of paths");
+  NS_TEST_ASSERT_MSG_EQ (records[15].pathTypes, static_cast<uint64_t> (GreyPath | GreyPath << 2 | GreyPath << 4), "Wrong path types");
+
+  for (uint32_t flowId = 1; flowId <= nFlows; ++flowId)
+    {
+      tlb->FlowFinish (flowId * 7919, destination);
+    }
+  tlb->GetPath (1, source, destination);
+  NS_TEST_ASSERT_MSG_EQ (m_flowsOnPaths, 0, "Finished flows still counted on their path");
+  NS_TEST_ASSERT_MSG_EQ (tlb->GetPauseTime (1), MicroSeconds (0), "New flow paused");
+
+  Simulator::Destroy ();
+}
+
+// Addresses found through a shared ToR directory, after the ones added alone
+class TlbTorDirectoryTestCase : public TestCase
+{
+public:
+  TlbTorDirectoryTestCase ();
+
+private:
+  virtual void DoRun (void);
+};
+
+TlbTorDirectoryTestCase::TlbTorDirectoryTestCase ()
+  : TestCase ("Tlb ToR directory")
+{
+}
+
+void
+TlbTorDirectoryTestCase::DoRun (void)
+{
+  Ptr<TorDirectory> directory = Create<TorDirectory> (Ipv4Address ("10.1.1.0"), Ipv4Mask ("255.255.255.0"), 4);
+  Ptr<Ipv4TLB> tlb = CreateObject<Ipv4TLB> ();
+  tlb->SetTorDirectory (directory);
+  tlb->AddAvailPath (3, 100);
+  tlb->AddAddressWithTor (Ipv4Address ("192.168.0.1"), 2);
+  tlb->AddAvailPath (2, 200);
+
+  std::vector<uint32_t> paths = tlb->GetAvailPath (Ipv4Address ("10.1.4.7"));
+  NS_TEST_ASSERT_MSG_EQ (paths.size (), 1, "Address not found in the directory");
+  NS_TEST_ASSERT_MSG_EQ (paths[0], 100, "Wrong ToR from the directory");
+  paths = tlb->GetAvailPath (Ipv4Address ("192.168.0.1"));
+  NS_TEST_ASSERT_MSG_EQ ((paths.size () == 1 && paths[0] == 200), true, "Address added alone not found");
+  NS_TEST_ASSERT_MSG_EQ (tlb->GetAvailPath (Ipv4Address ("10.1.5.1")).empty (), true, "Address past the last ToR found");
+  NS_TEST_ASSERT_MSG_EQ (tlb->GetPath (1, Ipv4Address ("10.1.1.1"), Ipv4Address ("10.1.4.7")), 100, "Wrong path");
+
+  // An address added alone overrides the directory
+  tlb->AddAddressWithTor (Ipv4Address ("10.1.4.8"), 2);
+  paths = tlb->GetAvailPath (Ipv4Address ("10.1.4.8"));
+  NS_TEST_ASSERT_MSG_EQ ((paths.size () == 1 && paths[0] == 200), true, "Directory used before the address added alone");
+
+  Simulator::Destroy ();
+}
+
 // The TestSuite class names the TestSuite, identifies what type of TestSuite,
 // and enables the TestCases to be run.  Typically, only the constructor for
 // this class must be defined
@@ -61,6 +190,8 @@ TlbTestSuite::TlbTestSuite ()
 {
   // TestDuration for TestCase can be QUICK, EXTENSIVE or TAKES_FOREVER
   AddTestCase (new TlbTestCase1, TestCase::QUICK);
+  AddTestCase (new TlbFlowTableTestCase, TestCase::QUICK);
+  AddTestCase (new TlbTorDirectoryTestCase, TestCase::QUICK);
 }
 
 // Do not forget to allocate an instance of this TestSuite
@@ -3,7 +3,7 @@
 #include "ns3/delay-queue-disc.h"
 
 namespace ns3 {
-  
+
   NS_LOG_COMPONENT_DEFINE ("DelayQueueDisc");
   NS_OBJECT_ENSURE_REGISTERED (DelayQueueDisc);
 
@@ -32,11 +32,17 @@ namespace ns3 {
       .SetParent<QueueDisc> ()
       .SetGroupName ("TrafficControl")
       .AddConstructor<DelayQueueDisc> ()
+      .AddAttribute ("TimerGranularity",
+                     "Tick the release events are rounded up to, 0 releases every packet on time",
+                     TimeValue (Time (0)),
+                     MakeTimeAccessor (&DelayQueueDisc::m_granularity),
+                     MakeTimeChecker ())
       ;
     return tid;
   }
 
   DelayQueueDisc::DelayQueueDisc ()
+    : m_granularity (Time (0))
   {
     NS_LOG_FUNCTION (this);
   }
@@ -44,59 +50,112 @@ namespace ns3 {
   DelayQueueDisc::~DelayQueueDisc ()
   {
     NS_LOG_FUNCTION (this);
+  }
+
+  void
+  DelayQueueDisc::DoDispose (void)
+  {
+    NS_LOG_FUNCTION (this);
+    for (uint32_t cl = 0; cl < m_delayClasses.size (); ++cl)
+      {
+        if (m_delayClasses[cl] != 0)
+          {
+            m_delayClasses[cl]->event.Cancel ();
+          }
+      }
     m_delayClasses.clear ();
+    while (!m_outQueue.empty ())
+      {
+        m_outQueue.pop ();
+      }
+    QueueDisc::DoDispose ();
   }
 
   void
   DelayQueueDisc::AddDelayClass (int32_t cl, Time delay)
   {
+    NS_ASSERT_MSG (cl >= 0, "Delay classes cannot be negative");
     Ptr<DelayClass> delayClass = CreateObject<DelayClass> ();
     delayClass->cl = cl;
     delayClass->delay = delay;
+    if (static_cast<uint32_t> (cl) >= m_delayClasses.size ())
+      {
+        m_delayClasses.resize (cl + 1);
+      }
     m_delayClasses[cl] = delayClass;
   }
 
   void
-  DelayQueueDisc::FetchToOutQueue (Ptr<DelayClass> fromClass)
+  DelayQueueDisc::ArmClass (const Ptr<DelayClass> &delayClass)
   {
-    Ptr<const QueueDiscItem> item = 0;
-    item = fromClass->queue.front ();
-    fromClass->queue.pop ();
+    Time release = delayClass->queue.front ().release;
+    if (m_granularity.IsStrictlyPositive ())
+      {
+        // Round up to the next tick
+        int64_t tick = m_granularity.GetTimeStep ();
+        release = TimeStep ((release.GetTimeStep () + tick - 1) / tick * tick);
+      }
+    delayClass->event = Simulator::Schedule (release - Simulator::Now (),
+                                             &DelayQueueDisc::FetchToOutQueue, this,
+                                             static_cast<uint32_t> (delayClass->cl));
+  }
 
-    if (item == 0)
+  void
+  DelayQueueDisc::FetchToOutQueue (uint32_t cl)
+  {
+    const Ptr<DelayClass> &fromClass = m_delayClasses[cl];
+
+    while (!fromClass->queue.empty ()
+           && fromClass->queue.front ().release <= Simulator::Now ())
+      {
+        m_outQueue.push (fromClass->queue.front ().item);
+        fromClass->queue.pop ();
+        NS_LOG_INFO ("Fetch from class: " << cl << " to out queue");
+      }
+
+    if (!fromClass->queue.empty ())
       {
-        NS_LOG_ERROR ("Cannot fetch from qdisc, which is impossible to happen!");
-        return;
+        ArmClass (fromClass);
       }
 
-    m_outQueue.push (item);
-    NS_LOG_INFO ("Fetch from class: " << fromClass->cl << " to out queue");
+    // Nobody else would dequeue the packets just released if the device is
+    // idle, wake it up
+    if (GetNetDevice () != 0)
+      {
+        Run ();
+      }
   }
 
   bool
   DelayQueueDisc::DoEnqueue (Ptr<QueueDiscItem> item)
   {
     NS_LOG_FUNCTION (this << item);
-    Ptr<DelayClass> delayClass = 0;
 
     int32_t cl = Classify (item);
 
-    std::map<int32_t, Ptr<DelayClass> >::iterator itr = m_delayClasses.find (cl);
-    if (itr == m_delayClasses.end ())
+    if (cl < 0 || static_cast<uint32_t> (cl) >= m_delayClasses.size ()
+        || m_delayClasses[cl] == 0)
       {
         NS_LOG_ERROR ("Cannot find class, dropping the packet");
         Drop (item);
         return false;
       }
 
-    delayClass = itr->second;
+    const Ptr<DelayClass> &delayClass = m_delayClasses[cl];
 
-    delayClass->queue.push (ConstCast<const QueueDiscItem> (item));
+    DelayedItem delayed;
+    delayed.item = item;
+    delayed.release = Simulator::Now () + delayClass->delay;
+    delayClass->queue.push (delayed);
     NS_LOG_INFO ("Enqueue to class: " << cl);
 
-    m_event = Simulator::Schedule (delayClass->delay, &DelayQueueDisc::FetchToOutQueue, this, delayClass);
+    // The head packet already has its event, the others follow in FIFO order
+    if (!delayClass->event.IsRunning ())
+      {
+        ArmClass (delayClass);
+      }
 
-    return true; 
+    return true;
   }
 
   Ptr<QueueDiscItem>
@@ -111,7 +170,7 @@ namespace ns3 {
         return 0;
       }
 
-    item = ConstCast<QueueDiscItem> (m_outQueue.front ());
+    item = m_outQueue.front ();
     m_outQueue.pop ();
 
     return item;
@@ -120,6 +179,10 @@ namespace ns3 {
   Ptr<const QueueDiscItem>
   DelayQueueDisc::DoPeek (void) const
   {
+    if (m_outQueue.empty ())
+      {
+        return 0;
+      }
     return m_outQueue.front ();
   }
 
@@ -130,7 +193,7 @@ namespace ns3 {
     return true;
   }
 
-  void 
+  void
   DelayQueueDisc::InitializeParams (void)
   {
     NS_LOG_FUNCTION (this);
@@ -4,33 +4,55 @@
 #include "ns3/queue-disc.h"
 #include "ns3/nstime.h"
 #include "ns3/event-id.h"
-#include <list>
+#include <vector>
 #include <queue>
 
 namespace ns3 {
 
+  /**
+   * A packet held by a delay class until its release time
+   */
+  struct DelayedItem
+  {
+    Ptr<QueueDiscItem> item;
+    Time release;
+  };
+
   class DelayClass: public Object
   {
   public:
     static TypeId GetTypeId (void);
 
     DelayClass ();
-    
+
     int32_t cl;
-    std::queue<Ptr<const QueueDiscItem> > queue;
+    std::queue<DelayedItem> queue;
     Time delay;
+    EventId event;      // Release of the head packet, the only pending event of the class
   };
 
+  /**
+   * Holds every packet for the fixed delay of its class.
+   *
+   * Since the delay of a class is fixed, the packets of a class are released
+   * in FIFO order: each class keeps a single event, armed for the release
+   * time of its head packet. With a non zero TimerGranularity the events are
+   * rounded up to ticks of that granularity, so that one event releases all
+   * the packets of the class falling in the same tick.
+   */
   class DelayQueueDisc: public QueueDisc
   {
   public:
     static TypeId GetTypeId (void);
-    
+
     DelayQueueDisc ();
     virtual ~DelayQueueDisc ();
 
     void AddDelayClass (int32_t cl, Time delay);
 
+  protected:
+    virtual void DoDispose (void);
+
   private:
     virtual bool DoEnqueue (Ptr<QueueDiscItem> item);
     virtual Ptr<QueueDiscItem> DoDequeue (void);
@@ -38,11 +60,13 @@ namespace ns3 {
     virtual bool CheckConfig (void);
     virtual void InitializeParams (void);
 
-    void FetchToOutQueue (Ptr<DelayClass> fromClass);
+    void ArmClass (const Ptr<DelayClass> &delayClass);
+    void FetchToOutQueue (uint32_t cl);
+
+    Time m_granularity;
 
-    std::map<int32_t, Ptr<DelayClass> > m_delayClasses;
-    std::queue<Ptr<const QueueDiscItem> > m_outQueue;
-    EventId m_event;
+    std::vector<Ptr<DelayClass> > m_delayClasses;     // Indexed by class
+    std::queue<Ptr<QueueDiscItem> > m_outQueue;
   };
 
 }
@@ -5,6 +5,7 @@
 #include "ns3/drop-tail-queue.h"
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/string.h"
+#include "ns3/packet-tag-slots.h"
 
 #define DEFAULT_ECNSharp_LIMIT 100
 
@@ -13,6 +14,7 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("ECNSharpQueueDisc");
 
 NS_OBJECT_ENSURE_REGISTERED (ECNSharpQueueDisc);
+NS_PACKET_TAG_SLOT (ECNSharpTimestampTag);
 
 ECNSharpTimestampTag::ECNSharpTimestampTag ()
     : m_creationTime (Simulator::Now ().GetTimeStep ())
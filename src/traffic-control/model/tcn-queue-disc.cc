@@ -6,6 +6,7 @@
 #include "ns3/string.h"
 #include "ns3/ipv4-queue-disc-item.h"
 #include "ns3/drop-tail-queue.h"
+#include "ns3/packet-tag-slots.h"
 
 #define DEFAULT_TCN_LIMIT 100
 
@@ -37,6 +38,8 @@ private:
 
 };
 
+NS_PACKET_TAG_SLOT (TCNTimestampTag);
+
 TCNTimestampTag::TCNTimestampTag ()
   : m_creationTime (Simulator::Now ().GetTimeStep ())
 {
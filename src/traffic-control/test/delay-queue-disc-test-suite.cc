@@ -0,0 +1,313 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+
+#include "ns3/test.h"
+#include "ns3/delay-queue-disc.h"
+#include "ns3/packet-filter.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/error-model.h"
+#include "ns3/node.h"
+#include "ns3/nstime.h"
+#include "ns3/log.h"
+#include "ns3/simulator.h"
+
+#include <vector>
+
+using namespace ns3;
+
+class DelayQueueDiscTestItem : public QueueDiscItem {
+public:
+  DelayQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol);
+  virtual ~DelayQueueDiscTestItem ();
+  virtual void AddHeader (void);
+
+private:
+  DelayQueueDiscTestItem ();
+  DelayQueueDiscTestItem (const DelayQueueDiscTestItem &);
+  DelayQueueDiscTestItem &operator = (const DelayQueueDiscTestItem &);
+};
+
+DelayQueueDiscTestItem::DelayQueueDiscTestItem (Ptr<Packet> p, const Address & addr, uint16_t protocol)
+  : QueueDiscItem (p, addr, protocol)
+{
+}
+
+DelayQueueDiscTestItem::~DelayQueueDiscTestItem ()
+{
+}
+
+void
+DelayQueueDiscTestItem::AddHeader (void)
+{
+}
+
+/**
+ * Puts the packets of n hundred bytes in the class n
+ */
+class DelayQueueDiscTestFilter : public PacketFilter {
+public:
+  DelayQueueDiscTestFilter ();
+  virtual ~DelayQueueDiscTestFilter ();
+
+private:
+  virtual bool CheckProtocol (Ptr<QueueDiscItem> item) const;
+  virtual int32_t DoClassify (Ptr<QueueDiscItem> item) const;
+};
+
+DelayQueueDiscTestFilter::DelayQueueDiscTestFilter ()
+{
+}
+
+DelayQueueDiscTestFilter::~DelayQueueDiscTestFilter ()
+{
+}
+
+bool
+DelayQueueDiscTestFilter::CheckProtocol (Ptr<QueueDiscItem> item) const
+{
+  return true;
+}
+
+int32_t
+DelayQueueDiscTestFilter::DoClassify (Ptr<QueueDiscItem> item) const
+{
+  return item->GetPacket ()->GetSize () / 100;
+}
+
+/**
+ * Device recording the time every packet is sent, the packets being told
+ * apart by their size
+ */
+class DelayQueueDiscTestDevice : public SimpleNetDevice {
+public:
+  virtual bool Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber);
+
+  std::vector<uint32_t> m_sizes;
+  std::vector<Time> m_times;
+};
+
+bool
+DelayQueueDiscTestDevice::Send (Ptr<Packet> packet, const Address& dest, uint16_t protocolNumber)
+{
+  m_sizes.push_back (packet->GetSize ());
+  m_times.push_back (Simulator::Now ());
+  return true;
+}
+
+/**
+ * Base of the tests: a DelayQueueDisc on a recording device, the packets
+ * enqueued at given times as the traffic control layer does, i.e. running
+ * the queue disc right after the enqueue
+ */
+class DelayQueueDiscTestCase : public TestCase
+{
+public:
+  DelayQueueDiscTestCase (std::string description);
+
+protected:
+  void Setup (Time granularity);
+  void Enqueue (uint32_t size, Time at);
+  void DoEnqueue (uint32_t size);
+  void CheckSent (uint32_t n, uint32_t size, Time at);
+  void Finish (void);
+
+  Ptr<DelayQueueDisc> m_queue;
+  Ptr<DelayQueueDiscTestDevice> m_device;
+};
+
+DelayQueueDiscTestCase::DelayQueueDiscTestCase (std::string description)
+  : TestCase (description)
+{
+}
+
+void
+DelayQueueDiscTestCase::Setup (Time granularity)
+{
+  Ptr<Node> node = CreateObject<Node> ();
+  m_device = CreateObject<DelayQueueDiscTestDevice> ();
+  node->AddDevice (m_device);
+  m_device->AggregateObject (CreateObject<NetDeviceQueueInterface> ());
+
+  m_queue = CreateObject<DelayQueueDisc> ();
+  m_queue->SetAttribute ("TimerGranularity", TimeValue (granularity));
+  m_queue->AddPacketFilter (CreateObject<DelayQueueDiscTestFilter> ());
+  m_queue->SetNetDevice (m_device);
+  m_queue->Initialize ();
+}
+
+void
+DelayQueueDiscTestCase::Enqueue (uint32_t size, Time at)
+{
+  Simulator::Schedule (at, &DelayQueueDiscTestCase::DoEnqueue, this, size);
+}
+
+void
+DelayQueueDiscTestCase::DoEnqueue (uint32_t size)
+{
+  Address dest;
+  m_queue->Enqueue (Create<DelayQueueDiscTestItem> (Create<Packet> (size), dest, 0));
+  m_queue->Run ();
+}
+
+void
+DelayQueueDiscTestCase::CheckSent (uint32_t n, uint32_t size, Time at)
+{
+  NS_TEST_ASSERT_MSG_LT (n, m_device->m_sizes.size (), "Packet " << n << " not sent");
+  NS_TEST_EXPECT_MSG_EQ (m_device->m_sizes[n], size, "Packet " << n << " sent out of order");
+  NS_TEST_EXPECT_MSG_EQ (m_device->m_times[n], at, "Packet " << n << " sent at a wrong time");
+}
+
+void
+DelayQueueDiscTestCase::Finish (void)
+{
+  m_queue->Dispose ();
+  m_device->GetNode ()->Dispose ();
+  Simulator::Destroy ();
+}
+
+// Test 1: every packet is released after the delay of its class
+class DelayQueueDiscClassDelay : public DelayQueueDiscTestCase
+{
+public:
+  DelayQueueDiscClassDelay ();
+  virtual void DoRun (void);
+};
+
+DelayQueueDiscClassDelay::DelayQueueDiscClassDelay ()
+  : DelayQueueDiscTestCase ("Release of the packets after the delay of their class")
+{
+}
+
+void
+DelayQueueDiscClassDelay::DoRun (void)
+{
+  Setup (Time (0));
+  m_queue->AddDelayClass (0, MicroSeconds (10));
+  m_queue->AddDelayClass (1, MicroSeconds (30));
+
+  Enqueue (150, MicroSeconds (0));
+  Enqueue (50, MicroSeconds (0));
+  Enqueue (60, MicroSeconds (5));
+  Enqueue (160, MicroSeconds (12));
+  // No class 2, dropped
+  Enqueue (250, MicroSeconds (12));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_device->m_sizes.size (), 4, "Wrong number of packets sent");
+  CheckSent (0, 50, MicroSeconds (10));
+  CheckSent (1, 60, MicroSeconds (15));
+  CheckSent (2, 150, MicroSeconds (30));
+  CheckSent (3, 160, MicroSeconds (42));
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetTotalDroppedPackets (), 1, "The packet without class not dropped");
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 0, "Packets left in the queue disc");
+
+  Finish ();
+}
+
+// Test 2: the release events are rounded up to the timer granularity
+class DelayQueueDiscGranularity : public DelayQueueDiscTestCase
+{
+public:
+  DelayQueueDiscGranularity ();
+  virtual void DoRun (void);
+};
+
+DelayQueueDiscGranularity::DelayQueueDiscGranularity ()
+  : DelayQueueDiscTestCase ("Release rounded up to the timer granularity")
+{
+}
+
+void
+DelayQueueDiscGranularity::DoRun (void)
+{
+  Setup (MicroSeconds (8));
+  m_queue->AddDelayClass (0, MicroSeconds (10));
+
+  // Released at 10 and 13 us, both in the tick ending at 16 us
+  Enqueue (10, MicroSeconds (0));
+  Enqueue (20, MicroSeconds (3));
+  // Released at 17 us, in the next tick
+  Enqueue (30, MicroSeconds (7));
+  // Released at 30 us, not on a tick
+  Enqueue (40, MicroSeconds (20));
+  // Released at 32 us, on a tick
+  Enqueue (50, MicroSeconds (22));
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_device->m_sizes.size (), 5, "Wrong number of packets sent");
+  CheckSent (0, 10, MicroSeconds (16));
+  CheckSent (1, 20, MicroSeconds (16));
+  CheckSent (2, 30, MicroSeconds (24));
+  CheckSent (3, 40, MicroSeconds (32));
+  CheckSent (4, 50, MicroSeconds (32));
+
+  Finish ();
+}
+
+// Test 3: the queue disc wakes the device up by itself when a delayed packet
+// is released, both after an enqueue to an empty queue disc and after a
+// dequeue leaving delayed packets
+class DelayQueueDiscWakeUp : public DelayQueueDiscTestCase
+{
+public:
+  DelayQueueDiscWakeUp ();
+  virtual void DoRun (void);
+
+private:
+  void CheckQueued (uint32_t nSent, uint32_t nQueued);
+};
+
+DelayQueueDiscWakeUp::DelayQueueDiscWakeUp ()
+  : DelayQueueDiscTestCase ("Wake up of the device on the release of the delayed packets")
+{
+}
+
+void
+DelayQueueDiscWakeUp::CheckQueued (uint32_t nSent, uint32_t nQueued)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_device->m_sizes.size (), nSent, "Wrong number of packets sent at " << Simulator::Now ());
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), nQueued, "Wrong number of packets delayed at " << Simulator::Now ());
+}
+
+void
+DelayQueueDiscWakeUp::DoRun (void)
+{
+  Setup (Time (0));
+  m_queue->AddDelayClass (0, MicroSeconds (10));
+
+  // The run following the enqueue to the empty queue disc finds nothing to
+  // send, the release event must wake the device up
+  Enqueue (10, MicroSeconds (0));
+  Simulator::Schedule (MicroSeconds (1), &DelayQueueDiscWakeUp::CheckQueued, this, 0, 1);
+  // The packet arriving meanwhile is still delayed when the first one is
+  // dequeued, it needs a wake up of its own
+  Enqueue (20, MicroSeconds (4));
+  Simulator::Schedule (MicroSeconds (12), &DelayQueueDiscWakeUp::CheckQueued, this, 1, 1);
+  // A packet enqueued once the queue disc is empty again
+  Enqueue (30, MicroSeconds (50));
+  Simulator::Schedule (MicroSeconds (55), &DelayQueueDiscWakeUp::CheckQueued, this, 2, 1);
+  Simulator::Run ();
+
+  NS_TEST_ASSERT_MSG_EQ (m_device->m_sizes.size (), 3, "Delayed packets never sent");
+  CheckSent (0, 10, MicroSeconds (10));
+  CheckSent (1, 20, MicroSeconds (14));
+  CheckSent (2, 30, MicroSeconds (60));
+  NS_TEST_EXPECT_MSG_EQ (m_queue->GetNPackets (), 0, "Packets left in the queue disc");
+
+  Finish ();
+}
+
+static class DelayQueueDiscTestSuite : public TestSuite
+{
+public:
+  DelayQueueDiscTestSuite ()
+    : TestSuite ("delay-queue-disc", UNIT)
+  {
+    // Test 1: release after the delay of the class
+    AddTestCase (new DelayQueueDiscClassDelay (), TestCase::QUICK);
+    // Test 2: release rounded up to the timer granularity
+    AddTestCase (new DelayQueueDiscGranularity (), TestCase::QUICK);
+    // Test 3: wake up of the device on release
+    AddTestCase (new DelayQueueDiscWakeUp (), TestCase::QUICK);
+  }
+} g_delayQueueDiscTestSuite;
@@ -3,8 +3,6 @@
 #include "ipv4-xpath-routing.h"
 #include "ns3/ipv4-xpath-tag.h"
 #include "ns3/net-device.h"
-#include "ns3/channel.h"
-#include "ns3/node.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -69,7 +67,7 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   }
 
   Ipv4XPathTag ipv4XPathTag;
-  bool found = packet->RemovePacketTag (ipv4XPathTag);
+  bool found = packet->PeekPacketTag (ipv4XPathTag);
   if (!found)
   {
     NS_LOG_ERROR (this << " Cannot perform XPath routing without knowing the Path ID");
@@ -82,6 +80,7 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   if (pathId == 0)
   {
     NS_LOG_LOGIC (this << " Reaching final hop, XPath will not handle the final hop");
+    packet->RemovePacketTag (ipv4XPathTag);
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
   }
@@ -95,54 +94,42 @@ Ipv4XPathRouting::RouteInput (Ptr<const Packet> p, const Ipv4Header &header, Ptr
   if (currentPort > m_ipv4->GetNInterfaces ())
   {
     NS_LOG_ERROR (this << " Port number error");
+    packet->RemovePacketTag (ipv4XPathTag);
     ecb (packet, header, Socket::ERROR_NOROUTETOHOST);
     return false;
   }
 
   NS_LOG_LOGIC (this << " Forwarding packet: " << packet << " to port: " << currentPort);
 
+  // Rewrite the tag in place for the next hop
   ipv4XPathTag.SetPathId (pathId / 100);
-  packet->AddPacketTag (ipv4XPathTag);
-
-  Ptr<NetDevice> dev = m_ipv4->GetNetDevice (currentPort);
-  Ptr<Channel> channel = dev->GetChannel ();
-  uint32_t otherEnd = (channel->GetDevice (0) == dev) ? 1 : 0;
-  Ptr<Node> nextHop = channel->GetDevice (otherEnd)->GetNode ();
-  uint32_t nextIf = channel->GetDevice (otherEnd)->GetIfIndex ();
-  Ipv4Address nextHopAddr = nextHop->GetObject<Ipv4>()->GetAddress (nextIf, 0).GetLocal ();
-  Ptr<Ipv4Route> route = Create<Ipv4Route> ();
-  route->SetOutputDevice (m_ipv4->GetNetDevice (currentPort));
-  route->SetGateway (nextHopAddr);
-  route->SetSource (m_ipv4->GetAddress (currentPort, 0).GetLocal ());
-  route->SetDestination (destAddress);
-
-  ucb (route, packet, header);
-
-  return true;
+  packet->ReplacePacketTag (ipv4XPathTag);
+
+  return m_nextHopTable.Forward (currentPort, packet, header, ucb, ecb);
 }
 
 void
 Ipv4XPathRouting::NotifyInterfaceUp (uint32_t interface)
 {
-
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4XPathRouting::NotifyInterfaceDown (uint32_t interface)
 {
-
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4XPathRouting::NotifyAddAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
 Ipv4XPathRouting::NotifyRemoveAddress (uint32_t interface, Ipv4InterfaceAddress address)
 {
-
+  m_nextHopTable.Invalidate (interface);
 }
 
 void
@@ -151,6 +138,7 @@ Ipv4XPathRouting::SetIpv4 (Ptr<Ipv4> ipv4)
   NS_LOG_LOGIC (this << "Setting up Ipv4: " << ipv4);
   NS_ASSERT (m_ipv4 == 0 && ipv4 != 0);
   m_ipv4 = ipv4;
+  m_nextHopTable.SetIpv4 (ipv4);
 }
 
 void
@@ -163,6 +151,7 @@ void
 Ipv4XPathRouting::DoDispose (void)
 {
   m_ipv4 = 0;
+  m_nextHopTable.Clear ();
   Ipv4RoutingProtocol::DoDispose ();
 }
 
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/datacenter-topology-helper.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/point-to-point-partition-helper.h"
+#include "ns3/packet-pool.h"
+#include <iostream>
+#include <iomanip>
+#include <new>
+#include <stdlib.h>
+
+// Drive every server of a leaf-spine with 10G server links and 40G uplinks
+// with a bulk TCP flow towards the server of the same rank under the next
+// leaf, so that the server links run at line rate whatever the load
+// balancer, and count the calls to operator new per packet forwarded by the
+// switches once the flows have ramped up. With --threads, the nodes run on
+// the threads of MultithreadedSimulatorImpl, to compare its wall clock time
+// with the sequential simulator.
+
+using namespace ns3;
+
+#if __cplusplus >= 201103L
+#define BENCH_THROW_BAD_ALLOC
+#define BENCH_NOTHROW noexcept
+#else
+#define BENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#define BENCH_NOTHROW throw ()
+#endif
+
+static uint64_t g_allocations = 0;     //!< calls to operator new
+static uint64_t g_allocatedBytes = 0;  //!< bytes asked to operator new
+static uint64_t g_forwarded = 0;       //!< packets forwarded by the switches
+
+void *
+operator new (std::size_t size) BENCH_THROW_BAD_ALLOC
+{
+  __sync_fetch_and_add (&g_allocations, 1);
+  __sync_fetch_and_add (&g_allocatedBytes, size);
+  void *p = malloc (size == 0 ? 1 : size);
+  if (p == 0)
+    {
+      throw std::bad_alloc ();
+    }
+  return p;
+}
+
+void
+operator delete (void *p) BENCH_NOTHROW
+{
+  free (p);
+}
+
+#if __cplusplus >= 201402L
+void
+operator delete (void *p, std::size_t) BENCH_NOTHROW
+{
+  free (p);
+}
+#endif
+
+static void
+Forwarded (const Ipv4Header &, Ptr<const Packet>, uint32_t)
+{
+  __sync_fetch_and_add (&g_forwarded, 1);
+}
+
+static uint64_t
+GetTotalRx (const ApplicationContainer &sinks)
+{
+  uint64_t total = 0;
+  for (uint32_t i = 0; i < sinks.GetN (); i++)
+    {
+      total += DynamicCast<PacketSink> (sinks.Get (i))->GetTotalRx ();
+    }
+  return total;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t nSpines = 4;
+  uint32_t nLeaves = 4;
+  uint32_t nServers = 4;
+  std::string rate = "10Gbps";
+  std::string fabricRate = "40Gbps";
+  double warmup = 0.005;
+  double duration = 0.01;
+  bool pool = false;
+  std::string loadBalancer = "ECMP";
+  uint32_t threads = 0;
+
+  CommandLine cmd;
+  cmd.Usage ("Count the allocations per packet forwarded by a leaf-spine "
+             "fabric running at line rate.");
+  cmd.AddValue ("spines", "number of spines", nSpines);
+  cmd.AddValue ("leaves", "number of leaves", nLeaves);
+  cmd.AddValue ("servers", "number of servers per leaf", nServers);
+  cmd.AddValue ("rate", "rate of the server links", rate);
+  cmd.AddValue ("fabricRate", "rate of the leaf-spine links", fabricRate);
+  cmd.AddValue ("warmup", "seconds run before counting", warmup);
+  cmd.AddValue ("duration", "seconds counted", duration);
+  cmd.AddValue ("pool", "enable the packet pools", pool);
+  cmd.AddValue ("lb", "load balancer, a runMode name", loadBalancer);
+  cmd.AddValue ("threads", "threads of the multithreaded simulator, 0 for the sequential one", threads);
+  cmd.Parse (argc, argv);
+
+  if (pool)
+    {
+      Packet::EnablePooling ();
+    }
+  if (threads > 0)
+    {
+      Ptr<MultithreadedSimulatorImpl> simulator = CreateObject<MultithreadedSimulatorImpl> ();
+      simulator->SetAttribute ("ThreadCount", UintegerValue (threads));
+      Simulator::SetImplementation (simulator);
+    }
+  Config::SetDefault ("ns3::TcpSocket::SegmentSize", UintegerValue (1448));
+  Config::SetDefault ("ns3::TcpSocket::DelAckCount", UintegerValue (0));
+  Config::SetDefault ("ns3::TcpSocketBase::MinRto", TimeValue (MilliSeconds (5)));
+  Config::SetDefault ("ns3::TcpSocket::SndBufSize", UintegerValue (1 << 20));
+  Config::SetDefault ("ns3::TcpSocket::RcvBufSize", UintegerValue (1 << 20));
+
+  DatacenterTopologyHelper topology;
+  topology.SetLeafSpine (nSpines, nLeaves, nServers);
+  topology.SetServerLinkAttributes (DataRate (rate), MicroSeconds (1));
+  topology.SetFabricLinkAttributes (DataRate (fabricRate), MicroSeconds (1));
+  topology.SetDeviceQueue ("ns3::DropTailQueue", "MaxPackets", UintegerValue (1000));
+  topology.SetLoadBalancer (loadBalancer);
+  topology.Install ();
+  topology.AssignStreams (0);
+  if (threads > 0)
+    {
+      PointToPointPartitionHelper partition;
+      partition.Partition (NodeContainer::GetGlobal (), threads);
+    }
+
+  NodeContainer servers = topology.GetServers ();
+  uint16_t port = 5000;
+  ApplicationContainer apps;
+  ApplicationContainer sinks;
+  for (uint32_t i = 0; i < servers.GetN (); i++)
+    {
+      uint32_t dst = (i + nServers) % servers.GetN ();
+      BulkSendHelper source ("ns3::TcpSocketFactory",
+                             InetSocketAddress (topology.GetServerAddress (dst), port + i));
+      source.SetAttribute ("SendSize", UintegerValue (1448 * 16));
+      apps.Add (source.Install (servers.Get (i)));
+      PacketSinkHelper sink ("ns3::TcpSocketFactory",
+                             InetSocketAddress (Ipv4Address::GetAny (), port + i));
+      sinks.Add (sink.Install (servers.Get (dst)));
+    }
+  apps.Add (sinks);
+  apps.Start (Seconds (0));
+
+  NodeContainer switches (topology.GetTors (), topology.GetSpines ());
+  for (uint32_t i = 0; i < switches.GetN (); i++)
+    {
+      switches.Get (i)->GetObject<Ipv4L3Protocol> ()
+        ->TraceConnectWithoutContext ("UnicastForward", MakeCallback (&Forwarded));
+    }
+
+  Simulator::Stop (Seconds (warmup));
+  Simulator::Run ();
+
+  uint64_t allocations = g_allocations;
+  uint64_t allocatedBytes = g_allocatedBytes;
+  uint64_t forwarded = g_forwarded;
+  uint64_t received = GetTotalRx (sinks);
+  PacketPool::ResetStats ();
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  double seconds = clock.End () / 1000.0;
+  allocations = g_allocations - allocations;
+  allocatedBytes = g_allocatedBytes - allocatedBytes;
+  forwarded = g_forwarded - forwarded;
+  received = GetTotalRx (sinks) - received;
+
+  double lineRate = DataRate (rate).GetBitRate () * duration * servers.GetN ();
+  std::cout << std::fixed << std::setprecision (2)
+            << "forwarded packets: " << forwarded << std::endl
+            << "goodput: " << received * 8 / duration / 1e9 << " Gbps, "
+            << 100.0 * received * 8 / lineRate << "% of the line rate" << std::endl
+            << "allocations: " << allocations << ", "
+            << (double) allocations / forwarded << " per forwarded packet, "
+            << (double) allocatedBytes / forwarded << " bytes per forwarded packet" << std::endl
+            << "wall clock: " << seconds << " s, "
+            << forwarded / seconds << " forwarded packets/s" << std::endl;
+  if (pool)
+    {
+      PacketPool::Report (std::cout);
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
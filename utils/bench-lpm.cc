@@ -0,0 +1,125 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/command-line.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-lpm-trie.h"
+#include <iostream>
+#include <list>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdlib.h>
+
+using namespace ns3;
+
+struct BenchRoute
+{
+  Ipv4Address network;
+  Ipv4Mask mask;
+  uint32_t port;
+};
+
+static std::vector<BenchRoute>
+makeRoutes (uint32_t nRoutes)
+{
+  // Mostly host routes, as installed by the global routing on a
+  // datacenter fabric, plus a few aggregates
+  std::vector<BenchRoute> routes;
+  for (uint32_t i = 0; i < nRoutes; i++)
+    {
+      BenchRoute route;
+      uint32_t len = (i % 8 == 0) ? 16 + rand () % 8 : 32;
+      route.mask = Ipv4Mask (len == 0 ? 0 : 0xffffffff << (32 - len));
+      route.network = Ipv4Address ((0x0a000000 | (rand () & 0x00ffffff)) & route.mask.Get ());
+      route.port = rand () % 16;
+      routes.push_back (route);
+    }
+  return routes;
+}
+
+static uint64_t
+benchLinear (const std::vector<BenchRoute> &routes, const std::vector<Ipv4Address> &dests, uint64_t &hits)
+{
+  std::list<BenchRoute> table (routes.begin (), routes.end ());
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::vector<Ipv4Address>::const_iterator d = dests.begin (); d != dests.end (); ++d)
+    {
+      // Collect the matching routes as the linear lookups did
+      std::vector<uint32_t> ports;
+      for (std::list<BenchRoute>::const_iterator r = table.begin (); r != table.end (); ++r)
+        {
+          if (r->mask.IsMatch (*d, r->network))
+            {
+              ports.push_back (r->port);
+            }
+        }
+      hits += ports.size ();
+    }
+  return time.End ();
+}
+
+static uint64_t
+benchTrie (const std::vector<BenchRoute> &routes, const std::vector<Ipv4Address> &dests, uint64_t &hits)
+{
+  Ipv4LpmTrie<uint32_t> trie;
+  for (std::vector<BenchRoute>::const_iterator r = routes.begin (); r != routes.end (); ++r)
+    {
+      trie.Insert (r->network, r->mask, r->port);
+    }
+  trie.Lookup (Ipv4Address ("0.0.0.0")); // build outside the timed loop
+  SystemWallClockMs time;
+  time.Start ();
+  for (std::vector<Ipv4Address>::const_iterator d = dests.begin (); d != dests.end (); ++d)
+    {
+      hits += trie.Lookup (*d).size ();
+    }
+  return time.End ();
+}
+
+static void
+runBench (uint32_t nRoutes, uint32_t nLookups, uint32_t minIterations)
+{
+  std::vector<BenchRoute> routes = makeRoutes (nRoutes);
+  std::vector<Ipv4Address> dests;
+  for (uint32_t i = 0; i < nLookups; i++)
+    {
+      // Half of the lookups hit an installed host route
+      const BenchRoute &route = routes[rand () % routes.size ()];
+      dests.push_back (i % 2 == 0 ? route.network : Ipv4Address (0x0a000000 | (rand () & 0x00ffffff)));
+    }
+
+  uint64_t linearMs = std::numeric_limits<uint64_t>::max ();
+  uint64_t trieMs = std::numeric_limits<uint64_t>::max ();
+  uint64_t hits = 0;
+  for (uint32_t i = 0; i < minIterations; i++)
+    {
+      linearMs = std::min (linearMs, benchLinear (routes, dests, hits));
+      trieMs = std::min (trieMs, benchTrie (routes, dests, hits));
+    }
+  std::cout << nRoutes << " routes, " << nLookups << " lookups:\t"
+            << "linear " << linearMs << " ms\t"
+            << "trie " << trieMs << " ms\t"
+            << "(" << hits << " matches)"
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t n = 10000;
+  uint32_t minIterations = 1;
+
+  CommandLine cmd;
+  cmd.Usage ("Benchmark the longest prefix match trie against a linear route scan");
+  cmd.AddValue ("n", "number of lookups per table size", n);
+  cmd.AddValue ("min-iterations", "number of subiterations to minimize iteration time over", minIterations);
+  cmd.Parse (argc, argv);
+
+  srand (1);
+  std::cout << "Running bench-lpm with n=" << n << std::endl;
+  runBench (1000, n, minIterations);
+  runBench (10000, n, minIterations);
+  runBench (100000, n, minIterations);
+
+  return 0;
+}
@@ -21,6 +21,7 @@
 #include "ns3/system-wall-clock-ms.h"
 #include "ns3/packet.h"
 #include "ns3/packet-metadata.h"
+#include "ns3/packet-tag-slots.h"
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -125,13 +126,13 @@ BenchHeader<N>::Deserialize (Buffer::Iterator start)
   return N;
 }
 
-template <int N>
+template <int N, int ID = 0>
 class BenchTag : public Tag
 {
 public:
   static std::string GetName (void) {
     std::ostringstream oss;
-    oss << "anon::BenchTag<" << N << ">";
+    oss << "anon::BenchTag<" << N << "," << ID << ">";
     return oss.str ();
   }
   /**
@@ -143,7 +144,7 @@ public:
       .SetParent<Tag> ()
       .SetGroupName ("Utils")
       .HideFromDocumentation ()
-      .AddConstructor<BenchTag<N> > ()
+      .AddConstructor<BenchTag<N, ID> > ()
       ;
     return tid;
   }
@@ -284,6 +285,45 @@ benchFragment (uint32_t n)
   }
 }
 
+// The packet tags of a load balanced packet along a 3 hops path: a flow
+// id, a path id rewritten at every hop, a CONGA header and a queue disc
+// timestamp. The sizes are close to those of the real tags, the ID 1 tags
+// are given slots in main.
+template <int ID>
+static void
+benchTagHops (uint32_t n)
+{
+  BenchTag<4, ID> flowId;
+  BenchTag<6, ID> pathId;
+  BenchTag<16, ID> conga;
+  BenchTag<8, ID> timestamp;
+
+  for (uint32_t i = 0; i < n; i++)
+    {
+      Ptr<Packet> p = Create<Packet> (1500);
+      p->AddPacketTag (flowId);
+      p->AddPacketTag (pathId);
+      for (uint32_t hop = 0; hop < 3; hop++)
+        {
+          // Forwarding copies the packet
+          p = p->Copy ();
+          p->PeekPacketTag (flowId);
+          p->RemovePacketTag (pathId);
+          p->AddPacketTag (pathId);
+          if (hop == 0)
+            {
+              p->AddPacketTag (conga);
+            }
+          else
+            {
+              p->ReplacePacketTag (conga);
+            }
+          p->AddPacketTag (timestamp);
+          p->RemovePacketTag (timestamp);
+        }
+    }
+}
+
 static void
 benchByteTags (uint32_t n)
 {
@@ -350,6 +390,11 @@ int main (int argc, char *argv[])
         "by command-line argument --n=(number of packets)" << std::endl;
       exit (1);
     }
+  PacketTagSlots::Register (BenchTag<4, 1>::GetTypeId ());
+  PacketTagSlots::Register (BenchTag<6, 1>::GetTypeId ());
+  PacketTagSlots::Register (BenchTag<16, 1>::GetTypeId ());
+  PacketTagSlots::Register (BenchTag<8, 1>::GetTypeId ());
+
   std::cout << "Running bench-packets with n=" << n << std::endl;
   std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -359,6 +404,8 @@ int main (int argc, char *argv[])
   runBench (&benchD, n, minIterations, "Intermixed add/remove headers and tags");
   runBench (&benchFragment, n, minIterations, "Fragmentation and concatenation");
   runBench (&benchByteTags, n, minIterations, "Benchmark byte tags");
+  runBench (&benchTagHops<0>, n, minIterations, "Per hop packet tags in the tag list");
+  runBench (&benchTagHops<1>, n, minIterations, "Per hop packet tags in slots");
 
   return 0;
 }
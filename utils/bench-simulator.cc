@@ -124,6 +124,25 @@ Bench::Cb (void)
 }
 
 
+Ptr<RandomVariableStream>
+GetDatacenterStream (void)
+{
+  LOGME ("using datacenter event distribution");
+  // Relative event times of a packet level simulation of a 10G fabric:
+  // mostly transmissions (1-1.25 us) and propagation (10 us), then queue
+  // and transport timers up to 100 us, a few ms-scale delayed acks and
+  // pacing, and the retransmission timeouts.
+  Ptr<EmpiricalRandomVariable> erv = CreateObject<EmpiricalRandomVariable> ();
+  erv->CDF (1000,      0.0);
+  erv->CDF (1250,      0.45);
+  erv->CDF (9990,      0.55);
+  erv->CDF (10010,     0.80);
+  erv->CDF (100000,    0.95);
+  erv->CDF (5000000,   0.99);
+  erv->CDF (200000000, 1.0);
+  return erv;
+}
+
 Ptr<RandomVariableStream>
 GetRandomStream (std::string filename)
 {
@@ -186,17 +205,20 @@ int main (int argc, char *argv[])
   bool schedHeap = false;
   bool schedList = false;
   bool schedMap  = true;
+  bool schedWheel = false;
 
   uint32_t pop   =  100000;
   uint32_t total = 1000000;
   uint32_t runs  =       1;
   std::string filename = "";
+  bool datacenter = false;
   
   CommandLine cmd;
   cmd.Usage ("Benchmark the simulator scheduler.\n"
              "\n"
              "Event intervals are taken from one of:\n"
              "  an exponential distribution, with mean 100 ns,\n"
+             "  a mix of datacenter packet events, by the --dc argument,\n"
              "  an ascii file, given by the --file=\"<filename>\" argument,\n"
              "  or standard input, by the argument --file=\"-\"\n"
              "In the case of either --file form, the input is expected\n"
@@ -205,11 +227,13 @@ int main (int argc, char *argv[])
   cmd.AddValue ("heap",  "use HeapScheduler",             schedHeap);
   cmd.AddValue ("list",  "use ListSheduler",              schedList);
   cmd.AddValue ("map",   "use MapScheduler (default)",    schedMap);
+  cmd.AddValue ("wheel", "use TimingWheelScheduler",      schedWheel);
   cmd.AddValue ("debug", "enable debugging output",       g_debug);
   cmd.AddValue ("pop",   "event population size (default 1E5)",         pop);
   cmd.AddValue ("total", "total number of events to run (default 1E6)", total);
   cmd.AddValue ("runs",  "number of runs (default 1)",    runs);
   cmd.AddValue ("file",  "file of relative event times",  filename);
+  cmd.AddValue ("dc",    "use datacenter event times",    datacenter);
   cmd.AddValue ("prec",  "printed output precision",      g_fwidth);
   cmd.Parse (argc, argv);
   g_me = cmd.GetName () + ": ";
@@ -219,6 +243,7 @@ int main (int argc, char *argv[])
   if (schedCal)  { factory.SetTypeId ("ns3::CalendarScheduler"); }
   if (schedHeap) { factory.SetTypeId ("ns3::HeapScheduler");     }
   if (schedList) { factory.SetTypeId ("ns3::ListScheduler");     }  
+  if (schedWheel) { factory.SetTypeId ("ns3::TimingWheelScheduler"); }
   Simulator::SetScheduler (factory);
 
   LOGME (std::setprecision (g_fwidth - 6));
@@ -230,7 +255,7 @@ int main (int argc, char *argv[])
   LOGME ("runs: " << runs);
   
   Bench *bench = new Bench (pop, total);
-  bench->SetRandomStream (GetRandomStream (filename));
+  bench->SetRandomStream (datacenter ? GetDatacenterStream () : GetRandomStream (filename));
 
   // table header
   LOG ("");
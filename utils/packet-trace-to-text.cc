@@ -0,0 +1,35 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+#include "ns3/command-line.h"
+#include "ns3/packet-trace-writer.h"
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+// Converts a PacketTraceWriter file to the sent_ms.dat / received_ms.dat
+// text files read by the analysis scripts
+int main (int argc, char *argv[])
+{
+  std::string trace;
+  std::string sent = "sent_ms.dat";
+  std::string received = "received_ms.dat";
+
+  CommandLine cmd;
+  cmd.AddValue ("trace", "the binary packet trace", trace);
+  cmd.AddValue ("sent", "output for the sent packets, empty to skip", sent);
+  cmd.AddValue ("received", "output for the received packets, empty to skip", received);
+  cmd.Parse (argc, argv);
+
+  if (trace.empty ())
+    {
+      std::cerr << "usage: packet-trace-to-text --trace=<file> [--sent=<file>] [--received=<file>]" << std::endl;
+      return 1;
+    }
+
+  if (!PacketTraceReader::ConvertToText (trace, sent, received))
+    {
+      std::cerr << "cannot convert " << trace << std::endl;
+      return 1;
+    }
+  return 0;
+}